@@ -0,0 +1,137 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/integrator.h>
+#include <math++/calculator.h>
+#include <math++/thread.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+typedef math::TIntegrator<double> TIntegrator;
+
+// the antiderivatives of the integrated functions, to check the results
+double atanIntegral(double x) { return std::atan(x); }
+double sinIntegral(double x) { return 2 * x * std::sin(x) - (x * x - 2) * std::cos(x); }
+double lnIntegral(double x) { return x * std::log(x) - x; }
+
+void bench(const char *AName, const math::TFunction<double>& AFunction,
+    const math::TLibrary<double>& ALibrary, double (*AIntegral)(double),
+    const std::vector<double>& ALower, const std::vector<double>& AUpper) {
+
+    TIntegrator integrator(AFunction, ALibrary, 1e-10, 1e-10);
+    std::vector<TIntegrator::TResult> results(ALower.size());
+
+    std::cout << AName << std::endl;
+
+    unsigned threads[] = { 1, math::processors() };
+    for (unsigned i = 0; i < sizeof(threads) / sizeof(*threads); ++i) {
+        double t = now();
+        integrator.integrate(&ALower[0], &AUpper[0], ALower.size(), &results[0], threads[i]);
+        t = now() - t;
+
+        std::cout << "  " << threads[i] << " thread(s): " << t << " ms ("
+                  << ALower.size() / (t / 1000) << " integrals/s)" << std::endl;
+    }
+
+    unsigned long evaluations = 0;
+    unsigned failed = 0;
+    double error = 0, estimate = 0;
+
+    for (unsigned i = 0; i < results.size(); ++i) {
+        evaluations += results[i].evaluations;
+
+        if (results[i].status != TIntegrator::CONVERGED)
+            ++failed;
+
+        double e = std::fabs(results[i].value - (AIntegral(AUpper[i]) - AIntegral(ALower[i])));
+        if (e > error) {
+            error = e;
+            estimate = results[i].error;
+        }
+    }
+
+    std::cout << "  " << double(evaluations) / results.size() << " evaluations each, "
+              << failed << " not converged, worst error " << error
+              << " (estimated " << estimate << ")" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Adaptive Quadrature example/benchmark program (a1)" << std::endl;
+
+    try {
+        unsigned count = argc == 2 ? std::atoi(argv[1]) : 10000;
+
+        math::TLibrary<double> library;
+        library.insert(math::TFunction<double>("g", "1 / (1 + x^2)"));
+        library.insert(math::TFunction<double>("h", "x^2 * sin(x)"));
+
+        // calculating point by point vs. in batches
+        {
+            std::vector<double> params(1000000), values(params.size());
+            for (unsigned i = 0; i < params.size(); ++i)
+                params[i] = i * 1e-5;
+
+            math::TFunction<double> f("f", "h(x) + g(x)");
+
+            double t = now();
+            for (unsigned i = 0; i < params.size(); ++i)
+                values[i] = math::TCalculator<double>::calculate(f, params[i], library);
+            t = now() - t;
+
+            double b = now();
+            for (unsigned i = 0; i < params.size(); i += 240)
+                math::TBatchCalculator<double>::calculate(f, &params[i],
+                    &params[0] + std::min<unsigned>(i + 240, params.size()), &values[i], library);
+            b = now() - b;
+
+            std::cout << params.size() << " evaluations of " << "h(x) + g(x): point by point "
+                      << t << " ms, in batches of 240: " << b << " ms" << std::endl;
+        }
+
+        std::vector<double> lower(count), upper(count);
+        std::srand(42);
+
+        for (unsigned i = 0; i < count; ++i) {
+            lower[i] = std::rand() * 20.0 / RAND_MAX - 10;
+            upper[i] = lower[i] + std::rand() * 20.0 / RAND_MAX;
+        }
+        bench("g(x) = 1 / (1 + x^2)", math::TFunction<double>("f", "g(x)"), library,
+            atanIntegral, lower, upper);
+        bench("h(x) = x^2 * sin(x)", math::TFunction<double>("f", "h(x)"), library,
+            sinIntegral, lower, upper);
+
+        // singular at 0
+        for (unsigned i = 0; i < count; ++i) {
+            lower[i] = std::rand() * 1e-3 / RAND_MAX;
+            upper[i] = 1 + std::rand() * 10.0 / RAND_MAX;
+        }
+        bench("ln(x), near 0", math::TFunction<double>("f", "ln(x)"), library,
+            lnIntegral, lower, upper);
+
+        TIntegrator integrator(math::TFunction<double>("f", "ln(x)"), library, 1e-10, 1e-10);
+        TIntegrator::TResult r = integrator.integrate(0, 1);
+        std::cout << "integral of ln(x) over [0, 1]: " << r.value << " +- " << r.error
+                  << ", " << r.evaluations << " evaluations" << std::endl;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,315 @@
+
+#include <math++/nodes.h>
+#include <math++/reader.h>
+#include <math++/printer.h>
+#include <math++/library.h>
+#include <math++/loader.h>
+#include <math++/serializer.h>
+#include <math++/utils.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace math;
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+unsigned failures = 0;
+
+void check(bool ACondition, const std::string& AWhat) {
+    if (!ACondition) {
+        std::cout << "FAILED: " << AWhat << std::endl;
+        ++failures;
+    }
+}
+
+// writes, reads back and writes again; both binary forms must be the same
+void roundTrip(const TNode<double> *AExpr, const std::string& AWhat) {
+    std::string bin;
+    TSerializer<double>::write(AExpr, bin);
+
+    std::auto_ptr<TNode<double> > back(TSerializer<double>::read(bin));
+
+    std::string again;
+    TSerializer<double>::write(back.get(), again);
+
+    check(bin == again, "round trip of " + AWhat);
+}
+
+// the read must fail with EFormatError, for AReason if given
+void corrupt(const std::string& AInput, const std::string& AWhat, const std::string& AReason = "") {
+    try {
+        delete TSerializer<double>::read(AInput);
+        check(false, AWhat + " not detected");
+    } catch (const EFormatError& e) {
+        std::cout << "  " << AWhat << ": " << e.reason() << std::endl;
+        check(AReason.empty() || e.reason() == AReason, AWhat + " detected for the wrong reason");
+    }
+}
+
+// returns ABinary claiming to be of format version AVersion, with a valid checksum
+std::string versioned(const std::string& ABinary, unsigned AVersion) {
+    std::string result(ABinary, 0, ABinary.size() - 4);
+    result[4] = char(AVersion);
+
+    unsigned crc = crc32(result.data(), result.data() + result.size());
+    for (unsigned i = 0; i < 4; ++i, crc >>= 8)
+        result += char(crc & 0xFF);
+
+    return result;
+}
+
+// returns a unique function name for the given index (letters only)
+std::string name(unsigned AIndex) {
+    std::string result("f");
+
+    do result += char('a' + AIndex % 26);
+    while (AIndex /= 26);
+
+    return result;
+}
+
+void tests() {
+    static const char *exprs[] = {
+        "x", "3.25", "pi", "-x", "x^2 + 3x - 1", "sin(x) * cos(x) / tan(x)",
+        "ln(x) - sqrt(x)", "IF(x <= 2, f(x - 1), g(x))", "[x - 1] * (x + 1)",
+        "IF(x = 1, 1, IF(x <> 2, x < 3, x > 4)) + (x >= 5)"
+    };
+
+    for (unsigned i = 0; i < sizeof(exprs) / sizeof(*exprs); ++i) {
+        std::auto_ptr<TNode<double> > e(TReader<double>::parse(exprs[i]));
+        roundTrip(e.get(), exprs[i]);
+
+        std::string bin;
+        TSerializer<double>::write(e.get(), bin);
+        std::auto_ptr<TNode<double> > back(TSerializer<double>::read(bin));
+        check(TPrinter<double>::print(back.get()) == TPrinter<double>::print(e.get()), exprs[i]);
+    }
+
+    // numbers keep all their bits
+    TNumberNode<double> third(1.0 / 3.0);
+    std::string bin;
+    TSerializer<double>::write(&third, bin);
+    std::auto_ptr<TNode<double> > back(TSerializer<double>::read(bin));
+    check(static_cast<TNumberNode<double> *>(back.get())->number() == 1.0 / 3.0, "precision");
+
+    // very high trees don't need any recursion
+    std::string tower;
+    for (unsigned i = 0; i < 1000000; ++i)
+        tower += "x^";
+    tower += "2";
+
+    std::auto_ptr<TNode<double> > high(TReader<double>::parse(tower));
+    roundTrip(high.get(), "power tower");
+
+    // corrupted data
+    std::auto_ptr<TNode<double> > e(TReader<double>::parse("IF(x < 1, sin(x), 2.5)"));
+    std::string good;
+    TSerializer<double>::write(e.get(), good);
+
+    std::string flipped(good);
+    flipped[good.size() / 2] ^= 0x10;
+    corrupt(flipped, "flipped bit");
+    corrupt(good.substr(0, good.size() - 1), "truncated");
+    corrupt(good.substr(0, 6), "header only");
+
+    // the version just written is the newest one
+    corrupt(versioned(good, good[4] + 1), "future version",
+        "Unsupported binary expression format version.");
+
+    // older versions still read, unless they use opcodes added later
+    corrupt(versioned(good, 0), "version 0", "Unsupported binary expression format version.");
+
+    for (unsigned v = 1; v < unsigned(good[4]); ++v) {
+        std::auto_ptr<TNode<double> > oldTree(TSerializer<double>::read(versioned(good, v)));
+        check(oldTree->equals(e.get()), "tree read as version " + std::string(1, char('0' + v)));
+    }
+
+    std::auto_ptr<TNode<double> > series(TReader<double>::parse("sum(k, 1, x, k^2)"));
+    std::auto_ptr<TNode<double> > let(TReader<double>::parse("let u = x + 1 in u * u"));
+    std::string seriesBin, letBin;
+    TSerializer<double>::write(series.get(), seriesBin);
+    TSerializer<double>::write(let.get(), letBin);
+
+    std::auto_ptr<TNode<double> > oldSeries(TSerializer<double>::read(versioned(seriesBin, 2)));
+    check(oldSeries->equals(series.get()), "sum() read as version 2");
+    corrupt(versioned(seriesBin, 1), "sum() as version 1", "Opcode unknown to the binary format version.");
+    corrupt(versioned(letBin, 2), "let as version 2", "Opcode unknown to the binary format version.");
+
+    // a library as written by versions 1 (no tables) and 2 (no function parameters)
+    const std::string tree(good, 8, good.size() - 12);
+    for (unsigned v = 1; v <= 2; ++v) {
+        std::string oldBin(good, 0, 8);
+        oldBin[5] = 2;                      // content: library
+        oldBin += char(0);                  // no constants
+        oldBin += char(1);                  // a function called f
+        oldBin += char(1);
+        oldBin += 'f';
+        oldBin += tree;
+        if (v == 2)
+            oldBin += char(0);              // no tables
+        oldBin += "0000";
+
+        TLibrary<double> oldLib;
+        TSerializer<double>::read(versioned(oldBin, v), oldLib);
+        check(oldLib.functions() == 1 && oldLib.find("f")->params().empty()
+            && oldLib.find("f")->expression()->equals(e.get()),
+            "library read as version " + std::string(1, char('0' + v)));
+    }
+
+    // libraries
+    TLibrary<double> lib;
+    lib.insert(TConstant<double>("pi", 3.14159265358979323846));
+    lib.insert(TConstant<double>("e", 2.71828182845904523536));
+    lib.insert(TFunction<double>("g", "sin(x)^2 + pi"));
+    lib.insert(TFunction<double>("f", "IF(x > 1, g(x) * e, 1 / 3)"));
+
+    std::string libBin;
+    TSerializer<double>::write(lib, libBin);
+
+    TLibrary<double> lib2;
+    TSerializer<double>::read(libBin, lib2);
+
+    std::string libAgain;
+    TSerializer<double>::write(lib2, libAgain);
+
+    check(libBin == libAgain, "library round trip");
+    check(lib2.functions() == 2 && lib2.constants() == 2, "library size");
+    check(lib2.call("f", 2) == lib.call("f", 2) && lib2.call("f", 0) == lib.call("f", 0), "library calls");
+
+    try {
+        delete TSerializer<double>::read(libBin);
+        check(false, "library read as tree");
+    } catch (const EFormatError& e) {
+        std::cout << "  library read as tree: " << e.reason() << std::endl;
+    }
+
+    // a library fails as a whole, nothing of it gets inserted
+    TLibrary<double> lib3;
+    std::string cut(libBin, 0, libBin.size() - 5);
+    try {
+        TSerializer<double>::read(versioned(cut + "0000", libBin[4]), lib3);
+        check(false, "truncated library not detected");
+    } catch (const EFormatError& e) {
+        std::cout << "  truncated library: " << e.reason() << std::endl;
+    }
+    check(!lib3.constants() && !lib3.functions(), "truncated library left the library alone");
+
+    try {
+        TSerializer<double>::read(libBin, lib2);
+        check(false, "library read twice");
+    } catch (const ELibraryLookup& e) {
+        std::cout << "  library read twice: " << e.reason() << std::endl;
+    }
+    check(lib2.functions() == 2 && lib2.constants() == 2, "library read twice left the library alone");
+}
+
+void bench(unsigned ACount) {
+    TLibrary<double> lib;
+    std::ostringstream text;
+
+    for (unsigned i = 0; i < ACount; ++i) {
+        std::ostringstream expr;
+
+        switch (i % 4) {
+            case 0: expr << i % 97 << ".125x^2 + " << i % 13 << "x - 1"; break;
+            case 1: expr << "sin(x) * " << name(i - 1) << "(x)"; break;
+            case 2: expr << "IF(x < " << i % 7 << ", x, ln(x))"; break;
+            case 3: expr << "[x - " << i % 5 << "] / " << 1 + i % 11; break;
+        }
+        lib.insert(TFunction<double>(name(i), expr.str()));
+    }
+
+    double t = now();
+    for (unsigned i = 0; i < ACount; ++i)
+        text << name(i) << "(x)=" << TPrinter<double>::print(lib.find(name(i))->expression()) << '\n';
+    std::string printed(text.str());
+    double tText = now() - t;
+
+    std::string bin;
+    t = now();
+    TSerializer<double>::write(lib, bin);
+    double tBin = now() - t;
+
+    std::cout << ACount << " functions: text " << printed.size() << " bytes (printed in "
+              << tText << " ms), binary " << bin.size() << " bytes (written in " << tBin
+              << " ms)" << std::endl;
+
+    // load both ways a few times and take the best, the heap makes it noisy
+    double tLoad = 1e9, tRead = 1e9;
+    for (unsigned r = 0; r < 3; ++r) {
+        {
+            TLibrary<double> l;
+            TLoader<double>::TErrors errors;
+
+            t = now();
+            TLoader<double>::load(printed.data(), printed.data() + printed.size(), l, errors, 1);
+            tLoad = std::min(tLoad, now() - t);
+        }
+        {
+            TLibrary<double> l;
+
+            t = now();
+            TSerializer<double>::read(bin, l);
+            tRead = std::min(tRead, now() - t);
+        }
+    }
+    std::cout << "  reparse: " << tLoad << " ms, binary read: " << tRead << " ms" << std::endl;
+
+    // the trees alone, without inserting them into a library
+    std::vector<std::string> trees;
+    for (unsigned i = 0; i < ACount; ++i) {
+        trees.push_back(std::string());
+        TSerializer<double>::write(lib.find(name(i))->expression(), trees.back());
+    }
+
+    t = now();
+    for (std::string::size_type pos = 0; pos != printed.size(); ) {
+        std::string::size_type eq = printed.find('=', pos);
+        std::string::size_type eol = printed.find('\n', eq);
+
+        delete TReader<double>::parse(printed.data() + eq + 1, printed.data() + eol);
+        pos = eol + 1;
+    }
+    tLoad = now() - t;
+
+    t = now();
+    for (unsigned i = 0; i < ACount; ++i)
+        delete TSerializer<double>::read(trees[i]);
+    tRead = now() - t;
+
+    std::cout << "  trees only: reparse " << tLoad << " ms, binary read " << tRead << " ms"
+              << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Binary Format example program (b1)" << std::endl;
+
+    try {
+        tests();
+        std::cout << (failures ? "round trip tests failed" : "round trip tests passed") << std::endl;
+
+        bench(argc == 2 ? std::atoi(argv[1]) : 200000);
+    } catch (const EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return failures ? 1 : 0;
+}
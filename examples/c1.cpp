@@ -0,0 +1,101 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/exprcache.h>
+#include <math++/utils.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns ACount distinct expressions
+std::vector<std::string> expressions(unsigned ACount) {
+    std::vector<std::string> result;
+
+    for (unsigned i = 0; i < ACount; ++i) {
+        std::ostringstream out;
+
+        switch (i % 3) {
+            case 0: out << i << "*2^3 - sin(" << i % 17 << ")"; break;
+            case 1: out << "IF(" << i << " > 500, ln(" << i << "), cos(" << i << "))"; break;
+            case 2: out << "[" << i << " - 3] * (" << i << " / 7 + 1) - f(" << i % 11 << ")"; break;
+        }
+        result.push_back(out.str());
+    }
+    return result;
+}
+
+// returns ACount indices in [0, AMax) drawn from a Zipf distribution with exponent AS
+std::vector<unsigned> queries(unsigned ACount, unsigned AMax, double AS) {
+    std::vector<double> cdf(AMax);
+    double sum = 0;
+
+    for (unsigned k = 0; k < AMax; ++k)
+        cdf[k] = sum += 1 / std::pow(k + 1.0, AS);
+
+    std::vector<unsigned> result(ACount);
+    std::srand(42);
+
+    for (unsigned i = 0; i < ACount; ++i) {
+        double u = sum * std::rand() / (RAND_MAX + 1.0);
+        result[i] = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Expression Cache example program (c1)" << std::endl;
+
+    try {
+        unsigned count = argc == 2 ? std::atoi(argv[1]) : 500000;
+        std::vector<std::string> exprs(expressions(10000));
+        std::vector<unsigned> q(queries(count, exprs.size(), 1.1));
+
+        math::TLibrary<double> library;
+        library.insert(math::TFunction<double>("f", "x^2 + 1"));
+
+        double sum = 0;
+        double t = now();
+        for (unsigned i = 0; i < q.size(); ++i)
+            sum += math::calculate<double>(exprs[q[i]], library);
+        t = now() - t;
+        std::cout << count << " queries uncached: " << t << " ms (sum " << sum << ")" << std::endl;
+
+        unsigned capacities[] = { 64, 1024, 16384 };
+        for (unsigned c = 0; c < sizeof(capacities) / sizeof(*capacities); ++c) {
+            math::TExprCache<double> cache(capacities[c]);
+
+            sum = 0;
+            t = now();
+            for (unsigned i = 0; i < q.size(); ++i)
+                sum += math::calculate<double>(exprs[q[i]], library, cache);
+            t = now() - t;
+
+            std::cout << "capacity " << cache.capacity() << ": " << t << " ms (sum " << sum
+                      << "), " << cache.hits() << " hits, " << cache.misses() << " misses ("
+                      << 100.0 * cache.hits() / count << "%)" << std::endl;
+        }
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
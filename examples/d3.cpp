@@ -0,0 +1,135 @@
+
+#include <math++/nodes.h>
+#include <math++/reader.h>
+#include <math++/derive.h>
+#include <math++/dag.h>
+#include <math++/library.h>
+#include <math++/calculator.h>
+#include <math++/printer.h>
+#include <math++/utils.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns the number of nodes in the given expression tree
+unsigned count(const math::TNode<double> *ANode) {
+    if (!ANode)
+        return 0;
+
+    unsigned result = 1 + count(ANode->left()) + count(ANode->right());
+
+    if (ANode->nodeType() == math::TNode<double>::IF_NODE)
+        result += count(static_cast<const math::TIfNode<double> *>(ANode)->condition());
+
+    return result;
+}
+
+void bench(const std::string& AExprStr, unsigned AOrders) {
+    const unsigned treeLimit = 1000000;  // stop cloning derivatives beyond
+    const double simplifyLimit = 1000;   // stop simplifying beyond (ms)
+
+    std::auto_ptr<math::TNode<double> > expr(math::TReader<double>::parse(AExprStr));
+    math::TLibrary<double> library;
+
+    std::auto_ptr<math::TNode<double> > raw(expr->clone());
+    std::auto_ptr<math::TNode<double> > simple(expr->clone());
+    bool rawDone = false, simpleDone = false;
+
+    math::TExprDag<double> dag;
+    math::TExprDag<double>::TId id = dag.insert(expr.get());
+
+    std::cout << std::endl << "f(x)=" << AExprStr << std::endl
+              << " n |  TDeriver nodes       ms | +TSimplifier nodes       ms |"
+              << " TExprDag nodes       ms |     f(n)(0.7)" << std::endl;
+
+    std::cout << std::setprecision(3) << std::fixed;
+    for (unsigned n = 1; n <= AOrders; ++n) {
+        // the graph goes first, so it doesn't pay for freeing the big trees
+        double dagTime = now();
+        id = dag.derive(id);
+        dagTime = now() - dagTime;
+
+        std::cout << std::setw(2) << n << " |";
+
+        if (!rawDone) {
+            double t = now();
+            raw.reset(math::TDeriver<double>::derive(raw.get()));
+            t = now() - t;
+
+            unsigned c = count(raw.get());
+            std::cout << std::setw(15) << c << std::setw(9) << t << " |";
+
+            rawDone = c > treeLimit;
+        } else
+            std::cout << std::setw(25) << "-" << " |";
+
+        if (!simpleDone) {
+            double t = now();
+            simple.reset(math::derive(simple.get(), 1));
+            t = now() - t;
+
+            std::cout << std::setw(18) << count(simple.get()) << std::setw(9) << t << " |";
+
+            simpleDone = t > simplifyLimit;
+        } else
+            std::cout << std::setw(27) << "-" << " |";
+
+        std::cout << std::setw(15) << dag.count(id) << std::setw(9) << dagTime << " |"
+                  << std::scientific << std::setw(14)
+                  << dag.calculate(id, 0.7, library) << std::fixed << std::endl;
+    }
+    std::cout << "(TExprDag holds " << dag.size() << " nodes for all orders)" << std::endl;
+}
+
+// the graph inlines let values, a series index of the same name must not capture their symbols
+void capture() {
+    const char *text = "let v = k*x in sum(k, 1, 2, v)";
+    std::auto_ptr<math::TNode<double> > expr(math::TReader<double>::parse(text));
+
+    math::TLibrary<double> library;
+    library.insert(math::TConstant<double>("k", 100));
+
+    math::TExprDag<double> dag;
+    math::TExprDag<double>::TId id = dag.insert(expr.get());
+    std::auto_ptr<math::TNode<double> > tree(dag.tree(id));
+
+    std::cout << std::endl << "f(x)=" << text << ", as graph " << math::TPrinter<double>::print(tree.get())
+              << std::endl << "  f(0.7)=" << dag.calculate(id, 0.7, library) << ", by calculator "
+              << math::TCalculator<double>::calculate(expr.get(), 0.7, library)
+              << ", f'(0.7)=" << dag.calculate(dag.derive(id), 0.7, library) << " (200 expected)"
+              << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Derivative Graph benchmark program (d3)" << std::endl;
+
+    try {
+        if (argc == 2)
+            bench(argv[1], 10);
+        else {
+            bench("sin(ln(x^2+1))", 10);
+            bench("ln(2+sin(x))^x", 10);
+            bench("x^sin(ln(x))", 10);
+            capture();
+        }
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+
+#include <math++/nodes.h>
+#include <math++/derive.h>
+#include <math++/simplifier.h>
+#include <math++/printer.h>
+#include <math++/library.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <memory>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+void bench(const math::TLibrary<double>& ALibrary, const std::string& AName,
+    unsigned AOrder, unsigned ARounds) {
+
+    const math::TFunction<double> f(ALibrary.function(AName));
+    const math::TNode<double> *expr = f.expression();
+    double uncached = now();
+    for (unsigned r = 0; r < ARounds; ++r) {
+        // the way it's done without cache: derive and simplify each time
+        std::auto_ptr<math::TNode<double> > d(expr->clone());
+
+        for (unsigned n = 0; n < AOrder; ++n) {
+            std::auto_ptr<math::TNode<double> > raw(math::TDeriver<double>::derive(d.get()));
+            d.reset(math::TSimplifier<double>::simplify(raw.get()));
+        }
+    }
+    uncached = now() - uncached;
+
+    double cached = now();
+    for (unsigned r = 0; r < ARounds; ++r)
+        ALibrary.derivative(AName, AOrder);
+    cached = now() - cached;
+
+    std::cout << AName << "(" << AOrder << ")(x)="
+              << math::TPrinter<double>::print(ALibrary.derivative(AName, AOrder)) << std::endl
+              << "  " << ARounds << " requests: " << uncached << " ms uncached, "
+              << cached << " ms cached" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Derivative Cache example program (d4)" << std::endl;
+
+    try {
+        math::TLibrary<double> library;
+
+        library.insert(math::TFunction<double>("g", "sin(x)^2"));
+        library.insert(math::TFunction<double>("f", "g(x)*ln(x+1)"));
+        library.insert(math::TFunction<double>("h", "x^3-2x+1"));
+
+        bench(library, "h", 1, 10000);
+        bench(library, "h", 2, 10000);
+        bench(library, "g", 2, 10000);
+
+        // replacing h drops its cached derivatives
+        library.insert(math::TFunction<double>("h", "x^4"), true);
+        bench(library, "h", 3, 10000);
+
+        // and so does replacing it by a constant, or removing it
+        library.insert(math::TConstant<double>("h", 2), true);
+        try {
+            library.derivative("h", 3);
+            std::cout << "h(3) still cached after h became a constant" << std::endl;
+        } catch (const math::ELibraryLookup& e) {
+            std::cout << "h is a constant now: " << e.reason() << std::endl;
+        }
+
+        library.insert(math::TFunction<double>("h", "x^5"), true);
+        bench(library, "h", 1, 10000);
+
+        library.remove("h");
+        library.insert(math::TFunction<double>("h", "x^6"));
+        bench(library, "h", 1, 10000);
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/reader.h>
+#include <math++/calculator.h>
+#include <math++/expander.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns the number of terms of the (expanded) expression
+unsigned terms(const math::TNode<double> *ANode) {
+    std::vector<const math::TNode<double> *> pending(1, ANode);
+    unsigned result = 0;
+
+    while (!pending.empty()) {
+        const math::TNode<double> *n = pending.back();
+        pending.pop_back();
+
+        if (n->nodeType() == math::TNode<double>::PLUS_NODE) {
+            pending.push_back(n->left());
+            pending.push_back(n->right());
+        } else
+            ++result;
+    }
+    return result;
+}
+
+void bench(const char *AExpression, const math::TLibrary<double>& ALibrary) {
+    std::auto_ptr<math::TNode<double> > expr(math::TReader<double>::parse(AExpression));
+
+    double t = now();
+    std::auto_ptr<math::TNode<double> > result(math::TExpander<double>::expand(expr.get()));
+    t = now() - t;
+
+    // both have to give the same at x = 0.7
+    double a = math::TCalculator<double>::calculate(expr.get(), 0.7, ALibrary);
+    double b = math::TCalculator<double>::calculate(result.get(), 0.7, ALibrary);
+
+    std::cout << AExpression << ": " << terms(result.get()) << " terms in " << t
+              << " ms, relative difference " << std::fabs(a - b) / std::fabs(a) << std::endl;
+}
+
+int main() {
+    std::cout << "Polynomial Expansion example/benchmark program (e2)" << std::endl;
+
+    try {
+        math::TLibrary<double> library;
+        const char *symbols[] = { "a", "b", "c", "d", "e", "f", "y", "z", "t" };
+
+        for (unsigned i = 0; i < sizeof(symbols) / sizeof(*symbols); ++i)
+            library.insert(math::TConstant<double>(symbols[i], 0.1 + i * 0.05));
+
+        bench("(x+1)^2*(x-1)", library);
+        bench("(a+b+c+d+e+f)^10", library);
+        bench("(1+x+y+z+t)^20", library);
+        bench("(1+x+y+z+t)^10*((1+x+y+z+t)^10+1)", library);
+        bench("(x+y+z+1)^15*(x-y-z-1)^15", library);
+        bench("(sin(x)+a+1)^30/(a+1)", library);
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/calculator.h>
+#include <math++/gradient.h>
+#include <math++/utils.h>
+
+#include <iostream>
+#include <memory>
+
+int main(int argc, char *argv[]) {
+    std::cout << "Reverse Mode Gradient example program (g1)" << std::endl;
+
+    try {
+        math::TLibrary<double> library;
+        library.insert(math::TConstant<double>("a", 0.5));
+        library.insert(math::TConstant<double>("b", 2));
+        library.insert(math::TConstant<double>("c", 3));
+        library.insert(math::TFunction<double>("g", "b*sin(c*x)"));
+
+        math::TFunction<double> f("f", argc == 3 ? argv[1] : "a*x^2 + g(x) + a*c");
+        double x = argc == 3 ? math::calculate<double>(argv[2]) : 1.5;
+
+        math::TGradient<double>::TResult grad;
+        double y = math::TGradient<double>::gradient(f, x, library, grad);
+
+        std::cout << f << std::endl
+                  << "\tf(" << x << ")=" << y << std::endl;
+
+        for (math::TGradient<double>::TResult::iterator i = grad.begin(); i != grad.end(); ++i)
+            std::cout << "\tdf/d" << i->first << "=" << i->second << std::endl;
+
+        // the recursion limit is about the depth, fib(10) makes 177 calls
+        library.insert(math::TFunction<double>("fib", "IF(x <= 1, c*x, fib(x - 1) + fib(x - 2))"));
+        math::TFunction<double> r("r", "fib(x)");
+
+        grad.clear();
+        y = math::TGradient<double>::gradient(r, 10, library, grad);
+
+        std::cout << r << std::endl
+                  << "\tr(10)=" << y << ", by calculator "
+                  << math::TCalculator<double>::calculate(r, 10, library) << std::endl
+                  << "\tdr/dc=" << grad["c"] << std::endl;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/calculator.h>
+#include <math++/printer.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// evaluates AName for AParams one by one and as batch, prints the rates and returns the sum
+double bench(const char *ATitle, const std::string& AName, const math::TLibrary<double>& ALibrary,
+    const std::vector<double>& AParams) {
+
+    const math::TFunction<double> *f = ALibrary.find(AName);
+    double sum = 0;
+
+    double t = now();
+    for (unsigned i = 0; i < AParams.size(); ++i)
+        sum += math::TCalculator<double>::calculate(*f, AParams[i], ALibrary);
+    t = now() - t;
+
+    std::vector<double> results(AParams.size());
+
+    double b = now();
+    math::TBatchCalculator<double>::calculate(*f, &AParams[0], &AParams[0] + AParams.size(),
+        &results[0], ALibrary);
+    b = now() - b;
+
+    std::cout << "  " << ATitle << ": " << AParams.size() / (t / 1000) / 1e6 << " M/s, batch "
+              << AParams.size() / (b / 1000) / 1e6 << " M/s" << std::endl;
+
+    return sum;
+}
+
+// benchmarks the inline form AInline against the bound form ABound of the same formula
+void compare(const char *ATitle, const std::string& AInline, const std::string& ABound,
+    const math::TLibrary<double>& ALibrary, const std::vector<double>& AParams) {
+
+    std::cout << ATitle << ":" << std::endl;
+    double a = bench("inline ", AInline, ALibrary, AParams);
+    double b = bench("bound  ", ABound, ALibrary, AParams);
+    std::cout << "    difference of the sums " << std::fabs(a - b) << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Bindings example/benchmark program (h1)" << std::endl;
+
+    try {
+        const unsigned count = argc == 2 ? std::atoi(argv[1]) : 1000000;
+
+        // v/c (or h nu/kT) in (0.05, 0.95)
+        std::vector<double> params;
+        for (unsigned i = 0; i < count; ++i)
+            params.push_back(0.05 + 0.9 * std::rand() / RAND_MAX);
+
+        math::TLibrary<double> library;
+        library.insert(math::TConstant<double>("e", 2.71828182845904523536));
+
+        // a repeated argument
+        library.insert(math::TFunction<double>("wave", "sin(x^2 + 1)*cos(x^2 + 1) + (x^2 + 1)^2"));
+        library.insert(math::TFunction<double>("lwave", "let u = x^2 + 1 in sin(u)*cos(u) + u^2"));
+
+        // the relativistic kinetic energy and momentum per m c^2, x = v/c
+        library.insert(math::TFunction<double>("rel", "(1/sqrt(1 - x^2) - 1) + x/sqrt(1 - x^2)"));
+        library.insert(math::TFunction<double>("lrel", "let g = 1/sqrt(1 - x^2) in (g - 1) + x*g"));
+
+        // Planck's law and its temperature derivative, x = h nu/kT
+        library.insert(math::TFunction<double>("planck",
+            "x^3/(e^x - 1) + x^4*e^x/(e^x - 1)^2"));
+        library.insert(math::TFunction<double>("lplanck",
+            "let q = e^x in let n = 1/(q - 1) in x^3*n + x^4*q*n^2"));
+
+        // the potential of a dipole in the distance 2 from its axis
+        library.insert(math::TFunction<double>("dipole",
+            "1/sqrt((x - 1)^2 + 2^2) - 1/sqrt((x + 1)^2 + 2^2)"));
+        library.insert(math::TFunction<double>("pot", "x, y", "1/sqrt(x^2 + y^2)"));
+        library.insert(math::TFunction<double>("ldipole", "pot(x - 1, 2) - pot(x + 1, 2)"));
+
+        compare("sin(u)*cos(u) + u^2, u = x^2 + 1", "wave", "lwave", library, params);
+        compare("relativistic energy and momentum", "rel", "lrel", library, params);
+        compare("Planck's law", "planck", "lplanck", library, params);
+        compare("dipole potential, as two-argument calls", "dipole", "ldipole", library, params);
+
+        // the bindings survive deriving, the derivative of each bound value is bound as well
+        std::cout << "lrel(x)=" << math::TPrinter<double>::print(library.find("lrel")->expression())
+                  << std::endl << "lrel'(x)=" << math::TPrinter<double>::print(library.derivative("lrel"))
+                  << std::endl;
+
+        const double p = 0.6, h = 1e-6;
+        std::cout << "lrel'(" << p << ")=" << math::TCalculator<double>::calculate(
+                         library.derivative("lrel"), p, library)
+                  << ", rel'(" << p << ")=" << math::TCalculator<double>::calculate(
+                         library.derivative("rel"), p, library)
+                  << ", by difference quotient " << (library.call("lrel", p + h)
+                         - library.call("lrel", p - h)) / (2 * h) << std::endl;
+
+        // an inner let may rebind v, the derivative of its value still refers to the outer v
+        library.insert(math::TFunction<double>("shadow", "let v = x in let v = v*x in v"));
+        std::cout << "shadow(x)=" << math::TPrinter<double>::print(library.find("shadow")->expression())
+                  << ", shadow'(3)=" << math::TCalculator<double>::calculate(
+                         library.derivative("shadow"), 3, library)
+                  << " (6 expected)" << std::endl;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+
+#include <math++/biginteger.h>
+#include <math++/nodes.h>
+#include <math++/reader.h>
+#include <math++/printer.h>
+#include <math++/calculator.h>
+#include <math++/library.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns a random decimal number of ADigits digits
+std::string randomDigits(unsigned ADigits) {
+    std::string result(1, char('1' + std::rand() % 9));
+
+    while (result.size() < ADigits)
+        result += char('0' + std::rand() % 10);
+
+    return result;
+}
+
+// returns the residue of the decimal number ADigits modulo AModulus
+unsigned residue(const std::string& ADigits, unsigned AModulus) {
+    unsigned long long result = 0;
+
+    for (unsigned i = 0; i < ADigits.size(); ++i)
+        result = (result * 10 + (ADigits[i] - '0')) % AModulus;
+
+    return unsigned(result);
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Big Integer example/benchmark program (k1)" << std::endl;
+
+    try {
+        const unsigned maxDigits = argc == 2 ? std::atoi(argv[1]) : 1000000;
+        std::srand(42);
+
+        // the expression classes work on TBigInteger just as on double
+        math::TLibrary<math::TBigInteger> library;
+        library.insert(math::TFunction<math::TBigInteger>("fac", "IF(x <= 1, 1, x * fac(x - 1))"));
+
+        std::auto_ptr<math::TNode<math::TBigInteger> > expr(
+            math::TReader<math::TBigInteger>::parse("2^200 + fac(x)"));
+
+        std::cout << math::TPrinter<math::TBigInteger>::print(expr.get()) << " at x=30: "
+                  << math::TCalculator<math::TBigInteger>::calculate(expr.get(), 30, library)
+                  << std::endl;
+
+        std::cout << "2^128-1 = "
+                  << math::factorize(pow(math::TBigInteger(2), 128) - 1) << std::endl;
+
+        for (unsigned digits = 1000; digits <= maxDigits; digits *= 10) {
+            const std::string sa(randomDigits(digits)), sb(randomDigits(digits));
+
+            double t = now();
+            math::TBigInteger a(sa), b(sb);
+            const double parse = now() - t;
+
+            t = now();
+            math::TBigInteger p(a * b);
+            const double multiply = now() - t;
+
+            t = now();
+            std::string sp(p.toString());
+            const double print = now() - t;
+
+            t = now();
+            math::TBigInteger q(p / b);
+            const double divide = now() - t;
+
+            // the product must match modulo a few primes, and divide back
+            bool ok = q == a && (p % b).isZero();
+            static const unsigned moduli[] = { 1000000007, 998244353, 65521 };
+            for (unsigned i = 0; i < sizeof(moduli) / sizeof(*moduli); ++i)
+                ok = ok && residue(sp, moduli[i]) == (unsigned long long)residue(sa, moduli[i])
+                    * residue(sb, moduli[i]) % moduli[i];
+
+            std::cout << digits << " digits: parse " << parse << " ms, multiply "
+                      << multiply << " ms, print " << print << " ms, divide "
+                      << divide << " ms, " << (ok ? "ok" : "WRONG") << std::endl;
+
+            if (!ok)
+                return 1;
+        }
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
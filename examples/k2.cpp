@@ -0,0 +1,118 @@
+
+#include <math++/rational.h>
+#include <math++/nodes.h>
+#include <math++/reader.h>
+#include <math++/printer.h>
+#include <math++/derive.h>
+#include <math++/simplifier.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns the number of nodes in the given expression tree
+template<class T>
+unsigned count(const math::TNode<T> *ANode) {
+    std::vector<const math::TNode<T> *> pending(1, ANode);
+    unsigned result = 0;
+
+    while (!pending.empty()) {
+        const math::TNode<T> *n = pending.back();
+        pending.pop_back();
+
+        if (!n)
+            continue;
+
+        ++result;
+        pending.push_back(n->left());
+        pending.push_back(n->right());
+
+        if (n->nodeType() == math::TNode<T>::IF_NODE)
+            pending.push_back(static_cast<const math::TIfNode<T> *>(n)->condition());
+    }
+    return result;
+}
+
+// derives AFunction, simplifies the derivative ARepeat times and reports the sizes
+template<class T>
+double bench(const char *AType, const char *AFunction, unsigned ARepeat) {
+    std::auto_ptr<math::TNode<T> > f(math::TReader<T>::parse(AFunction));
+    std::auto_ptr<math::TNode<T> > d(math::TDeriver<T>::derive(f.get()));
+    std::auto_ptr<math::TNode<T> > s;
+
+    double t = now();
+    for (unsigned i = 0; i < ARepeat; ++i)
+        s.reset(math::TSimplifier<T>::simplify(d.get()));
+    t = (now() - t) / ARepeat;
+
+    std::cout << "  " << AType << ": " << count(d.get()) << " -> " << count(s.get())
+              << " nodes, " << t * 1000 << " us: " << math::TPrinter<T>::print(s.get())
+              << std::endl;
+    return t;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Exact Constant Folding example/benchmark program (k2)" << std::endl;
+
+    try {
+        const unsigned repeat = argc == 2 ? std::atoi(argv[1]) : 2000;
+
+        static const char *functions[] = {
+            "x^3/3 - 2x^(1/2) + sin(x)/7",
+            "(0.1x + 0.2)^3 - 0.3x",
+            "x^5/5 + x^4/4 + x^3/3 + x^2/2 + x",
+            "1/(1 + x^2) + 0.25x^4",
+            "ln(x)/3 + x^(2/3)",
+            "(0.1 + 0.2 - 0.3)*x^2 + x/10",
+            "0.1x * 0.2x * 0.3x",
+            "(x + 1/3) * (x - 1/3) * 3"
+        };
+
+        double exact = 0, rounded = 0;
+
+        for (unsigned i = 0; i < sizeof(functions) / sizeof(*functions); ++i) {
+            std::cout << "d/dx " << functions[i] << std::endl;
+
+            rounded += bench<double>("double   ", functions[i], repeat);
+            exact += bench<math::TRational>("TRational", functions[i], repeat);
+        }
+
+        std::cout << "simplify total: double " << rounded * 1000 << " us, TRational "
+                  << exact * 1000 << " us" << std::endl;
+
+        // integers beyond long long stay integers, as exponents and when printed
+        const math::TRational big("100000000000000000000");
+        std::cout << "1^" << big << " = " << pow(math::TRational(1), big)
+                  << ", (-1)^" << big << " = " << pow(math::TRational(-1), big)
+                  << ", " << big << "^2 = " << pow(big, math::TRational(2)) << std::endl;
+
+        std::string printed;
+        math::TPrinter<math::TRational>::print(big * big, printed);
+        std::cout << "printed within expressions: " << printed << std::endl;
+
+        try {
+            pow(math::TRational(2), big);
+        } catch (const math::ERational& e) {
+            std::cout << "2^" << big << ": " << e.reason() << std::endl;
+        }
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
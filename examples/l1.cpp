@@ -0,0 +1,129 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/loader.h>
+#include <math++/thread.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns a unique function name for the given index (letters only)
+std::string name(unsigned AIndex) {
+    std::string result("f");
+
+    do result += char('a' + AIndex % 26);
+    while (AIndex /= 26);
+
+    return result;
+}
+
+// writes ACount definitions into AFileName, each ABroken-th one is erroneous
+void generate(const std::string& AFileName, unsigned ACount, unsigned ABroken) {
+    std::ofstream out(AFileName.c_str());
+
+    out << "# generated by the l1 example program" << std::endl;
+    for (unsigned i = 0; i < ACount; ++i) {
+        out << name(i) << "(x) = ";
+
+        switch (i % 4) {
+            case 0: out << i % 97 << "x^2 + " << i % 13 << "x - 1"; break;
+            case 1: out << "sin(x) * " << name(i - 1) << "(x)"; break;
+            case 2: out << "IF(x < " << i % 7 << ", x, ln(x))"; break;
+            case 3: out << "[x - " << i % 5 << "] / " << 1 + i % 11; break;
+        }
+
+        if (ABroken && i % ABroken == ABroken - 1)
+            out << " +";
+
+        out << '\n';
+    }
+}
+
+// loads the file line by line, just as done without TLoader<>
+unsigned readLines(const std::string& AFileName, math::TLibrary<double>& ALibrary) {
+    std::ifstream in(AFileName.c_str());
+    std::string line;
+    unsigned result = 0;
+
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        try {
+            std::string::size_type eq = line.find('=');
+
+            ALibrary.insert(math::TFunction<double>(
+                line.substr(0, line.find('(')), line.substr(eq + 1)));
+            ++result;
+        } catch (const math::EMath&) {
+        }
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Bulk Loader example program (l1)" << std::endl;
+
+    const std::string fileName("l1-functions.txt");
+
+    try {
+        unsigned count = argc == 2 ? std::atoi(argv[1]) : 1000000;
+
+        generate(fileName, count, 100000);
+        std::cout << count << " definitions generated" << std::endl;
+
+        {
+            math::TLibrary<double> library;
+
+            double t = now();
+            unsigned n = readLines(fileName, library);
+            std::cout << "line by line: " << n << " functions in "
+                      << now() - t << " ms" << std::endl;
+        }
+
+        unsigned threads[] = { 1, 2, 4, math::processors() };
+        for (unsigned i = 0; i < sizeof(threads) / sizeof(*threads); ++i) {
+            math::TLibrary<double> library;
+            math::TLoader<double>::TErrors errors;
+
+            double t = now();
+            unsigned n = math::TLoader<double>::load(fileName, library, errors, threads[i]);
+            std::cout << "TLoader, " << threads[i] << " thread(s): " << n
+                      << " functions in " << now() - t << " ms, "
+                      << errors.size() << " errors" << std::endl;
+
+            if (i == 0) {
+                if (!errors.empty())
+                    std::cout << "  first error: line " << errors[0].line << ": "
+                              << errors[0].reason << std::endl;
+
+                std::cout << "  " << name(1) << "(2)=" << library.call(name(1), 2) << std::endl;
+            }
+        }
+    } catch (const math::EMath& e) {
+        std::remove(fileName.c_str());
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::remove(fileName.c_str());
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    std::remove(fileName.c_str());
+    return 0;
+}
@@ -0,0 +1,239 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/loader.h>
+#include <math++/snapshot.h>
+
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns a unique function name for the given index (letters only)
+std::string name(unsigned AIndex) {
+    std::string result("f");
+
+    do result += char('a' + AIndex % 26);
+    while (AIndex /= 26);
+
+    return result;
+}
+
+// writes ACount definitions into AFileName
+void generate(const std::string& AFileName, unsigned ACount) {
+    std::ofstream out(AFileName.c_str());
+
+    out << "fac(x) = IF(x <= 1, 1, x * fac(x - 1))\n";
+    for (unsigned i = 0; i < ACount; ++i) {
+        out << name(i) << "(x) = ";
+
+        switch (i % 4) {
+            case 0: out << i % 97 << "x^2 + " << i % 13 << "x - 1"; break;
+            case 1: out << "sin(x) * " << name(i - 1) << "(x)"; break;
+            case 2: out << "IF(x < " << i % 7 << ", x, ln(x))"; break;
+            case 3: out << "[x - " << i % 5 << "] / " << 1 + i % 11 << " + fac(x)"; break;
+        }
+        out << '\n';
+    }
+}
+
+const char *textFile = "m1-functions.txt";
+const char *snapshotFile = "m1-library.snap";
+
+// loads the text definitions, writes the snapshot and compares both
+void build(unsigned ACount) {
+    math::TLibrary<double> library;
+    math::TLoader<double>::TErrors errors;
+    math::TLoader<double>::load(textFile, library, errors, 1);
+
+    double t = now();
+    math::TSnapshot<double>::write(library, snapshotFile);
+    t = now() - t;
+
+    math::TSnapshot<double> snapshot(snapshotFile);
+
+    unsigned mismatches = 0;
+    for (unsigned i = 0; i < ACount; ++i) {
+        double a = library.call(name(i), 2.5);
+        double b = snapshot.call(name(i), 2.5);
+
+        if (a != b && (a == a || b == b))
+            ++mismatches;
+    }
+
+    std::cout << "snapshot of " << snapshot.functions() << " functions written in "
+              << t << " ms, " << mismatches << " results differ from TLibrary<>" << std::endl;
+}
+
+// TStats is what each worker reports
+struct TStats {
+    double startup;     // ms
+    double rss;         // KB
+    double shared;      // KB (file backed)
+};
+
+TStats measure() {
+    TStats result;
+    std::ifstream statm("/proc/self/statm");
+    unsigned long size, resident, shared;
+
+    statm >> size >> resident >> shared;
+
+    const double page = sysconf(_SC_PAGESIZE) / 1024.0;
+    result.rss = resident * page;
+    result.shared = shared * page;
+
+    return result;
+}
+
+// a worker process: get the library ready, use every function once, report, wait
+void worker(bool ASnapshot, unsigned ACount, int AReport, int AWait) {
+    double t = now();
+    double sum = 0;
+    TStats stats;
+
+    if (ASnapshot) {
+        math::TSnapshot<double> snapshot(snapshotFile);
+        sum += snapshot.call(name(0), 2);
+        stats.startup = now() - t;
+
+        for (unsigned i = 0; i < ACount; ++i)
+            sum += snapshot.call(name(i), 2);
+
+        TStats m = measure();
+        stats.rss = m.rss;
+        stats.shared = m.shared;
+        write(AReport, &stats, sizeof(stats));
+
+        char c;
+        read(AWait, &c, 1);
+    } else {
+        math::TLibrary<double> library;
+        math::TLoader<double>::TErrors errors;
+
+        math::TLoader<double>::load(textFile, library, errors, 1);
+        sum += library.call(name(0), 2);
+        stats.startup = now() - t;
+
+        for (unsigned i = 0; i < ACount; ++i)
+            sum += library.call(name(i), 2);
+
+        TStats m = measure();
+        stats.rss = m.rss;
+        stats.shared = m.shared;
+        write(AReport, &stats, sizeof(stats));
+
+        char c;
+        read(AWait, &c, 1);
+    }
+}
+
+// runs AProcesses workers at once and prints what they report
+void run(bool ASnapshot, unsigned ACount, unsigned AProcesses) {
+    int report[2], wait[2];
+    if (pipe(report) < 0 || pipe(wait) < 0) {
+        std::perror("pipe");
+        std::exit(1);
+    }
+
+    std::cout.flush();
+    double t = now();
+
+    std::vector<pid_t> pids;
+    for (unsigned i = 0; i < AProcesses; ++i) {
+        pid_t pid = fork();
+
+        if (pid == 0) {
+            close(report[0]);
+            close(wait[1]);
+
+            try {
+                worker(ASnapshot, ACount, report[1], wait[0]);
+            } catch (const math::EMath& e) {
+                std::cout << "exception caught: " << e.reason() << std::endl;
+                _exit(1);
+            }
+            _exit(0);
+        }
+        pids.push_back(pid);
+    }
+    close(report[1]);
+    close(wait[0]);
+
+    double startup = 0, rss = 0, unshared = 0;
+    unsigned count = 0;
+    TStats stats;
+
+    while (count < AProcesses && read(report[0], &stats, sizeof(stats)) == sizeof(stats)) {
+        startup += stats.startup;
+        rss += stats.rss;
+        unshared += stats.rss - stats.shared;
+        ++count;
+    }
+    t = now() - t;
+
+    // all workers are alive now, let them go
+    close(wait[1]);
+    close(report[0]);
+    for (unsigned i = 0; i < pids.size(); ++i)
+        waitpid(pids[i], 0, 0);
+
+    std::cout << (ASnapshot ? "snapshot" : "text    ") << ", " << AProcesses << " process(es): "
+              << "startup " << (count ? startup / count : 0) << " ms avg, all ready in "
+              << t << " ms, RSS " << rss / 1024 << " MB in total, "
+              << unshared / 1024 << " MB not shared" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Library Snapshot example program (m1)" << std::endl;
+
+    unsigned count = argc == 2 ? std::atoi(argv[1]) : 100000;
+    generate(textFile, count);
+
+    // built in a child, so the workers don't inherit the parent's heap
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        try {
+            build(count);
+        } catch (const math::EMath& e) {
+            std::cout << "exception caught: " << e.reason() << std::endl;
+            _exit(1);
+        } catch (...) {
+            std::cout << "further exception caught." << std::endl;
+            _exit(1);
+        }
+        _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        const unsigned processes[] = { 1, 32 };
+
+        for (unsigned i = 0; i < sizeof(processes) / sizeof(*processes); ++i) {
+            run(false, count, processes[i]);
+            run(true, count, processes[i]);
+        }
+    }
+
+    std::remove(textFile);
+    std::remove(snapshotFile);
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
@@ -0,0 +1,56 @@
+
+#include <math++/library.h>
+#include <math++/codegen.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+// the library compiled into the n2 benchmark program
+void define(math::TLibrary<double>& ALibrary) {
+    ALibrary.insert(math::TConstant<double>("pi", 3.14159265358979323846));
+    ALibrary.insert(math::TConstant<double>("e", 2.71828182845904523536));
+
+    ALibrary.insert(math::TFunction<double>("fac", "IF(x <= 1, 1, x * fac(x - 1))"));
+    ALibrary.insert(math::TFunction<double>("fib", "IF(x < 2, x, fib(x - 1) + fib(x - 2))"));
+    ALibrary.insert(math::TFunction<double>("poly", "3x^4 - 2x^3 + x^2/7 - 5x + 1.25"));
+    ALibrary.insert(math::TFunction<double>("wave", "sin(pi*x) * cos(x/e) + sqrt(x^2 + 1)"));
+    ALibrary.insert(math::TFunction<double>("damp", "e^(-x/10) * wave(x)"));
+    ALibrary.insert(math::TFunction<double>("ramp", "IF(x > 0, ln(x + 1), -x) + tan(x/100)"));
+
+    // calls an unknown function, so it's left to the interpreter
+    ALibrary.insert(math::TFunction<double>("later", "x * missing(x)"));
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Code Generator example program (n1)" << std::endl;
+
+    try {
+        math::TLibrary<double> library;
+        define(library);
+
+        std::string source;
+        math::TCodeGenerator<double>::generate(library, source, "n1");
+
+        if (argc == 2) {
+            std::ofstream out(argv[1]);
+            out << source;
+
+            if (!out) {
+                std::cout << "could not write " << argv[1] << std::endl;
+                return 1;
+            }
+            std::cout << source.size() << " bytes written to " << argv[1] << std::endl;
+        } else
+            std::cout << source;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+
+#include <math++/library.h>
+#include <math++/calculator.h>
+#include <math++/codegen.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+
+// the library generated by the n1 example program
+namespace n1 {
+    extern const math::TNativeFunction<double> functions[];
+    extern const unsigned functionCount;
+    extern const math::TNativeConstant<double> constants[];
+    extern const unsigned constantCount;
+}
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+void bench(const math::TNativeLibrary<double>& ALibrary, const std::string& AName,
+    double AFrom, double ATo, unsigned ACount) {
+
+    const math::TLibrary<double>& library = ALibrary.library();
+    const math::TFunction<double> *f = library.find(AName);
+    const double step = (ATo - AFrom) / ACount;
+
+    // the interpreter
+    double t = now();
+    double sum = 0;
+    for (unsigned i = 0; i < ACount; ++i)
+        sum += math::TCalculator<double>::calculate(f->expression(), AFrom + i * step, library);
+    double interpreted = now() - t;
+
+    // the compiled function
+    math::TNativeLibrary<double>::TFunctionPtr native = ALibrary.function(AName);
+    t = now();
+    double nativeSum = 0;
+    for (unsigned i = 0; i < ACount; ++i)
+        nativeSum += native(AFrom + i * step);
+    double compiled = now() - t;
+
+    // the compiler may pick other (but equally exact) instructions, e.g. sincos
+    double difference = 0;
+    for (unsigned i = 0; i < ACount; i += 97) {
+        double a = math::TCalculator<double>::calculate(f->expression(), AFrom + i * step, library);
+        double b = native(AFrom + i * step);
+
+        if (a != b && a == a && std::fabs(a - b) / std::fabs(a) > difference)
+            difference = std::fabs(a - b) / std::fabs(a);
+    }
+
+    std::cout << AName << "(x): " << ACount << " calls, interpreted " << interpreted
+              << " ms, compiled " << compiled << " ms (" << interpreted / compiled
+              << "x), relative difference " << difference << std::endl;
+
+    if (sum == 42 && nativeSum == 42)
+        std::cout << "  (the sums keep the loops alive)" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Code Generator benchmark program (n2)" << std::endl;
+
+    try {
+        unsigned count = argc == 2 ? std::atoi(argv[1]) : 200000;
+        math::TNativeLibrary<double> library(n1::functions, n1::functionCount,
+                                              n1::constants, n1::constantCount);
+
+        for (unsigned i = 0; i < n1::functionCount; ++i)
+            std::cout << n1::functions[i].name << "(x)=" << n1::functions[i].expression
+                      << (n1::functions[i].function ? "" : " (interpreted)") << std::endl;
+
+        std::cout << "fac(10)=" << library.call("fac", 10)
+                  << ", fib(20)=" << library.call("fib", 20) << std::endl;
+
+        bench(library, "poly", -10, 10, count);
+        bench(library, "wave", -10, 10, count);
+        bench(library, "damp", -10, 10, count);
+        bench(library, "ramp", -10, 10, count);
+        bench(library, "fac", 0, 20, count / 10);
+        bench(library, "fib", 0, 15, count / 1000);
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
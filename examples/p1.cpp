@@ -0,0 +1,142 @@
+
+#include <math++/nodes.h>
+#include <math++/reader.h>
+#include <math++/printer.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns a random number, some integral, some with all digits used
+double number() {
+    switch (std::rand() % 3) {
+        case 0:  return std::rand() % 1000;
+        case 1:  return std::rand() % 100000 / 100.0;
+        default: return std::rand() / (RAND_MAX + 1.0) * 1000;
+    }
+}
+
+// builds ACount formulas
+std::vector<math::TNode<double> *> formulas(unsigned ACount) {
+    std::vector<math::TNode<double> *> result;
+    std::srand(42);
+
+    for (unsigned i = 0; i < ACount; ++i) {
+        math::TNode<double> *x = new math::TParamNode<double>();
+        math::TNode<double> *e;
+
+        switch (i % 4) {
+            case 0:
+                e = new math::TPlusNode<double>(
+                    new math::TMulNode<double>(new math::TNumberNode<double>(number()),
+                        new math::TPowNode<double>(x, new math::TNumberNode<double>(2))),
+                    new math::TNumberNode<double>(number()));
+                break;
+            case 1:
+                e = new math::TMulNode<double>(new math::TSinNode<double>(
+                    new math::TDivNode<double>(x, new math::TNumberNode<double>(number()))),
+                    new math::TFuncNode<double>("f", new math::TParamNode<double>()));
+                break;
+            case 2:
+                e = new math::TIfNode<double>(
+                    new math::TLessNode<double>(x, new math::TNumberNode<double>(number())),
+                    new math::TLnNode<double>(new math::TParamNode<double>()),
+                    new math::TNumberNode<double>(number()));
+                break;
+            default:
+                e = new math::TNegNode<double>(new math::TPlusNode<double>(
+                    new math::TSymbolNode<double>("pi"),
+                    new math::TSqrtNode<double>(x)));
+                break;
+        }
+        result.push_back(e);
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Expression Printer benchmark program (p1)" << std::endl;
+
+    std::vector<math::TNode<double> *> exprs;
+
+    try {
+        unsigned count = argc == 2 ? std::atoi(argv[1]) : 1000000;
+        exprs = formulas(count);
+
+        // a string per formula
+        double t = now();
+        std::string::size_type bytes = 0;
+        for (unsigned i = 0; i < exprs.size(); ++i)
+            bytes += math::TPrinter<double>::print(exprs[i]).size();
+        t = now() - t;
+        std::cout << "print(), string per formula: " << t << " ms, "
+                  << bytes / 1048576.0 / (t / 1000) << " MB/s" << std::endl;
+
+        // a reused buffer
+        t = now();
+        std::string buffer;
+        bytes = 0;
+        for (unsigned i = 0; i < exprs.size(); ++i) {
+            buffer.clear();
+            math::TPrinter<double>::print(exprs[i], buffer);
+            bytes += buffer.size();
+        }
+        t = now() - t;
+        std::cout << "print() into a reused buffer: " << t << " ms, "
+                  << bytes / 1048576.0 / (t / 1000) << " MB/s" << std::endl;
+
+        // all of them into a file, one per line
+        t = now();
+        {
+            std::ofstream out("p1-formulas.txt");
+            math::TPrintStream<double> stream(out);
+
+            for (unsigned i = 0; i < exprs.size(); ++i)
+                stream << exprs[i] << '\n';
+        }
+        t = now() - t;
+        std::cout << "TPrintStream<> into a file: " << t << " ms, "
+                  << bytes / 1048576.0 / (t / 1000) << " MB/s" << std::endl;
+        std::remove("p1-formulas.txt");
+
+        // everything printed must read back the same
+        unsigned mismatches = 0;
+        for (unsigned i = 0; i < exprs.size(); ++i) {
+            buffer.clear();
+            math::TPrinter<double>::print(exprs[i], buffer);
+
+            math::TNode<double> *back = math::TReader<double>::parse(buffer);
+            if (!back->equals(exprs[i])) {
+                if (mismatches++ < 5)
+                    std::cout << "  differs: " << buffer << std::endl;
+            }
+            delete back;
+        }
+        std::cout << mismatches << " of " << exprs.size() << " formulas didn't read back the same" << std::endl;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    for (unsigned i = 0; i < exprs.size(); ++i)
+        delete exprs[i];
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/reader.h>
+#include <math++/calculator.h>
+#include <math++/polynomial.h>
+#include <math++/utils.h>
+#include <math++/thread.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <cmath>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+typedef math::TPolynomial<double> TPolynomial;
+typedef TPolynomial::TComplex TComplex;
+
+// returns a polynomial of given degree with random coefficients in [-1, 1]
+TPolynomial random(unsigned ADegree) {
+    std::vector<double> c(ADegree + 1);
+
+    for (unsigned k = 0; k <= ADegree; ++k)
+        c[k] = 2.0 * std::rand() / RAND_MAX - 1;
+
+    return TPolynomial(c);
+}
+
+// returns the largest |p(z)| relative to its rounding error bound over all roots
+double backwardError(const TPolynomial& APolynomial, const std::vector<TComplex>& ARoots) {
+    const std::vector<double>& c = APolynomial.coefficients();
+    double result = 0;
+
+    for (unsigned i = 0; i < ARoots.size(); ++i) {
+        TComplex p(0);
+        double bound = 0;
+
+        for (unsigned k = c.size(); k-- > 0; ) {
+            p = p * ARoots[i] + c[k];
+            bound = bound * std::abs(ARoots[i]) + std::fabs(c[k]);
+        }
+        result = std::max(result, std::abs(p) / bound);
+    }
+    return result;
+}
+
+// compares the roots of the product of (x - r) over the Chebyshev nodes r
+void chebyshev(unsigned ADegree) {
+    const double pi = std::acos(-1.0);
+    std::vector<double> nodes(ADegree);
+    std::ostringstream expression;
+
+    expression.precision(17);
+    for (unsigned k = 0; k < ADegree; ++k) {
+        nodes[k] = std::cos((2 * k + 1) * pi / (2 * ADegree));
+        expression << (k ? "*" : "") << "(x-" << nodes[k] << ")";
+    }
+
+    math::TLibrary<double> library;
+    std::auto_ptr<math::TNode<double> > expr(math::TReader<double>::parse(expression.str()));
+
+    std::cout << "product of (x - r) over " << ADegree << " Chebyshev nodes" << std::endl;
+
+    // Aberth-Ehrlich on the detected polynomial
+    double t = now();
+    TPolynomial p;
+    if (!TPolynomial::detect(expr.get(), library, p))
+        throw math::EMath("no polynomial detected");
+
+    TPolynomial::TRoots roots = p.roots();
+    t = now() - t;
+
+    double error = 0;
+    for (unsigned k = 0; k < ADegree; ++k) {
+        double e = 1e300;
+
+        for (unsigned i = 0; i < roots.roots.size(); ++i)
+            e = std::min(e, std::abs(roots.roots[i] - nodes[k]));
+
+        error = std::max(error, e);
+    }
+
+    std::cout << "  detected and solved: " << t << " ms, " << roots.roots.size()
+              << " roots, " << roots.iterations << " iterations, max error " << error << std::endl;
+
+    // Newton from 10 starting points per root through TCalculator<>
+    t = now();
+    std::auto_ptr<math::TNode<double> > derivative(math::derive(expr.get()));
+    std::vector<double> found;
+    unsigned long evaluations = 0;
+
+    for (unsigned s = 0; s < 10 * ADegree; ++s) {
+        double x = -1.1 + 2.2 * s / (10 * ADegree - 1);
+
+        for (unsigned i = 0; i < 100; ++i) {
+            double dx = math::TCalculator<double>::calculate(expr.get(), x, library)
+                      / math::TCalculator<double>::calculate(derivative.get(), x, library);
+            evaluations += 2;
+            x -= dx;
+
+            if (std::fabs(dx) < 1e-14)
+                break;
+        }
+
+        bool known = false;
+        for (unsigned i = 0; i < found.size() && !known; ++i)
+            known = std::fabs(found[i] - x) < 1e-8;
+
+        if (!known && std::fabs(x) <= 1)
+            found.push_back(x);
+    }
+    t = now() - t;
+
+    error = 0;
+    for (unsigned i = 0; i < found.size(); ++i) {
+        double e = 1e300;
+
+        for (unsigned k = 0; k < ADegree; ++k)
+            e = std::min(e, std::fabs(found[i] - nodes[k]));
+
+        error = std::max(error, e);
+    }
+
+    std::cout << "  Newton via TCalculator<>: " << t << " ms, " << found.size() << " roots, "
+              << evaluations << " evaluations, max error " << error << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Polynomial Roots example/benchmark program (p2)" << std::endl;
+
+    try {
+        unsigned count = argc == 2 ? std::atoi(argv[1]) : 10000;
+
+        std::srand(42);
+
+        chebyshev(10);
+        chebyshev(30);
+
+        // large degrees
+        for (unsigned degree = 50; degree <= 800; degree *= 2) {
+            TPolynomial p = random(degree);
+
+            double t = now();
+            TPolynomial::TRoots roots = p.roots();
+            t = now() - t;
+
+            std::cout << "degree " << degree << ": " << t << " ms, " << roots.iterations
+                      << " iterations, " << (roots.converged ? "converged" : "not converged")
+                      << ", backward error " << backwardError(p, roots.roots) << std::endl;
+        }
+
+        // many small polynomials
+        std::vector<TPolynomial> polynomials(count);
+        for (unsigned i = 0; i < count; ++i)
+            polynomials[i] = random(20);
+
+        std::vector<TPolynomial::TRoots> roots(count);
+
+        unsigned threads[] = { 1, math::processors() };
+        for (unsigned i = 0; i < sizeof(threads) / sizeof(*threads); ++i) {
+            double t = now();
+            TPolynomial::roots(&polynomials[0], &polynomials[0] + count, &roots[0], threads[i]);
+            t = now() - t;
+
+            std::cout << count << " polynomials of degree 20, " << threads[i] << " thread(s): "
+                      << t << " ms (" << count / (t / 1000) << " polynomials/s)" << std::endl;
+        }
+
+        double error = 0;
+        for (unsigned i = 0; i < count; ++i)
+            error = std::max(error, backwardError(polynomials[i], roots[i].roots));
+
+        std::cout << "  worst backward error " << error << std::endl;
+
+        // Horner's scheme on many points at once
+        std::vector<double> x(1000000), y(x.size());
+        for (unsigned i = 0; i < x.size(); ++i)
+            x[i] = i * 1e-6;
+
+        double t = now();
+        for (unsigned i = 0; i < x.size(); ++i)
+            y[i] = polynomials[0](x[i]);
+        t = now() - t;
+
+        double b = now();
+        polynomials[0].calculate(&x[0], &x[0] + x.size(), &y[0]);
+        b = now() - b;
+
+        std::cout << x.size() << " points of degree 20: one by one " << t << " ms, at once "
+                  << b << " ms" << std::endl;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
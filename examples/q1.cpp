@@ -0,0 +1,99 @@
+
+#include <math++/error.h>
+#include <math++/utils.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// the way it was done before: trial division by all odd numbers
+bool trialDivision(unsigned long long ANumber) {
+    if (ANumber < 2)
+        return false;
+
+    if (!(ANumber & 1))
+        return ANumber == 2;
+
+    for (unsigned long long n = 3; n * n <= ANumber; n += 2)
+        if (ANumber % n == 0)
+            return false;
+
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Prime Test benchmark program (q1)" << std::endl;
+
+    try {
+        const unsigned count = argc == 2 ? std::atoi(argv[1]) : 100000;
+
+        // the small ones against plain trial division
+        for (unsigned long long n = 0; n < 1000000; ++n)
+            if (math::isPrime(n) != trialDivision(n)) {
+                std::cout << "wrong result for " << n << std::endl;
+                return 1;
+            }
+
+        // the largest 64 bit prime, a Carmichael number and a strong pseudoprime to base 2
+        std::cout << "isPrime(18446744073709551557)=" << math::isPrime(18446744073709551557ULL)
+                  << ", isPrime(561)=" << math::isPrime(561)
+                  << ", isPrime(3215031751)=" << math::isPrime(3215031751ULL) << std::endl;
+
+        static const unsigned bits[] = { 16, 24, 32, 40, 48, 56, 63 };
+        std::vector<unsigned long long> numbers(count);
+        bool *flags = new bool[count];
+
+        for (unsigned b = 0; b < sizeof(bits) / sizeof(*bits); ++b) {
+            const unsigned long long base = 1ULL << bits[b];
+
+            for (unsigned i = 0; i < count; ++i)
+                numbers[i] = base + 2 * i + 1;
+
+            double t = now();
+            math::isPrime(&numbers[0], &numbers[0] + count, flags);
+            t = now() - t;
+
+            unsigned primes = 0;
+            for (unsigned i = 0; i < count; ++i)
+                primes += flags[i];
+
+            std::cout << "2^" << bits[b] << ": " << count << " odd numbers, " << primes
+                      << " primes, " << t << " ms (" << t * 1e6 / count << " ns each)";
+
+            // trial division takes way too long beyond
+            if (bits[b] <= 40) {
+                const unsigned n = bits[b] <= 32 ? count : count / 100;
+
+                double d = now();
+                unsigned agree = 0;
+                for (unsigned i = 0; i < n; ++i)
+                    agree += trialDivision(numbers[i]) == flags[i];
+                d = now() - d;
+
+                std::cout << ", trial division " << d * 1e6 / n << " ns each ("
+                          << n - agree << " differences)";
+            }
+            std::cout << std::endl;
+        }
+
+        delete[] flags;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+
+#include <math++/error.h>
+#include <math++/utils.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns a random number of ABits bits (the highest one set)
+unsigned long long randomBits(unsigned ABits) {
+    unsigned long long result = 0;
+
+    for (unsigned i = 0; i < 4; ++i)
+        result = result << 16 | (std::rand() & 0xFFFF);
+
+    if (ABits < 64)
+        result &= (1ULL << ABits) - 1;
+
+    return result | 1ULL << (ABits - 1);
+}
+
+// returns a random prime of ABits bits
+unsigned long long randomPrime(unsigned ABits) {
+    unsigned long long result;
+
+    do result = randomBits(ABits) | 1;
+    while (!math::isPrime(result));
+
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Factorization benchmark program (q2)" << std::endl;
+
+    try {
+        const unsigned count = argc == 2 ? std::atoi(argv[1]) : 200;
+        std::srand(42);
+
+        std::cout << "600851475143 = " << math::factorize(600851475143ULL) << std::endl
+                  << "2^64-1 = " << math::factorize(18446744073709551615ULL) << std::endl
+                  << "3^40 = " << math::factorize(12157665459056928801ULL) << std::endl
+                  << "4294967291^2 = " << math::factorize(18446744030759878681ULL) << std::endl;
+
+        // all numbers up to 10^5 must multiply back
+        std::vector<std::pair<unsigned long long, unsigned long long> > factors;
+        for (unsigned long long n = 2; n < 100000; ++n) {
+            math::factorize(n, factors);
+
+            unsigned long long product = 1;
+            for (unsigned i = 0; i < factors.size(); ++i)
+                for (unsigned e = 0; e < factors[i].second; ++e)
+                    product *= factors[i].first;
+
+            if (product != n) {
+                std::cout << "wrong factors for " << n << std::endl;
+                return 1;
+            }
+        }
+
+        static const unsigned bits[] = { 20, 24, 28, 32 };
+        for (unsigned b = 0; b < sizeof(bits) / sizeof(*bits); ++b) {
+            std::vector<unsigned long long> p(count), q(count);
+            for (unsigned i = 0; i < count; ++i) {
+                p[i] = randomPrime(bits[b]);
+                q[i] = randomPrime(bits[b]);
+            }
+
+            double t = now();
+            unsigned wrong = 0;
+            for (unsigned i = 0; i < count; ++i) {
+                math::factorize(p[i] * q[i], factors);
+
+                unsigned long long small = p[i] < q[i] ? p[i] : q[i];
+                if (factors.empty() || factors[0].first != small)
+                    ++wrong;
+            }
+            t = now() - t;
+
+            std::cout << count << " semiprimes of " << 2 * bits[b] << " bits: "
+                      << t << " ms (" << t / count << " ms each), "
+                      << wrong << " wrong" << std::endl;
+        }
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+
+#include <math++/error.h>
+#include <math++/utils.h>
+#include <math++/thread.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// TStatistics collects what the prime callback got
+struct TStatistics {
+    unsigned long long count, sum, previous;
+    bool ordered;
+};
+
+void collect(const unsigned long long *ABegin, const unsigned long long *AEnd, void *AContext) {
+    TStatistics& s = *static_cast<TStatistics *>(AContext);
+
+    for (const unsigned long long *i = ABegin; i != AEnd; ++i) {
+        if (*i <= s.previous)
+            s.ordered = false;
+
+        s.previous = *i;
+        s.sum += *i;
+        ++s.count;
+    }
+}
+
+// compares primes() in [AFrom, ATo] against isPrime()
+bool check(unsigned long long AFrom, unsigned long long ATo) {
+    std::vector<unsigned long long> found;
+    math::primes(AFrom, ATo, found, 2);
+
+    unsigned j = 0;
+    for (unsigned long long n = AFrom; n <= ATo; ++n)
+        if (math::isPrime(n) && (j == found.size() || found[j++] != n))
+            return false;
+
+    return j == found.size();
+}
+
+// compares countPrimes() for small ranges and more threads than numbers against isPrime()
+bool checkCount() {
+    for (unsigned long long from = 0; from < 40; ++from)
+        for (unsigned long long to = from; to < from + 40; ++to) {
+            unsigned long long count = 0;
+            for (unsigned long long n = from; n <= to; ++n)
+                count += math::isPrime(n);
+
+            for (unsigned threads = 1; threads <= 8; ++threads)
+                if (math::countPrimes(from, to, threads) != count)
+                    return false;
+        }
+
+    return math::primePi(6, 8) == 3 && math::primePi(100, 64) == 25;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Prime Sieve benchmark program (q3)" << std::endl;
+
+    try {
+        const unsigned long long window = argc == 2 ? std::atoi(argv[1]) * 1000000ULL : 1000000000ULL;
+
+        if (!check(0, 100000) || !check(1000000007, 1003000000)
+            || !check(99999000000ULL, 99999900000ULL)
+            || !check(1000000000000000ULL, 1000000001000000ULL)) {
+            std::cout << "primes() disagrees with isPrime()" << std::endl;
+            return 1;
+        }
+
+        if (!checkCount()) {
+            std::cout << "countPrimes() disagrees with isPrime()" << std::endl;
+            return 1;
+        }
+
+        static const unsigned long long pi[] = {
+            4, 25, 168, 1229, 9592, 78498, 664579, 5761455, 50847534
+        };
+
+        unsigned long long n = 10;
+        for (unsigned i = 0; i < sizeof(pi) / sizeof(*pi); ++i, n *= 10) {
+            double t = now();
+            unsigned long long count = math::primePi(n);
+            t = now() - t;
+
+            std::cout << "pi(10^" << i + 1 << ")=" << count << " in " << t << " ms"
+                      << (count == pi[i] ? "" : " (wrong)") << std::endl;
+        }
+
+        // windows of the given size up to 10^11
+        for (unsigned long long from = 1000000000ULL; from <= 100000000000ULL; from *= 10) {
+            double t = now();
+            unsigned long long count = math::countPrimes(from, from + window - 1);
+            double counted = now() - t;
+
+            TStatistics s = { 0, 0, 0, true };
+            t = now();
+            math::primes(from, from + window - 1, &collect, &s);
+            double streamed = now() - t;
+
+            std::cout << "[" << from << ", +" << window << "): " << count << " primes, counted in "
+                      << counted << " ms, streamed in " << streamed << " ms"
+                      << (s.count == count && s.ordered ? "" : " (wrong)") << std::endl;
+        }
+
+        // the scaling by threads
+        std::cout << "threads  pi(10^9) ms  streaming ms" << std::endl;
+        unsigned threads[] = { 1, 2, 4, 8, math::processors() };
+        for (unsigned i = 0; i < sizeof(threads) / sizeof(*threads); ++i) {
+            double t = now();
+            math::primePi(1000000000ULL, threads[i]);
+            double counted = now() - t;
+
+            TStatistics s = { 0, 0, 0, true };
+            t = now();
+            math::primes(0, 1000000000ULL, &collect, &s, threads[i]);
+            double streamed = now() - t;
+
+            std::cout << threads[i] << "\t " << counted << "\t      " << streamed << std::endl;
+        }
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
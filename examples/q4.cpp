@@ -0,0 +1,80 @@
+
+#include <math++/error.h>
+#include <math++/utils.h>
+#include <math++/thread.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns a random 64 bit number
+unsigned long long randomNumber() {
+    unsigned long long result = 0;
+
+    for (unsigned i = 0; i < 4; ++i)
+        result = result << 16 | (std::rand() & 0xFFFF);
+
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Batch Factorization benchmark program (q4)" << std::endl;
+
+    try {
+        const unsigned count = argc == 2 ? std::atoi(argv[1]) : 20000;
+        typedef std::vector<std::pair<unsigned long long, unsigned long long> > TFactors;
+
+        std::srand(42);
+        std::vector<unsigned long long> numbers(count);
+        for (unsigned i = 0; i < count; ++i)
+            numbers[i] = i % 2 ? randomNumber() : randomNumber() >> 32; // 64 and 32 bits
+
+        // one at a time
+        double t = now();
+        std::vector<TFactors> single(count);
+        for (unsigned i = 0; i < count; ++i)
+            math::factorize(numbers[i], single[i]);
+        t = now() - t;
+
+        std::cout << count << " numbers one at a time: " << t << " ms, "
+                  << count / (t / 1000) << " numbers/s" << std::endl;
+
+        unsigned threads[] = { 1, 2, 4, 8, math::processors() };
+        for (unsigned i = 0; i < sizeof(threads) / sizeof(*threads); ++i) {
+            std::vector<unsigned> offsets;
+            TFactors factors;
+
+            double t = now();
+            math::factorize(&numbers[0], count, offsets, factors, threads[i]);
+            t = now() - t;
+
+            unsigned wrong = 0;
+            for (unsigned n = 0; n < count; ++n)
+                if (TFactors(factors.begin() + offsets[n], factors.begin() + offsets[n + 1]) != single[n])
+                    ++wrong;
+
+            std::cout << "batch, " << threads[i] << " thread(s): " << t << " ms, "
+                      << count / (t / 1000) << " numbers/s, " << factors.size()
+                      << " factors, " << wrong << " wrong" << std::endl;
+        }
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
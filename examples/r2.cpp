@@ -0,0 +1,97 @@
+
+#include <math++/nodes.h>
+#include <math++/reader.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// builds a feed of ACount formulas, one per line
+std::string feed(unsigned ACount) {
+    static const char *templates[] = {
+        "%1*x^2 + %2*x - %3",
+        "sin(%1x) * cos(x/%2) + ln(x + %3)",
+        "IF(x > %1, %2*x, -%3)",
+        "a*x^3 - b*x^2 + c*x + %1.%2",
+        "tan(x)^2 + [sqrt(x) - %1] * (x - %2) / %3",
+        "IF(x <= %1, f(x - %2), g(x)) + %3"
+    };
+    const unsigned templateCount = sizeof(templates) / sizeof(*templates);
+
+    std::ostringstream out;
+    std::srand(42);
+
+    for (unsigned i = 0; i < ACount; ++i) {
+        for (const char *t = templates[i % templateCount]; *t; ++t) {
+            if (*t == '%' && t[1]) {
+                out << std::rand() % (t[1] == '1' ? 1000 : 100);
+                ++t;
+            } else
+                out << *t;
+        }
+        out << '\n';
+    }
+    return out.str();
+}
+
+void report(const char *AName, double AMs, unsigned ABytes, unsigned ACount) {
+    std::cout << AName << ": " << AMs << " ms, "
+              << ABytes / 1048576.0 / (AMs / 1000) << " MB/s, "
+              << ACount / (AMs / 1000) << " formulas/s" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Expression Reader throughput program (r2)" << std::endl;
+
+    try {
+        unsigned count = argc == 2 ? std::atoi(argv[1]) : 1000000;
+        std::string input(feed(count));
+
+        std::cout << count << " formulas, " << input.size() << " bytes" << std::endl;
+
+        // the formulas get parsed right out of the feed buffer
+        double t = now();
+        const char *begin = input.data();
+        const char *end = begin + input.size();
+        while (begin != end) {
+            const char *eol = begin;
+            while (*eol != '\n')
+                ++eol;
+
+            delete math::TReader<double>::parse(begin, eol);
+            begin = eol + 1;
+        }
+        report("in place", now() - t, input.size(), count);
+
+        // the same, but going through a std::string per formula
+        t = now();
+        std::string::size_type pos = 0;
+        while (pos != input.size()) {
+            std::string::size_type eol = input.find('\n', pos);
+
+            delete math::TReader<double>::parse(input.substr(pos, eol - pos));
+            pos = eol + 1;
+        }
+        report("std::string", now() - t, input.size(), count);
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+
+#include <math++/nodes.h>
+#include <math++/reader.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// returns the number of nodes in the given expression tree (without recursion)
+unsigned count(const math::TNode<double> *ANode) {
+    std::vector<const math::TNode<double> *> pending(1, ANode);
+    unsigned result = 0;
+
+    while (!pending.empty()) {
+        const math::TNode<double> *n = pending.back();
+        pending.pop_back();
+
+        if (!n)
+            continue;
+
+        ++result;
+        pending.push_back(n->left());
+        pending.push_back(n->right());
+
+        if (n->nodeType() == math::TNode<double>::IF_NODE)
+            pending.push_back(static_cast<const math::TIfNode<double> *>(n)->condition());
+    }
+    return result;
+}
+
+// returns AHead repeated, then AMiddle, then ATail repeated, about ASize bytes in total
+std::string generate(const std::string& AHead, const std::string& AMiddle,
+    const std::string& ATail, unsigned ASize) {
+
+    unsigned n = ASize / (AHead.size() + ATail.size());
+    std::string result;
+    result.reserve(n * (AHead.size() + ATail.size()) + AMiddle.size());
+
+    for (unsigned i = 0; i < n; ++i)
+        result += AHead;
+
+    result += AMiddle;
+
+    for (unsigned i = 0; i < n; ++i)
+        result += ATail;
+
+    return result;
+}
+
+void bench(const char *AName, const std::string& AInput) {
+    double t = now();
+    math::TNode<double> *expr = math::TReader<double>::parse(AInput);
+    t = now() - t;
+
+    unsigned nodes = count(expr);
+
+    double d = now();
+    delete expr;
+    d = now() - d;
+
+    std::cout << AName << ": " << AInput.size() / 1048576.0 << " MB, "
+              << nodes << " nodes, parsed in " << t << " ms ("
+              << AInput.size() / 1048576.0 / (t / 1000) << " MB/s), deleted in "
+              << d << " ms" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Expression Reader stress program (r3)" << std::endl;
+
+    try {
+        const unsigned size = (argc == 2 ? std::atoi(argv[1]) : 10) * 1048576;
+
+        bench("long chain", generate("x*2+3/x-", "1", "", size));
+        bench("power tower", generate("x^", "2", "", size));
+        bench("left nesting", generate("(", "x", "+1)", size));
+        bench("right nesting", generate("sin(x-", "x", ")", size));
+        bench("conditions", generate("IF(x<2,-x,", "x", ")", size));
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/calculator.h>
+#include <math++/printer.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// calls AName ARepeat times at AParam, prints the rate and returns the result
+double bench(const char *ATitle, const std::string& AName, const math::TLibrary<double>& ALibrary,
+    double AParam, unsigned ARepeat) {
+
+    const math::TFunction<double> *f = ALibrary.find(AName);
+    double result = 0;
+
+    // the recursive functions need a recursion limit as high as the number of terms
+    const unsigned limit = unsigned(AParam) + 64;
+
+    double t = now();
+    for (unsigned i = 0; i < ARepeat; ++i)
+        result = math::TCalculator<double>::calculate(*f, AParam, ALibrary, limit);
+    t = now() - t;
+
+    std::cout << "  " << ATitle << ": " << ARepeat * AParam / (t / 1000) / 1e6
+              << " M terms/s" << std::endl;
+
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Series example/benchmark program (s2)" << std::endl;
+
+    try {
+        const unsigned terms = argc == 2 ? std::atoi(argv[1]) : 10000;
+
+        math::TLibrary<double> library;
+
+        // the recursive way, just as fib() in the f1 example
+        library.insert(math::TFunction<double>("tri", "IF(x <= 1, 1, x + tri(x - 1))"));
+        library.insert(math::TFunction<double>("zeta", "IF(x < 1, 0, 1/x^2 + zeta(x - 1))"));
+        library.insert(math::TFunction<double>("fac", "IF(x <= 1, 1, x * fac(x - 1))"));
+
+        // and as series
+        library.insert(math::TFunction<double>("stri", "sum(k, 1, x, k)"));
+        library.insert(math::TFunction<double>("szeta", "sum(k, 1, x, 1/k^2)"));
+        library.insert(math::TFunction<double>("sfac", "prod(k, 1, x, k)"));
+
+        for (unsigned n = 10; n <= terms; n *= 10) {
+            const unsigned repeat = 1000000 / n;
+
+            std::cout << n << " terms:" << std::endl;
+            double a = bench("recursive 1 + ... + n ", "tri", library, n, repeat);
+            double b = bench("sum(k, 1, n, k)        ", "stri", library, n, repeat);
+            std::cout << "    results " << a << ", " << b << std::endl;
+
+            a = bench("recursive 1/1 + 1/n^2  ", "zeta", library, n, repeat);
+            b = bench("sum(k, 1, n, 1/k^2)    ", "szeta", library, n, repeat);
+
+            // the exact value up to rounding, summing up the small terms first
+            long double exact = 0;
+            for (unsigned k = n; k >= 1; --k)
+                exact += 1.0L / ((long double)k * k);
+
+            std::cout.precision(17);
+            std::cout << "    errors " << std::fabs(a - double(exact)) << " (recursive), "
+                      << std::fabs(b - double(exact)) << " (compensated)" << std::endl;
+            std::cout.precision(6);
+        }
+
+        std::cout << "170! = " << library.call("sfac", 170) << ", recursive "
+                  << math::TCalculator<double>::calculate(library.function("fac"), 170, library, 256)
+                  << std::endl;
+
+        // derivatives work term by term
+        library.insert(math::TFunction<double>("p", "prod(k, 1, 3, x - k)"));
+        std::cout << "p(x)=" << math::TPrinter<double>::print(library.find("p")->expression())
+                  << ", p'(x)=" << math::TPrinter<double>::print(library.derivative("p"))
+                  << ", p'(2.5)=" << math::TCalculator<double>::calculate(
+                         library.derivative("p"), 2.5, library) << std::endl;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
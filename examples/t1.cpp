@@ -0,0 +1,162 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/calculator.h>
+#include <math++/printer.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// the "measured" curve to be tabulated
+double curve(double x) {
+    return std::sin(3 * x) / (1 + x * x);
+}
+
+// returns ACount sample points in [0, 4], uniform or denser towards 0
+std::vector<double> samples(unsigned ACount, bool AUniform) {
+    std::vector<double> result;
+
+    for (unsigned i = 0; i < ACount; ++i) {
+        double t = double(i) / (ACount - 1);
+        result.push_back(4 * (AUniform ? t : t * t));
+    }
+    return result;
+}
+
+std::vector<double> values(const std::vector<double>& AX) {
+    std::vector<double> result;
+
+    for (unsigned i = 0; i < AX.size(); ++i)
+        result.push_back(curve(AX[i]));
+
+    return result;
+}
+
+// returns the table as nested IF()s of linear pieces, the way it is done without tables
+std::string chain(const std::vector<double>& AX, const std::vector<double>& AY) {
+    std::ostringstream out;
+    out.precision(17);
+
+    for (unsigned i = 0; i + 1 < AX.size(); ++i) {
+        double slope = (AY[i + 1] - AY[i]) / (AX[i + 1] - AX[i]);
+
+        out << "IF(x < " << AX[i + 1] << ", " << AY[i] << " + (x - " << AX[i] << ")*" << slope;
+        if (i + 2 < AX.size())
+            out << ", ";
+    }
+    out << ", " << AY.back();
+
+    for (unsigned i = 0; i + 1 < AX.size(); ++i)
+        out << ')';
+
+    return out.str();
+}
+
+// evaluates AName for AParams one by one and as batch, prints the rates and the largest error
+void bench(const char *ATitle, const std::string& AName, const math::TLibrary<double>& ALibrary,
+    const std::vector<double>& AParams) {
+
+    const math::TFunction<double> *f = ALibrary.find(AName);
+    double error = 0, sum = 0;
+
+    double t = now();
+    for (unsigned i = 0; i < AParams.size(); ++i)
+        sum += math::TCalculator<double>::calculate(*f, AParams[i], ALibrary);
+    t = now() - t;
+
+    for (unsigned i = 0; i < AParams.size(); i += 97)
+        error = std::max(error, std::fabs(f->call(AParams[i], ALibrary) - curve(AParams[i])));
+
+    std::vector<double> results(AParams.size());
+
+    double b = now();
+    math::TBatchCalculator<double>::calculate(*f, &AParams[0], &AParams[0] + AParams.size(),
+        &results[0], ALibrary);
+    b = now() - b;
+
+    std::cout << "  " << ATitle << ": " << AParams.size() / (t / 1000) / 1e6 << " M/s, batch "
+              << AParams.size() / (b / 1000) / 1e6 << " M/s, max. error " << error << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Table Lookup example/benchmark program (t1)" << std::endl;
+
+    try {
+        const unsigned count = argc == 2 ? std::atoi(argv[1]) : 1000000;
+
+        std::vector<double> params;
+        for (unsigned i = 0; i < count; ++i)
+            params.push_back(4.0 * std::rand() / RAND_MAX);
+
+        // a few table sizes, each as nested IF()s and as linear and cubic tables
+        unsigned sizes[] = { 8, 32, 128, 4096 };
+        for (unsigned s = 0; s < sizeof(sizes) / sizeof(*sizes); ++s) {
+            math::TLibrary<double> library;
+
+            std::vector<double> ux(samples(sizes[s], true)), nx(samples(sizes[s], false));
+            std::vector<double> uy(values(ux)), ny(values(nx));
+
+            typedef math::TTable<double> TTable;
+            library.insert(TTable("uniform", 0.0, ux[1], uy, TTable::LINEAR));
+            library.insert(TTable("dense", nx, ny, TTable::LINEAR));
+            library.insert(TTable("spline", ux, uy, TTable::CUBIC));
+            library.insert(TTable("nspline", nx, ny, TTable::CUBIC));
+
+            library.insert(math::TFunction<double>("u", "TABLE(uniform, x)"));
+            library.insert(math::TFunction<double>("d", "TABLE(dense, x)"));
+            library.insert(math::TFunction<double>("s", "TABLE(spline, x)"));
+            library.insert(math::TFunction<double>("n", "TABLE(nspline, x)"));
+
+            std::cout << sizes[s] << " points:" << std::endl;
+
+            if (sizes[s] <= 128) {
+                library.insert(math::TFunction<double>("c", chain(ux, uy)));
+                bench("IF() chain       ", "c", library, params);
+            }
+
+            bench("linear, uniform  ", "u", library, params);
+            bench("linear, nonunif. ", "d", library, params);
+            bench("cubic, uniform   ", "s", library, params);
+            bench("cubic, nonunif.  ", "n", library, params);
+        }
+
+        // derivatives are piecewise, as the interpolation is
+        math::TLibrary<double> library;
+        std::vector<double> x(samples(64, true));
+        library.insert(math::TTable<double>("t", x, values(x), math::TTable<double>::CUBIC));
+        library.insert(math::TFunction<double>("f", "TABLE(t, x^2)"));
+
+        std::cout << "f(x)=" << math::TPrinter<double>::print(library.find("f")->expression())
+                  << ", f'(x)=" << math::TPrinter<double>::print(library.derivative("f"))
+                  << std::endl;
+
+        const double p = 1.1, h = 1e-6;
+        std::cout << "f'(" << p << ")=" << math::TCalculator<double>::calculate(
+                         library.derivative("f"), p, library)
+                  << ", by difference quotient " << (library.call("f", p + h)
+                         - library.call("f", p - h)) / (2 * h) << std::endl;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
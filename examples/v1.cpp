@@ -0,0 +1,154 @@
+
+#include <math++/nodes.h>
+#include <math++/reader.h>
+#include <math++/library.h>
+#include <math++/calculator.h>
+#include <math++/interval.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+typedef std::vector<std::pair<double, double> > TRanges;
+
+// bisects [ALower, AUpper] down to AWidth, dropping the parts where f can't be 
+// zero, and returns the evaluations; adjacent pieces are merged in ARoots
+unsigned isolate(const math::TNode<double> *AExpr, const math::TLibrary<double>& ALibrary,
+    double ALower, double AUpper, double AWidth, TRanges& ARoots) {
+
+    std::vector<std::pair<double, double> > pending(1, std::make_pair(ALower, AUpper));
+    unsigned evaluations = 0;
+
+    while (!pending.empty()) {
+        const double l = pending.back().first, u = pending.back().second;
+        pending.pop_back();
+
+        math::TInterval<double> f(
+            math::TIntervalCalculator<double>::calculate(AExpr, math::TInterval<double>(l, u), ALibrary));
+        ++evaluations;
+
+        if (!f.contains(0))
+            continue;
+
+        if (u - l <= AWidth) {
+            if (!ARoots.empty() && ARoots.back().second >= l)
+                ARoots.back().second = u;
+            else
+                ARoots.push_back(std::make_pair(l, u));
+        } else {
+            // the left half comes first, so the roots are found in order
+            const double m = l + (u - l) / 2;
+            pending.push_back(std::make_pair(m, u));
+            pending.push_back(std::make_pair(l, m));
+        }
+    }
+    return evaluations;
+}
+
+// samples f in steps of AWidth and collects the sign changes into ARoots
+unsigned sample(const math::TNode<double> *AExpr, const math::TLibrary<double>& ALibrary,
+    double ALower, double AUpper, double AWidth, TRanges& ARoots) {
+
+    const unsigned n = unsigned((AUpper - ALower) / AWidth);
+    double x0 = ALower, f0 = math::TCalculator<double>::calculate(AExpr, x0, ALibrary);
+
+    for (unsigned i = 1; i <= n; ++i) {
+        const double x = ALower + (AUpper - ALower) * i / n;
+        const double f = math::TCalculator<double>::calculate(AExpr, x, ALibrary);
+
+        if ((f0 <= 0 && f >= 0) || (f0 >= 0 && f <= 0)) {
+            if (!ARoots.empty() && ARoots.back().second >= x0)
+                ARoots.back().second = x;
+            else
+                ARoots.push_back(std::make_pair(x0, x));
+        }
+        x0 = x;
+        f0 = f;
+    }
+    return n + 1;
+}
+
+void print(const TRanges& ARoots) {
+    for (unsigned i = 0; i < ARoots.size() && i < 8; ++i)
+        std::cout << " [" << ARoots[i].first << ", " << ARoots[i].second << "]";
+
+    std::cout << (ARoots.size() > 8 ? " ..." : "") << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Interval Root Isolation example/benchmark program (v1)" << std::endl;
+
+    try {
+        const double width = argc == 2 ? std::atof(argv[1]) : 1e-5;
+
+        math::TLibrary<double> library;
+        library.insert(math::TFunction<double>("g", "IF(x < 0, x^2 - 1, sqrt(x) - 2)"));
+
+        static const char *functions[] = {
+            "sin(x)*x - 1",
+            "cos(3x) + x/4",
+            "(x - 1)^2 * (x + 2)",
+            "ln(x) + x^2 - 4",
+            "g(x)",
+            "x^5 - 3x^3 + x - 0.1"
+        };
+
+        double intervalTime = 0, samplingTime = 0;
+
+        for (unsigned i = 0; i < sizeof(functions) / sizeof(*functions); ++i) {
+            std::auto_ptr<math::TNode<double> > f(math::TReader<double>::parse(functions[i]));
+            TRanges roots;
+
+            std::cout << functions[i] << " on [-10, 10]:" << std::endl;
+
+            double t = now();
+            unsigned n = isolate(f.get(), library, -10, 10, width, roots);
+            t = now() - t;
+            intervalTime += t;
+
+            std::cout << "  interval: " << n << " evaluations, " << t << " ms, "
+                      << roots.size() << " enclosures:";
+            print(roots);
+
+            roots.clear();
+            t = now();
+            n = sample(f.get(), library, -10, 10, width, roots);
+            t = now() - t;
+            samplingTime += t;
+
+            std::cout << "  sampling: " << n << " evaluations, " << t << " ms, "
+                      << roots.size() << " sign changes:";
+            print(roots);
+        }
+
+        std::cout << "total: interval " << intervalTime << " ms, sampling "
+                  << samplingTime << " ms" << std::endl;
+
+        // a negative base is defined at the integral exponents only, here at x = 0.5
+        std::auto_ptr<math::TNode<double> > p(math::TReader<double>::parse("(-1 - x)^(x + 1.5)"));
+        const math::TInterval<double> b = math::TIntervalCalculator<double>::calculate(
+            p.get(), math::TInterval<double>(0, 1), library);
+        std::cout << "(-1 - x)^(x + 1.5) on [0, 1]: [" << b.lower() << ", " << b.upper()
+                  << "] (containing 2.25)" << std::endl;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/solver.h>
+#include <math++/calculator.h>
+#include <math++/thread.h>
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+// returns the current time in milliseconds
+double now() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+typedef math::TSolver<double> TSolver;
+
+// solves all targets and prints throughput, iterations and the worst residual
+void bench(const char *AName, const TSolver& ASolver, const math::TFunction<double>& AFunction,
+    const math::TLibrary<double>& ALibrary, const std::vector<double>& ATargets, unsigned AThreads) {
+
+    std::vector<TSolver::TResult> results(ATargets.size());
+
+    double t = now();
+    ASolver.solve(&ATargets[0], &ATargets[0] + ATargets.size(), &results[0], AThreads);
+    t = now() - t;
+
+    unsigned long iterations = 0;
+    unsigned failed = 0;
+    double residual = 0;
+
+    for (unsigned i = 0; i < results.size(); ++i) {
+        iterations += results[i].iterations;
+
+        if (results[i].status != TSolver::CONVERGED) {
+            ++failed;
+            continue;
+        }
+
+        double r = std::fabs(math::TCalculator<double>::calculate(AFunction, results[i].x, ALibrary)
+                             - ATargets[i]);
+        residual = std::max(residual, r);
+    }
+
+    std::cout << "  " << AName << ", " << AThreads << " thread(s): " << t << " ms ("
+              << ATargets.size() / (t / 1000) / 1e6 << " M/s), "
+              << double(iterations) / results.size() << " evaluations each, "
+              << failed << " not converged, max residual " << residual << std::endl;
+}
+
+void run(const char *AExpression, double ALower, double AUpper, unsigned ACount) {
+    math::TLibrary<double> library;
+    math::TFunction<double> f("f", AExpression);
+
+    std::cout << "f(x) = " << AExpression << " on [" << ALower << ", " << AUpper << "]" << std::endl;
+
+    // the targets: values of f over the bracket, sorted and shuffled
+    double lower = math::TCalculator<double>::calculate(f, ALower, library);
+    double upper = math::TCalculator<double>::calculate(f, AUpper, library);
+
+    std::vector<double> sorted(ACount);
+    for (unsigned i = 0; i < ACount; ++i)
+        sorted[i] = lower + (upper - lower) * (i + 0.5) / ACount;
+
+    std::vector<double> shuffled(sorted);
+    std::srand(42);
+    std::random_shuffle(shuffled.begin(), shuffled.end());
+
+    TSolver solver(f, library, ALower, AUpper, 1e-12);
+
+    // the same function, but hidden behind a library call, so without Newton steps
+    library.insert(f);
+    math::TFunction<double> g("g", "f(x)");
+    TSolver brent(g, library, ALower, AUpper, 1e-12);
+
+    bench("Brent only, shuffled", brent, f, library, shuffled, 1);
+    bench("Brent+Newton, shuffled", solver, f, library, shuffled, 1);
+    bench("Brent+Newton, sorted", solver, f, library, sorted, 1);
+    bench("Brent+Newton, sorted", solver, f, library, sorted, math::processors());
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Equation Solver example/benchmark program (z1)" << std::endl;
+
+    try {
+        unsigned count = argc == 2 ? std::atoi(argv[1]) : 200000;
+
+        run("x^3 + x", -10, 10, count);
+        run("x + sin(x) / 2", -20, 20, count);
+        run("x * ln(x)", 1, 100, count);
+
+        // no solution within the bracket
+        math::TLibrary<double> library;
+        TSolver solver(math::TFunction<double>("f", "x^2 + 1"), library, -1, 1, 1e-12);
+        TSolver::TResult r = solver.solve(0);
+        std::cout << "x^2 + 1 = 0: " << (r.status == TSolver::NO_BRACKET ? "no bracket" : "?!")
+                  << std::endl;
+    } catch (const math::EMath& e) {
+        std::cout << "exception caught: " << e.reason() << std::endl;
+
+        return 1;
+    } catch (...) {
+        std::cout << "further exception caught." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
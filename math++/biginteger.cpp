@@ -0,0 +1,1112 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the arbitrary precision integer implementation)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#include <math++/biginteger.h>
+#include <math++/utils.h>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+
+namespace math {
+
+typedef TBigInteger::TLimb TLimb;
+
+static const TLimb base = TBigInteger::BASE;
+
+// construction and storage
+
+TBigInteger::TBigInteger() :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+}
+
+TBigInteger::TBigInteger(int ANumber) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+    assign(ANumber < 0 ? 0ULL - (unsigned long long)ANumber : ANumber, ANumber < 0);
+}
+
+TBigInteger::TBigInteger(unsigned ANumber) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+    assign(ANumber, false);
+}
+
+TBigInteger::TBigInteger(long ANumber) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+    assign(ANumber < 0 ? 0ULL - (unsigned long long)ANumber : ANumber, ANumber < 0);
+}
+
+TBigInteger::TBigInteger(unsigned long ANumber) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+    assign(ANumber, false);
+}
+
+TBigInteger::TBigInteger(long long ANumber) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+    assign(ANumber < 0 ? 0ULL - (unsigned long long)ANumber : ANumber, ANumber < 0);
+}
+
+TBigInteger::TBigInteger(unsigned long long ANumber) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+    assign(ANumber, false);
+}
+
+TBigInteger::TBigInteger(double ANumber) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+
+    if (ANumber != ANumber || ANumber - ANumber != 0)
+        throw EBigInteger("Can't convert a number which isn't finite.");
+
+    double a = std::floor(std::fabs(ANumber));
+
+    if (a < 18446744073709551616.0)
+        assign((unsigned long long)a, ANumber < 0);
+    else {
+        // 53 significant bits, shifted into place
+        int exponent;
+        double mantissa = std::frexp(a, &exponent);
+
+        *this = TBigInteger((unsigned long long)std::ldexp(mantissa, 53))
+              * power(TBigInteger(2), TBigInteger(exponent - 53));
+        FNegative = ANumber < 0;
+    }
+}
+
+TBigInteger::TBigInteger(const std::string& ANumber) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+    assign(ANumber.data(), ANumber.data() + ANumber.size());
+}
+
+TBigInteger::TBigInteger(const char *ANumber) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+    assign(ANumber, ANumber + std::strlen(ANumber));
+}
+
+TBigInteger::TBigInteger(const TBigInteger& AOther) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(AOther.FNegative) {
+
+    reserve(AOther.FSize);
+    std::memcpy(FLimbs, AOther.FLimbs, AOther.FSize * sizeof(TLimb));
+    FSize = AOther.FSize;
+}
+
+TBigInteger::TBigInteger(const TLimb *ALimbs, unsigned ASize) :
+    FLimbs(FInline), FSize(0), FCapacity(INLINE), FNegative(false) {
+
+    reserve(ASize);
+    std::memcpy(FLimbs, ALimbs, ASize * sizeof(TLimb));
+    FSize = ASize;
+    trim();
+}
+
+TBigInteger::~TBigInteger() {
+    if (FLimbs != FInline)
+        delete[] FLimbs;
+}
+
+TBigInteger& TBigInteger::operator=(const TBigInteger& AOther) {
+    if (this != &AOther) {
+        FSize = 0;
+        reserve(AOther.FSize);
+        std::memcpy(FLimbs, AOther.FLimbs, AOther.FSize * sizeof(TLimb));
+        FSize = AOther.FSize;
+        FNegative = AOther.FNegative;
+    }
+    return *this;
+}
+
+void TBigInteger::swap(TBigInteger& AOther) {
+    if (FLimbs != FInline && AOther.FLimbs != AOther.FInline) {
+        std::swap(FLimbs, AOther.FLimbs);
+        std::swap(FSize, AOther.FSize);
+        std::swap(FCapacity, AOther.FCapacity);
+        std::swap(FNegative, AOther.FNegative);
+    } else {
+        TBigInteger t(*this);
+        *this = AOther;
+        AOther = t;
+    }
+}
+
+void TBigInteger::assign(unsigned long long AMagnitude, bool ANegative) {
+    FSize = 0;
+
+    for (; AMagnitude; AMagnitude /= base) {
+        reserve(FSize + 1);
+        FLimbs[FSize++] = TLimb(AMagnitude % base);
+    }
+    FNegative = ANegative && FSize;
+}
+
+void TBigInteger::assign(const char *ABegin, const char *AEnd) {
+    while (ABegin != AEnd && std::isspace(static_cast<unsigned char>(*ABegin)))
+        ++ABegin;
+
+    bool negative = false;
+    if (ABegin != AEnd && (*ABegin == '-' || *ABegin == '+'))
+        negative = *ABegin++ == '-';
+
+    const char *end = ABegin;
+    while (end != AEnd && *end >= '0' && *end <= '9')
+        ++end;
+
+    // nine digits per limb, starting at the least significant ones
+    FSize = 0;
+    reserve(unsigned((end - ABegin + BASE_DIGITS - 1) / BASE_DIGITS));
+
+    for (const char *p = end; p != ABegin; ) {
+        const char *start = p - ABegin > BASE_DIGITS ? p - BASE_DIGITS : ABegin;
+        TLimb limb = 0;
+
+        for (const char *d = start; d != p; ++d)
+            limb = limb * 10 + (*d - '0');
+
+        FLimbs[FSize++] = limb;
+        p = start;
+    }
+
+    FNegative = negative;
+    trim();
+}
+
+void TBigInteger::reserve(unsigned ACapacity) {
+    if (ACapacity <= FCapacity)
+        return;
+
+    ACapacity = std::max(ACapacity, 2 * FCapacity);
+    TLimb *limbs = new TLimb[ACapacity];
+    std::memcpy(limbs, FLimbs, FSize * sizeof(TLimb));
+
+    if (FLimbs != FInline)
+        delete[] FLimbs;
+
+    FLimbs = limbs;
+    FCapacity = ACapacity;
+}
+
+void TBigInteger::resize(unsigned ASize) {
+    reserve(ASize);
+
+    if (ASize > FSize)
+        std::memset(FLimbs + FSize, 0, (ASize - FSize) * sizeof(TLimb));
+
+    FSize = ASize;
+}
+
+void TBigInteger::trim() {
+    while (FSize && !FLimbs[FSize - 1])
+        --FSize;
+
+    if (!FSize)
+        FNegative = false;
+}
+
+// conversion
+
+unsigned TBigInteger::mod(unsigned ADivisor) const {
+    unsigned long long r = 0;
+
+    for (unsigned i = FSize; i--; )
+        r = (r * base + FLimbs[i]) % ADivisor;
+
+    return unsigned(r);
+}
+
+unsigned TBigInteger::digits() const {
+    if (!FSize)
+        return 1;
+
+    unsigned result = (FSize - 1) * BASE_DIGITS;
+    for (TLimb top = FLimbs[FSize - 1]; top; top /= 10)
+        ++result;
+
+    return result;
+}
+
+bool TBigInteger::fitsUnsigned() const {
+    // 2^64 - 1 = 18 446744073 709551615
+    static const TLimb max[] = { 709551615, 446744073, 18 };
+
+    if (FSize != 3)
+        return FSize < 3;
+
+    for (unsigned i = 3; i--; )
+        if (FLimbs[i] != max[i])
+            return FLimbs[i] < max[i];
+
+    return true;
+}
+
+unsigned long long TBigInteger::toUnsigned() const {
+    unsigned long long result = 0;
+
+    for (unsigned i = FSize; i--; )
+        result = result * base + FLimbs[i];
+
+    return result;
+}
+
+double TBigInteger::toDouble() const {
+    // the three leading limbs are more than enough for 53 bits
+    double result = 0;
+    unsigned lead = std::min(FSize, 3U);
+
+    for (unsigned i = 0; i < lead; ++i)
+        result = result * base + FLimbs[FSize - 1 - i];
+
+    if (FSize > lead)
+        result *= std::pow(double(base), double(FSize - lead));
+
+    return FNegative ? -result : result;
+}
+
+void TBigInteger::print(std::string& AOutput) const {
+    if (!FSize) {
+        AOutput += '0';
+        return;
+    }
+
+    std::string::size_type start = AOutput.size();
+    AOutput.resize(start + FNegative + FSize * BASE_DIGITS);
+
+    char *p = &AOutput[start];
+    if (FNegative)
+        *p++ = '-';
+
+    // the leading limb without leading zeros, all others with nine digits
+    char lead[BASE_DIGITS];
+    unsigned n = 0;
+    for (TLimb top = FLimbs[FSize - 1]; top; top /= 10)
+        lead[n++] = char('0' + top % 10);
+    while (n)
+        *p++ = lead[--n];
+
+    for (unsigned i = FSize - 1; i--; ) {
+        TLimb limb = FLimbs[i];
+
+        for (unsigned d = BASE_DIGITS; d--; limb /= 10)
+            p[d] = char('0' + limb % 10);
+
+        p += BASE_DIGITS;
+    }
+
+    AOutput.resize(p - &AOutput[0]);
+}
+
+std::string TBigInteger::toString() const {
+    std::string result;
+    print(result);
+
+    return result;
+}
+
+// comparison
+
+int TBigInteger::compareMagnitude(const TBigInteger& a, const TBigInteger& b) {
+    if (a.FSize != b.FSize)
+        return a.FSize < b.FSize ? -1 : 1;
+
+    for (unsigned i = a.FSize; i--; )
+        if (a.FLimbs[i] != b.FLimbs[i])
+            return a.FLimbs[i] < b.FLimbs[i] ? -1 : 1;
+
+    return 0;
+}
+
+int TBigInteger::compare(const TBigInteger& a, const TBigInteger& b) {
+    if (a.FNegative != b.FNegative)
+        return a.FNegative ? -1 : 1;
+
+    return a.FNegative ? compareMagnitude(b, a) : compareMagnitude(a, b);
+}
+
+// addition and subtraction
+
+TLimb TBigInteger::addTo(TLimb *r, unsigned nr, const TLimb *a, unsigned na) {
+    TLimb carry = 0;
+    unsigned i = 0;
+
+    for (; i < na; ++i) {
+        TLimb s = r[i] + a[i] + carry;
+
+        carry = s >= base;
+        r[i] = carry ? s - base : s;
+    }
+
+    for (; carry && i < nr; ++i) {
+        if (++r[i] == base)
+            r[i] = 0;
+        else
+            carry = 0;
+    }
+    return carry;
+}
+
+void TBigInteger::subtractFrom(TLimb *r, unsigned nr, const TLimb *a, unsigned na) {
+    TLimb borrow = 0;
+    unsigned i = 0;
+
+    for (; i < na; ++i) {
+        TLimb s = a[i] + borrow;
+
+        if (r[i] >= s) {
+            r[i] -= s;
+            borrow = 0;
+        } else {
+            r[i] = r[i] + base - s;
+            borrow = 1;
+        }
+    }
+
+    for (; borrow && i < nr; ++i) {
+        if (r[i]) {
+            --r[i];
+            borrow = 0;
+        } else
+            r[i] = base - 1;
+    }
+}
+
+void TBigInteger::addMagnitude(const TBigInteger& AOther) {
+    if (&AOther == this) {
+        TBigInteger copy(AOther);
+        addMagnitude(copy);
+        return;
+    }
+
+    resize(std::max(FSize, AOther.FSize) + 1);
+    addTo(FLimbs, FSize, AOther.FLimbs, AOther.FSize);
+    trim();
+}
+
+void TBigInteger::subtractMagnitude(const TBigInteger& AOther) {
+    if (compareMagnitude(*this, AOther) >= 0) {
+        subtractFrom(FLimbs, FSize, AOther.FLimbs, AOther.FSize);
+        trim();
+    } else {
+        TBigInteger result(AOther);
+        subtractFrom(result.FLimbs, result.FSize, FLimbs, FSize);
+        result.FNegative = !FNegative;
+        result.trim();
+        swap(result);
+    }
+}
+
+TBigInteger& TBigInteger::operator+=(const TBigInteger& AOther) {
+    if (FNegative == AOther.FNegative)
+        addMagnitude(AOther);
+    else
+        subtractMagnitude(AOther);
+
+    return *this;
+}
+
+TBigInteger& TBigInteger::operator-=(const TBigInteger& AOther) {
+    if (&AOther == this)
+        FSize = 0, FNegative = false;
+    else if (FNegative != AOther.FNegative)
+        addMagnitude(AOther);
+    else
+        subtractMagnitude(AOther);
+
+    return *this;
+}
+
+TBigInteger TBigInteger::operator-() const {
+    TBigInteger result(*this);
+    result.FNegative = FSize && !FNegative;
+
+    return result;
+}
+
+// multiplication
+
+void TBigInteger::multiplySchool(const TLimb *a, unsigned na, const TLimb *b, unsigned nb,
+    TLimb *r) {
+
+    std::fill(r, r + na + nb, TLimb(0));
+
+    for (unsigned i = 0; i < na; ++i) {
+        const unsigned long long ai = a[i];
+        unsigned long long carry = 0;
+
+        if (!ai)
+            continue;
+
+        for (unsigned j = 0; j < nb; ++j) {
+            unsigned long long t = r[i + j] + ai * b[j] + carry;
+
+            carry = t / base;
+            r[i + j] = TLimb(t - carry * base);
+        }
+        r[i + nb] = TLimb(carry);
+    }
+}
+
+void TBigInteger::multiplyKaratsuba(const TLimb *a, unsigned na, const TLimb *b, unsigned nb,
+    TLimb *r) {
+
+    // a = a1 B^h + a0, b = b1 B^h + b0, with na >= nb > na / 2
+    const unsigned h = (na + 1) / 2;
+    const unsigned na1 = na - h, nb1 = nb - h;
+
+    // a0 b0 and a1 b1 go right into place
+    multiply(a, h, b, h, r);
+    if (nb1)
+        multiply(a + h, na1, b + h, nb1, r + 2 * h);
+    else
+        std::fill(r + 2 * h, r + na + nb, TLimb(0));
+
+    // the middle term is (a0 + a1)(b0 + b1) - a0 b0 - a1 b1
+    std::vector<TLimb> sa(a, a + h), sb(b, b + h), z(2 * h + 2);
+    sa.push_back(addTo(&sa[0], h, a + h, na1));
+    sb.push_back(nb1 ? addTo(&sb[0], h, b + h, nb1) : 0);
+
+    multiply(&sa[0], h + 1, &sb[0], h + 1, &z[0]);
+    subtractFrom(&z[0], z.size(), r, 2 * h);
+    subtractFrom(&z[0], z.size(), r + 2 * h, na1 + nb1);
+
+    unsigned nz = z.size();
+    while (nz && !z[nz - 1])
+        --nz;
+
+    addTo(r + h, na + nb - h, &z[0], nz);
+}
+
+void TBigInteger::multiplyToom(const TLimb *a, unsigned na, const TLimb *b, unsigned nb,
+    TLimb *r) {
+
+    // a and b get split into three parts of k limbs each, the product 
+    // polynomial is evaluated at 0, 1, -1, -2 and infinity
+    const unsigned k = (na + 2) / 3;
+
+    TBigInteger a0(a, std::min(k, na)), a1(a + k, std::min(k, na - k)), a2(a + 2 * k, na - 2 * k);
+    TBigInteger b0(b, std::min(k, nb));
+    TBigInteger b1(b + std::min(k, nb), nb > k ? std::min(k, nb - k) : 0);
+    TBigInteger b2(b + std::min(2 * k, nb), nb > 2 * k ? nb - 2 * k : 0);
+
+    TBigInteger p1(a0 + a2), pm1(p1 - a1), pm2;
+    p1 += a1;
+    pm2 = pm1 + a2;
+    pm2 += pm2;
+    pm2 -= a0;
+
+    TBigInteger q1(b0 + b2), qm1(q1 - b1), qm2;
+    q1 += b1;
+    qm2 = qm1 + b2;
+    qm2 += qm2;
+    qm2 -= b0;
+
+    TBigInteger r0(a0 * b0), r1(p1 * q1), rm1(pm1 * qm1), rm2(pm2 * qm2), rinf(a2 * b2);
+
+    // the interpolation as given by Bodrato
+    TBigInteger r3((rm2 - r1) / 3);
+    r1 = (r1 - rm1) / 2;
+    TBigInteger r2(rm1 - r0);
+    r3 = (r2 - r3) / 2 + rinf + rinf;
+    r2 += r1;
+    r2 -= rinf;
+    r1 -= r3;
+
+    const unsigned n = na + nb;
+    std::fill(r, r + n, TLimb(0));
+
+    addTo(r, n, r0.FLimbs, r0.FSize);
+    addTo(r + k, n - k, r1.FLimbs, r1.FSize);
+    addTo(r + 2 * k, n - 2 * k, r2.FLimbs, r2.FSize);
+    addTo(r + 3 * k, n - 3 * k, r3.FLimbs, r3.FSize);
+    addTo(r + 4 * k, n - 4 * k, rinf.FLimbs, rinf.FSize);
+}
+
+void TBigInteger::multiply(const TLimb *a, unsigned na, const TLimb *b, unsigned nb, TLimb *r) {
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+
+    if (nb < KARATSUBA)
+        multiplySchool(a, na, b, nb, r);
+    else if (na >= 2 * nb) {
+        // unbalanced, so b gets multiplied with one slice of a after the other
+        std::vector<TLimb> t(2 * nb);
+        std::fill(r, r + na + nb, TLimb(0));
+
+        for (unsigned offset = 0; offset < na; offset += nb) {
+            unsigned n = std::min(nb, na - offset);
+
+            multiply(a + offset, n, b, nb, &t[0]);
+            addTo(r + offset, na + nb - offset, &t[0], n + nb);
+        }
+    } else if (nb >= TOOM)
+        multiplyToom(a, na, b, nb, r);
+    else
+        multiplyKaratsuba(a, na, b, nb, r);
+}
+
+TBigInteger& TBigInteger::operator*=(const TBigInteger& AOther) {
+    if (!FSize || !AOther.FSize) {
+        FSize = 0;
+        FNegative = false;
+        return *this;
+    }
+
+    TBigInteger result;
+    result.resize(FSize + AOther.FSize);
+    multiply(FLimbs, FSize, AOther.FLimbs, AOther.FSize, result.FLimbs);
+
+    result.FNegative = FNegative != AOther.FNegative;
+    result.trim();
+    swap(result);
+
+    return *this;
+}
+
+// division
+
+TLimb TBigInteger::divideSmall(TLimb *a, unsigned n, TLimb d) {
+    unsigned long long r = 0;
+
+    for (unsigned i = n; i--; ) {
+        unsigned long long t = r * base + a[i];
+
+        a[i] = TLimb(t / d);
+        r = t % d;
+    }
+    return TLimb(r);
+}
+
+void TBigInteger::divideKnuth(const TBigInteger& u, const TBigInteger& v,
+    TBigInteger& q, TBigInteger& r) {
+
+    // Knuth's algorithm D, on magnitudes with u >= v and at least two limbs in v
+    const unsigned n = v.FSize, m = u.FSize - v.FSize;
+    const TLimb norm = base / (v.FLimbs[n - 1] + 1);
+
+    TBigInteger un(u), vn(v);
+    un.FNegative = vn.FNegative = false;
+    un *= TBigInteger(norm);
+    vn *= TBigInteger(norm);
+    un.resize(u.FSize + 1);
+
+    TLimb *w = un.FLimbs;
+    const TLimb *y = vn.FLimbs;
+    const unsigned long long top = y[n - 1], second = y[n - 2];
+
+    q.FNegative = false;
+    q.FSize = 0;
+    q.resize(m + 1);
+
+    for (unsigned j = m + 1; j--; ) {
+        unsigned long long t = w[j + n] * (unsigned long long)base + w[j + n - 1];
+        unsigned long long qhat = t / top, rhat = t % top;
+
+        while (qhat >= base || qhat * second > rhat * base + w[j + n - 2]) {
+            --qhat;
+            if ((rhat += top) >= base)
+                break;
+        }
+
+        // w[j..j+n] -= qhat * y
+        unsigned long long carry = 0;
+        long long borrow = 0;
+        for (unsigned i = 0; i < n; ++i) {
+            unsigned long long p = qhat * y[i] + carry;
+            carry = p / base;
+
+            long long d = (long long)w[i + j] - (long long)(p - carry * base) - borrow;
+            borrow = d < 0;
+            w[i + j] = TLimb(d < 0 ? d + base : d);
+        }
+
+        long long d = (long long)w[j + n] - (long long)carry - borrow;
+        if (d < 0) {
+            // qhat was one too large, so add y back
+            --qhat;
+            addTo(w + j, n, y, n);
+            d = 0;
+        }
+        w[j + n] = TLimb(d);
+
+        q.FLimbs[j] = TLimb(qhat);
+    }
+    q.trim();
+
+    // the remainder, unnormalized
+    un.FSize = n;
+    divideSmall(un.FLimbs, n, norm);
+    un.trim();
+    r.swap(un);
+}
+
+TBigInteger TBigInteger::shifted(const TBigInteger& a, int ALimbs) {
+    TBigInteger result;
+
+    if (ALimbs >= 0) {
+        if (a.FSize) {
+            result.resize(a.FSize + ALimbs);
+            std::memcpy(result.FLimbs + ALimbs, a.FLimbs, a.FSize * sizeof(TLimb));
+        }
+    } else if (a.FSize > unsigned(-ALimbs)) {
+        result.resize(a.FSize + ALimbs);
+        std::memcpy(result.FLimbs, a.FLimbs - ALimbs, result.FSize * sizeof(TLimb));
+    }
+
+    result.FNegative = a.FNegative;
+    result.trim();
+    return result;
+}
+
+TBigInteger TBigInteger::basePower(unsigned ALimbs) {
+    TBigInteger result;
+    result.resize(ALimbs + 1);
+    result.FLimbs[ALimbs] = 1;
+
+    return result;
+}
+
+TBigInteger TBigInteger::reciprocal(const TLimb *v, unsigned n) {
+    // returns B^2n / v within a few units, refining the reciprocal of v's upper half
+    const TBigInteger divisor(v, n);
+    const TBigInteger scale(basePower(2 * n));
+    TBigInteger x, e;
+
+    if (n <= NEWTON / 2) {
+        divideKnuth(scale, divisor, x, e);
+        return x;
+    }
+
+    // the upper half, with a few extra limbs to keep the error that small
+    const unsigned h = n / 2 + 3;
+    x = shifted(reciprocal(v + n - h, h), n - h);
+
+    // one Newton step: x += x (B^2n - v x) / B^2n
+    e = scale - divisor * x;
+    x += shifted(x * e, -int(2 * n));
+
+    return x;
+}
+
+void TBigInteger::divideNewton(const TBigInteger& u, const TBigInteger& v,
+    TBigInteger& q, TBigInteger& r) {
+
+    // u is divided in slices of n limbs, from the top, each by multiplying 
+    // with the approximate reciprocal x = B^2n / v
+    const unsigned n = v.FSize;
+    const TBigInteger x(reciprocal(v.FLimbs, n));
+    TBigInteger divisor(v);
+    divisor.FNegative = false;
+
+    q.FNegative = false;
+    q.FSize = 0;
+    q.resize(u.FSize);
+
+    TBigInteger rest;
+    for (unsigned slice = (u.FSize + n - 1) / n; slice--; ) {
+        const unsigned low = slice * n, high = std::min(u.FSize, low + n);
+
+        TBigInteger current(shifted(rest, high - low));
+        TBigInteger part(u.FLimbs + low, high - low);
+        current += part;
+
+        // only the upper n + 2 limbs of current matter for the estimate
+        const int drop = std::min(int(current.FSize), int(n) - 2);
+        TBigInteger digit(shifted(shifted(current, -drop) * x, drop - int(2 * n)));
+        rest = current - digit * divisor;
+
+        // the estimate is off by a few units, either way
+        while (rest.FNegative) {
+            digit -= 1;
+            rest += divisor;
+        }
+        while (compareMagnitude(rest, divisor) >= 0) {
+            digit += 1;
+            rest -= divisor;
+        }
+
+        std::memcpy(q.FLimbs + low, digit.FLimbs, digit.FSize * sizeof(TLimb));
+    }
+
+    q.trim();
+    r.swap(rest);
+}
+
+void TBigInteger::divide(const TBigInteger& ADividend, const TBigInteger& ADivisor,
+    TBigInteger& AQuotient, TBigInteger& ARemainder) {
+
+    if (!ADivisor.FSize)
+        throw EBigInteger("Division by zero.");
+
+    const bool negative = ADividend.FNegative != ADivisor.FNegative;
+    const bool dividendNegative = ADividend.FNegative;
+    TBigInteger q, r;
+
+    if (compareMagnitude(ADividend, ADivisor) < 0)
+        r = ADividend;
+    else if (ADivisor.FSize == 1) {
+        q = ADividend;
+        r = TBigInteger(divideSmall(q.FLimbs, q.FSize, ADivisor.FLimbs[0]));
+        q.trim();
+    } else if (ADivisor.FSize >= NEWTON && ADividend.FSize - ADivisor.FSize >= NEWTON)
+        divideNewton(ADividend, ADivisor, q, r);
+    else
+        divideKnuth(ADividend, ADivisor, q, r);
+
+    q.FNegative = negative && q.FSize;
+    r.FNegative = dividendNegative && r.FSize;
+
+    AQuotient.swap(q);
+    ARemainder.swap(r);
+}
+
+TBigInteger& TBigInteger::operator/=(const TBigInteger& AOther) {
+    TBigInteger r;
+    divide(*this, AOther, *this, r);
+
+    return *this;
+}
+
+TBigInteger& TBigInteger::operator%=(const TBigInteger& AOther) {
+    TBigInteger q;
+    divide(*this, AOther, q, *this);
+
+    return *this;
+}
+
+// functions
+
+TBigInteger TBigInteger::power(const TBigInteger& a, const TBigInteger& b) {
+    if (b.FNegative) {
+        if (!a.FSize)
+            throw EBigInteger("Division by zero.");
+
+        // only 1 and -1 have integral reciprocals
+        if (a.FSize == 1 && a.FLimbs[0] == 1)
+            return a.FNegative && b.mod(2) ? a : TBigInteger(1);
+
+        return TBigInteger();
+    }
+
+    if (!b.fitsUnsigned() || b.toUnsigned() > 0xFFFFFFFFULL)
+        throw EBigInteger("Exponent too large.");
+
+    TBigInteger result(1), square(a);
+    for (unsigned long long e = b.toUnsigned(); e; e >>= 1) {
+        if (e & 1)
+            result *= square;
+        if (e > 1)
+            square *= square;
+    }
+    return result;
+}
+
+TBigInteger TBigInteger::squareRoot(const TBigInteger& a) {
+    if (a.FNegative)
+        throw EBigInteger("Square root of a negative number.");
+
+    if (!a.FSize)
+        return a;
+
+    // Newton's method from above, starting at 10^ceil(digits / 2)
+    TBigInteger x(power(TBigInteger(10), TBigInteger((a.digits() + 1) / 2)));
+
+    for (;;) {
+        TBigInteger y((x + a / x) / 2);
+
+        if (compare(y, x) >= 0)
+            return x;
+
+        x.swap(y);
+    }
+}
+
+double TBigInteger::logarithm(const TBigInteger& a) {
+    if (a.FNegative || !a.FSize)
+        return std::log(a.toDouble());
+
+    // the leading limbs, scaled down to stay finite
+    unsigned lead = std::min(a.FSize, 3U);
+    TBigInteger top(a.FLimbs + a.FSize - lead, lead);
+
+    return std::log(top.toDouble()) + (a.FSize - lead) * BASE_DIGITS * std::log(10.0);
+}
+
+TBigInteger operator+(const TBigInteger& a, const TBigInteger& b) {
+    TBigInteger result(a);
+    return result += b;
+}
+
+TBigInteger operator-(const TBigInteger& a, const TBigInteger& b) {
+    TBigInteger result(a);
+    return result -= b;
+}
+
+TBigInteger operator*(const TBigInteger& a, const TBigInteger& b) {
+    TBigInteger result(a);
+    return result *= b;
+}
+
+TBigInteger operator/(const TBigInteger& a, const TBigInteger& b) {
+    TBigInteger q, r;
+    TBigInteger::divide(a, b, q, r);
+    return q;
+}
+
+TBigInteger operator%(const TBigInteger& a, const TBigInteger& b) {
+    TBigInteger q, r;
+    TBigInteger::divide(a, b, q, r);
+    return r;
+}
+
+bool operator==(const TBigInteger& a, const TBigInteger& b) {
+    return TBigInteger::compare(a, b) == 0;
+}
+
+bool operator!=(const TBigInteger& a, const TBigInteger& b) {
+    return TBigInteger::compare(a, b) != 0;
+}
+
+bool operator<(const TBigInteger& a, const TBigInteger& b) {
+    return TBigInteger::compare(a, b) < 0;
+}
+
+bool operator>(const TBigInteger& a, const TBigInteger& b) {
+    return TBigInteger::compare(a, b) > 0;
+}
+
+bool operator<=(const TBigInteger& a, const TBigInteger& b) {
+    return TBigInteger::compare(a, b) <= 0;
+}
+
+bool operator>=(const TBigInteger& a, const TBigInteger& b) {
+    return TBigInteger::compare(a, b) >= 0;
+}
+
+std::ostream& operator<<(std::ostream& AOutput, const TBigInteger& ANumber) {
+    return AOutput << ANumber.toString();
+}
+
+std::istream& operator>>(std::istream& AInput, TBigInteger& ANumber) {
+    std::string digits;
+    char c;
+
+    AInput >> std::ws;
+    if (AInput.get(c)) {
+        if ((c == '-' || c == '+' || (c >= '0' && c <= '9')))
+            digits += c;
+        else {
+            AInput.putback(c);
+            AInput.setstate(std::ios::failbit);
+            return AInput;
+        }
+    }
+
+    while (AInput.get(c)) {
+        if (c < '0' || c > '9') {
+            AInput.putback(c);
+            break;
+        }
+        digits += c;
+    }
+
+    if (AInput.eof() && !digits.empty())
+        AInput.clear(std::ios::eofbit);
+
+    ANumber = TBigInteger(digits);
+    return AInput;
+}
+
+TBigInteger gcd(const TBigInteger& a, const TBigInteger& b) {
+    TBigInteger x(abs(a)), y(abs(b));
+
+    while (!y.isZero()) {
+        x %= y;
+        x.swap(y);
+    }
+    return x;
+}
+
+// number theory
+
+// returns a^e mod m
+static TBigInteger powmod(TBigInteger a, TBigInteger e, const TBigInteger& m) {
+    TBigInteger result(1);
+
+    for (a %= m; !e.isZero(); e /= 2) {
+        if (e.mod(2))
+            result = result * a % m;
+        a = a * a % m;
+    }
+    return result;
+}
+
+bool isPrime(const TBigInteger& ANumber) {
+    if (ANumber.sign() <= 0)
+        return false;
+
+    if (ANumber.fitsUnsigned())
+        return isPrime(ANumber.toUnsigned());
+
+    static const unsigned bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+    for (unsigned i = 0; i < sizeof(bases) / sizeof(*bases); ++i)
+        if (ANumber.mod(bases[i]) == 0)
+            return false;
+
+    const TBigInteger n1(ANumber - 1);
+    TBigInteger d(n1);
+    unsigned s = 0;
+    while (!d.mod(2)) {
+        d /= 2;
+        ++s;
+    }
+
+    for (unsigned i = 0; i < sizeof(bases) / sizeof(*bases); ++i) {
+        TBigInteger x(powmod(TBigInteger(bases[i]), d, ANumber));
+
+        if (x == 1 || x == n1)
+            continue;
+
+        unsigned k = 1;
+        for (; k < s; ++k) {
+            x = x * x % ANumber;
+
+            if (x == n1)
+                break;
+        }
+        if (k == s)
+            return false;
+    }
+    return true;
+}
+
+// returns a non trivial divisor of the odd composite ANumber (Pollard-Brent rho)
+static TBigInteger findDivisor(const TBigInteger& n) {
+    const unsigned batch = 64;
+
+    for (unsigned c = 1; ; ++c) {
+        TBigInteger x, y(2), ys(2), q(1), g(1);
+
+        for (unsigned long long r = 1; g == 1; r *= 2) {
+            x = y;
+            for (unsigned long long i = 0; i < r; ++i)
+                y = (y * y + c) % n;
+
+            for (unsigned long long k = 0; k < r && g == 1; k += batch) {
+                ys = y;
+                for (unsigned long long i = 0; i < batch && i < r - k; ++i) {
+                    y = (y * y + c) % n;
+                    q = q * abs(x - y) % n;
+                }
+                g = gcd(q, n);
+            }
+        }
+
+        if (g == n) {
+            do {
+                ys = (ys * ys + c) % n;
+                g = gcd(x - ys, n);
+            } while (g == 1);
+        }
+
+        if (g != n)
+            return g;
+    }
+}
+
+unsigned factorize(const TBigInteger& ANumber,
+    std::vector<std::pair<TBigInteger, TBigInteger> >& AResult) {
+
+    AResult.erase(AResult.begin(), AResult.end());
+
+    TBigInteger n(abs(ANumber));
+    std::vector<TBigInteger> factors;
+
+    if (n < 2) {
+        AResult.push_back(std::make_pair(n, TBigInteger(1)));
+        return AResult.size();
+    }
+
+    // the small primes first, leaving the rest to the 64 bit version if possible
+    std::vector<unsigned long long> small;
+    primes(2, 65535, small);
+
+    for (unsigned i = 0; i < small.size() && !n.fitsUnsigned(); ++i)
+        while (n.mod(unsigned(small[i])) == 0) {
+            n /= TBigInteger(small[i]);
+            factors.push_back(TBigInteger(small[i]));
+        }
+
+    std::vector<TBigInteger> pending;
+    if (n != 1)
+        pending.push_back(n);
+
+    while (!pending.empty()) {
+        TBigInteger m(pending.back());
+        pending.pop_back();
+
+        if (m.fitsUnsigned()) {
+            std::vector<std::pair<unsigned long long, unsigned long long> > f;
+            factorize(m.toUnsigned(), f);
+
+            for (unsigned i = 0; i < f.size(); ++i)
+                for (unsigned long long e = 0; e < f[i].second; ++e)
+                    factors.push_back(TBigInteger(f[i].first));
+        } else if (isPrime(m))
+            factors.push_back(m);
+        else {
+            TBigInteger d(findDivisor(m));
+            pending.push_back(m / d);
+            pending.push_back(d);
+        }
+    }
+
+    std::sort(factors.begin(), factors.end());
+
+    for (unsigned i = 0; i < factors.size(); ++i) {
+        if (i && factors[i] == factors[i - 1])
+            AResult.back().second += 1;
+        else
+            AResult.push_back(std::make_pair(factors[i], TBigInteger(1)));
+    }
+    return AResult.size();
+}
+
+std::string factorize(const TBigInteger& ANumber) {
+    std::vector<std::pair<TBigInteger, TBigInteger> > factors;
+    factorize(ANumber, factors);
+
+    std::string result;
+
+    for (unsigned i = 0; i < factors.size(); ++i) {
+        if (result.size())
+            result += "*";
+
+        factors[i].first.print(result);
+        result += '^';
+        factors[i].second.print(result);
+    }
+    return result;
+}
+
+} // namespace math
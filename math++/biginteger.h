@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the arbitrary precision integer interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_biginteger_h
+#define libmath_biginteger_h
+
+#include <math++/error.h>
+
+#include <iosfwd>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace math {
+
+/**
+  * EBigInteger is thrown on invalid TBigInteger operations, such as 
+  * divisions by zero.
+  */
+class EBigInteger : public EMath {
+public:
+    EBigInteger(const std::string& AReason) : EMath(AReason) {}
+};
+
+/**
+  * TBigInteger is an integer of arbitrary size. It may be used as T of 
+  * the expression trees, the reader, printer and calculator; divisions 
+  * truncate and the transcendental functions go through double.
+  *
+  * The magnitude is stored in base 10^9 limbs, least significant first, 
+  * so decimal input and output take linear time. Numbers of up to 36 
+  * digits are stored within the object itself. Multiplication switches 
+  * from schoolbook to Karatsuba to Toom-3 with growing size, and large 
+  * divisions multiply by a Newton reciprocal.
+  */
+class TBigInteger {
+public:
+    typedef unsigned TLimb;
+    enum { BASE = 1000000000, BASE_DIGITS = 9 };
+
+    TBigInteger();
+    TBigInteger(int);
+    TBigInteger(unsigned);
+    TBigInteger(long);
+    TBigInteger(unsigned long);
+    TBigInteger(long long);
+    TBigInteger(unsigned long long);
+    /// truncates ANumber towards zero, throws EBigInteger if it's not finite
+    explicit TBigInteger(double ANumber);
+    /// reads an optionally signed decimal number, ignoring what follows its digits
+    explicit TBigInteger(const std::string& ANumber);
+    explicit TBigInteger(const char *ANumber);
+    TBigInteger(const TBigInteger&);
+    ~TBigInteger();
+
+    TBigInteger& operator=(const TBigInteger&);
+    void swap(TBigInteger&);
+
+    TBigInteger& operator+=(const TBigInteger&);
+    TBigInteger& operator-=(const TBigInteger&);
+    TBigInteger& operator*=(const TBigInteger&);
+    /// truncating division, throws EBigInteger on division by zero
+    TBigInteger& operator/=(const TBigInteger&);
+    /// the remainder of the truncating division, signed as the dividend
+    TBigInteger& operator%=(const TBigInteger&);
+    TBigInteger operator-() const;
+
+    /// computes quotient and remainder of ADividend / ADivisor at once
+    static void divide(const TBigInteger& ADividend, const TBigInteger& ADivisor,
+        TBigInteger& AQuotient, TBigInteger& ARemainder);
+
+    /// returns -1, 0 or 1 as a is less than, equal to or greater than b
+    static int compare(const TBigInteger& a, const TBigInteger& b);
+
+    /// returns -1, 0 or 1 for negative numbers, zero and positive ones
+    int sign() const { return FSize ? (FNegative ? -1 : 1) : 0; }
+    bool isZero() const { return !FSize; }
+
+    /// returns the absolute value modulo ADivisor (not 0)
+    unsigned mod(unsigned ADivisor) const;
+    /// returns the number of decimal digits (1 for zero)
+    unsigned digits() const;
+
+    /// returns true if the absolute value fits into an unsigned long long
+    bool fitsUnsigned() const;
+    /// returns the absolute value, if it fits
+    unsigned long long toUnsigned() const;
+    /// returns the nearest double, or infinity
+    double toDouble() const;
+
+    /// appends the decimal representation to AOutput
+    void print(std::string& AOutput) const;
+    /// returns the decimal representation
+    std::string toString() const;
+
+    // the functions of the calculator, found by argument dependent lookup only
+    friend TBigInteger pow(const TBigInteger& a, const TBigInteger& b) { return power(a, b); }
+    friend TBigInteger sqrt(const TBigInteger& a) { return squareRoot(a); }
+    friend TBigInteger sin(const TBigInteger& a) { return TBigInteger(std::sin(a.toDouble())); }
+    friend TBigInteger cos(const TBigInteger& a) { return TBigInteger(std::cos(a.toDouble())); }
+    friend TBigInteger tan(const TBigInteger& a) { return TBigInteger(std::tan(a.toDouble())); }
+    friend TBigInteger log(const TBigInteger& a) { return TBigInteger(logarithm(a)); }
+    friend TBigInteger abs(const TBigInteger& a) { return a.sign() < 0 ? -a : a; }
+
+private:
+    enum { INLINE = 4, KARATSUBA = 40, TOOM = 150, NEWTON = 120 };
+
+    TLimb *FLimbs;          // FInline or on the heap
+    unsigned FSize;         // the significant limbs, none for zero
+    unsigned FCapacity;
+    bool FNegative;
+    TLimb FInline[INLINE];
+
+    TBigInteger(const TLimb *ALimbs, unsigned ASize);
+
+    void assign(unsigned long long AMagnitude, bool ANegative);
+    void assign(const char *ABegin, const char *AEnd);
+    void reserve(unsigned ACapacity);
+    /// resizes to ASize limbs, new ones are zero
+    void resize(unsigned ASize);
+    /// drops leading zero limbs
+    void trim();
+
+    void addMagnitude(const TBigInteger&);
+    void subtractMagnitude(const TBigInteger&);
+
+    static int compareMagnitude(const TBigInteger& a, const TBigInteger& b);
+    static TBigInteger shifted(const TBigInteger& a, int ALimbs);
+    static TBigInteger basePower(unsigned ALimbs);
+
+    static TLimb addTo(TLimb *r, unsigned nr, const TLimb *a, unsigned na);
+    static void subtractFrom(TLimb *r, unsigned nr, const TLimb *a, unsigned na);
+    static void multiply(const TLimb *a, unsigned na, const TLimb *b, unsigned nb, TLimb *r);
+    static void multiplySchool(const TLimb *a, unsigned na, const TLimb *b, unsigned nb, TLimb *r);
+    static void multiplyKaratsuba(const TLimb *a, unsigned na, const TLimb *b, unsigned nb, TLimb *r);
+    static void multiplyToom(const TLimb *a, unsigned na, const TLimb *b, unsigned nb, TLimb *r);
+    static TLimb divideSmall(TLimb *a, unsigned n, TLimb d);
+    static void divideKnuth(const TBigInteger& u, const TBigInteger& v, TBigInteger& q, TBigInteger& r);
+    static void divideNewton(const TBigInteger& u, const TBigInteger& v, TBigInteger& q, TBigInteger& r);
+    static TBigInteger reciprocal(const TLimb *v, unsigned n);
+
+    static TBigInteger power(const TBigInteger& a, const TBigInteger& b);
+    static TBigInteger squareRoot(const TBigInteger& a);
+    static double logarithm(const TBigInteger& a);
+};
+
+TBigInteger operator+(const TBigInteger& a, const TBigInteger& b);
+TBigInteger operator-(const TBigInteger& a, const TBigInteger& b);
+TBigInteger operator*(const TBigInteger& a, const TBigInteger& b);
+TBigInteger operator/(const TBigInteger& a, const TBigInteger& b);
+TBigInteger operator%(const TBigInteger& a, const TBigInteger& b);
+
+bool operator==(const TBigInteger& a, const TBigInteger& b);
+bool operator!=(const TBigInteger& a, const TBigInteger& b);
+bool operator<(const TBigInteger& a, const TBigInteger& b);
+bool operator>(const TBigInteger& a, const TBigInteger& b);
+bool operator<=(const TBigInteger& a, const TBigInteger& b);
+bool operator>=(const TBigInteger& a, const TBigInteger& b);
+
+std::ostream& operator<<(std::ostream& AOutput, const TBigInteger& ANumber);
+std::istream& operator>>(std::istream& AInput, TBigInteger& ANumber);
+
+/// returns the greatest common divisor of a and b (not negative)
+TBigInteger gcd(const TBigInteger& a, const TBigInteger& b);
+
+/**
+  * isPrime returns true if ANumber is a prime number. Numbers beyond 
+  * 64 bits get a Miller-Rabin test to the first twelve prime bases, 
+  * which is deterministic below 3.3*10^24 and probabilistic above.
+  */
+bool isPrime(const TBigInteger& ANumber);
+
+/**
+  * factorizes the absolute value of ANumber, just as the unsigned long 
+  * long version does; larger factors are found by Pollard's rho method.
+  */
+unsigned factorize(const TBigInteger& ANumber,
+    std::vector<std::pair<TBigInteger, TBigInteger> >& AResult);
+
+/**
+  * factorizes ANumber and returns the result as a well formatted string.
+  */
+std::string factorize(const TBigInteger& ANumber);
+
+} // namespace math
+
+#endif
@@ -27,12 +27,15 @@
 #include <math++/error.h>
 
 #include <string>
+#include <vector>
 #include <map>
 
 namespace math {
 
 template<class> class TFunction;
 template<class> class TLibrary;
+template<class> class TSeriesNode;
+template<class> class TCalculator;
 
 /**
   * ECalcError gets thrown whenever any error during function calculation
@@ -54,17 +57,24 @@ public:
     static T calculate(const TFunction<T>& AFunction, const T& AParam, 
         const TLibrary<T>& ALibrary, unsigned ARecursionLimit = 64);
 
+    /// calculates the expression's result using given values.
+    static T calculate(const TNode<T> *AExpression, const T& AParam, 
+        const TLibrary<T>& ALibrary, unsigned ARecursionLimit = 64);
+
 private:
+    /// a bound symbol (e.g. a summation index) with its value
+    typedef std::pair<std::string, T> TBinding;
+
     T FParam;
     const TLibrary<T>& FLibrary;
     std::map<std::string, unsigned> FRecursions;
     unsigned FLimit;
+    std::vector<TBinding> FBindings; // innermost last
     T FResult;
 
 private:
     /// creates a calculator
-    TCalculator(const TFunction<T>& AFunction, const T& AParam, 
-        const TLibrary<T>& ALibrary, unsigned ALimit);
+    TCalculator(const T& AParam, const TLibrary<T>& ALibrary, unsigned ALimit);
 
     /// calculates partial expression
     T calculate(const TNode<T> *AExpression);
@@ -89,6 +99,96 @@ private:
 
     virtual void visit(TFuncNode<T> *);
     virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
+
+    virtual void visit(TEquNode<T> *);
+    virtual void visit(TUnEquNode<T> *);
+    virtual void visit(TGreaterNode<T> *);
+    virtual void visit(TLessNode<T> *);
+    virtual void visit(TGreaterEquNode<T> *);
+    virtual void visit(TLessEquNode<T> *);
+};
+
+/**
+  * TBatchCalculator calculates an expression for many parameters at once. 
+  * Each node is visited once per batch instead of once per parameter, 
+  * and the arithmetic runs in plain loops over arrays, which compilers 
+  * may vectorize. IF only calculates each branch for the parameters 
+  * taking it, so recursive functions end just as with TCalculator.
+  * The terms of sums and products are calculated the same way, in
+  * blocks of index values (also for TCalculator).
+  */
+template<class T>
+class TBatchCalculator : protected TNodeVisitor<T> {
+public:
+    /// calculates the function's result for each parameter in [ABegin, AEnd) into AResult
+    static void calculate(const TFunction<T>& AFunction, const T *ABegin, const T *AEnd,
+        T *AResult, const TLibrary<T>& ALibrary, unsigned ARecursionLimit = 64);
+
+    /// calculates the expression's result for each parameter in [ABegin, AEnd) into AResult
+    static void calculate(const TNode<T> *AExpression, const T *ABegin, const T *AEnd,
+        T *AResult, const TLibrary<T>& ALibrary, unsigned ARecursionLimit = 64);
+
+private:
+    /// a bound symbol (e.g. a summation index) with its value per parameter
+    typedef std::pair<std::string, std::vector<T> > TBinding;
+
+    std::vector<T> FParams;
+    const TLibrary<T>& FLibrary;
+    std::map<std::string, unsigned> FRecursions;
+    unsigned FLimit;
+    std::vector<TBinding> FBindings; // innermost last
+    std::vector<T> FResult;
+
+    friend class TCalculator<T>;
+
+private:
+    TBatchCalculator(const T *ABegin, const T *AEnd, const TLibrary<T>& ALibrary, unsigned ALimit);
+
+    /**
+      * calculates the sum or product ANode with the bounds ALower and AUpper for 
+      * the parameter AParam, where ABindings are the symbols bound outside of it.
+      * Sums are compensated (Neumaier), so their error doesn't grow with the 
+      * number of terms.
+      */
+    static T series(const TSeriesNode<T> *ANode, const T& AParam, const T& ALower, const T& AUpper,
+        const std::vector<std::pair<std::string, T> >& ABindings,
+        const std::map<std::string, unsigned>& ARecursions, const TLibrary<T>& ALibrary,
+        unsigned ALimit);
+
+    /// calculates partial expression for all current parameters
+    void calculate(const TNode<T> *AExpression, std::vector<T>& AResult);
+
+    /// calculates both operands of ANode into FResult and ARight
+    void operands(TNode<T> *ANode, std::vector<T>& ARight);
+
+    virtual void visit(TNumberNode<T> *);
+    virtual void visit(TSymbolNode<T> *);
+    virtual void visit(TParamNode<T> *);
+
+    virtual void visit(TPlusNode<T> *);
+    virtual void visit(TNegNode<T> *);
+
+    virtual void visit(TMulNode<T> *);
+    virtual void visit(TDivNode<T> *);
+
+    virtual void visit(TPowNode<T> *);
+    virtual void visit(TSqrtNode<T> *);
+
+    virtual void visit(TSinNode<T> *);
+    virtual void visit(TCosNode<T> *);
+    virtual void visit(TTanNode<T> *);
+    virtual void visit(TLnNode<T> *);
+
+    virtual void visit(TFuncNode<T> *);
+    virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
 
     virtual void visit(TEquNode<T> *);
     virtual void visit(TUnEquNode<T> *);
@@ -24,7 +24,12 @@
 #error You may not include math++/calculator.tcc directly; include math++/calculator.h instead.
 #endif
 
+#include <math++/nodes.h>
+#include <math++/library.h>
+
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace math {
 
@@ -32,16 +37,20 @@ template<class T>
 T TCalculator<T>::calculate(const TFunction<T>& AFunction, const T& AParam,
     const TLibrary<T>& ALibrary, unsigned ALimit) {
 
-    TCalculator<T> c(AFunction, AParam, ALibrary, ALimit);
-    return c.FResult;
+    return calculate(AFunction.expression(), AParam, ALibrary, ALimit);
 }
 
 template<class T>
-TCalculator<T>::TCalculator(const TFunction<T>& AFunction, const T& AParam, 
-    const TLibrary<T>& ALibrary, unsigned ALimit) :
-    FParam(AParam), FLibrary(ALibrary), FLimit(ALimit) {
+T TCalculator<T>::calculate(const TNode<T> *AExpression, const T& AParam,
+    const TLibrary<T>& ALibrary, unsigned ALimit) {
 
-    AFunction.expression()->accept(*this);
+    TCalculator<T> c(AParam, ALibrary, ALimit);
+    return c.calculate(AExpression);
+}
+
+template<class T>
+TCalculator<T>::TCalculator(const T& AParam, const TLibrary<T>& ALibrary, unsigned ALimit) :
+    FParam(AParam), FLibrary(ALibrary), FLimit(ALimit) {
 }
 
 template<class T>
@@ -58,7 +67,15 @@ void TCalculator<T>::visit(TNumberNode<T> *ANode) {
 
 template<class T>
 void TCalculator<T>::visit(TSymbolNode<T> *ANode) {
-    FResult = FLibrary.value(ANode->symbol());
+    const std::string symbol(ANode->symbol());
+
+    for (unsigned i = FBindings.size(); i-- > 0; )
+        if (FBindings[i].first == symbol) {
+            FResult = FBindings[i].second;
+            return;
+        }
+
+    FResult = FLibrary.value(symbol);
 }
 
 template<class T>
@@ -120,27 +137,80 @@ template<class T>
 void TCalculator<T>::visit(TFuncNode<T> *ANode) {
     const std::string name(ANode->name());
 
-    if (FRecursions.find(name) == FRecursions.end())
-        FRecursions[name] = 0;
+    unsigned& depth = FRecursions[name];
 
-    if (++FRecursions[name] > FLimit)
+    if (++depth > FLimit)
         throw ECalcError("Function exceeds recursion counter: " + name + ".");
 
+    const T param(calculate(ANode->node()));
+
+    const TFunction<T> *f = FLibrary.find(name);
+    if (!f)
+        throw ELibraryLookup("No function found in library called: " + name + ".");
+
+    if (ANode->params() != f->params().size() + 1)
+        throw ECalcError("Wrong number of arguments calling function: " + name + ".");
+
+    // the symbols bound by the caller are not visible within the callee,
+    // just its further parameters are
+    std::vector<TBinding> bindings(f->params().size());
+    for (unsigned i = 0; i < bindings.size(); ++i)
+        bindings[i] = TBinding(f->params()[i], calculate(ANode->param(i + 1)));
+
     T save(FParam);
-    FParam = calculate(ANode->node());
+    FParam = param;
+    FBindings.swap(bindings);
 
-    FResult = calculate(FLibrary.function(name).expression());
+    FResult = calculate(f->expression());
 
+    FBindings.swap(bindings);
     FParam = save;
+    --depth; // the limit is about the depth, not the number of calls
 }
 
 template<class T>
 void TCalculator<T>::visit(TIfNode<T> *ANode) {
-    FResult = calculate(ANode->condition())
+    FResult = calculate(ANode->condition()) != T(0)
             ? calculate(ANode->trueExpr())
             : calculate(ANode->falseExpr());
 }
 
+template<class T>
+void TCalculator<T>::visit(TTableNode<T> *ANode) {
+    const T param(calculate(ANode->node()));
+
+    const TTable<T> *t = FLibrary.findTable(ANode->name());
+    if (!t)
+        throw ELibraryLookup("No table found in library called: " + ANode->name() + ".");
+
+    FResult = t->value(param, ANode->order());
+}
+
+template<class T>
+void TCalculator<T>::visit(TSumNode<T> *ANode) {
+    const T lower(calculate(ANode->lower())), upper(calculate(ANode->upper()));
+
+    FResult = TBatchCalculator<T>::series(ANode, FParam, lower, upper, FBindings, FRecursions,
+        FLibrary, FLimit);
+}
+
+template<class T>
+void TCalculator<T>::visit(TProdNode<T> *ANode) {
+    const T lower(calculate(ANode->lower())), upper(calculate(ANode->upper()));
+
+    FResult = TBatchCalculator<T>::series(ANode, FParam, lower, upper, FBindings, FRecursions,
+        FLibrary, FLimit);
+}
+
+template<class T>
+void TCalculator<T>::visit(TLetNode<T> *ANode) {
+    const T value(calculate(ANode->value()));
+
+    FBindings.push_back(TBinding(ANode->name(), value));
+    FResult = calculate(ANode->body());
+    FBindings.pop_back();
+}
+
 template<class T>
 void TCalculator<T>::visit(TEquNode<T> *ANode) {
     FResult = calculate(ANode->left()) == calculate(ANode->right());
@@ -171,4 +241,455 @@ void TCalculator<T>::visit(TLessEquNode<T> *ANode) {
     FResult = calculate(ANode->left()) <= calculate(ANode->right());
 }
 
+template<class T>
+void TBatchCalculator<T>::calculate(const TFunction<T>& AFunction, const T *ABegin,
+    const T *AEnd, T *AResult, const TLibrary<T>& ALibrary, unsigned ALimit) {
+
+    calculate(AFunction.expression(), ABegin, AEnd, AResult, ALibrary, ALimit);
+}
+
+template<class T>
+void TBatchCalculator<T>::calculate(const TNode<T> *AExpression, const T *ABegin,
+    const T *AEnd, T *AResult, const TLibrary<T>& ALibrary, unsigned ALimit) {
+
+    TBatchCalculator<T> c(ABegin, AEnd, ALibrary, ALimit);
+    std::vector<T> result;
+
+    c.calculate(AExpression, result);
+    std::copy(result.begin(), result.end(), AResult);
+}
+
+template<class T>
+TBatchCalculator<T>::TBatchCalculator(const T *ABegin, const T *AEnd,
+    const TLibrary<T>& ALibrary, unsigned ALimit) :
+    FParams(ABegin, AEnd), FLibrary(ALibrary), FLimit(ALimit) {
+}
+
+template<class T>
+T TBatchCalculator<T>::series(const TSeriesNode<T> *ANode, const T& AParam, const T& ALower,
+    const T& AUpper, const std::vector<std::pair<std::string, T> >& ABindings,
+    const std::map<std::string, unsigned>& ARecursions, const TLibrary<T>& ALibrary,
+    unsigned ALimit) {
+
+    const bool sum = ANode->nodeType() == TNode<T>::SUM_NODE;
+
+    if (ALower != ALower)
+        return ALower;
+    if (AUpper != AUpper)
+        return AUpper;
+
+    // the calculator starts at the caller's recursion depths, so the
+    // limit holds for recursions through the body, too
+    TBatchCalculator<T> c(&AParam, &AParam + 1, ALibrary, ALimit);
+    c.FRecursions = ARecursions;
+
+    const unsigned block = 256;
+    T result(sum ? 0 : 1), error(0);
+    unsigned long count = 0;
+    std::vector<T> index, terms;
+
+    // beyond the precision of numbers the index would get stuck
+    if (ALower <= AUpper && !(ALower + T(1) > ALower && AUpper + T(1) > AUpper))
+        throw ECalcError("Series index exceeds the precision of numbers.");
+
+    for (T k(ALower); k <= AUpper; ) {
+        // the next block of index values, each one counted from the lower bound
+        index.clear();
+
+        do {
+            index.push_back(k);
+            k = ALower + T(++count);
+
+            if (!(index.back() < k))
+                throw ECalcError("Series index exceeds the precision of numbers.");
+        } while (index.size() < block && k <= AUpper);
+
+        c.FParams.assign(index.size(), AParam);
+        c.FBindings.clear();
+
+        for (unsigned i = 0; i < ABindings.size(); ++i)
+            c.FBindings.push_back(TBinding(ABindings[i].first,
+                std::vector<T>(index.size(), ABindings[i].second)));
+
+        c.FBindings.push_back(TBinding(ANode->index(), index));
+        c.calculate(ANode->body(), terms);
+
+        if (sum) {
+            // Neumaier's compensated summation, in its branch free form (TwoSum)
+            for (unsigned i = 0; i < terms.size(); ++i) {
+                T s = result + terms[i];
+                T z = s - result;
+
+                error += (result - (s - z)) + (terms[i] - z);
+                result = s;
+            }
+        } else {
+            // the relative error of a product grows just linearly, no need to compensate
+            for (unsigned i = 0; i < terms.size(); ++i)
+                result *= terms[i];
+        }
+    }
+
+    return result + error;
+}
+
+template<class T>
+void TBatchCalculator<T>::calculate(const TNode<T> *AExpression, std::vector<T>& AResult) {
+    const_cast<TNode<T> *>(AExpression)->accept(*this);
+
+    AResult.swap(FResult);
+}
+
+template<class T>
+void TBatchCalculator<T>::operands(TNode<T> *ANode, std::vector<T>& ARight) {
+    std::vector<T> left;
+
+    calculate(ANode->left(), left);
+    calculate(ANode->right(), ARight);
+
+    FResult.swap(left);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TNumberNode<T> *ANode) {
+    FResult.assign(FParams.size(), ANode->number());
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TSymbolNode<T> *ANode) {
+    const std::string symbol(ANode->symbol());
+
+    for (unsigned i = FBindings.size(); i-- > 0; )
+        if (FBindings[i].first == symbol) {
+            FResult = FBindings[i].second;
+            return;
+        }
+
+    FResult.assign(FParams.size(), FLibrary.value(symbol));
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TParamNode<T> *ANode) {
+    FResult = FParams;
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TPlusNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] += right[i];
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TNegNode<T> *ANode) {
+    std::vector<T> result;
+    calculate(ANode->node(), result);
+
+    for (unsigned i = 0; i < result.size(); ++i)
+        result[i] = - result[i];
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TMulNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] *= right[i];
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TDivNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] /= right[i];
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TPowNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] = pow(FResult[i], right[i]);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TSqrtNode<T> *ANode) {
+    std::vector<T> result;
+    calculate(ANode->node(), result);
+
+    for (unsigned i = 0; i < result.size(); ++i)
+        result[i] = sqrt(result[i]);
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TSinNode<T> *ANode) {
+    std::vector<T> result;
+    calculate(ANode->node(), result);
+
+    for (unsigned i = 0; i < result.size(); ++i)
+        result[i] = sin(result[i]);
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TCosNode<T> *ANode) {
+    std::vector<T> result;
+    calculate(ANode->node(), result);
+
+    for (unsigned i = 0; i < result.size(); ++i)
+        result[i] = cos(result[i]);
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TTanNode<T> *ANode) {
+    std::vector<T> result;
+    calculate(ANode->node(), result);
+
+    for (unsigned i = 0; i < result.size(); ++i)
+        result[i] = tan(result[i]);
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TLnNode<T> *ANode) {
+    std::vector<T> result;
+    calculate(ANode->node(), result);
+
+    for (unsigned i = 0; i < result.size(); ++i)
+        result[i] = log(result[i]);
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TFuncNode<T> *ANode) {
+    const std::string name(ANode->name());
+
+    unsigned& depth = FRecursions[name];
+
+    if (++depth > FLimit)
+        throw ECalcError("Function exceeds recursion counter: " + name + ".");
+
+    std::vector<T> params;
+    calculate(ANode->node(), params);
+
+    const TFunction<T> *f = FLibrary.find(name);
+    if (!f)
+        throw ELibraryLookup("No function found in library called: " + name + ".");
+
+    if (ANode->params() != f->params().size() + 1)
+        throw ECalcError("Wrong number of arguments calling function: " + name + ".");
+
+    // the symbols bound by the caller are not visible within the callee,
+    // just its further parameters are
+    std::vector<TBinding> bindings(f->params().size());
+    for (unsigned i = 0; i < bindings.size(); ++i) {
+        bindings[i].first = f->params()[i];
+        calculate(ANode->param(i + 1), bindings[i].second);
+    }
+
+    FParams.swap(params);
+    FBindings.swap(bindings);
+
+    std::vector<T> result;
+    calculate(f->expression(), result);
+
+    FParams.swap(params);
+    FBindings.swap(bindings);
+    FResult.swap(result);
+
+    --depth;
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TIfNode<T> *ANode) {
+    std::vector<T> condition;
+    calculate(ANode->condition(), condition);
+
+    // split up the parameters (and bound symbols) by the branch they take
+    std::vector<T> params[2];
+    std::vector<TBinding> bindings[2];
+    std::vector<unsigned> branch(condition.size());
+
+    for (unsigned i = 0; i < condition.size(); ++i) {
+        branch[i] = condition[i] != T(0) ? 0 : 1;
+        params[branch[i]].push_back(FParams[i]);
+    }
+
+    for (unsigned b = 0; b < 2 && !FBindings.empty(); ++b) {
+        bindings[b].resize(FBindings.size());
+
+        for (unsigned j = 0; j < FBindings.size(); ++j)
+            bindings[b][j].first = FBindings[j].first;
+    }
+
+    for (unsigned j = 0; j < FBindings.size(); ++j)
+        for (unsigned i = 0; i < condition.size(); ++i)
+            bindings[branch[i]][j].second.push_back(FBindings[j].second[i]);
+
+    std::vector<T> results[2];
+    TNode<T> *nodes[2] = { ANode->trueExpr(), ANode->falseExpr() };
+
+    for (unsigned b = 0; b < 2; ++b) {
+        if (params[b].empty())
+            continue;
+
+        FParams.swap(params[b]);
+        FBindings.swap(bindings[b]);
+        calculate(nodes[b], results[b]);
+        FParams.swap(params[b]);
+        FBindings.swap(bindings[b]);
+    }
+
+    std::vector<T> result(condition.size());
+    unsigned next[2] = { 0, 0 };
+
+    for (unsigned i = 0; i < result.size(); ++i)
+        result[i] = results[branch[i]][next[branch[i]]++];
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TTableNode<T> *ANode) {
+    std::vector<T> result;
+    calculate(ANode->node(), result);
+
+    const TTable<T> *t = FLibrary.findTable(ANode->name());
+    if (!t)
+        throw ELibraryLookup("No table found in library called: " + ANode->name() + ".");
+
+    if (!result.empty())
+        t->calculate(&result[0], &result[0] + result.size(), &result[0], ANode->order());
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TSumNode<T> *ANode) {
+    std::vector<T> lower, upper;
+
+    calculate(ANode->lower(), lower);
+    calculate(ANode->upper(), upper);
+
+    std::vector<std::pair<std::string, T> > bindings(FBindings.size());
+    for (unsigned j = 0; j < FBindings.size(); ++j)
+        bindings[j].first = FBindings[j].first;
+
+    for (unsigned i = 0; i < lower.size(); ++i) {
+        for (unsigned j = 0; j < FBindings.size(); ++j)
+            bindings[j].second = FBindings[j].second[i];
+
+        lower[i] = series(ANode, FParams[i], lower[i], upper[i], bindings, FRecursions,
+            FLibrary, FLimit);
+    }
+
+    FResult.swap(lower);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TProdNode<T> *ANode) {
+    std::vector<T> lower, upper;
+
+    calculate(ANode->lower(), lower);
+    calculate(ANode->upper(), upper);
+
+    std::vector<std::pair<std::string, T> > bindings(FBindings.size());
+    for (unsigned j = 0; j < FBindings.size(); ++j)
+        bindings[j].first = FBindings[j].first;
+
+    for (unsigned i = 0; i < lower.size(); ++i) {
+        for (unsigned j = 0; j < FBindings.size(); ++j)
+            bindings[j].second = FBindings[j].second[i];
+
+        lower[i] = series(ANode, FParams[i], lower[i], upper[i], bindings, FRecursions,
+            FLibrary, FLimit);
+    }
+
+    FResult.swap(lower);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TLetNode<T> *ANode) {
+    std::vector<T> value;
+    calculate(ANode->value(), value);
+
+    FBindings.push_back(TBinding(ANode->name(), std::vector<T>()));
+    FBindings.back().second.swap(value);
+
+    std::vector<T> result;
+    calculate(ANode->body(), result);
+
+    FBindings.pop_back();
+    FResult.swap(result);
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TEquNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] = FResult[i] == right[i];
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TUnEquNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] = FResult[i] != right[i];
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TGreaterNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] = FResult[i] > right[i];
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TLessNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] = FResult[i] < right[i];
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TGreaterEquNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] = FResult[i] >= right[i];
+}
+
+template<class T>
+void TBatchCalculator<T>::visit(TLessEquNode<T> *ANode) {
+    std::vector<T> right;
+    operands(ANode, right);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult[i] = FResult[i] <= right[i];
+}
+
 } // namespace math
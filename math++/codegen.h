@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the C++ code generator interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_codegen_h
+#define libmath_codegen_h
+
+#include <math++/visitor.h>
+#include <math++/library.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+namespace math {
+
+template<class> class TNode;
+
+/**
+  * TNativeFunction<> is a function of a generated library, see TCodeGenerator<>.
+  */
+template<class T>
+struct TNativeFunction {
+    const char *name;
+    T (*function)(T);           // 0, if it couldn't be compiled
+    const char *expression;     // the source, for the interpreter
+    const char *params;         // the parameter list, e.g. "x, y" (0 for x only)
+};
+
+/**
+  * TNativeConstant<> is a constant of a generated library.
+  */
+template<class T>
+struct TNativeConstant {
+    const char *name;
+    T value;
+};
+
+/**
+  * TCodeGenerator<> turns functions into plain C++ source code, to be 
+  * compiled along with the program using them. Each user function 
+  * becomes a C++ function (calling each other directly, recursion 
+  * included), IF becomes ?: and constants become literals.
+  *
+  * The generated code defines, in the given namespace:
+  *
+  *   extern const math::TNativeFunction<T> functions[];
+  *   extern const unsigned functionCount;
+  *   extern const math::TNativeConstant<T> constants[];
+  *   extern const unsigned constantCount;
+  *
+  * which are meant to be passed to TNativeLibrary<>. Functions using tables, 
+  * sums, products, unknown symbols or functions are left to the interpreter. 
+  * Note, the compiled functions don't check the recursion limit.
+  *
+  * T must be float, double or long double.
+  */
+template<class T>
+class TCodeGenerator : protected TNodeVisitor<T> {
+public:
+    /// appends the source of all functions and constants of ALibrary to AOutput
+    static void generate(const TLibrary<T>& ALibrary, std::string& AOutput,
+        const std::string& ANamespace = "generated");
+
+    /// appends the source of AFunction and all functions of ALibrary it calls to AOutput
+    static void generate(const TFunction<T>& AFunction, const TLibrary<T>& ALibrary,
+        std::string& AOutput, const std::string& ANamespace = "generated");
+
+private:
+    std::string& FOutput;
+    const TLibrary<T>& FLibrary;
+
+    TCodeGenerator(std::string& AOutput, const TLibrary<T>& ALibrary);
+
+    /// appends the source of AFunctions (sorted by name) to AOutput
+    static void generate(const std::vector<const TFunction<T> *>& AFunctions,
+        const TLibrary<T>& ALibrary, std::string& AOutput, const std::string& ANamespace);
+
+    /**
+      * adds the names of the functions and symbols used by AExpression and returns 
+      * false if it uses anything left to the interpreter (tables, sums, products, let
+      * or calls with further arguments).
+      */
+    static bool uses(const TNode<T> *AExpression, std::set<std::string>& AFunctions,
+        std::set<std::string>& ASymbols);
+
+    /// orders functions by name
+    static bool before(const TFunction<T> *a, const TFunction<T> *b);
+
+    /// returns the name of T in C++
+    static const char *typeName();
+    /// returns the suffix of T's floating point literals
+    static const char *suffix();
+    /// appends the digits of the finite number ANumber to AOutput
+    static void digits(const T& ANumber, std::string& AOutput);
+    /// appends ANumber as C++ literal
+    void literal(const T& ANumber);
+    /// appends the C++ name of the function AName
+    static void functionName(const std::string& AName, std::string& AOutput);
+    /// appends AText as C++ string literal to AOutput
+    static void quote(const std::string& AText, std::string& AOutput);
+
+    void unary(const char *AFunction, TNode<T> *ANode);
+    void binary(const char *AOperator, TNode<T> *ANode);
+    void relation(const char *AOperator, TNode<T> *ANode);
+
+    virtual void visit(TNumberNode<T> *);
+    virtual void visit(TSymbolNode<T> *);
+    virtual void visit(TParamNode<T> *);
+
+    virtual void visit(TPlusNode<T> *);
+    virtual void visit(TNegNode<T> *);
+
+    virtual void visit(TMulNode<T> *);
+    virtual void visit(TDivNode<T> *);
+
+    virtual void visit(TPowNode<T> *);
+    virtual void visit(TSqrtNode<T> *);
+
+    virtual void visit(TSinNode<T> *);
+    virtual void visit(TCosNode<T> *);
+    virtual void visit(TTanNode<T> *);
+    virtual void visit(TLnNode<T> *);
+
+    virtual void visit(TFuncNode<T> *);
+    virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
+
+    virtual void visit(TEquNode<T> *);
+    virtual void visit(TUnEquNode<T> *);
+    virtual void visit(TGreaterNode<T> *);
+    virtual void visit(TLessNode<T> *);
+    virtual void visit(TGreaterEquNode<T> *);
+    virtual void visit(TLessEquNode<T> *);
+};
+
+/**
+  * TNativeLibrary<> makes the functions of a generated library callable 
+  * by name. The compiled functions are called directly, the others (and 
+  * all of them through library()) run in the interpreter.
+  */
+template<class T>
+class TNativeLibrary {
+public:
+    typedef T (*TFunctionPtr)(T);
+
+    /// uses the generated tables AFunctions and AConstants
+    TNativeLibrary(const TNativeFunction<T> *AFunctions, unsigned AFunctionCount,
+        const TNativeConstant<T> *AConstants, unsigned AConstantCount);
+
+    /// returns the compiled function AName or 0 if it's interpreted only
+    TFunctionPtr function(const std::string& AName) const;
+
+    /// calls the function AName, compiled if possible
+    T call(const std::string& AName, const T& AParam) const;
+
+    /// returns the value of the constant AName
+    T value(const std::string& AName) const;
+
+    /// returns the library for the interpreter
+    const TLibrary<T>& library() const { return FLibrary; }
+
+private:
+    TLibrary<T> FLibrary;
+    std::map<std::string, TFunctionPtr> FFunctions;
+};
+
+} // namespace math
+
+#include <math++/codegen.tcc>
+
+#endif
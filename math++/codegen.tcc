@@ -0,0 +1,545 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the C++ code generator template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_codegen_h
+#error You may not include math++/codegen.tcc directly; include math++/codegen.h instead.
+#endif
+
+#include <math++/nodes.h>
+#include <math++/printer.h>
+
+#include <algorithm>
+#include <sstream>
+#include <limits>
+#include <cstdio>
+
+namespace math {
+
+template<class T>
+TCodeGenerator<T>::TCodeGenerator(std::string& AOutput, const TLibrary<T>& ALibrary) :
+    FOutput(AOutput), FLibrary(ALibrary) {
+}
+
+template<class T>
+void TCodeGenerator<T>::generate(const TLibrary<T>& ALibrary, std::string& AOutput,
+    const std::string& ANamespace) {
+
+    std::vector<const TFunction<T> *> functions;
+    for (typename TLibrary<T>::TFunctionList::const_iterator i = ALibrary.FFunctions.begin();
+         i != ALibrary.FFunctions.end(); ++i)
+        functions.push_back(&*i);
+
+    generate(functions, ALibrary, AOutput, ANamespace);
+}
+
+template<class T>
+void TCodeGenerator<T>::generate(const TFunction<T>& AFunction, const TLibrary<T>& ALibrary,
+    std::string& AOutput, const std::string& ANamespace) {
+
+    std::set<std::string> callees;
+    ALibrary.dependencies(AFunction.expression(), callees);
+
+    std::vector<const TFunction<T> *> functions(1, &AFunction);
+    for (std::set<std::string>::const_iterator i = callees.begin(); i != callees.end(); ++i)
+        if (*i != AFunction.name())
+            if (const TFunction<T> *f = ALibrary.find(*i))
+                functions.push_back(f);
+
+    generate(functions, ALibrary, AOutput, ANamespace);
+}
+
+template<class T>
+bool TCodeGenerator<T>::before(const TFunction<T> *a, const TFunction<T> *b) {
+    return a->name() < b->name();
+}
+
+template<class T>
+void TCodeGenerator<T>::generate(const std::vector<const TFunction<T> *>& AFunctions,
+    const TLibrary<T>& ALibrary, std::string& AOutput, const std::string& ANamespace) {
+
+    std::vector<const TFunction<T> *> functions(AFunctions);
+    std::sort(functions.begin(), functions.end(), &before);
+
+    // a function of x only is compiled if all the symbols it uses are constants, it uses
+    // no tables, series or let and all the functions it calls get compiled themselves
+    std::map<std::string, std::set<std::string> > calls;
+    std::set<std::string> compiled, constants;
+
+    for (unsigned i = 0; i < functions.size(); ++i) {
+        std::set<std::string> symbols;
+        bool resolved = uses(functions[i]->expression(), calls[functions[i]->name()], symbols);
+
+        for (std::set<std::string>::const_iterator s = symbols.begin(); s != symbols.end(); ++s) {
+            if (ALibrary.hasConstant(*s))
+                constants.insert(*s);
+            else
+                resolved = false;
+        }
+        if (resolved && functions[i]->params().empty())
+            compiled.insert(functions[i]->name());
+    }
+
+    for (bool changed = true; changed; ) {
+        changed = false;
+
+        for (std::set<std::string>::iterator i = compiled.begin(); i != compiled.end(); ) {
+            const std::set<std::string>& callees = calls[*i];
+            bool resolved = true;
+
+            for (std::set<std::string>::const_iterator c = callees.begin(); c != callees.end(); ++c)
+                if (compiled.find(*c) == compiled.end())
+                    resolved = false;
+
+            if (resolved)
+                ++i;
+            else {
+                compiled.erase(i++);
+                changed = true;
+            }
+        }
+    }
+
+    const std::string type(typeName());
+    TCodeGenerator<T> generator(AOutput, ALibrary);
+
+    AOutput += "// generated by the libmath C++ code generator, do not edit\n\n";
+    AOutput += "#include <math++/codegen.h>\n\n";
+    AOutput += "#include <cmath>\n";
+    AOutput += "#include <limits>\n\n";
+    AOutput += "namespace " + ANamespace + " {\n\n";
+
+    // the prototypes, so the functions may call each other in any order
+    for (unsigned i = 0; i < functions.size(); ++i) {
+        if (compiled.find(functions[i]->name()) == compiled.end())
+            continue;
+
+        AOutput += type + ' ';
+        functionName(functions[i]->name(), AOutput);
+        AOutput += '(' + type + " x);\n";
+    }
+
+    for (unsigned i = 0; i < functions.size(); ++i) {
+        if (compiled.find(functions[i]->name()) == compiled.end())
+            continue;
+
+        AOutput += '\n' + type + ' ';
+        functionName(functions[i]->name(), AOutput);
+        AOutput += '(' + type + " x) {\n    return ";
+        functions[i]->expression()->accept(generator);
+        AOutput += ";\n}\n";
+    }
+
+    // the tables to be passed to TNativeLibrary<>
+    AOutput += "\nextern const math::TNativeFunction<" + type + "> functions[] = {\n";
+    for (unsigned i = 0; i < functions.size(); ++i) {
+        AOutput += "    { ";
+        quote(functions[i]->name(), AOutput);
+        AOutput += ", ";
+
+        if (compiled.find(functions[i]->name()) != compiled.end())
+            functionName(functions[i]->name(), AOutput);
+        else
+            AOutput += '0';
+
+        AOutput += ", ";
+        quote(TPrinter<T>::print(functions[i]->expression()), AOutput);
+
+        if (!functions[i]->params().empty()) {
+            std::string params("x");
+            for (unsigned k = 0; k < functions[i]->params().size(); ++k)
+                params += ", " + functions[i]->params()[k];
+
+            AOutput += ", ";
+            quote(params, AOutput);
+        }
+        AOutput += " },\n";
+    }
+    if (functions.empty())
+        AOutput += "    { 0, 0, 0 }\n";
+    AOutput += "};\n";
+
+    char count[32];
+    std::sprintf(count, "%u", unsigned(functions.size()));
+    AOutput += std::string("extern const unsigned functionCount = ") + count + ";\n";
+
+    AOutput += "\nextern const math::TNativeConstant<" + type + "> constants[] = {\n";
+    for (std::set<std::string>::const_iterator i = constants.begin(); i != constants.end(); ++i) {
+        AOutput += "    { ";
+        quote(*i, AOutput);
+        AOutput += ", ";
+        generator.literal(ALibrary.value(*i));
+        AOutput += " },\n";
+    }
+    if (constants.empty())
+        AOutput += "    { 0, 0 }\n";
+    AOutput += "};\n";
+
+    std::sprintf(count, "%u", unsigned(constants.size()));
+    AOutput += std::string("extern const unsigned constantCount = ") + count + ";\n";
+
+    AOutput += "\n} // namespace " + ANamespace + "\n";
+}
+
+template<class T>
+bool TCodeGenerator<T>::uses(const TNode<T> *AExpression, std::set<std::string>& AFunctions,
+    std::set<std::string>& ASymbols) {
+
+    std::vector<const TNode<T> *> pending(1, AExpression);
+    bool result = true;
+
+    while (!pending.empty()) {
+        const TNode<T> *n = pending.back();
+        pending.pop_back();
+
+        if (!n)
+            continue;
+
+        switch (n->nodeType()) {
+            case TNode<T>::SYMBOL_NODE:
+                ASymbols.insert(static_cast<const TSymbolNode<T> *>(n)->symbol());
+                break;
+            case TNode<T>::FUNC_NODE: {
+                const TFuncNode<T> *call = static_cast<const TFuncNode<T> *>(n);
+                AFunctions.insert(call->name());
+
+                for (unsigned i = 1; i < call->params(); ++i) {
+                    pending.push_back(call->param(i));
+                    result = false;
+                }
+                break;
+            }
+            case TNode<T>::IF_NODE:
+                pending.push_back(static_cast<const TIfNode<T> *>(n)->condition());
+                break;
+            case TNode<T>::SUM_NODE:
+            case TNode<T>::PROD_NODE:
+                pending.push_back(static_cast<const TSeriesNode<T> *>(n)->body());
+                // fall through
+            case TNode<T>::TABLE_NODE:
+            case TNode<T>::LET_NODE:
+                result = false;
+                break;
+            default:
+                break;
+        }
+
+        pending.push_back(n->left());
+        pending.push_back(n->right());
+    }
+    return result;
+}
+
+template<> inline const char *TCodeGenerator<float>::typeName() { return "float"; }
+template<> inline const char *TCodeGenerator<double>::typeName() { return "double"; }
+template<> inline const char *TCodeGenerator<long double>::typeName() { return "long double"; }
+
+template<> inline const char *TCodeGenerator<float>::suffix() { return "f"; }
+template<> inline const char *TCodeGenerator<double>::suffix() { return ""; }
+template<> inline const char *TCodeGenerator<long double>::suffix() { return "L"; }
+
+template<class T>
+void TCodeGenerator<T>::digits(const T& ANumber, std::string& AOutput) {
+    std::ostringstream sstr;
+    sstr.precision(std::numeric_limits<T>::digits10 + 3); // enough to read back the same
+    sstr << ANumber;
+
+    AOutput += sstr.str();
+}
+
+template<>
+inline void TCodeGenerator<double>::digits(const double& ANumber, std::string& AOutput) {
+    TPrinter<double>::print(ANumber, AOutput);
+}
+
+template<class T>
+void TCodeGenerator<T>::literal(const T& ANumber) {
+    const std::string type(typeName());
+
+    if (ANumber != ANumber) {
+        FOutput += "std::numeric_limits<" + type + ">::quiet_NaN()";
+        return;
+    }
+    if (ANumber > std::numeric_limits<T>::max() || ANumber < -std::numeric_limits<T>::max()) {
+        FOutput += ANumber < 0 ? "(-" : "";
+        FOutput += "std::numeric_limits<" + type + ">::infinity()";
+        FOutput += ANumber < 0 ? ")" : "";
+        return;
+    }
+
+    std::string::size_type start = FOutput.size();
+    if (ANumber < 0)
+        FOutput += '(';
+
+    digits(ANumber, FOutput);
+
+    // integral numbers still have to be floating point literals
+    if (FOutput.find_first_of(".e", start) == std::string::npos)
+        FOutput += ".0";
+
+    FOutput += suffix();
+
+    if (ANumber < 0)
+        FOutput += ')';
+}
+
+template<class T>
+void TCodeGenerator<T>::functionName(const std::string& AName, std::string& AOutput) {
+    static const char hex[] = "0123456789abcdef";
+
+    AOutput += "f_";
+    for (std::string::const_iterator i = AName.begin(); i != AName.end(); ++i) {
+        if ((*i >= 'a' && *i <= 'z') || (*i >= 'A' && *i <= 'Z') || (*i >= '0' && *i <= '9'))
+            AOutput += *i;
+        else {
+            // anything else gets escaped, underscores included, to stay unique
+            AOutput += '_';
+            AOutput += hex[(unsigned char)*i >> 4];
+            AOutput += hex[*i & 15];
+        }
+    }
+}
+
+template<class T>
+void TCodeGenerator<T>::quote(const std::string& AText, std::string& AOutput) {
+    AOutput += '"';
+    for (std::string::const_iterator i = AText.begin(); i != AText.end(); ++i) {
+        if (*i == '"' || *i == '\\') {
+            AOutput += '\\';
+            AOutput += *i;
+        } else if (*i >= ' ' && *i <= '~' && *i != '?') // no trigraphs
+            AOutput += *i;
+        else {
+            AOutput += "\\";
+            AOutput += char('0' + ((unsigned char)*i >> 6));
+            AOutput += char('0' + ((*i >> 3) & 7));
+            AOutput += char('0' + (*i & 7));
+        }
+    }
+    AOutput += '"';
+}
+
+template<class T>
+void TCodeGenerator<T>::unary(const char *AFunction, TNode<T> *ANode) {
+    FOutput += AFunction;
+    FOutput += '(';
+    ANode->accept(*this);
+    FOutput += ')';
+}
+
+template<class T>
+void TCodeGenerator<T>::binary(const char *AOperator, TNode<T> *ANode) {
+    FOutput += '(';
+    ANode->left()->accept(*this);
+    FOutput += AOperator;
+    ANode->right()->accept(*this);
+    FOutput += ')';
+}
+
+template<class T>
+void TCodeGenerator<T>::relation(const char *AOperator, TNode<T> *ANode) {
+    FOutput += typeName();
+    binary(AOperator, ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TNumberNode<T> *ANode) {
+    literal(ANode->number());
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TSymbolNode<T> *ANode) {
+    literal(FLibrary.value(ANode->symbol()));
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TParamNode<T> *ANode) {
+    FOutput += 'x';
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TPlusNode<T> *ANode) {
+    binary(" + ", ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TNegNode<T> *ANode) {
+    FOutput += "(-";
+    ANode->node()->accept(*this);
+    FOutput += ')';
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TMulNode<T> *ANode) {
+    binary(" * ", ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TDivNode<T> *ANode) {
+    binary(" / ", ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TPowNode<T> *ANode) {
+    FOutput += "std::pow";
+    binary(", ", ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TSqrtNode<T> *ANode) {
+    unary("std::sqrt", ANode->node());
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TSinNode<T> *ANode) {
+    unary("std::sin", ANode->node());
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TCosNode<T> *ANode) {
+    unary("std::cos", ANode->node());
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TTanNode<T> *ANode) {
+    unary("std::tan", ANode->node());
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TLnNode<T> *ANode) {
+    unary("std::log", ANode->node());
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TFuncNode<T> *ANode) {
+    functionName(ANode->name(), FOutput);
+    FOutput += '(';
+    ANode->node()->accept(*this);
+    FOutput += ')';
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TIfNode<T> *ANode) {
+    FOutput += '(';
+    ANode->condition()->accept(*this);
+    FOutput += " != 0 ? ";
+    ANode->trueExpr()->accept(*this);
+    FOutput += " : ";
+    ANode->falseExpr()->accept(*this);
+    FOutput += ')';
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TTableNode<T> *ANode) {
+    // functions using tables are left to the interpreter, see generate()
+    throw ELibraryLookup("Tables can't be compiled: " + ANode->name() + ".");
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TSumNode<T> *ANode) {
+    // functions using sums are left to the interpreter, see generate()
+    throw ECalcError("Sums can't be compiled.");
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TProdNode<T> *ANode) {
+    // functions using products are left to the interpreter, see generate()
+    throw ECalcError("Products can't be compiled.");
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TLetNode<T> *ANode) {
+    // functions using let are left to the interpreter, see generate()
+    throw ECalcError("Let can't be compiled.");
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TEquNode<T> *ANode) {
+    relation(" == ", ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TUnEquNode<T> *ANode) {
+    relation(" != ", ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TGreaterNode<T> *ANode) {
+    relation(" > ", ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TLessNode<T> *ANode) {
+    relation(" < ", ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TGreaterEquNode<T> *ANode) {
+    relation(" >= ", ANode);
+}
+
+template<class T>
+void TCodeGenerator<T>::visit(TLessEquNode<T> *ANode) {
+    relation(" <= ", ANode);
+}
+
+// TNativeLibrary
+
+template<class T>
+TNativeLibrary<T>::TNativeLibrary(const TNativeFunction<T> *AFunctions, unsigned AFunctionCount,
+    const TNativeConstant<T> *AConstants, unsigned AConstantCount) {
+
+    for (unsigned i = 0; i < AConstantCount; ++i)
+        FLibrary.insert(TConstant<T>(AConstants[i].name, AConstants[i].value));
+
+    for (unsigned i = 0; i < AFunctionCount; ++i) {
+        if (AFunctions[i].params)
+            FLibrary.insert(TFunction<T>(AFunctions[i].name, AFunctions[i].params,
+                AFunctions[i].expression));
+        else
+            FLibrary.insert(TFunction<T>(AFunctions[i].name, AFunctions[i].expression));
+
+        if (AFunctions[i].function)
+            FFunctions[AFunctions[i].name] = AFunctions[i].function;
+    }
+}
+
+template<class T>
+typename TNativeLibrary<T>::TFunctionPtr TNativeLibrary<T>::function(const std::string& AName) const {
+    typename std::map<std::string, TFunctionPtr>::const_iterator i = FFunctions.find(AName);
+
+    return i != FFunctions.end() ? i->second : 0;
+}
+
+template<class T>
+T TNativeLibrary<T>::call(const std::string& AName, const T& AParam) const {
+    if (TFunctionPtr f = function(AName))
+        return f(AParam);
+
+    return FLibrary.call(AName, AParam);
+}
+
+template<class T>
+T TNativeLibrary<T>::value(const std::string& AName) const {
+    return FLibrary.value(AName);
+}
+
+} // namespace math
@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the shared expression graph interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_dag_h
+#define libmath_dag_h
+
+#include <math++/visitor.h>
+#include <math++/nodes.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace math {
+
+template<class> class TLibrary;
+
+/**
+  * TExprDag<> stores expressions as a directed acyclic graph of immutable,
+  * shared nodes. Each distinct subexpression is stored exactly once
+  * (hash consing), so building a derivative just references the operands
+  * it needs instead of cloning them as TDeriver<> does.
+  *
+  * This keeps higher order derivatives small: the n-th derivative only
+  * adds the nodes being really new, and each derivative of a shared
+  * subexpression is built only once.
+  *
+  * Expressions are addressed by their id (TId), which is valid as long as
+  * the graph lives. Sums and products get calculated by TCalculator<>, as
+  * the values of their terms change with the index, and so do calls with
+  * further arguments. The symbols bound by let are replaced by their 
+  * values, which get shared anyway.
+  */
+template<class T>
+class TExprDag : protected TNodeVisitor<T> {
+public:
+    typedef unsigned TId;
+
+    TExprDag();
+
+    /// imports given expression tree and returns the id of its root node
+    TId insert(const TNode<T> *AExpression);
+
+    /// returns the id of the derivative (by x) of the expression AExpression
+    TId derive(TId AExpression);
+
+    /// returns the id of the ACount-th derivative (by x) of the expression AExpression
+    TId derive(TId AExpression, unsigned ACount);
+
+    /// creates an expression tree of AExpression (shared nodes get duplicated)
+    TNode<T> *tree(TId AExpression) const;
+
+    /// calculates AExpression's result using given parameter and library
+    T calculate(TId AExpression, const T& AParam, const TLibrary<T>& ALibrary) const;
+
+    /// returns the number of distinct nodes the expression AExpression consists of
+    unsigned count(TId AExpression) const;
+
+    /// returns the number of nodes stored in this graph
+    unsigned size() const;
+
+private:
+    typedef typename TNode<T>::TNodeType TNodeType;
+
+    /// TEntry represents a single, immutable node in the graph
+    struct TEntry {
+        TNodeType type;
+        TId left;           // first operand (or the only one)
+        TId right;          // second operand
+        TId cond;           // condition of IF nodes, derivative order of tables, body of series
+        T number;           // value of number nodes
+        std::string name;   // name of symbols, user functions, tables and series indices
+        std::vector<TId> params;    // further arguments of user functions
+
+        bool operator<(const TEntry&) const;
+    };
+
+    std::vector<TEntry> FNodes;
+    std::map<TEntry, TId> FIndex;       // used for sharing equal nodes
+    std::map<TId, TId> FDerivatives;    // already built derivatives
+    std::vector<std::pair<std::string, TId> > FBindings; // symbols bound while inserting
+    TId FResult;
+
+private:
+    /// returns the id of the node equal to AEntry, inserting it if needed
+    TId share(const TEntry& AEntry);
+
+    /// the create methods return the id of the requested (folded) node
+    TId create(TNodeType AType, TId ALeft = 0, TId ARight = 0, TId ACond = 0);
+    TId createUnary(TNodeType AType, TId ANode);
+    TId createNumber(const T& AValue);
+    TId createSymbol(TNodeType AType, const std::string& AName, TId AParam = 0);
+    TId createCall(const std::string& AName, const std::vector<TId>& AParams);
+    TId createTable(const std::string& AName, TId AParam, unsigned AOrder);
+    TId createSeries(TNodeType AType, const std::string& AIndex, TId ALower, TId AUpper, TId ABody);
+    TId createPlus(TId ALeft, TId ARight);
+    TId createNeg(TId ANode);
+    TId createMul(TId ALeft, TId ARight);
+    TId createDiv(TId ALeft, TId ARight);
+    TId createPow(TId ALeft, TId ARight);
+
+    /**
+      * inserts the body of a sum or product, where its index is bound. The
+      * index gets renamed into AIndex, if a value bound by an enclosing let
+      * refers to a symbol of the same name, as it would capture it otherwise.
+      */
+    TId insertBody(TSeriesNode<T> *ANode, std::string& AIndex);
+
+    /// returns true, if the symbol ASymbol occurs within the node AId
+    bool uses(TId AId, const std::string& ASymbol) const;
+
+    /// returns true, if given node is a number node of value AValue
+    bool isNumber(TId AId, const T& AValue) const;
+
+    const TEntry& entry(TId AId) const;
+
+    T calculate(TId AId, const T& AParam, const TLibrary<T>& ALibrary,
+        std::vector<T>& AValues, std::vector<bool>& ADone) const;
+
+    virtual void visit(TNumberNode<T> *);
+    virtual void visit(TSymbolNode<T> *);
+    virtual void visit(TParamNode<T> *);
+
+    virtual void visit(TPlusNode<T> *);
+    virtual void visit(TNegNode<T> *);
+
+    virtual void visit(TMulNode<T> *);
+    virtual void visit(TDivNode<T> *);
+
+    virtual void visit(TPowNode<T> *);
+    virtual void visit(TSqrtNode<T> *);
+
+    virtual void visit(TSinNode<T> *);
+    virtual void visit(TCosNode<T> *);
+    virtual void visit(TTanNode<T> *);
+    virtual void visit(TLnNode<T> *);
+
+    virtual void visit(TFuncNode<T> *);
+    virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
+
+    virtual void visit(TEquNode<T> *);
+    virtual void visit(TUnEquNode<T> *);
+    virtual void visit(TGreaterNode<T> *);
+    virtual void visit(TLessNode<T> *);
+    virtual void visit(TGreaterEquNode<T> *);
+    virtual void visit(TLessEquNode<T> *);
+};
+
+} // namespace math
+
+#include <math++/dag.tcc>
+
+#endif
@@ -0,0 +1,788 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the shared expression graph template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_dag_h
+#error You may not include math++/dag.tcc directly; include math++/dag.h instead.
+#endif
+
+#include <math++/library.h>
+#include <math++/calculator.h>
+
+#include <memory>
+#include <cmath>
+
+namespace math {
+
+// TExprDag<>::TEntry
+template<class T>
+bool TExprDag<T>::TEntry::operator<(const TEntry& e) const {
+    if (type != e.type)
+        return type < e.type;
+
+    if (left != e.left)
+        return left < e.left;
+
+    if (right != e.right)
+        return right < e.right;
+
+    if (cond != e.cond)
+        return cond < e.cond;
+
+    if (name != e.name)
+        return name < e.name;
+
+    if (params != e.params)
+        return params < e.params;
+
+    return number < e.number;
+}
+
+// TExprDag<>
+template<class T>
+TExprDag<T>::TExprDag() : FResult(0) {
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::insert(const TNode<T> *AExpression) {
+    const_cast<TNode<T> *>(AExpression)->accept(*this);
+
+    return FResult;
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::derive(TId AId) {
+    typename std::map<TId, TId>::const_iterator i = FDerivatives.find(AId);
+    if (i != FDerivatives.end())
+        return i->second;
+
+    // take a copy, the node storage may grow while deriving.
+    const TEntry e(entry(AId));
+    TId result;
+
+    switch (e.type) {
+        case TNode<T>::NUMBER_NODE:
+        case TNode<T>::SYMBOL_NODE:
+            // [const]' = 0
+            result = createNumber(T(0));
+            break;
+        case TNode<T>::PARAM_NODE:
+            // [x]' = 1
+            result = createNumber(T(1));
+            break;
+        case TNode<T>::PLUS_NODE:
+            // [f + g]' = f' + g'
+            result = createPlus(derive(e.left), derive(e.right));
+            break;
+        case TNode<T>::NEG_NODE:
+            // [-f]' = -(f')
+            result = createNeg(derive(e.left));
+            break;
+        case TNode<T>::MUL_NODE:
+            // [f * g]' = f'g + g'f
+            result = createPlus(
+                createMul(derive(e.left), e.right),
+                createMul(derive(e.right), e.left)
+            );
+            break;
+        case TNode<T>::DIV_NODE:
+            // [f/g]' = (f'g - g'f)/(g^2)
+            result = createDiv(
+                createPlus(
+                    createMul(derive(e.left), e.right),
+                    createNeg(createMul(derive(e.right), e.left))
+                ),
+                createPow(e.right, createNumber(T(2)))
+            );
+            break;
+        case TNode<T>::POW_NODE:
+            // [f ^ g]' = f^g * (g'ln(f) + (f'g)/f)
+            result = createMul(
+                AId,
+                createPlus(
+                    createMul(derive(e.right), createUnary(TNode<T>::LN_NODE, e.left)),
+                    createDiv(createMul(derive(e.left), e.right), e.left)
+                )
+            );
+            break;
+        case TNode<T>::SQRT_NODE:
+            // [sqrt(f)]' = f' / (2 sqrt(f))
+            result = createDiv(derive(e.left), createMul(createNumber(T(2)), AId));
+            break;
+        case TNode<T>::SIN_NODE:
+            // [sin(f)]' = cos(f) * f'
+            result = createMul(createUnary(TNode<T>::COS_NODE, e.left), derive(e.left));
+            break;
+        case TNode<T>::COS_NODE:
+            // [cos(f)]' = -(sin(f) * f')
+            result = createNeg(
+                createMul(createUnary(TNode<T>::SIN_NODE, e.left), derive(e.left))
+            );
+            break;
+        case TNode<T>::TAN_NODE:
+            // [tan(f)]' = (1 + tan(f)^2) * f'
+            result = createMul(
+                createPlus(createNumber(T(1)), createPow(AId, createNumber(T(2)))),
+                derive(e.left)
+            );
+            break;
+        case TNode<T>::LN_NODE:
+            // [ln(f)]' = f' / f
+            result = createDiv(derive(e.left), e.left);
+            break;
+        case TNode<T>::IF_NODE:
+            result = create(TNode<T>::IF_NODE, derive(e.left), derive(e.right), e.cond);
+            break;
+        case TNode<T>::TABLE_NODE:
+            // [TABLE(t, f)]' = TABLE(t, f, 1) * f'
+            result = createMul(createTable(e.name, e.left, e.cond + 1), derive(e.left));
+            break;
+        case TNode<T>::SUM_NODE:
+            // [sum(k, a, b, f)]' = sum(k, a, b, f')
+            result = createSeries(TNode<T>::SUM_NODE, e.name, e.left, e.right, derive(e.cond));
+            break;
+        case TNode<T>::PROD_NODE:
+            // [prod(k, a, b, f)]' = prod(k, a, b, f) * sum(k, a, b, f'/f)
+            result = createMul(
+                AId,
+                createSeries(TNode<T>::SUM_NODE, e.name, e.left, e.right,
+                    createDiv(derive(e.cond), e.cond))
+            );
+            break;
+        default:
+            // user functions and equations are kept as they are (see TDeriver<>)
+            result = AId;
+            break;
+    }
+
+    FDerivatives[AId] = result;
+
+    return result;
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::derive(TId AId, unsigned ACount) {
+    while (ACount--)
+        AId = derive(AId);
+
+    return AId;
+}
+
+template<class T>
+TNode<T> *TExprDag<T>::tree(TId AId) const {
+    const TEntry& e = entry(AId);
+
+    switch (e.type) {
+        case TNode<T>::NUMBER_NODE:
+            return new TNumberNode<T>(e.number);
+        case TNode<T>::SYMBOL_NODE:
+            return new TSymbolNode<T>(e.name);
+        case TNode<T>::PARAM_NODE:
+            return new TParamNode<T>();
+        case TNode<T>::PLUS_NODE:
+            return new TPlusNode<T>(tree(e.left), tree(e.right));
+        case TNode<T>::NEG_NODE:
+            return new TNegNode<T>(tree(e.left));
+        case TNode<T>::MUL_NODE:
+            return new TMulNode<T>(tree(e.left), tree(e.right));
+        case TNode<T>::DIV_NODE:
+            return new TDivNode<T>(tree(e.left), tree(e.right));
+        case TNode<T>::POW_NODE:
+            return new TPowNode<T>(tree(e.left), tree(e.right));
+        case TNode<T>::SQRT_NODE:
+            return new TSqrtNode<T>(tree(e.left));
+        case TNode<T>::SIN_NODE:
+            return new TSinNode<T>(tree(e.left));
+        case TNode<T>::COS_NODE:
+            return new TCosNode<T>(tree(e.left));
+        case TNode<T>::TAN_NODE:
+            return new TTanNode<T>(tree(e.left));
+        case TNode<T>::LN_NODE:
+            return new TLnNode<T>(tree(e.left));
+        case TNode<T>::FUNC_NODE: {
+            std::auto_ptr<TFuncNode<T> > call(new TFuncNode<T>(e.name, tree(e.left)));
+
+            for (unsigned i = 0; i < e.params.size(); ++i)
+                call->addParam(tree(e.params[i]));
+
+            return call.release();
+        }
+        case TNode<T>::IF_NODE:
+            return new TIfNode<T>(tree(e.cond), tree(e.left), tree(e.right));
+        case TNode<T>::TABLE_NODE:
+            return new TTableNode<T>(e.name, tree(e.left), e.cond);
+        case TNode<T>::SUM_NODE:
+            return new TSumNode<T>(e.name, tree(e.left), tree(e.right), tree(e.cond));
+        case TNode<T>::PROD_NODE:
+            return new TProdNode<T>(e.name, tree(e.left), tree(e.right), tree(e.cond));
+        case TNode<T>::EQU_NODE:
+            return new TEquNode<T>(tree(e.left), tree(e.right));
+        case TNode<T>::UNEQU_NODE:
+            return new TUnEquNode<T>(tree(e.left), tree(e.right));
+        case TNode<T>::LESS_EQU_NODE:
+            return new TLessEquNode<T>(tree(e.left), tree(e.right));
+        case TNode<T>::GREATER_EQU_NODE:
+            return new TGreaterEquNode<T>(tree(e.left), tree(e.right));
+        case TNode<T>::LESS_NODE:
+            return new TLessNode<T>(tree(e.left), tree(e.right));
+        case TNode<T>::GREATER_NODE:
+            return new TGreaterNode<T>(tree(e.left), tree(e.right));
+        default:
+            return 0;
+    }
+}
+
+template<class T>
+T TExprDag<T>::calculate(TId AId, const T& AParam, const TLibrary<T>& ALibrary) const {
+    std::vector<T> values(FNodes.size());
+    std::vector<bool> done(FNodes.size(), false);
+
+    return calculate(AId, AParam, ALibrary, values, done);
+}
+
+template<class T>
+T TExprDag<T>::calculate(TId AId, const T& AParam, const TLibrary<T>& ALibrary,
+    std::vector<T>& AValues, std::vector<bool>& ADone) const {
+
+    // each shared node is calculated only once
+    if (ADone[AId])
+        return AValues[AId];
+
+    const TEntry& e = entry(AId);
+    T result;
+
+#define LEFT  calculate(e.left, AParam, ALibrary, AValues, ADone)
+#define RIGHT calculate(e.right, AParam, ALibrary, AValues, ADone)
+
+    switch (e.type) {
+        case TNode<T>::NUMBER_NODE: result = e.number; break;
+        case TNode<T>::SYMBOL_NODE: result = ALibrary.value(e.name); break;
+        case TNode<T>::PARAM_NODE:  result = AParam; break;
+        case TNode<T>::PLUS_NODE:   result = LEFT + RIGHT; break;
+        case TNode<T>::NEG_NODE:    result = - LEFT; break;
+        case TNode<T>::MUL_NODE:    result = LEFT * RIGHT; break;
+        case TNode<T>::DIV_NODE:    result = LEFT / RIGHT; break;
+        case TNode<T>::POW_NODE:    result = pow(LEFT, RIGHT); break;
+        case TNode<T>::SQRT_NODE:   result = sqrt(LEFT); break;
+        case TNode<T>::SIN_NODE:    result = sin(LEFT); break;
+        case TNode<T>::COS_NODE:    result = cos(LEFT); break;
+        case TNode<T>::TAN_NODE:    result = tan(LEFT); break;
+        case TNode<T>::LN_NODE:     result = log(LEFT); break;
+        case TNode<T>::FUNC_NODE:
+            if (e.params.empty())
+                result = ALibrary.call(e.name, LEFT);
+            else {
+                // the further arguments get bound by the calculator
+                std::auto_ptr<TNode<T> > node(tree(AId));
+                result = TCalculator<T>::calculate(node.get(), AParam, ALibrary);
+            }
+            break;
+        case TNode<T>::IF_NODE:
+            result = calculate(e.cond, AParam, ALibrary, AValues, ADone) ? LEFT : RIGHT;
+            break;
+        case TNode<T>::TABLE_NODE:
+            result = ALibrary.table(e.name).value(LEFT, e.cond);
+            break;
+        case TNode<T>::SUM_NODE:
+        case TNode<T>::PROD_NODE: {
+            // the body's values depend on the index, so they can't be shared
+            std::auto_ptr<TNode<T> > series(tree(AId));
+            result = TCalculator<T>::calculate(series.get(), AParam, ALibrary);
+            break;
+        }
+        case TNode<T>::EQU_NODE:         result = LEFT == RIGHT; break;
+        case TNode<T>::UNEQU_NODE:       result = LEFT != RIGHT; break;
+        case TNode<T>::LESS_EQU_NODE:    result = LEFT <= RIGHT; break;
+        case TNode<T>::GREATER_EQU_NODE: result = LEFT >= RIGHT; break;
+        case TNode<T>::LESS_NODE:        result = LEFT < RIGHT; break;
+        case TNode<T>::GREATER_NODE:     result = LEFT > RIGHT; break;
+        default:                         result = T(0); break;
+    }
+
+#undef LEFT
+#undef RIGHT
+
+    ADone[AId] = true;
+    return AValues[AId] = result;
+}
+
+template<class T>
+unsigned TExprDag<T>::count(TId AId) const {
+    std::vector<bool> seen(FNodes.size(), false);
+    std::vector<TId> stack(1, AId);
+    unsigned result = 0;
+
+    while (!stack.empty()) {
+        TId id = stack.back();
+        stack.pop_back();
+
+        if (seen[id])
+            continue;
+
+        seen[id] = true;
+        ++result;
+
+        const TEntry& e = entry(id);
+        switch (e.type) {
+            case TNode<T>::NUMBER_NODE:
+            case TNode<T>::SYMBOL_NODE:
+            case TNode<T>::PARAM_NODE:
+                break;
+            case TNode<T>::FUNC_NODE:
+                stack.insert(stack.end(), e.params.begin(), e.params.end());
+                stack.push_back(e.left);
+                break;
+            case TNode<T>::IF_NODE:
+            case TNode<T>::SUM_NODE:
+            case TNode<T>::PROD_NODE:
+                stack.push_back(e.cond);
+                // fall through
+            default:
+                stack.push_back(e.left);
+                if (e.right != e.left)
+                    stack.push_back(e.right);
+        }
+    }
+    return result;
+}
+
+template<class T>
+unsigned TExprDag<T>::size() const {
+    return FNodes.size();
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::share(const TEntry& AEntry) {
+    typename std::map<TEntry, TId>::const_iterator i = FIndex.find(AEntry);
+    if (i != FIndex.end())
+        return i->second;
+
+    TId id = FNodes.size();
+    FNodes.push_back(AEntry);
+    FIndex[AEntry] = id;
+
+    return id;
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::create(TNodeType AType, TId ALeft, TId ARight, TId ACond) {
+    TEntry e;
+    e.type = AType;
+    e.left = ALeft;
+    e.right = ARight;
+    e.cond = ACond;
+    e.number = T(0);
+
+    return share(e);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createUnary(TNodeType AType, TId ANode) {
+    // unary operators refer to their operand by both, left and right
+    return create(AType, ANode, ANode);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createNumber(const T& AValue) {
+    TEntry e;
+    e.type = TNode<T>::NUMBER_NODE;
+    e.left = e.right = e.cond = 0;
+    e.number = AValue;
+
+    return share(e);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createSymbol(TNodeType AType,
+    const std::string& AName, TId AParam) {
+
+    TEntry e;
+    e.type = AType;
+    e.left = e.right = AParam;
+    e.cond = 0;
+    e.number = T(0);
+    e.name = AName;
+
+    return share(e);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createCall(const std::string& AName,
+    const std::vector<TId>& AParams) {
+
+    TEntry e;
+    e.type = TNode<T>::FUNC_NODE;
+    e.left = e.right = AParams[0];
+    e.cond = 0;
+    e.number = T(0);
+    e.name = AName;
+    e.params.assign(AParams.begin() + 1, AParams.end());
+
+    return share(e);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createTable(const std::string& AName, TId AParam,
+    unsigned AOrder) {
+
+    TEntry e;
+    e.type = TNode<T>::TABLE_NODE;
+    e.left = e.right = AParam;
+    e.cond = AOrder;
+    e.number = T(0);
+    e.name = AName;
+
+    return share(e);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createSeries(TNodeType AType, const std::string& AIndex,
+    TId ALower, TId AUpper, TId ABody) {
+
+    TEntry e;
+    e.type = AType;
+    e.left = ALower;
+    e.right = AUpper;
+    e.cond = ABody;
+    e.number = T(0);
+    e.name = AIndex;
+
+    return share(e);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createPlus(TId ALeft, TId ARight) {
+    if (entry(ALeft).type == TNode<T>::NUMBER_NODE && entry(ARight).type == TNode<T>::NUMBER_NODE)
+        return createNumber(entry(ALeft).number + entry(ARight).number);
+
+    // 0+a = a
+    if (isNumber(ALeft, T(0)))
+        return ARight;
+
+    // a+0 = a
+    if (isNumber(ARight, T(0)))
+        return ALeft;
+
+    return create(TNode<T>::PLUS_NODE, ALeft, ARight);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createNeg(TId ANode) {
+    if (entry(ANode).type == TNode<T>::NUMBER_NODE)
+        return createNumber(- entry(ANode).number);
+
+    // -(-a) = a
+    if (entry(ANode).type == TNode<T>::NEG_NODE)
+        return entry(ANode).left;
+
+    return createUnary(TNode<T>::NEG_NODE, ANode);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createMul(TId ALeft, TId ARight) {
+    if (entry(ALeft).type == TNode<T>::NUMBER_NODE && entry(ARight).type == TNode<T>::NUMBER_NODE)
+        return createNumber(entry(ALeft).number * entry(ARight).number);
+
+    // 0*a = a*0 = 0
+    if (isNumber(ALeft, T(0)) || isNumber(ARight, T(0)))
+        return createNumber(T(0));
+
+    // 1*a = a
+    if (isNumber(ALeft, T(1)))
+        return ARight;
+
+    // a*1 = a
+    if (isNumber(ARight, T(1)))
+        return ALeft;
+
+    return create(TNode<T>::MUL_NODE, ALeft, ARight);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createDiv(TId ALeft, TId ARight) {
+    // 0/a = 0
+    if (isNumber(ALeft, T(0)))
+        return createNumber(T(0));
+
+    // a/1 = a
+    if (isNumber(ARight, T(1)))
+        return ALeft;
+
+    return create(TNode<T>::DIV_NODE, ALeft, ARight);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::createPow(TId ALeft, TId ARight) {
+    // a^0 = 1
+    if (isNumber(ARight, T(0)))
+        return createNumber(T(1));
+
+    // a^1 = a
+    if (isNumber(ARight, T(1)))
+        return ALeft;
+
+    return create(TNode<T>::POW_NODE, ALeft, ARight);
+}
+
+template<class T>
+bool TExprDag<T>::isNumber(TId AId, const T& AValue) const {
+    return entry(AId).type == TNode<T>::NUMBER_NODE && entry(AId).number == AValue;
+}
+
+template<class T>
+const typename TExprDag<T>::TEntry& TExprDag<T>::entry(TId AId) const {
+    return FNodes[AId];
+}
+
+template<class T>
+void TExprDag<T>::visit(TNumberNode<T> *ANode) {
+    FResult = createNumber(ANode->number());
+}
+
+template<class T>
+void TExprDag<T>::visit(TSymbolNode<T> *ANode) {
+    const std::string symbol(ANode->symbol());
+
+    for (unsigned i = FBindings.size(); i-- > 0; )
+        if (FBindings[i].first == symbol) {
+            FResult = FBindings[i].second;
+            return;
+        }
+
+    FResult = createSymbol(TNode<T>::SYMBOL_NODE, symbol);
+}
+
+template<class T>
+void TExprDag<T>::visit(TParamNode<T> *ANode) {
+    FResult = create(TNode<T>::PARAM_NODE);
+}
+
+template<class T>
+void TExprDag<T>::visit(TPlusNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::PLUS_NODE, left, insert(ANode->right()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TNegNode<T> *ANode) {
+    FResult = createUnary(TNode<T>::NEG_NODE, insert(ANode->node()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TMulNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::MUL_NODE, left, insert(ANode->right()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TDivNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::DIV_NODE, left, insert(ANode->right()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TPowNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::POW_NODE, left, insert(ANode->right()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TSqrtNode<T> *ANode) {
+    FResult = createUnary(TNode<T>::SQRT_NODE, insert(ANode->node()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TSinNode<T> *ANode) {
+    FResult = createUnary(TNode<T>::SIN_NODE, insert(ANode->node()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TCosNode<T> *ANode) {
+    FResult = createUnary(TNode<T>::COS_NODE, insert(ANode->node()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TTanNode<T> *ANode) {
+    FResult = createUnary(TNode<T>::TAN_NODE, insert(ANode->node()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TLnNode<T> *ANode) {
+    FResult = createUnary(TNode<T>::LN_NODE, insert(ANode->node()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TFuncNode<T> *ANode) {
+    std::vector<TId> params;
+
+    for (unsigned i = 0; i < ANode->params(); ++i)
+        params.push_back(insert(ANode->param(i)));
+
+    FResult = createCall(ANode->name(), params);
+}
+
+template<class T>
+void TExprDag<T>::visit(TIfNode<T> *ANode) {
+    TId cond = insert(ANode->condition());
+    TId left = insert(ANode->trueExpr());
+    FResult = create(TNode<T>::IF_NODE, left, insert(ANode->falseExpr()), cond);
+}
+
+template<class T>
+void TExprDag<T>::visit(TTableNode<T> *ANode) {
+    FResult = createTable(ANode->name(), insert(ANode->node()), ANode->order());
+}
+
+template<class T>
+void TExprDag<T>::visit(TSumNode<T> *ANode) {
+    TId lower = insert(ANode->lower());
+    TId upper = insert(ANode->upper());
+    std::string index;
+    TId body = insertBody(ANode, index);
+
+    FResult = createSeries(TNode<T>::SUM_NODE, index, lower, upper, body);
+}
+
+template<class T>
+void TExprDag<T>::visit(TProdNode<T> *ANode) {
+    TId lower = insert(ANode->lower());
+    TId upper = insert(ANode->upper());
+    std::string index;
+    TId body = insertBody(ANode, index);
+
+    FResult = createSeries(TNode<T>::PROD_NODE, index, lower, upper, body);
+}
+
+template<class T>
+typename TExprDag<T>::TId TExprDag<T>::insertBody(TSeriesNode<T> *ANode, std::string& AIndex) {
+    // the let values are inlined, so the index must not capture their 
+    // symbols: let v = k in sum(k, 1, 2, v) sums up the outer k. The index 
+    // gets renamed then, to a name the body doesn't use.
+    AIndex = ANode->index();
+
+    for (bool captures = true; captures; ) {
+        captures = AIndex != ANode->index() && mentions(ANode->body(), AIndex);
+
+        for (unsigned i = 0; i < FBindings.size() && !captures; ++i)
+            captures = FBindings[i].first != ANode->index() && uses(FBindings[i].second, AIndex);
+
+        if (captures)
+            AIndex = ANode->index() + AIndex;
+    }
+
+    // the index hides a symbol of the same name bound outside
+    FBindings.push_back(std::make_pair(ANode->index(),
+        createSymbol(TNode<T>::SYMBOL_NODE, AIndex)));
+
+    TId result = insert(ANode->body());
+    FBindings.pop_back();
+
+    return result;
+}
+
+template<class T>
+bool TExprDag<T>::uses(TId AId, const std::string& ASymbol) const {
+    std::vector<bool> seen(FNodes.size(), false);
+    std::vector<TId> stack(1, AId);
+
+    while (!stack.empty()) {
+        TId id = stack.back();
+        stack.pop_back();
+
+        if (seen[id])
+            continue;
+
+        seen[id] = true;
+
+        const TEntry& e = entry(id);
+        switch (e.type) {
+            case TNode<T>::SYMBOL_NODE:
+                if (e.name == ASymbol)
+                    return true;
+                break;
+            case TNode<T>::NUMBER_NODE:
+            case TNode<T>::PARAM_NODE:
+                break;
+            case TNode<T>::FUNC_NODE:
+                stack.insert(stack.end(), e.params.begin(), e.params.end());
+                stack.push_back(e.left);
+                break;
+            case TNode<T>::IF_NODE:
+            case TNode<T>::SUM_NODE:
+            case TNode<T>::PROD_NODE:
+                stack.push_back(e.cond);
+                // fall through
+            default:
+                stack.push_back(e.left);
+                if (e.right != e.left)
+                    stack.push_back(e.right);
+        }
+    }
+    return false;
+}
+
+template<class T>
+void TExprDag<T>::visit(TLetNode<T> *ANode) {
+    // just the value's id gets bound, it's shared wherever the body uses it
+    TId value = insert(ANode->value());
+
+    FBindings.push_back(std::make_pair(ANode->name(), value));
+    FResult = insert(ANode->body());
+    FBindings.pop_back();
+}
+
+template<class T>
+void TExprDag<T>::visit(TEquNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::EQU_NODE, left, insert(ANode->right()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TUnEquNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::UNEQU_NODE, left, insert(ANode->right()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TGreaterNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::GREATER_NODE, left, insert(ANode->right()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TLessNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::LESS_NODE, left, insert(ANode->right()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TGreaterEquNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::GREATER_EQU_NODE, left, insert(ANode->right()));
+}
+
+template<class T>
+void TExprDag<T>::visit(TLessEquNode<T> *ANode) {
+    TId left = insert(ANode->left());
+    FResult = create(TNode<T>::LESS_EQU_NODE, left, insert(ANode->right()));
+}
+
+} // namespace math
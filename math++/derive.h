@@ -25,8 +25,14 @@
 
 #include <math++/visitor.h>
 
+#include <string>
+#include <vector>
+#include <memory>
+
 namespace math {
 
+template<class> class TSeriesNode;
+
 /**
   * \todo: complete implementation.
   */
@@ -39,11 +45,20 @@ public:
     static TNode<T> *derive(TNode<T> *AExpression);
 
 private:
+    /// a symbol bound by let with the symbol bound to its derivative ("" for sum indices)
+    typedef std::pair<std::string, std::string> TBinding;
+
     TNode<T> *FResult;
+    std::vector<TBinding> FBindings; // innermost last
 
 private:
     TDeriver();
 
+    /// derives a partial expression within the current bindings
+    TNode<T> *derivative(TNode<T> *AExpression);
+    /// derives the body of a sum or product, where its index is bound
+    TNode<T> *body(TSeriesNode<T> *ANode);
+
     virtual void visit(TNumberNode<T> *);
     virtual void visit(TSymbolNode<T> *);
     virtual void visit(TParamNode<T> *);
@@ -64,6 +79,10 @@ private:
 
     virtual void visit(TFuncNode<T> *);
     virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
 
     virtual void visit(TEquNode<T> *);
     virtual void visit(TUnEquNode<T> *);
@@ -35,6 +35,13 @@ template<class T>
 TDeriver<T>::TDeriver() : FResult(0) {
 }
 
+template<class T>
+TNode<T> *TDeriver<T>::derivative(TNode<T> *AExpression) {
+    AExpression->accept(*this);
+
+    return FResult;
+}
+
 template<class T>
 void TDeriver<T>::visit(TNumberNode<T> *ANode) {
     // [const]' = 0
@@ -44,7 +51,17 @@ void TDeriver<T>::visit(TNumberNode<T> *ANode) {
 
 template<class T>
 void TDeriver<T>::visit(TSymbolNode<T> *ANode) {
-    // [const]' = 0
+    // [v]' = dv, if v is bound by let, otherwise [const]' = 0
+    const std::string symbol(ANode->symbol());
+
+    for (unsigned i = FBindings.size(); i-- > 0; )
+        if (FBindings[i].first == symbol) {
+            if (!FBindings[i].second.empty()) {
+                FResult = new TSymbolNode<T>(FBindings[i].second);
+                return;
+            }
+            break;
+        }
 
     FResult = new TNumberNode<T>(T(0));
 }
@@ -62,8 +79,8 @@ void TDeriver<T>::visit(TPlusNode<T> *ANode) {
     // [f + g]' = f' + g'
 
     FResult = new TPlusNode<T>(
-        derive(ANode->left()),
-        derive(ANode->right())
+        derivative(ANode->left()),
+        derivative(ANode->right())
     );
 }
 
@@ -72,7 +89,7 @@ void TDeriver<T>::visit(TNegNode<T> *ANode) {
     // [-f]' = -(f')
 
     FResult = new TNegNode<T>(
-        derive(ANode->node())
+        derivative(ANode->node())
     );
 }
 
@@ -82,11 +99,11 @@ void TDeriver<T>::visit(TMulNode<T> *ANode) {
 
     FResult = new TPlusNode<T>(
         new TMulNode<T>(
-            derive(ANode->left()),
+            derivative(ANode->left()),
             ANode->right()->clone()
         ),
         new TMulNode<T>(
-            derive(ANode->right()),
+            derivative(ANode->right()),
             ANode->left()->clone()
         )
     );
@@ -99,12 +116,12 @@ void TDeriver<T>::visit(TDivNode<T> *ANode) {
     FResult = new TDivNode<T>(
         new TPlusNode<T>(
             new TMulNode<T>(
-                derive(ANode->left()),
+                derivative(ANode->left()),
                 ANode->right()->clone()
             ),
             new TNegNode<T>(
                 new TMulNode<T>(
-                    derive(ANode->right()),
+                    derivative(ANode->right()),
                     ANode->left()->clone()
                 )
             )
@@ -124,12 +141,12 @@ void TDeriver<T>::visit(TPowNode<T> *ANode) {
         ANode->clone(),
         new TPlusNode<T>(
             new TMulNode<T>(
-                derive(ANode->right()),
+                derivative(ANode->right()),
                 new TLnNode<T>(ANode->left()->clone())
             ),
             new TDivNode<T>(
                 new TMulNode<T>(
-                    derive(ANode->left()),
+                    derivative(ANode->left()),
                     ANode->right()->clone()
                 ),
                 ANode->left()->clone()
@@ -141,6 +158,14 @@ void TDeriver<T>::visit(TPowNode<T> *ANode) {
 template<class T>
 void TDeriver<T>::visit(TSqrtNode<T> *ANode) {
     // [sqrt(f)]' = sqrt'(f) * f'
+    //            = f' / (2 * sqrt(f))
+    FResult = new TDivNode<T>(
+        derivative(ANode->node()),
+        new TMulNode<T>(
+            new TNumberNode<T>(T(2)),
+            ANode->clone()
+        )
+    );
 }
 
 template<class T>
@@ -151,7 +176,7 @@ void TDeriver<T>::visit(TSinNode<T> *ANode) {
         new TCosNode<T>(
             ANode->node()->clone()
         ),
-        derive(ANode->node())
+        derivative(ANode->node())
     );
 }
 
@@ -163,7 +188,7 @@ void TDeriver<T>::visit(TCosNode<T> *ANode) {
             new TSinNode<T>(
                 ANode->node()->clone()
             ),
-            derive(ANode->node())
+            derivative(ANode->node())
         )
     );
 }
@@ -179,7 +204,7 @@ void TDeriver<T>::visit(TTanNode<T> *ANode) {
                 new TNumberNode<T>(T(2))
             )
         ),
-        derive(ANode->node())
+        derivative(ANode->node())
     );
 }
 
@@ -187,7 +212,7 @@ template<class T>
 void TDeriver<T>::visit(TLnNode<T> *ANode) {
     // [ln(f)]' = f' / f
     FResult = new TDivNode<T>(
-        derive(ANode->node()),
+        derivative(ANode->node()),
         ANode->node()->clone()
     );
 }
@@ -202,8 +227,85 @@ template<class T>
 void TDeriver<T>::visit(TIfNode<T> *ANode) {
     FResult = new TIfNode<T>(
         ANode->condition()->clone(),
-        derive(ANode->trueExpr()), 
-        derive(ANode->falseExpr())
+        derivative(ANode->trueExpr()), 
+        derivative(ANode->falseExpr())
+    );
+}
+
+template<class T>
+void TDeriver<T>::visit(TTableNode<T> *ANode) {
+    // [TABLE(t, f)]' = TABLE(t, f, 1) * f', piecewise as the interpolation
+    FResult = new TMulNode<T>(
+        new TTableNode<T>(ANode->name(), ANode->node()->clone(), ANode->order() + 1),
+        derivative(ANode->node())
+    );
+}
+
+template<class T>
+void TDeriver<T>::visit(TSumNode<T> *ANode) {
+    // [sum(k, a, b, f)]' = sum(k, a, b, f'), the number of terms is piecewise constant
+    FResult = new TSumNode<T>(
+        ANode->index(),
+        ANode->lower()->clone(),
+        ANode->upper()->clone(),
+        body(ANode)
+    );
+}
+
+template<class T>
+void TDeriver<T>::visit(TProdNode<T> *ANode) {
+    // [prod(k, a, b, f)]' = prod(k, a, b, f) * sum(k, a, b, f'/f), where no f = 0
+    FResult = new TMulNode<T>(
+        ANode->clone(),
+        new TSumNode<T>(
+            ANode->index(),
+            ANode->lower()->clone(),
+            ANode->upper()->clone(),
+            new TDivNode<T>(
+                body(ANode),
+                ANode->body()->clone()
+            )
+        )
+    );
+}
+
+template<class T>
+TNode<T> *TDeriver<T>::body(TSeriesNode<T> *ANode) {
+    // the index hides a symbol of the same name bound outside (it's a constant)
+    FBindings.push_back(TBinding(ANode->index(), std::string()));
+    TNode<T> *result = derivative(ANode->body());
+    FBindings.pop_back();
+
+    return result;
+}
+
+template<class T>
+void TDeriver<T>::visit(TLetNode<T> *ANode) {
+    // [let v = f in g]' = let dv = f' in let v = f in g', where [v]' = dv within g'.
+    // f' refers to the v outside, so it's bound before v gets rebound. dv
+    // must neither capture a symbol of f or g nor hide a name in scope.
+    std::string name("d" + ANode->name());
+
+    for (bool used = true; used; ) {
+        used = mentions(ANode->value(), name) || mentions(ANode->body(), name);
+
+        for (unsigned i = 0; i < FBindings.size() && !used; ++i)
+            used = FBindings[i].first == name || FBindings[i].second == name;
+
+        if (used)
+            name = "d" + name;
+    }
+
+    std::auto_ptr<TNode<T> > value(derivative(ANode->value()));
+
+    FBindings.push_back(TBinding(ANode->name(), name));
+    TNode<T> *inner = derivative(ANode->body());
+    FBindings.pop_back();
+
+    FResult = new TLetNode<T>(
+        name,
+        value.release(),
+        new TLetNode<T>(ANode->name(), ANode->value()->clone(), inner)
     );
 }
 
@@ -23,24 +23,93 @@
 #ifndef libmath_expander_h
 #define libmath_expander_h
 
-#include <math++/nodevisitor.h>
+#include <math++/visitor.h>
+#include <math++/nodes.h>
+
+#include <vector>
 
 namespace math {
 
 /**
   * This class impelents the expander extension. It intents to be the opposite
-  * of the simplify implementation.
-  * \todo: implementation.
+  * of the simplify implementation: products and integer powers of sums are
+  * multiplied out and like terms are collected, e.g. (x+1)^2 becomes x^2+2x+1.
+  *
+  * The expression is turned into a sparse polynomial first, whose variables
+  * are x, the symbols and any other subexpression (sin(x), f(x), IF, ...,
+  * each with its argument expanded). All arithmetic is done on that
+  * polynomial, and only the result is turned back into a tree.
+  * Division by anything but a monomial is kept as negative power.
   */
 template<class T>
-class TExpander : public TNodeVisitor<T> {
+class TExpander : protected TNodeVisitor<T> {
 public:
     /**
       * expands given expression (AExpression).
       */
-    static TNode<T> *expand(TNode<T> *AExpression);
+    static TNode<T> *expand(const TNode<T> *AExpression);
 
 private:
+    /**
+      * TPolynomial is a sum of terms, each a coefficient times a monomial.
+      * A monomial is a vector of width exponents, one per variable, all
+      * stored in one array. The terms are sorted by monomial, descending, 
+      * and no coefficient is zero.
+      */
+    struct TPolynomial {
+        unsigned width;
+        std::vector<int> exponents;
+        std::vector<T> coefficients;
+
+        TPolynomial() : width(0) {}
+
+        unsigned size() const { return coefficients.size(); }
+        const int *monomial(unsigned i) const { return width ? &exponents[i * width] : 0; }
+        void swap(TPolynomial& APolynomial);
+    };
+
+    /// TOrder sorts term indices of a polynomial by their monomials, descending
+    struct TOrder {
+        const TPolynomial *polynomial;
+
+        bool operator()(unsigned a, unsigned b) const;
+    };
+
+    std::vector<TNode<T> *> FVariables;
+    TPolynomial FResult;
+
+    TExpander();
+    ~TExpander();
+
+    /// expands AExpression into AResult
+    void expand(const TNode<T> *AExpression, TPolynomial& AResult);
+    /// returns the expanded tree of AExpression
+    TNode<T> *argument(const TNode<T> *AExpression);
+    /// makes the result the variable ANode (which gets owned) raised to AExponent
+    void atom(TNode<T> *ANode, int AExponent = 1);
+
+    /// creates the tree of given polynomial
+    TNode<T> *tree(const TPolynomial& APolynomial) const;
+
+    /// returns -1, 0 or 1 if the monomial a is less, equal or greater than b
+    static int compare(const int *a, const int *b, unsigned AWidth);
+    /// adds zero exponents to each monomial up to AWidth
+    static void widen(TPolynomial& APolynomial, unsigned AWidth);
+    /// sorts the terms and drops the zero ones
+    static void normalize(TPolynomial& APolynomial);
+
+    static void constant(const T& AValue, TPolynomial& AResult);
+    /// returns true, if APolynomial is a constant (stored into AValue)
+    static bool isConstant(const TPolynomial& APolynomial, T& AValue);
+    /// returns true, if AValue is a (not too large) integer (stored into AResult)
+    static bool isInteger(const T& AValue, int& AResult);
+
+    static void add(TPolynomial& a, TPolynomial& b, TPolynomial& AResult);
+    static void multiply(TPolynomial& a, TPolynomial& b, TPolynomial& AResult);
+    static void power(TPolynomial& ABase, unsigned AExponent, TPolynomial& AResult);
+    /// inverts the single term polynomial APolynomial
+    static void invert(TPolynomial& APolynomial);
+
     virtual void visit(TNumberNode<T> *);
     virtual void visit(TSymbolNode<T> *);
     virtual void visit(TParamNode<T> *);
@@ -56,6 +125,10 @@ private:
 
     virtual void visit(TFuncNode<T> *);
     virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
 
     virtual void visit(TSinNode<T> *);
     virtual void visit(TCosNode<T> *);
@@ -20,8 +20,565 @@
 //  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
 //  Boston, MA 02111-1307, USA.
 ///////////////////////////////////////////////////////////////////////
+#ifndef libmath_expander_h
+#error You may not include math++/expander.tcc directly; include math++/expander.h instead.
+#endif
+
+#include <algorithm>
+
 namespace math {
 
-// ...
+template<class T>
+void TExpander<T>::TPolynomial::swap(TPolynomial& APolynomial) {
+    std::swap(width, APolynomial.width);
+    exponents.swap(APolynomial.exponents);
+    coefficients.swap(APolynomial.coefficients);
+}
+
+template<class T>
+bool TExpander<T>::TOrder::operator()(unsigned a, unsigned b) const {
+    return compare(polynomial->monomial(a), polynomial->monomial(b), polynomial->width) > 0;
+}
+
+template<class T>
+TNode<T> *TExpander<T>::expand(const TNode<T> *AExpression) {
+    TExpander<T> expander;
+    TPolynomial result;
+
+    expander.expand(AExpression, result);
+
+    return expander.tree(result);
+}
+
+template<class T>
+TExpander<T>::TExpander() {
+}
+
+template<class T>
+TExpander<T>::~TExpander() {
+    for (unsigned i = 0; i < FVariables.size(); ++i)
+        delete FVariables[i];
+}
+
+template<class T>
+void TExpander<T>::expand(const TNode<T> *AExpression, TPolynomial& AResult) {
+    const_cast<TNode<T> *>(AExpression)->accept(*this);
+
+    AResult.swap(FResult);
+}
+
+template<class T>
+TNode<T> *TExpander<T>::argument(const TNode<T> *AExpression) {
+    TPolynomial p;
+    expand(AExpression, p);
+
+    return tree(p);
+}
+
+template<class T>
+void TExpander<T>::atom(TNode<T> *ANode, int AExponent) {
+    unsigned index = 0;
+
+    while (index < FVariables.size() && !FVariables[index]->equals(ANode))
+        ++index;
+
+    if (index < FVariables.size())
+        delete ANode;
+    else
+        FVariables.push_back(ANode);
+
+    TPolynomial result;
+    result.width = FVariables.size();
+    result.exponents.resize(result.width);
+    result.exponents[index] = AExponent;
+    result.coefficients.push_back(T(1));
+
+    FResult.swap(result);
+}
+
+template<class T>
+TNode<T> *TExpander<T>::tree(const TPolynomial& APolynomial) const {
+    if (!APolynomial.size())
+        return new TNumberNode<T>(T(0));
+
+    TNode<T> *result = 0;
+
+    for (unsigned i = 0; i < APolynomial.size(); ++i) {
+        const int *monomial = APolynomial.monomial(i);
+        TNode<T> *numerator = 0, *denominator = 0;
+
+        for (unsigned k = 0; k < APolynomial.width; ++k) {
+            const int e = monomial[k];
+
+            if (!e)
+                continue;
+
+            TNode<T> *factor = FVariables[k]->clone();
+
+            if (e != 1 && e != -1)
+                factor = new TPowNode<T>(factor, new TNumberNode<T>(T(e < 0 ? -e : e)));
+
+            TNode<T> *&product = e > 0 ? numerator : denominator;
+            product = product ? new TMulNode<T>(product, factor) : factor;
+        }
+
+        const T& c = APolynomial.coefficients[i];
+        const bool negative = c < T(0);
+        const T magnitude = negative ? -c : c;
+
+        if (!numerator)
+            numerator = new TNumberNode<T>(magnitude);
+        else if (magnitude != T(1))
+            numerator = new TMulNode<T>(new TNumberNode<T>(magnitude), numerator);
+
+        if (denominator)
+            numerator = new TDivNode<T>(numerator, denominator);
+
+        if (negative)
+            numerator = new TNegNode<T>(numerator);
+
+        result = result ? new TPlusNode<T>(result, numerator) : numerator;
+    }
+
+    return result;
+}
+
+template<class T>
+int TExpander<T>::compare(const int *a, const int *b, unsigned AWidth) {
+    for (unsigned k = 0; k < AWidth; ++k)
+        if (a[k] != b[k])
+            return a[k] < b[k] ? -1 : 1;
+
+    return 0;
+}
+
+template<class T>
+void TExpander<T>::widen(TPolynomial& APolynomial, unsigned AWidth) {
+    if (APolynomial.width >= AWidth)
+        return;
+
+    // new variables come last, so the order of the terms doesn't change
+    std::vector<int> exponents(APolynomial.size() * AWidth);
+
+    for (unsigned i = 0; i < APolynomial.size(); ++i)
+        std::copy(APolynomial.monomial(i), APolynomial.monomial(i) + APolynomial.width,
+            exponents.begin() + i * AWidth);
+
+    APolynomial.exponents.swap(exponents);
+    APolynomial.width = AWidth;
+}
+
+template<class T>
+void TExpander<T>::normalize(TPolynomial& APolynomial) {
+    std::vector<unsigned> order;
+    order.reserve(APolynomial.size());
+
+    for (unsigned i = 0; i < APolynomial.size(); ++i)
+        if (APolynomial.coefficients[i] != T(0))
+            order.push_back(i);
+
+    TOrder before;
+    before.polynomial = &APolynomial;
+    std::sort(order.begin(), order.end(), before);
+
+    TPolynomial result;
+    result.width = APolynomial.width;
+    result.exponents.reserve(order.size() * result.width);
+    result.coefficients.reserve(order.size());
+
+    for (unsigned i = 0; i < order.size(); ++i) {
+        const int *m = APolynomial.monomial(order[i]);
+
+        result.exponents.insert(result.exponents.end(), m, m + result.width);
+        result.coefficients.push_back(APolynomial.coefficients[order[i]]);
+    }
+
+    APolynomial.swap(result);
+}
+
+template<class T>
+void TExpander<T>::constant(const T& AValue, TPolynomial& AResult) {
+    TPolynomial result;
+
+    if (AValue != T(0))
+        result.coefficients.push_back(AValue);
+
+    AResult.swap(result);
+}
+
+template<class T>
+bool TExpander<T>::isConstant(const TPolynomial& APolynomial, T& AValue) {
+    if (!APolynomial.size()) {
+        AValue = T(0);
+        return true;
+    }
+
+    if (APolynomial.size() > 1)
+        return false;
+
+    const int *m = APolynomial.monomial(0);
+    if (std::count(m, m + APolynomial.width, 0) != int(APolynomial.width))
+        return false;
+
+    AValue = APolynomial.coefficients[0];
+    return true;
+}
+
+template<class T>
+bool TExpander<T>::isInteger(const T& AValue, int& AResult) {
+    // T needs no conversion into int this way
+    const int limit = 1 << 20;
+
+    if (!(T(-limit) <= AValue && AValue <= T(limit)))
+        return false;
+
+    int lower = -limit, upper = limit;
+
+    while (lower < upper) {
+        const int middle = lower + (upper - lower) / 2;
+
+        if (T(middle) < AValue)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+
+    AResult = lower;
+    return T(lower) == AValue;
+}
+
+template<class T>
+void TExpander<T>::add(TPolynomial& a, TPolynomial& b, TPolynomial& AResult) {
+    const unsigned width = std::max(a.width, b.width);
+    widen(a, width);
+    widen(b, width);
+
+    TPolynomial result;
+    result.width = width;
+    result.exponents.reserve((a.size() + b.size()) * width);
+    result.coefficients.reserve(a.size() + b.size());
+
+    unsigned i = 0, j = 0;
+
+    while (i < a.size() || j < b.size()) {
+        const int c = i == a.size() ? -1 : j == b.size() ? 1
+                    : compare(a.monomial(i), b.monomial(j), width);
+
+        const int *m = c < 0 ? b.monomial(j) : a.monomial(i);
+        T coefficient = c < 0 ? b.coefficients[j++] : a.coefficients[i++];
+
+        if (!c)
+            coefficient += b.coefficients[j++];
+
+        if (coefficient != T(0)) {
+            result.exponents.insert(result.exponents.end(), m, m + width);
+            result.coefficients.push_back(coefficient);
+        }
+    }
+
+    AResult.swap(result);
+}
+
+template<class T>
+void TExpander<T>::multiply(TPolynomial& a, TPolynomial& b, TPolynomial& AResult) {
+    const unsigned width = std::max(a.width, b.width);
+    widen(a, width);
+    widen(b, width);
+
+    TPolynomial result;
+    result.width = width;
+
+    // like terms are collected in a hash table (open addressing) of term indices
+    const unsigned empty = ~0u;
+    unsigned capacity = 16;
+
+    while (capacity < 2 * (a.size() + b.size()))
+        capacity *= 2;
+
+    std::vector<unsigned> table(capacity, empty);
+    std::vector<unsigned> hashes;
+    std::vector<int> m(width + 1);
+
+    for (unsigned i = 0; i < a.size(); ++i) {
+        const int *x = a.monomial(i);
+
+        for (unsigned j = 0; j < b.size(); ++j) {
+            const int *y = b.monomial(j);
+            unsigned hash = 2166136261u;
+
+            for (unsigned k = 0; k < width; ++k) {
+                m[k] = x[k] + y[k];
+                hash = (hash ^ unsigned(m[k])) * 16777619u;
+            }
+
+            const T coefficient = a.coefficients[i] * b.coefficients[j];
+            unsigned slot = hash & (capacity - 1);
+
+            for (;;) {
+                const unsigned index = table[slot];
+
+                if (index == empty) {
+                    table[slot] = result.size();
+                    hashes.push_back(hash);
+                    result.exponents.insert(result.exponents.end(), m.begin(), m.begin() + width);
+                    result.coefficients.push_back(coefficient);
+                    break;
+                }
+
+                if (hashes[index] == hash && std::equal(m.begin(), m.begin() + width, result.monomial(index))) {
+                    result.coefficients[index] += coefficient;
+                    break;
+                }
+
+                slot = (slot + 1) & (capacity - 1);
+            }
+
+            // keep the table at most half full
+            if (2 * result.size() > capacity) {
+                capacity *= 2;
+                table.assign(capacity, empty);
+
+                for (unsigned k = 0; k < result.size(); ++k) {
+                    slot = hashes[k] & (capacity - 1);
+
+                    while (table[slot] != empty)
+                        slot = (slot + 1) & (capacity - 1);
+
+                    table[slot] = k;
+                }
+            }
+        }
+    }
+
+    normalize(result);
+    AResult.swap(result);
+}
+
+template<class T>
+void TExpander<T>::power(TPolynomial& ABase, unsigned AExponent, TPolynomial& AResult) {
+    TPolynomial result;
+    constant(T(1), result);
+
+    // square and multiply
+    for (;;) {
+        if (AExponent & 1)
+            multiply(result, ABase, result);
+
+        AExponent >>= 1;
+        if (!AExponent)
+            break;
+
+        TPolynomial square;
+        multiply(ABase, ABase, square);
+        ABase.swap(square);
+    }
+
+    AResult.swap(result);
+}
+
+template<class T>
+void TExpander<T>::invert(TPolynomial& APolynomial) {
+    for (unsigned k = 0; k < APolynomial.width; ++k)
+        APolynomial.exponents[k] = -APolynomial.exponents[k];
+
+    APolynomial.coefficients[0] = T(1) / APolynomial.coefficients[0];
+}
+
+template<class T>
+void TExpander<T>::visit(TNumberNode<T> *ANode) {
+    constant(ANode->number(), FResult);
+}
+
+template<class T>
+void TExpander<T>::visit(TSymbolNode<T> *ANode) {
+    atom(ANode->clone());
+}
+
+template<class T>
+void TExpander<T>::visit(TParamNode<T> *ANode) {
+    atom(ANode->clone());
+}
+
+template<class T>
+void TExpander<T>::visit(TPlusNode<T> *ANode) {
+    TPolynomial left, right;
+
+    expand(ANode->left(), left);
+    expand(ANode->right(), right);
+
+    add(left, right, FResult);
+}
+
+template<class T>
+void TExpander<T>::visit(TNegNode<T> *ANode) {
+    expand(ANode->node(), FResult);
+
+    for (unsigned i = 0; i < FResult.size(); ++i)
+        FResult.coefficients[i] = -FResult.coefficients[i];
+}
+
+template<class T>
+void TExpander<T>::visit(TMulNode<T> *ANode) {
+    TPolynomial left, right;
+
+    expand(ANode->left(), left);
+    expand(ANode->right(), right);
+
+    multiply(left, right, FResult);
+}
+
+template<class T>
+void TExpander<T>::visit(TDivNode<T> *ANode) {
+    TPolynomial left, right;
+
+    expand(ANode->left(), left);
+    expand(ANode->right(), right);
+
+    if (right.size() == 1)
+        invert(right);
+    else {
+        // the divisor stays as it is, powered by -1
+        atom(tree(right), -1);
+        right.swap(FResult);
+    }
+
+    multiply(left, right, FResult);
+}
+
+template<class T>
+void TExpander<T>::visit(TPowNode<T> *ANode) {
+    TPolynomial base, exponent;
+
+    expand(ANode->left(), base);
+    expand(ANode->right(), exponent);
+
+    T value;
+    int n;
+
+    if (isConstant(exponent, value) && isInteger(value, n)) {
+        if (n >= 0)
+            power(base, n, FResult);
+        else if (base.size() == 1) {
+            invert(base);
+            power(base, -n, FResult);
+        } else
+            atom(tree(base), n);
+    } else
+        atom(new TPowNode<T>(tree(base), tree(exponent)));
+}
+
+template<class T>
+void TExpander<T>::visit(TSqrtNode<T> *ANode) {
+    atom(new TSqrtNode<T>(argument(ANode->node())));
+}
+
+template<class T>
+void TExpander<T>::visit(TFuncNode<T> *ANode) {
+    std::auto_ptr<TFuncNode<T> > call(new TFuncNode<T>(ANode->name(), argument(ANode->node())));
+
+    for (unsigned i = 1; i < ANode->params(); ++i)
+        call->addParam(argument(ANode->param(i)));
+
+    atom(call.release());
+}
+
+template<class T>
+void TExpander<T>::visit(TIfNode<T> *ANode) {
+    TNode<T> *condition = argument(ANode->condition());
+    TNode<T> *trueExpr = argument(ANode->trueExpr());
+
+    atom(new TIfNode<T>(condition, trueExpr, argument(ANode->falseExpr())));
+}
+
+template<class T>
+void TExpander<T>::visit(TTableNode<T> *ANode) {
+    atom(new TTableNode<T>(ANode->name(), argument(ANode->node()), ANode->order()));
+}
+
+template<class T>
+void TExpander<T>::visit(TSumNode<T> *ANode) {
+    TNode<T> *lower = argument(ANode->lower());
+    TNode<T> *upper = argument(ANode->upper());
+
+    atom(new TSumNode<T>(ANode->index(), lower, upper, argument(ANode->body())));
+}
+
+template<class T>
+void TExpander<T>::visit(TProdNode<T> *ANode) {
+    TNode<T> *lower = argument(ANode->lower());
+    TNode<T> *upper = argument(ANode->upper());
+
+    atom(new TProdNode<T>(ANode->index(), lower, upper, argument(ANode->body())));
+}
+
+template<class T>
+void TExpander<T>::visit(TLetNode<T> *ANode) {
+    // the body depends on the bound symbol, so the binding stays as it is
+    TNode<T> *value = argument(ANode->value());
+
+    atom(new TLetNode<T>(ANode->name(), value, argument(ANode->body())));
+}
+
+template<class T>
+void TExpander<T>::visit(TSinNode<T> *ANode) {
+    atom(new TSinNode<T>(argument(ANode->node())));
+}
+
+template<class T>
+void TExpander<T>::visit(TCosNode<T> *ANode) {
+    atom(new TCosNode<T>(argument(ANode->node())));
+}
+
+template<class T>
+void TExpander<T>::visit(TTanNode<T> *ANode) {
+    atom(new TTanNode<T>(argument(ANode->node())));
+}
+
+template<class T>
+void TExpander<T>::visit(TLnNode<T> *ANode) {
+    atom(new TLnNode<T>(argument(ANode->node())));
+}
+
+template<class T>
+void TExpander<T>::visit(TEquNode<T> *ANode) {
+    TNode<T> *left = argument(ANode->left());
+
+    atom(new TEquNode<T>(left, argument(ANode->right())));
+}
+
+template<class T>
+void TExpander<T>::visit(TUnEquNode<T> *ANode) {
+    TNode<T> *left = argument(ANode->left());
+
+    atom(new TUnEquNode<T>(left, argument(ANode->right())));
+}
+
+template<class T>
+void TExpander<T>::visit(TGreaterNode<T> *ANode) {
+    TNode<T> *left = argument(ANode->left());
+
+    atom(new TGreaterNode<T>(left, argument(ANode->right())));
+}
+
+template<class T>
+void TExpander<T>::visit(TLessNode<T> *ANode) {
+    TNode<T> *left = argument(ANode->left());
+
+    atom(new TLessNode<T>(left, argument(ANode->right())));
+}
+
+template<class T>
+void TExpander<T>::visit(TGreaterEquNode<T> *ANode) {
+    TNode<T> *left = argument(ANode->left());
+
+    atom(new TGreaterEquNode<T>(left, argument(ANode->right())));
+}
+
+template<class T>
+void TExpander<T>::visit(TLessEquNode<T> *ANode) {
+    TNode<T> *left = argument(ANode->left());
+
+    atom(new TLessEquNode<T>(left, argument(ANode->right())));
+}
 
 } // namespace math
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the parse result cache interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_exprcache_h
+#define libmath_exprcache_h
+
+#include <math++/thread.h>
+
+#include <string>
+#include <list>
+#include <vector>
+
+namespace math {
+
+template<class> class TNode;
+template<class> class TLibrary;
+
+/**
+  * TExprCache<> remembers the parsed trees of the most recently calculated 
+  * expression strings, so repeated requests don't need to parse them again.
+  * It holds at most capacity() trees and drops the least recently used 
+  * one when it's full.
+  *
+  * A cache may be shared by multiple threads. Only the lookup happens 
+  * under its lock, parsing and calculation don't.
+  */
+template<class T>
+class TExprCache {
+public:
+    /// creates a cache holding up to ACapacity parsed expressions
+    explicit TExprCache(unsigned ACapacity = 1024);
+    ~TExprCache();
+
+    /// calculates AExprStr for the given parameter, parsing it on a miss only
+    T calculate(const std::string& AExprStr, const TLibrary<T>& ALibrary, 
+        const T& AParam = T());
+
+    /// drops all cached expressions (the ones in use are kept until done)
+    void clear();
+
+    /// returns the number of cached expressions
+    unsigned size() const;
+    /// returns the maximum number of cached expressions
+    unsigned capacity() const { return FCapacity; }
+
+    /// returns the number of requests served without parsing
+    unsigned long hits() const;
+    /// returns the number of requests that needed to parse
+    unsigned long misses() const;
+
+private:
+    /// TEntry is a single cached expression
+    struct TEntry {
+        std::string source;
+        unsigned long hash;     // hash value of source
+        TNode<T> *expression;
+        unsigned users;         // number of calculations currently using it
+
+        TEntry(const std::string& ASource, unsigned long AHash, TNode<T> *AExpression) :
+            source(ASource), hash(AHash), expression(AExpression), users(0) {}
+    };
+
+    typedef std::list<TEntry> TEntryList;   // most recently used first
+    typedef std::vector<typename TEntryList::iterator> TBucket;
+
+    TEntryList FEntries;
+    std::vector<TBucket> FBuckets;          // the entries by hash value
+    unsigned FSize;
+    unsigned FCapacity;
+    unsigned long FHits;
+    unsigned long FMisses;
+    mutable TMutex FMutex;
+
+    /// returns the entry for AExprStr (in use), parsing it if not cached yet
+    TEntry *acquire(const std::string& AExprStr);
+    /// returns the bucket for the hash value AHash
+    TBucket& bucket(unsigned long AHash) { return FBuckets[AHash & (FBuckets.size() - 1)]; }
+    /// looks up the cached entry for AExprStr, returns false if there's none
+    bool find(const std::string& AExprStr, unsigned long AHash, typename TEntryList::iterator& AResult);
+    /// removes the unused entry AEntry, returns the entry following it
+    typename TEntryList::iterator erase(typename TEntryList::iterator AEntry);
+    /// returns the hash value of AExprStr
+    static unsigned long hash(const std::string& AExprStr);
+    /// marks AEntry not to be in use by the caller anymore
+    void release(TEntry *AEntry);
+    /// drops unused entries from the tail until the capacity is met
+    void shrink();
+
+    TExprCache(const TExprCache<T>&);
+    TExprCache<T>& operator=(const TExprCache<T>&);
+};
+
+} // namespace math
+
+#include <math++/exprcache.tcc>
+
+#endif
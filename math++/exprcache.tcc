@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the parse result cache template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_exprcache_h
+#error You may not include math++/exprcache.tcc directly; include math++/exprcache.h instead.
+#endif
+
+#include <math++/nodes.h>
+#include <math++/reader.h>
+#include <math++/calculator.h>
+
+#include <memory>
+
+namespace math {
+
+template<class T>
+TExprCache<T>::TExprCache(unsigned ACapacity) :
+    FSize(0), FCapacity(ACapacity), FHits(0), FMisses(0) {
+
+    // about two buckets per entry, but a power of two
+    unsigned buckets = 16;
+    while (buckets < 2 * ACapacity && buckets < (1U << 24))
+        buckets *= 2;
+
+    FBuckets.resize(buckets);
+}
+
+template<class T>
+TExprCache<T>::~TExprCache() {
+    for (typename TEntryList::iterator i = FEntries.begin(); i != FEntries.end(); ++i)
+        delete i->expression;
+}
+
+template<class T>
+T TExprCache<T>::calculate(const std::string& AExprStr, const TLibrary<T>& ALibrary,
+    const T& AParam) {
+
+    TEntry *entry = acquire(AExprStr);
+
+    try {
+        T result = TCalculator<T>::calculate(entry->expression, AParam, ALibrary);
+
+        release(entry);
+        return result;
+    } catch (...) {
+        release(entry);
+        throw;
+    }
+}
+
+template<class T>
+void TExprCache<T>::clear() {
+    TMutexLocker lock(FMutex);
+
+    typename TEntryList::iterator i = FEntries.begin();
+    while (i != FEntries.end())
+        if (i->users)
+            ++i;
+        else
+            i = erase(i);
+}
+
+template<class T>
+unsigned TExprCache<T>::size() const {
+    TMutexLocker lock(FMutex);
+    return FSize;
+}
+
+template<class T>
+unsigned long TExprCache<T>::hits() const {
+    TMutexLocker lock(FMutex);
+    return FHits;
+}
+
+template<class T>
+unsigned long TExprCache<T>::misses() const {
+    TMutexLocker lock(FMutex);
+    return FMisses;
+}
+
+template<class T>
+typename TExprCache<T>::TEntry *TExprCache<T>::acquire(const std::string& AExprStr) {
+    unsigned long h = hash(AExprStr);
+    typename TEntryList::iterator i;
+
+    {
+        TMutexLocker lock(FMutex);
+
+        if (find(AExprStr, h, i)) {
+            ++FHits;
+            FEntries.splice(FEntries.begin(), FEntries, i);
+            ++i->users;
+            return &*i;
+        }
+        ++FMisses;
+    }
+
+    // parse without holding the lock, others may go on meanwhile
+    std::auto_ptr<TNode<T> > expression(TReader<T>::parse(AExprStr));
+
+    TMutexLocker lock(FMutex);
+
+    if (find(AExprStr, h, i)) {
+        // another thread was faster, so take that one
+        FEntries.splice(FEntries.begin(), FEntries, i);
+    } else {
+        FEntries.push_front(TEntry(AExprStr, h, expression.release()));
+        i = FEntries.begin();
+        bucket(h).push_back(i);
+        ++FSize;
+    }
+    ++i->users;
+    shrink();
+
+    return &*i;
+}
+
+template<class T>
+void TExprCache<T>::release(TEntry *AEntry) {
+    TMutexLocker lock(FMutex);
+
+    --AEntry->users;
+    shrink();
+}
+
+template<class T>
+void TExprCache<T>::shrink() {
+    typename TEntryList::iterator i = FEntries.end();
+
+    while (FSize > FCapacity && i != FEntries.begin())
+        if ((--i)->users == 0)
+            i = erase(i);
+}
+
+template<class T>
+bool TExprCache<T>::find(const std::string& AExprStr, unsigned long AHash,
+    typename TEntryList::iterator& AResult) {
+
+    const TBucket& b = bucket(AHash);
+
+    for (typename TBucket::const_iterator i = b.begin(); i != b.end(); ++i) {
+        if ((*i)->hash == AHash && (*i)->source == AExprStr) {
+            AResult = *i;
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class T>
+typename TExprCache<T>::TEntryList::iterator TExprCache<T>::erase(
+    typename TEntryList::iterator AEntry) {
+
+    TBucket& b = bucket(AEntry->hash);
+    for (typename TBucket::iterator i = b.begin(); i != b.end(); ++i) {
+        if (*i == AEntry) {
+            *i = b.back();
+            b.pop_back();
+            break;
+        }
+    }
+
+    --FSize;
+    delete AEntry->expression;
+    return FEntries.erase(AEntry);
+}
+
+template<class T>
+unsigned long TExprCache<T>::hash(const std::string& AExprStr) {
+    // FNV-1a
+    unsigned long result = 2166136261UL;
+
+    for (std::string::size_type i = 0; i < AExprStr.size(); ++i)
+        result = (result ^ static_cast<unsigned char>(AExprStr[i])) * 16777619UL;
+
+    return result;
+}
+
+} // namespace math
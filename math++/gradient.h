@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the reverse mode differentiation interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_gradient_h
+#define libmath_gradient_h
+
+#include <math++/visitor.h>
+#include <math++/nodes.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace math {
+
+template<class> class TFunction;
+template<class> class TLibrary;
+
+/**
+  * TGradient<> computes the gradient of a function with respect to every
+  * library constant (TConstant<>) it refers to, using reverse mode
+  * differentiation.
+  *
+  * The expression is evaluated once while each operation is recorded onto
+  * a tape. The tape is then swept backwards once to accumulate the partial
+  * derivatives of all constants at the same time. So the costs are a small
+  * constant factor of one calculation, no matter how many constants are used.
+  */
+template<class T>
+class TGradient : protected TNodeVisitor<T> {
+public:
+    /// maps each referenced constant name to its partial derivative d f / d c
+    typedef std::map<std::string, T> TResult;
+
+    /**
+      * calculates the function result at AParam, stores the partial derivatives
+      * of all referenced constants into AResult and returns the function result.
+      */
+    static T gradient(const TFunction<T>& AFunction, const T& AParam,
+        const TLibrary<T>& ALibrary, TResult& AResult, unsigned ARecursionLimit = 64);
+
+private:
+    /// TEntry represents a single recorded operation on the tape
+    struct TEntry {
+        typename TNode<T>::TNodeType type;
+        unsigned left;  // tape index of the first operand (if any)
+        unsigned right; // tape index of the second operand (if any)
+        T value;        // the operation's result
+    };
+
+    typedef std::vector<TEntry> TTape;
+    typedef std::map<std::string, unsigned> TSymbolMap;
+    typedef std::pair<std::string, unsigned> TBinding;
+
+    TTape FTape;
+    TSymbolMap FSymbols;    // tape index of each referenced constant
+    std::vector<TBinding> FBindings; // tape index of each bound symbol (innermost last)
+    unsigned FParam;        // tape index of the current parameter value
+    const TLibrary<T>& FLibrary;
+    std::map<std::string, unsigned> FRecursions;
+    unsigned FLimit;
+    unsigned FResult;       // tape index of the last recorded result
+
+private:
+    TGradient(const TLibrary<T>& ALibrary, unsigned ALimit);
+
+    /// records given operation onto the tape and returns its tape index
+    unsigned record(typename TNode<T>::TNodeType AType, unsigned ALeft,
+        unsigned ARight, const T& AValue);
+
+    /// records partial expression and returns the tape index of its result
+    unsigned record(const TNode<T> *AExpression);
+
+    /// returns the recorded value at given tape index
+    const T& value(unsigned AIndex) const;
+
+    /// sweeps the tape backwards and stores the constant's adjoints into AResult
+    void sweep(TResult& AResult) const;
+
+    /// records each term of the sum or product ANode and their accumulation
+    void series(TSeriesNode<T> *ANode);
+
+    virtual void visit(TNumberNode<T> *);
+    virtual void visit(TSymbolNode<T> *);
+    virtual void visit(TParamNode<T> *);
+
+    virtual void visit(TPlusNode<T> *);
+    virtual void visit(TNegNode<T> *);
+
+    virtual void visit(TMulNode<T> *);
+    virtual void visit(TDivNode<T> *);
+
+    virtual void visit(TPowNode<T> *);
+    virtual void visit(TSqrtNode<T> *);
+
+    virtual void visit(TSinNode<T> *);
+    virtual void visit(TCosNode<T> *);
+    virtual void visit(TTanNode<T> *);
+    virtual void visit(TLnNode<T> *);
+
+    virtual void visit(TFuncNode<T> *);
+    virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
+
+    virtual void visit(TEquNode<T> *);
+    virtual void visit(TUnEquNode<T> *);
+    virtual void visit(TGreaterNode<T> *);
+    virtual void visit(TLessNode<T> *);
+    virtual void visit(TGreaterEquNode<T> *);
+    virtual void visit(TLessEquNode<T> *);
+};
+
+} // namespace math
+
+#include <math++/gradient.tcc>
+
+#endif
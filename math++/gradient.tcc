@@ -0,0 +1,428 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the reverse mode differentiation template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_gradient_h
+#error You may not include math++/gradient.tcc directly; include math++/gradient.h instead.
+#endif
+
+#include <math++/library.h>
+#include <math++/calculator.h>
+
+#include <cmath>
+
+namespace math {
+
+template<class T>
+T TGradient<T>::gradient(const TFunction<T>& AFunction, const T& AParam,
+    const TLibrary<T>& ALibrary, TResult& AResult, unsigned ALimit) {
+
+    TGradient<T> g(ALibrary, ALimit);
+
+    // the parameter is just an input slot on the tape
+    g.FParam = g.record(TNode<T>::PARAM_NODE, 0, 0, AParam);
+
+    unsigned result = g.record(AFunction.expression());
+    g.sweep(AResult);
+
+    return g.value(result);
+}
+
+template<class T>
+TGradient<T>::TGradient(const TLibrary<T>& ALibrary, unsigned ALimit) :
+    FParam(0), FLibrary(ALibrary), FLimit(ALimit), FResult(0) {
+
+    FTape.reserve(64);
+}
+
+template<class T>
+unsigned TGradient<T>::record(typename TNode<T>::TNodeType AType,
+    unsigned ALeft, unsigned ARight, const T& AValue) {
+
+    TEntry e;
+    e.type = AType;
+    e.left = ALeft;
+    e.right = ARight;
+    e.value = AValue;
+
+    FTape.push_back(e);
+
+    return FResult = FTape.size() - 1;
+}
+
+template<class T>
+unsigned TGradient<T>::record(const TNode<T> *AExpression) {
+    const_cast<TNode<T> *>(AExpression)->accept(*this);
+
+    return FResult;
+}
+
+template<class T>
+const T& TGradient<T>::value(unsigned AIndex) const {
+    return FTape[AIndex].value;
+}
+
+template<class T>
+void TGradient<T>::sweep(TResult& AResult) const {
+    std::vector<T> adjoint(FTape.size(), T(0));
+    adjoint[FResult] = T(1);
+
+    for (unsigned i = FTape.size(); i-- != 0; ) {
+        const TEntry& e = FTape[i];
+        const T a(adjoint[i]);
+
+        if (a == T(0))
+            continue;
+
+        switch (e.type) {
+            case TNode<T>::PLUS_NODE:
+                // [f + g]' = f' + g'
+                adjoint[e.left] += a;
+                adjoint[e.right] += a;
+                break;
+            case TNode<T>::NEG_NODE:
+                // [-f]' = -(f')
+                adjoint[e.left] -= a;
+                break;
+            case TNode<T>::MUL_NODE:
+                // [f * g]' = f'g + g'f
+                adjoint[e.left] += a * value(e.right);
+                adjoint[e.right] += a * value(e.left);
+                break;
+            case TNode<T>::DIV_NODE:
+                // [f / g]' = f'/g - g'(f/g)/g
+                adjoint[e.left] += a / value(e.right);
+                adjoint[e.right] -= a * e.value / value(e.right);
+                break;
+            case TNode<T>::POW_NODE:
+                // [f ^ g]' = g*f^(g-1) * f' + f^g*ln(f) * g'
+                adjoint[e.left] += a * value(e.right)
+                    * pow(value(e.left), value(e.right) - T(1));
+
+                // the exponent's partial is only defined on positive bases
+                if (value(e.left) > T(0))
+                    adjoint[e.right] += a * e.value * log(value(e.left));
+                break;
+            case TNode<T>::SQRT_NODE:
+                // [sqrt(f)]' = f' / (2 sqrt(f))
+                adjoint[e.left] += a / (T(2) * e.value);
+                break;
+            case TNode<T>::SIN_NODE:
+                // [sin(f)]' = cos(f) * f'
+                adjoint[e.left] += a * cos(value(e.left));
+                break;
+            case TNode<T>::COS_NODE:
+                // [cos(f)]' = -(sin(f) * f')
+                adjoint[e.left] -= a * sin(value(e.left));
+                break;
+            case TNode<T>::TAN_NODE:
+                // [tan(f)]' = (1 + tan(f)^2) * f'
+                adjoint[e.left] += a * (T(1) + e.value * e.value);
+                break;
+            case TNode<T>::LN_NODE:
+                // [ln(f)]' = f' / f
+                adjoint[e.left] += a / value(e.left);
+                break;
+            case TNode<T>::TABLE_NODE:
+                // [TABLE(t, f)]' = TABLE(t, f, 1) * f', the slope is recorded at right
+                adjoint[e.left] += a * value(e.right);
+                break;
+            default:
+                // numbers, constants, the parameter and any comparison
+                // do not propagate anything.
+                break;
+        }
+    }
+
+    for (typename TSymbolMap::const_iterator i = FSymbols.begin(); i != FSymbols.end(); ++i)
+        AResult[i->first] = adjoint[i->second];
+}
+
+template<class T>
+void TGradient<T>::visit(TNumberNode<T> *ANode) {
+    record(TNode<T>::NUMBER_NODE, 0, 0, ANode->number());
+}
+
+template<class T>
+void TGradient<T>::visit(TSymbolNode<T> *ANode) {
+    // each constant gets exactly one slot on the tape, so all of its
+    // references accumulate into the same adjoint.
+    const std::string name(ANode->symbol());
+
+    for (unsigned k = FBindings.size(); k-- > 0; )
+        if (FBindings[k].first == name) {
+            FResult = FBindings[k].second;
+            return;
+        }
+
+    typename TSymbolMap::const_iterator i = FSymbols.find(name);
+
+    if (i != FSymbols.end()) {
+        FResult = i->second;
+        return;
+    }
+
+    FSymbols[name] = record(TNode<T>::SYMBOL_NODE, 0, 0, FLibrary.value(name));
+}
+
+template<class T>
+void TGradient<T>::visit(TParamNode<T> *ANode) {
+    FResult = FParam;
+}
+
+template<class T>
+void TGradient<T>::visit(TPlusNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::PLUS_NODE, left, right, value(left) + value(right));
+}
+
+template<class T>
+void TGradient<T>::visit(TNegNode<T> *ANode) {
+    unsigned node = record(ANode->node());
+
+    record(TNode<T>::NEG_NODE, node, 0, - value(node));
+}
+
+template<class T>
+void TGradient<T>::visit(TMulNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::MUL_NODE, left, right, value(left) * value(right));
+}
+
+template<class T>
+void TGradient<T>::visit(TDivNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::DIV_NODE, left, right, value(left) / value(right));
+}
+
+template<class T>
+void TGradient<T>::visit(TPowNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::POW_NODE, left, right, pow(value(left), value(right)));
+}
+
+template<class T>
+void TGradient<T>::visit(TSqrtNode<T> *ANode) {
+    unsigned node = record(ANode->node());
+
+    record(TNode<T>::SQRT_NODE, node, 0, sqrt(value(node)));
+}
+
+template<class T>
+void TGradient<T>::visit(TSinNode<T> *ANode) {
+    unsigned node = record(ANode->node());
+
+    record(TNode<T>::SIN_NODE, node, 0, sin(value(node)));
+}
+
+template<class T>
+void TGradient<T>::visit(TCosNode<T> *ANode) {
+    unsigned node = record(ANode->node());
+
+    record(TNode<T>::COS_NODE, node, 0, cos(value(node)));
+}
+
+template<class T>
+void TGradient<T>::visit(TTanNode<T> *ANode) {
+    unsigned node = record(ANode->node());
+
+    record(TNode<T>::TAN_NODE, node, 0, tan(value(node)));
+}
+
+template<class T>
+void TGradient<T>::visit(TLnNode<T> *ANode) {
+    unsigned node = record(ANode->node());
+
+    record(TNode<T>::LN_NODE, node, 0, log(value(node)));
+}
+
+template<class T>
+void TGradient<T>::visit(TFuncNode<T> *ANode) {
+    const std::string name(ANode->name());
+
+    unsigned& depth = FRecursions[name];
+
+    if (++depth > FLimit) {
+        --depth;
+        throw ECalcError("Function exceeds recursion counter: " + name + ".");
+    }
+
+    try {
+        // the callee is recorded inline, using the arguments' slots as parameters
+        const unsigned param = record(ANode->node());
+        const TFunction<T>& f = FLibrary.function(name);
+
+        if (ANode->params() != f.params().size() + 1)
+            throw ECalcError("Wrong number of arguments calling function: " + name + ".");
+
+        // the symbols bound by the caller are not visible within the callee,
+        // just its further parameters are
+        std::vector<TBinding> bindings(f.params().size());
+        for (unsigned i = 0; i < bindings.size(); ++i)
+            bindings[i] = TBinding(f.params()[i], record(ANode->param(i + 1)));
+
+        unsigned save = FParam;
+        FParam = param;
+        FBindings.swap(bindings);
+
+        record(f.expression());
+
+        FBindings.swap(bindings);
+        FParam = save;
+    } catch (...) {
+        --depth;
+        throw;
+    }
+
+    --depth; // the limit is about the depth, not the number of calls
+}
+
+template<class T>
+void TGradient<T>::visit(TIfNode<T> *ANode) {
+    // only the taken branch is recorded. The condition itself is piecewise
+    // constant, so nothing propagates through it.
+    unsigned cond = record(ANode->condition());
+
+    if (value(cond) != T(0))
+        record(ANode->trueExpr());
+    else
+        record(ANode->falseExpr());
+}
+
+template<class T>
+void TGradient<T>::visit(TTableNode<T> *ANode) {
+    const TTable<T>& table = FLibrary.table(ANode->name());
+    unsigned node = record(ANode->node());
+
+    // the local slope goes onto the tape as a number of its own
+    unsigned slope = record(TNode<T>::NUMBER_NODE, 0, 0, table.value(value(node), ANode->order() + 1));
+
+    record(TNode<T>::TABLE_NODE, node, slope, table.value(value(node), ANode->order()));
+}
+
+template<class T>
+void TGradient<T>::visit(TSumNode<T> *ANode) {
+    series(ANode);
+}
+
+template<class T>
+void TGradient<T>::visit(TProdNode<T> *ANode) {
+    series(ANode);
+}
+
+template<class T>
+void TGradient<T>::visit(TLetNode<T> *ANode) {
+    // the value is recorded once, all its uses accumulate into its adjoint
+    FBindings.push_back(TBinding(ANode->name(), record(ANode->value())));
+    record(ANode->body());
+    FBindings.pop_back();
+}
+
+template<class T>
+void TGradient<T>::series(TSeriesNode<T> *ANode) {
+    // the bounds are piecewise constant, so just the terms get differentiated
+    const T lower(value(record(ANode->lower()))), upper(value(record(ANode->upper())));
+    const bool sum = ANode->nodeType() == TNode<T>::SUM_NODE;
+
+    unsigned result = record(TNode<T>::NUMBER_NODE, 0, 0, T(sum ? 0 : 1));
+    unsigned long count = 0;
+
+    // beyond the precision of numbers the index would get stuck
+    if (lower <= upper && !(lower + T(1) > lower && upper + T(1) > upper))
+        throw ECalcError("Series index exceeds the precision of numbers.");
+
+    for (T k(lower); k <= upper; ) {
+        FBindings.push_back(TBinding(ANode->index(), record(TNode<T>::NUMBER_NODE, 0, 0, k)));
+        unsigned term = record(ANode->body());
+        FBindings.pop_back();
+
+        if (sum)
+            result = record(TNode<T>::PLUS_NODE, result, term, value(result) + value(term));
+        else
+            result = record(TNode<T>::MUL_NODE, result, term, value(result) * value(term));
+
+        const T next(lower + T(++count));
+        if (!(k < next))
+            throw ECalcError("Series index exceeds the precision of numbers.");
+
+        k = next;
+    }
+
+    FResult = result;
+}
+
+template<class T>
+void TGradient<T>::visit(TEquNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::EQU_NODE, left, right, value(left) == value(right));
+}
+
+template<class T>
+void TGradient<T>::visit(TUnEquNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::UNEQU_NODE, left, right, value(left) != value(right));
+}
+
+template<class T>
+void TGradient<T>::visit(TGreaterNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::GREATER_NODE, left, right, value(left) > value(right));
+}
+
+template<class T>
+void TGradient<T>::visit(TLessNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::LESS_NODE, left, right, value(left) < value(right));
+}
+
+template<class T>
+void TGradient<T>::visit(TGreaterEquNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::GREATER_EQU_NODE, left, right, value(left) >= value(right));
+}
+
+template<class T>
+void TGradient<T>::visit(TLessEquNode<T> *ANode) {
+    unsigned left = record(ANode->left());
+    unsigned right = record(ANode->right());
+
+    record(TNode<T>::LESS_EQU_NODE, left, right, value(left) <= value(right));
+}
+
+} // namespace math
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the adaptive numeric integrator)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_integrator_h
+#define libmath_integrator_h
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+
+#include <memory>
+#include <vector>
+
+namespace math {
+
+/**
+  * TIntegrator<> numerically calculates definite integrals of a function 
+  * using adaptive Gauss-Kronrod quadrature (7 Gauss, 15 Kronrod nodes), 
+  * for one interval or whole arrays of them.
+  *
+  * The subintervals are kept in a priority queue ordered by their error 
+  * estimate. Each step bisects the worst ones, as many as needed to 
+  * get below the tolerance (but at most a few), and calculates the 
+  * nodes of all their halves in one TBatchCalculator<> run.
+  *
+  * T must be float, double or long double. The integrator can be used 
+  * by many threads at once.
+  */
+template<class T>
+class TIntegrator {
+public:
+    enum TStatus {
+        CONVERGED,      // the error estimate is within the tolerance
+        NO_CONVERGENCE, // the evaluation limit was hit
+        FAILED          // f couldn't be calculated or isn't finite
+    };
+
+    struct TResult {
+        T value;
+        T error;                // estimated absolute error
+        unsigned evaluations;   // function evaluations done
+        TStatus status;
+    };
+
+    /**
+      * creates an integrator for AFunction, which stops when the error 
+      * estimate is below ATolerance or ARelativeTolerance times the 
+      * integral's magnitude. ALibrary must live as long as the integrator 
+      * does.
+      */
+    TIntegrator(const TFunction<T>& AFunction, const TLibrary<T>& ALibrary,
+        const T& ATolerance, const T& ARelativeTolerance, unsigned AMaxEvaluations = 15 * 1000);
+
+    /// integrates f over [ALower, AUpper]
+    TResult integrate(const T& ALower, const T& AUpper) const;
+
+    /**
+      * integrates f over [ALower[i], AUpper[i]] into AResult[i] for each 
+      * i < ACount, split up on AThreads threads.
+      */
+    void integrate(const T *ALower, const T *AUpper, unsigned ACount, TResult *AResult,
+        unsigned AThreads = 1) const;
+
+private:
+    /// TSegment is a subinterval with its integral and error estimate
+    struct TSegment {
+        T lower, upper;
+        T value, error;
+
+        bool operator<(const TSegment& ASegment) const { return error < ASegment.error; }
+    };
+
+    struct TJob {
+        const TIntegrator<T> *integrator;
+        const T *lower;
+        const T *upper;
+        unsigned count;
+        TResult *result;
+
+        void run();
+    };
+
+    std::auto_ptr<TNode<T> > FExpression;
+    const TLibrary<T>& FLibrary;
+    T FTolerance;
+    T FRelativeTolerance;
+    unsigned FMaxEvaluations;
+
+    TIntegrator(const TIntegrator<T>&);
+    TIntegrator<T>& operator=(const TIntegrator<T>&);
+
+    /// appends the 15 nodes of [ALower, AUpper] to AParams
+    static void nodes(const T& ALower, const T& AUpper, std::vector<T>& AParams);
+
+    /// sets the value and error of ASegment using the function values at its nodes
+    static void estimate(TSegment& ASegment, const T *AValues);
+
+    /// returns true, if ASegment is too small to be split up
+    static bool tiny(const TSegment& ASegment);
+};
+
+} // namespace math
+
+#include <math++/integrator.tcc>
+
+#endif
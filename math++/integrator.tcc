@@ -0,0 +1,278 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the adaptive numeric integrator template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_integrator_h
+#error You may not include math++/integrator.tcc directly; include math++/integrator.h instead.
+#endif
+
+#include <math++/calculator.h>
+#include <math++/thread.h>
+#include <math++/error.h>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace math {
+
+// the nodes and weights of the Gauss-Kronrod rule, as in QUADPACK's qk15
+static const long double gkNodes[8] = {
+    0.991455371120812639206854697526329L, 0.949107912342758524526189684047851L,
+    0.864864423359769072789712788640926L, 0.741531185599394439863864773280788L,
+    0.586087235467691130294144845693013L, 0.405845151377397166906606412076961L,
+    0.207784955007898467600689403773245L, 0.0L
+};
+
+static const long double gkKronrodWeights[8] = {
+    0.022935322010529224963732008058970L, 0.063092092629978553290700663189204L,
+    0.104790010322250183839876322541518L, 0.140653259715525918745189590510238L,
+    0.169004726639267902826583426598550L, 0.190350578064785409913256402421014L,
+    0.204432940075298892414161999234649L, 0.209482141084727828012999174891714L
+};
+
+// weights of the Gauss nodes gkNodes[1], [3], [5] and [7]
+static const long double gkGaussWeights[4] = {
+    0.129484966168869693270611432679082L, 0.279705391489276667901467771423780L,
+    0.381830050505118944950369775488975L, 0.417959183673469387755102040816327L
+};
+
+// the number of segments bisected at most per step
+static const unsigned gkBatch = 8;
+
+template<class T>
+TIntegrator<T>::TIntegrator(const TFunction<T>& AFunction, const TLibrary<T>& ALibrary,
+    const T& ATolerance, const T& ARelativeTolerance, unsigned AMaxEvaluations) :
+    FExpression(AFunction.expression()->clone()), FLibrary(ALibrary),
+    FTolerance(ATolerance), FRelativeTolerance(ARelativeTolerance),
+    FMaxEvaluations(AMaxEvaluations) {
+}
+
+template<class T>
+void TIntegrator<T>::nodes(const T& ALower, const T& AUpper, std::vector<T>& AParams) {
+    const T center = (ALower + AUpper) / T(2);
+    const T half = (AUpper - ALower) / T(2);
+
+    AParams.push_back(center);
+
+    for (unsigned j = 0; j < 7; ++j) {
+        const T offset = half * T(gkNodes[j]);
+
+        AParams.push_back(center - offset);
+        AParams.push_back(center + offset);
+    }
+}
+
+template<class T>
+void TIntegrator<T>::estimate(TSegment& ASegment, const T *AValues) {
+    const T half = (ASegment.upper - ASegment.lower) / T(2);
+    const T center = AValues[0];
+
+    T gauss = center * T(gkGaussWeights[3]);
+    T kronrod = center * T(gkKronrodWeights[7]);
+    T absolute = std::fabs(kronrod);
+
+    for (unsigned j = 0; j < 7; ++j) {
+        const T sum = AValues[1 + 2 * j] + AValues[2 + 2 * j];
+
+        kronrod += T(gkKronrodWeights[j]) * sum;
+        absolute += T(gkKronrodWeights[j]) * (std::fabs(AValues[1 + 2 * j]) + std::fabs(AValues[2 + 2 * j]));
+
+        if (j % 2)
+            gauss += T(gkGaussWeights[j / 2]) * sum;
+    }
+
+    // the deviation from the mean, to scale the error estimate
+    const T mean = kronrod / T(2);
+    T deviation = T(gkKronrodWeights[7]) * std::fabs(center - mean);
+
+    for (unsigned j = 0; j < 7; ++j)
+        deviation += T(gkKronrodWeights[j])
+                   * (std::fabs(AValues[1 + 2 * j] - mean) + std::fabs(AValues[2 + 2 * j] - mean));
+
+    const T width = std::fabs(half);
+    const T epsilon = std::numeric_limits<T>::epsilon();
+
+    absolute *= width;
+    deviation *= width;
+
+    ASegment.value = kronrod * half;
+    ASegment.error = std::fabs((kronrod - gauss) * half);
+
+    if (deviation != T(0) && ASegment.error != T(0))
+        ASegment.error = deviation * std::min(T(1), std::pow(T(200) * ASegment.error / deviation, T(1.5)));
+
+    if (absolute > std::numeric_limits<T>::min() / (T(50) * epsilon))
+        ASegment.error = std::max(T(50) * epsilon * absolute, ASegment.error);
+}
+
+template<class T>
+bool TIntegrator<T>::tiny(const TSegment& ASegment) {
+    const T lower = std::min(ASegment.lower, ASegment.upper);
+    const T upper = std::max(ASegment.lower, ASegment.upper);
+    const T middle = (lower + upper) / T(2);
+
+    return !(lower < middle && middle < upper)
+        || upper - lower <= T(100) * std::numeric_limits<T>::epsilon()
+                          * (std::fabs(lower) + std::fabs(upper));
+}
+
+template<class T>
+typename TIntegrator<T>::TResult TIntegrator<T>::integrate(const T& ALower, const T& AUpper) const {
+    TResult result;
+    result.value = T(0);
+    result.error = T(0);
+    result.evaluations = 0;
+    result.status = CONVERGED;
+
+    if (ALower == AUpper)
+        return result;
+
+    try {
+        std::vector<T> params, values;
+        std::vector<TSegment> queue;    // a heap, the worst segment first
+        std::vector<TSegment> done;     // segments too small to be split up
+        std::vector<TSegment> split;
+
+        TSegment first;
+        first.lower = ALower;
+        first.upper = AUpper;
+        split.push_back(first);
+
+        T value = T(0), error = T(0);
+
+        for (;;) {
+            // calculate the nodes of all new segments at once
+            params.clear();
+            for (unsigned i = 0; i < split.size(); ++i)
+                nodes(split[i].lower, split[i].upper, params);
+
+            values.resize(params.size());
+            TBatchCalculator<T>::calculate(FExpression.get(), &params[0],
+                &params[0] + params.size(), &values[0], FLibrary);
+            result.evaluations += params.size();
+
+            for (unsigned i = 0; i < split.size(); ++i) {
+                TSegment& s = split[i];
+                estimate(s, &values[15 * i]);
+
+                // finite numbers are the only ones giving 0 when subtracted from themselves
+                if (s.value - s.value != T(0) || s.error - s.error != T(0)) {
+                    result.status = FAILED;
+                    return result;
+                }
+
+                value += s.value;
+                error += s.error;
+
+                queue.push_back(s);
+                std::push_heap(queue.begin(), queue.end());
+            }
+
+            const T tolerance = std::max(FTolerance, FRelativeTolerance * std::fabs(value));
+
+            if (error <= tolerance)
+                break;
+
+            // take the worst segments until their errors are worth the excess
+            std::vector<TSegment> parents;
+            T removed = T(0);
+
+            while (!queue.empty() && parents.size() < gkBatch && removed < error - tolerance
+                    && result.evaluations + 30 * (parents.size() + 1) <= FMaxEvaluations) {
+
+                std::pop_heap(queue.begin(), queue.end());
+                TSegment s = queue.back();
+                queue.pop_back();
+
+                if (tiny(s))
+                    done.push_back(s);
+                else {
+                    parents.push_back(s);
+                    removed += s.error;
+                }
+            }
+
+            if (parents.empty()) {
+                result.status = NO_CONVERGENCE;
+                break;
+            }
+
+            split.clear();
+            for (unsigned i = 0; i < parents.size(); ++i) {
+                const TSegment& p = parents[i];
+                TSegment s;
+
+                s.lower = p.lower;
+                s.upper = (p.lower + p.upper) / T(2);
+                split.push_back(s);
+
+                s.lower = s.upper;
+                s.upper = p.upper;
+                split.push_back(s);
+
+                value -= p.value;
+                error -= p.error;
+            }
+        }
+
+        // sum up again, the running sums drift
+        queue.insert(queue.end(), done.begin(), done.end());
+
+        for (unsigned i = 0; i < queue.size(); ++i) {
+            result.value += queue[i].value;
+            result.error += queue[i].error;
+        }
+    } catch (const EMath&) {
+        result.status = FAILED;
+    }
+
+    return result;
+}
+
+template<class T>
+void TIntegrator<T>::TJob::run() {
+    for (unsigned i = 0; i < count; ++i)
+        result[i] = integrator->integrate(lower[i], upper[i]);
+}
+
+template<class T>
+void TIntegrator<T>::integrate(const T *ALower, const T *AUpper, unsigned ACount,
+    TResult *AResult, unsigned AThreads) const {
+
+    const unsigned threads = AThreads < 1 ? 1 : AThreads > ACount ? ACount : AThreads;
+
+    std::vector<TJob> jobs(threads);
+
+    for (unsigned i = 0; i < threads; ++i) {
+        const unsigned first = ACount * i / threads, last = ACount * (i + 1) / threads;
+
+        jobs[i].integrator = this;
+        jobs[i].lower = ALower + first;
+        jobs[i].upper = AUpper + first;
+        jobs[i].count = last - first;
+        jobs[i].result = AResult + first;
+    }
+
+    parallel(jobs);
+}
+
+} // namespace math
@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the interval arithmetic interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_interval_h
+#define libmath_interval_h
+
+#include <math++/visitor.h>
+#include <math++/nodes.h>
+#include <math++/calculator.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace math {
+
+template<class> class TFunction;
+template<class> class TLibrary;
+template<class> class TTable;
+
+/**
+  * TInterval<> is a closed interval [lower, upper] which is guaranteed to 
+  * contain the exact result of the operations done on it. Results of 
+  * double, float and long double get rounded outwards by an ulp, those of 
+  * the library functions by two. Any other type has to be exact.
+  *
+  * Functions are restricted to their domain: sqrt([-1, 4]) is [0, 2] and 
+  * ln([-2, -1]) is empty. Negative bases take the integral exponents only,
+  * [-2, -1]^[0.5, 2.5] is the hull of [-2, -1]^1 and [-2, -1]^2, [-2, 4].
+  * Divisors containing zero give the entire line.
+  * Table lookups cover the extrema of the interpolation within the interval 
+  * and get rounded outwards like the library functions.
+  */
+template<class T>
+class TInterval {
+public:
+    /// creates the empty interval
+    TInterval();
+    /// creates the interval containing AValue only
+    TInterval(const T& AValue);
+    TInterval(const T& ALower, const T& AUpper);
+
+    static TInterval<T> empty();
+    static TInterval<T> entire();
+    /// returns the smallest interval containing a and b
+    static TInterval<T> hull(const TInterval<T>& a, const TInterval<T>& b);
+
+    const T& lower() const { return FLower; }
+    const T& upper() const { return FUpper; }
+
+    bool isEmpty() const { return !(FLower <= FUpper); }
+    bool isPoint() const { return FLower == FUpper; }
+    bool contains(const T& AValue) const { return FLower <= AValue && AValue <= FUpper; }
+    T width() const { return FUpper - FLower; }
+
+    friend TInterval<T> operator+(const TInterval<T>& a, const TInterval<T>& b) { return add(a, b); }
+    friend TInterval<T> operator-(const TInterval<T>& a, const TInterval<T>& b) { return add(a, -b); }
+    friend TInterval<T> operator*(const TInterval<T>& a, const TInterval<T>& b) { return multiply(a, b); }
+    friend TInterval<T> operator/(const TInterval<T>& a, const TInterval<T>& b) { return divide(a, b); }
+
+    TInterval<T> operator-() const;
+
+    // the functions of the calculator, found by argument dependent lookup only
+    friend TInterval<T> pow(const TInterval<T>& a, const TInterval<T>& b) { return power(a, b); }
+    friend TInterval<T> sqrt(const TInterval<T>& a) { return squareRoot(a); }
+    friend TInterval<T> sin(const TInterval<T>& a) { return periodic(a, PI / 2, false); }
+    friend TInterval<T> cos(const TInterval<T>& a) { return periodic(a, 0, true); }
+    friend TInterval<T> tan(const TInterval<T>& a) { return tangent(a); }
+    friend TInterval<T> log(const TInterval<T>& a) { return logarithm(a); }
+    friend TInterval<T> lookup(const TTable<T>& t, const TInterval<T>& a, unsigned order) {
+        return tabulated(t, a, order);
+    }
+
+private:
+    T FLower;
+    T FUpper;
+
+    static const double PI;
+
+    /// rounds a computed bound outwards
+    static T down(const T& a);
+    static T up(const T& a);
+
+    static TInterval<T> add(const TInterval<T>& a, const TInterval<T>& b);
+    static TInterval<T> multiply(const TInterval<T>& a, const TInterval<T>& b);
+    static TInterval<T> divide(const TInterval<T>& a, const TInterval<T>& b);
+    static TInterval<T> power(const TInterval<T>& a, const TInterval<T>& b);
+    static TInterval<T> squareRoot(const TInterval<T>& a);
+    /// sin (AShift = pi/2) or cos (AShift = 0), their maxima are at AShift + 2k pi
+    static TInterval<T> periodic(const TInterval<T>& a, double AShift, bool ACosine);
+    static TInterval<T> tangent(const TInterval<T>& a);
+    static TInterval<T> logarithm(const TInterval<T>& a);
+    static TInterval<T> tabulated(const TTable<T>& t, const TInterval<T>& a, unsigned order);
+
+    /// returns true if a point AOffset + k APeriod might lie in [ALower, AUpper]
+    static bool hits(double ALower, double AUpper, double AOffset, double APeriod);
+};
+
+/**
+  * TIntervalCalculator<> calculates guaranteed bounds of a function over 
+  * a whole interval of its parameter, e.g. to discard regions without 
+  * roots at once. Relations give [0, 0], [1, 1] or [0, 1]; an IF whose 
+  * condition may be either gives the hull of both branches. Sums and 
+  * products need a point as lower bound (otherwise they're unbounded),
+  * their upper bound may be an interval.
+  */
+template<class T>
+class TIntervalCalculator : protected TNodeVisitor<T> {
+public:
+    /// calculates the bounds of the function over AParam.
+    static TInterval<T> calculate(const TFunction<T>& AFunction, const TInterval<T>& AParam, 
+        const TLibrary<T>& ALibrary, unsigned ARecursionLimit = 64);
+
+    /// calculates the bounds of the expression over AParam.
+    static TInterval<T> calculate(const TNode<T> *AExpression, const TInterval<T>& AParam, 
+        const TLibrary<T>& ALibrary, unsigned ARecursionLimit = 64);
+
+private:
+    /// a bound symbol (e.g. a summation index) with its value
+    typedef std::pair<std::string, TInterval<T> > TBinding;
+
+    TInterval<T> FParam;
+    const TLibrary<T>& FLibrary;
+    std::map<std::string, unsigned> FRecursions;
+    unsigned FLimit;
+    std::vector<TBinding> FBindings; // innermost last
+    TInterval<T> FResult;
+
+private:
+    TIntervalCalculator(const TInterval<T>& AParam, const TLibrary<T>& ALibrary, unsigned ALimit);
+
+    /// calculates partial expression
+    TInterval<T> calculate(const TNode<T> *AExpression);
+
+    /// returns [0, 0], [1, 1] or [0, 1] for never, always or maybe
+    static TInterval<T> truth(bool AAlways, bool ANever);
+
+    /// calculates the sum or product ANode into FResult
+    void series(TSeriesNode<T> *ANode);
+
+    virtual void visit(TNumberNode<T> *);
+    virtual void visit(TSymbolNode<T> *);
+    virtual void visit(TParamNode<T> *);
+
+    virtual void visit(TPlusNode<T> *);
+    virtual void visit(TNegNode<T> *);
+
+    virtual void visit(TMulNode<T> *);
+    virtual void visit(TDivNode<T> *);
+
+    virtual void visit(TPowNode<T> *);
+    virtual void visit(TSqrtNode<T> *);
+
+    virtual void visit(TSinNode<T> *);
+    virtual void visit(TCosNode<T> *);
+    virtual void visit(TTanNode<T> *);
+    virtual void visit(TLnNode<T> *);
+
+    virtual void visit(TFuncNode<T> *);
+    virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
+
+    virtual void visit(TEquNode<T> *);
+    virtual void visit(TUnEquNode<T> *);
+    virtual void visit(TGreaterNode<T> *);
+    virtual void visit(TLessNode<T> *);
+    virtual void visit(TGreaterEquNode<T> *);
+    virtual void visit(TLessEquNode<T> *);
+};
+
+} // namespace math
+
+#include <math++/interval.tcc>
+
+#endif
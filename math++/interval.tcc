@@ -0,0 +1,613 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the interval arithmetic template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_interval_h
+#error You may not include math++/interval.tcc directly; include math++/interval.h instead.
+#endif
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <math.h>
+
+namespace math {
+
+template<class T>
+const double TInterval<T>::PI = 3.14159265358979323846;
+
+template<class T>
+TInterval<T>::TInterval() :
+    FLower(std::numeric_limits<T>::infinity()), FUpper(-std::numeric_limits<T>::infinity()) {
+}
+
+template<class T>
+TInterval<T>::TInterval(const T& AValue) :
+    FLower(AValue), FUpper(AValue) {
+}
+
+template<class T>
+TInterval<T>::TInterval(const T& ALower, const T& AUpper) :
+    FLower(ALower), FUpper(AUpper) {
+
+    // undefined bounds (inf - inf, inf / inf) can be anything
+    if (FLower != FLower)
+        FLower = -std::numeric_limits<T>::infinity();
+    if (FUpper != FUpper)
+        FUpper = std::numeric_limits<T>::infinity();
+}
+
+template<class T>
+TInterval<T> TInterval<T>::empty() {
+    return TInterval<T>();
+}
+
+template<class T>
+TInterval<T> TInterval<T>::entire() {
+    return TInterval<T>(-std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity());
+}
+
+template<class T>
+TInterval<T> TInterval<T>::hull(const TInterval<T>& a, const TInterval<T>& b) {
+    if (a.isEmpty())
+        return b;
+    if (b.isEmpty())
+        return a;
+
+    return TInterval<T>(std::min(a.FLower, b.FLower), std::max(a.FUpper, b.FUpper));
+}
+
+// other types are taken as exact, as TRational is
+template<class T>
+T TInterval<T>::down(const T& a) {
+    return a;
+}
+
+template<class T>
+T TInterval<T>::up(const T& a) {
+    return a;
+}
+
+// the basic operations are rounded to nearest, so one ulp outwards is enough
+template<>
+inline double TInterval<double>::down(const double& a) {
+    return ::nextafter(a, -HUGE_VAL);
+}
+
+template<>
+inline double TInterval<double>::up(const double& a) {
+    return ::nextafter(a, HUGE_VAL);
+}
+
+template<>
+inline float TInterval<float>::down(const float& a) {
+    return ::nextafterf(a, -HUGE_VALF);
+}
+
+template<>
+inline float TInterval<float>::up(const float& a) {
+    return ::nextafterf(a, HUGE_VALF);
+}
+
+template<>
+inline long double TInterval<long double>::down(const long double& a) {
+    return ::nextafterl(a, -HUGE_VALL);
+}
+
+template<>
+inline long double TInterval<long double>::up(const long double& a) {
+    return ::nextafterl(a, HUGE_VALL);
+}
+
+template<class T>
+TInterval<T> TInterval<T>::operator-() const {
+    TInterval<T> result;
+    result.FLower = -FUpper;
+    result.FUpper = -FLower;
+
+    return result;
+}
+
+template<class T>
+TInterval<T> TInterval<T>::add(const TInterval<T>& a, const TInterval<T>& b) {
+    if (a.isEmpty() || b.isEmpty())
+        return empty();
+
+    return TInterval<T>(down(a.FLower + b.FLower), up(a.FUpper + b.FUpper));
+}
+
+// returns x * y, where zero times infinity is zero
+template<class T>
+inline T boundProduct(const T& x, const T& y) {
+    return x == T(0) || y == T(0) ? T(0) : x * y;
+}
+
+template<class T>
+TInterval<T> TInterval<T>::multiply(const TInterval<T>& a, const TInterval<T>& b) {
+    if (a.isEmpty() || b.isEmpty())
+        return empty();
+
+    const T p[] = {
+        boundProduct(a.FLower, b.FLower), boundProduct(a.FLower, b.FUpper),
+        boundProduct(a.FUpper, b.FLower), boundProduct(a.FUpper, b.FUpper)
+    };
+
+    return TInterval<T>(down(std::min(std::min(p[0], p[1]), std::min(p[2], p[3]))),
+                        up(std::max(std::max(p[0], p[1]), std::max(p[2], p[3]))));
+}
+
+template<class T>
+TInterval<T> TInterval<T>::divide(const TInterval<T>& a, const TInterval<T>& b) {
+    if (a.isEmpty() || b.isEmpty())
+        return empty();
+
+    if (b.contains(T(0)))
+        return entire();
+
+    const T q[] = {
+        a.FLower / b.FLower, a.FLower / b.FUpper,
+        a.FUpper / b.FLower, a.FUpper / b.FUpper
+    };
+
+    return TInterval<T>(down(std::min(std::min(q[0], q[1]), std::min(q[2], q[3]))),
+                        up(std::max(std::max(q[0], q[1]), std::max(q[2], q[3]))));
+}
+
+template<class T>
+TInterval<T> TInterval<T>::power(const TInterval<T>& a, const TInterval<T>& b) {
+    using std::pow;
+
+    if (a.isEmpty() || b.isEmpty())
+        return empty();
+
+    // integral exponents are defined for negative bases as well
+    const T n = b.FLower;
+    if (b.isPoint() && n == std::floor(n) && n > -2147483648.0 && n < 2147483648.0) {
+        if (n == T(0))
+            return TInterval<T>(T(1));
+
+        if (n < T(0))
+            return divide(TInterval<T>(T(1)), power(a, TInterval<T>(-n)));
+
+        // pow() is a library function, so two ulps
+        if (std::fmod(n, T(2)) != T(0) || a.FLower >= T(0))
+            return TInterval<T>(down(down(pow(a.FLower, n))), up(up(pow(a.FUpper, n))));
+
+        if (a.FUpper <= T(0))
+            return TInterval<T>(std::max(T(0), down(down(pow(a.FUpper, n)))), up(up(pow(a.FLower, n))));
+
+        return TInterval<T>(T(0), up(up(pow(std::max(-a.FLower, a.FUpper), n))));
+    }
+
+    // negative bases count the integers within the exponent only, |x|^n is
+    // monotonic in |x| and n, so the first and last even and odd n bound them
+    TInterval<T> negative;
+    if (a.FLower < T(0)) {
+        const T first = std::ceil(b.FLower), last = std::floor(b.FUpper);
+
+        if (first <= last) {
+            if (first <= -2147483648.0 || last >= 2147483648.0)
+                return entire();
+
+            const TInterval<T> base(a.FLower, std::min(a.FUpper, T(0)));
+            const T n[] = { first, first + 1, last - 1, last };
+            for (unsigned i = 0; i < 4; ++i)
+                if (n[i] >= first && n[i] <= last)
+                    negative = hull(negative, power(base, TInterval<T>(n[i])));
+        }
+
+        if (a.FUpper < T(0))
+            return negative;
+    }
+
+    // x^y is monotonic in x and in y, so its extremes are at the corners
+    const T x = std::max(a.FLower, T(0));
+    const T p[] = {
+        pow(x, b.FLower), pow(x, b.FUpper), pow(a.FUpper, b.FLower), pow(a.FUpper, b.FUpper)
+    };
+
+    return hull(negative, TInterval<T>(
+        std::max(T(0), down(down(std::min(std::min(p[0], p[1]), std::min(p[2], p[3]))))),
+        up(up(std::max(std::max(p[0], p[1]), std::max(p[2], p[3]))))));
+}
+
+template<class T>
+TInterval<T> TInterval<T>::squareRoot(const TInterval<T>& a) {
+    if (a.isEmpty() || a.FUpper < T(0))
+        return empty();
+
+    // sqrt() is rounded to nearest just as the basic operations
+    return TInterval<T>(std::max(T(0), down(std::sqrt(std::max(a.FLower, T(0))))),
+                        up(std::sqrt(a.FUpper)));
+}
+
+template<class T>
+bool TInterval<T>::hits(double ALower, double AUpper, double AOffset, double APeriod) {
+    // the points are computed with rounding errors, so it's rather hit than miss
+    const double tolerance = (std::fabs(ALower) + std::fabs(AUpper) + APeriod) * 1e-14;
+    const double k = std::floor((ALower - AOffset) / APeriod);
+
+    for (double j = k - 1; j <= k + 2; ++j) {
+        const double p = AOffset + j * APeriod;
+
+        if (p >= ALower - tolerance && p <= AUpper + tolerance)
+            return true;
+    }
+    return false;
+}
+
+template<class T>
+TInterval<T> TInterval<T>::periodic(const TInterval<T>& a, double AShift, bool ACosine) {
+    if (a.isEmpty())
+        return empty();
+
+    const T l = a.FLower, u = a.FUpper;
+
+    if (!(u - l < 2 * PI) || std::fabs(l) > 1e9 || std::fabs(u) > 1e9)
+        return TInterval<T>(T(-1), T(1));
+
+    const T fl = ACosine ? std::cos(l) : std::sin(l);
+    const T fu = ACosine ? std::cos(u) : std::sin(u);
+
+    T lower = down(down(std::min(fl, fu)));
+    T upper = up(up(std::max(fl, fu)));
+
+    // the maxima are at AShift + 2k pi, the minima half a period later
+    if (hits(l, u, AShift, 2 * PI))
+        upper = T(1);
+    if (hits(l, u, AShift + PI, 2 * PI))
+        lower = T(-1);
+
+    return TInterval<T>(std::max(lower, T(-1)), std::min(upper, T(1)));
+}
+
+template<class T>
+TInterval<T> TInterval<T>::tangent(const TInterval<T>& a) {
+    if (a.isEmpty())
+        return empty();
+
+    const T l = a.FLower, u = a.FUpper;
+
+    // tan is increasing between its poles at pi/2 + k pi
+    if (!(u - l < PI) || std::fabs(l) > 1e9 || std::fabs(u) > 1e9 || hits(l, u, PI / 2, PI))
+        return entire();
+
+    return TInterval<T>(down(down(std::tan(l))), up(up(std::tan(u))));
+}
+
+template<class T>
+TInterval<T> TInterval<T>::logarithm(const TInterval<T>& a) {
+    if (a.isEmpty() || a.FUpper < T(0))
+        return empty();
+
+    return TInterval<T>(
+        a.FLower <= T(0) ? -std::numeric_limits<T>::infinity() : down(down(std::log(a.FLower))),
+        up(up(std::log(a.FUpper))));
+}
+
+template<class T>
+TInterval<T> TInterval<T>::tabulated(const TTable<T>& t, const TInterval<T>& a, unsigned order) {
+    if (a.isEmpty())
+        return a;
+
+    T lower, upper;
+    t.range(a.FLower, a.FUpper, order, lower, upper);
+
+    return TInterval<T>(down(down(lower)), up(up(upper)));
+}
+
+// TIntervalCalculator
+
+template<class T>
+TInterval<T> TIntervalCalculator<T>::calculate(const TFunction<T>& AFunction,
+    const TInterval<T>& AParam, const TLibrary<T>& ALibrary, unsigned ALimit) {
+
+    return calculate(AFunction.expression(), AParam, ALibrary, ALimit);
+}
+
+template<class T>
+TInterval<T> TIntervalCalculator<T>::calculate(const TNode<T> *AExpression,
+    const TInterval<T>& AParam, const TLibrary<T>& ALibrary, unsigned ALimit) {
+
+    TIntervalCalculator<T> c(AParam, ALibrary, ALimit);
+    return c.calculate(AExpression);
+}
+
+template<class T>
+TIntervalCalculator<T>::TIntervalCalculator(const TInterval<T>& AParam,
+    const TLibrary<T>& ALibrary, unsigned ALimit) :
+    FParam(AParam), FLibrary(ALibrary), FLimit(ALimit) {
+}
+
+template<class T>
+TInterval<T> TIntervalCalculator<T>::calculate(const TNode<T> *AExpression) {
+    const_cast<TNode<T> *>(AExpression)->accept(*this);
+
+    return FResult;
+}
+
+template<class T>
+TInterval<T> TIntervalCalculator<T>::truth(bool AAlways, bool ANever) {
+    if (AAlways)
+        return TInterval<T>(T(1));
+
+    if (ANever)
+        return TInterval<T>(T(0));
+
+    return TInterval<T>(T(0), T(1));
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TNumberNode<T> *ANode) {
+    FResult = TInterval<T>(ANode->number());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TSymbolNode<T> *ANode) {
+    const std::string symbol(ANode->symbol());
+
+    for (unsigned i = FBindings.size(); i-- > 0; )
+        if (FBindings[i].first == symbol) {
+            FResult = FBindings[i].second;
+            return;
+        }
+
+    FResult = TInterval<T>(FLibrary.value(symbol));
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TParamNode<T> *ANode) {
+    FResult = FParam;
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TPlusNode<T> *ANode) {
+    FResult = calculate(ANode->left()) + calculate(ANode->right());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TNegNode<T> *ANode) {
+    FResult = - calculate(ANode->node());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TMulNode<T> *ANode) {
+    FResult = calculate(ANode->left()) * calculate(ANode->right());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TDivNode<T> *ANode) {
+    FResult = calculate(ANode->left()) / calculate(ANode->right());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TPowNode<T> *ANode) {
+    FResult = pow(calculate(ANode->left()), calculate(ANode->right()));
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TSqrtNode<T> *ANode) {
+    FResult = sqrt(calculate(ANode->node()));
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TSinNode<T> *ANode) {
+    FResult = sin(calculate(ANode->node()));
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TCosNode<T> *ANode) {
+    FResult = cos(calculate(ANode->node()));
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TTanNode<T> *ANode) {
+    FResult = tan(calculate(ANode->node()));
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TLnNode<T> *ANode) {
+    FResult = log(calculate(ANode->node()));
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TFuncNode<T> *ANode) {
+    const std::string name(ANode->name());
+
+    unsigned& depth = FRecursions[name];
+
+    if (++depth > FLimit)
+        throw ECalcError("Function exceeds recursion counter: " + name + ".");
+
+    const TInterval<T> param(calculate(ANode->node()));
+
+    const TFunction<T> *f = FLibrary.find(name);
+    if (!f)
+        throw ELibraryLookup("No function found in library called: " + name + ".");
+
+    if (ANode->params() != f->params().size() + 1)
+        throw ECalcError("Wrong number of arguments calling function: " + name + ".");
+
+    // the symbols bound by the caller are not visible within the callee,
+    // just its further parameters are
+    std::vector<TBinding> bindings(f->params().size());
+    for (unsigned i = 0; i < bindings.size(); ++i)
+        bindings[i] = TBinding(f->params()[i], calculate(ANode->param(i + 1)));
+
+    TInterval<T> save(FParam);
+    FParam = param;
+    FBindings.swap(bindings);
+
+    FResult = calculate(f->expression());
+
+    FBindings.swap(bindings);
+    FParam = save;
+    --depth;
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TIfNode<T> *ANode) {
+    const TInterval<T> condition(calculate(ANode->condition()));
+
+    if (condition.isEmpty())
+        FResult = condition;
+    else if (!condition.contains(T(0)))
+        FResult = calculate(ANode->trueExpr());
+    else if (condition.isPoint())
+        FResult = calculate(ANode->falseExpr());
+    else {
+        // either way, so the result may be any of both
+        const TInterval<T> t(calculate(ANode->trueExpr()));
+        FResult = TInterval<T>::hull(t, calculate(ANode->falseExpr()));
+    }
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TTableNode<T> *ANode) {
+    const TInterval<T> param(calculate(ANode->node()));
+
+    const TTable<T> *t = FLibrary.findTable(ANode->name());
+    if (!t)
+        throw ELibraryLookup("No table found in library called: " + ANode->name() + ".");
+
+    FResult = lookup(*t, param, ANode->order());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TSumNode<T> *ANode) {
+    series(ANode);
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TProdNode<T> *ANode) {
+    series(ANode);
+}
+
+template<class T>
+void TIntervalCalculator<T>::series(TSeriesNode<T> *ANode) {
+    const TInterval<T> lower(calculate(ANode->lower())), upper(calculate(ANode->upper()));
+    const bool sum = ANode->nodeType() == TNode<T>::SUM_NODE;
+
+    if (lower.isEmpty() || upper.isEmpty()) {
+        FResult = TInterval<T>::empty();
+        return;
+    }
+
+    // the index values aren't known otherwise
+    if (!lower.isPoint()) {
+        FResult = TInterval<T>::entire();
+        return;
+    }
+
+    // the series ends somewhere within the upper bound, so the result is
+    // the hull of the partial results that may be the last one
+    TInterval<T> partial(T(sum ? 0 : 1));
+    TInterval<T> result(upper.lower() < lower.lower() ? partial : TInterval<T>::empty());
+    unsigned long count = 0;
+
+    // beyond the precision of numbers the index would get stuck
+    if (lower.lower() <= upper.upper() && !(lower.lower() + T(1) > lower.lower() && upper.upper() + T(1) > upper.upper()))
+        throw ECalcError("Series index exceeds the precision of numbers.");
+
+    for (T k(lower.lower()); k <= upper.upper(); ) {
+        FBindings.push_back(TBinding(ANode->index(), TInterval<T>(k)));
+        const TInterval<T> term(calculate(ANode->body()));
+        FBindings.pop_back();
+
+        partial = sum ? partial + term : partial * term;
+
+        const T next(lower.lower() + T(++count));
+        if (!(k < next))
+            throw ECalcError("Series index exceeds the precision of numbers.");
+
+        k = next;
+        if (upper.lower() < k)
+            result = TInterval<T>::hull(result, partial);
+    }
+
+    FResult = result;
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TLetNode<T> *ANode) {
+    // the value is an interval of its own, so using it twice isn't sharper
+    // than writing it out twice (the dependency problem remains)
+    const TInterval<T> value(calculate(ANode->value()));
+
+    FBindings.push_back(TBinding(ANode->name(), value));
+    FResult = calculate(ANode->body());
+    FBindings.pop_back();
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TEquNode<T> *ANode) {
+    const TInterval<T> a(calculate(ANode->left())), b(calculate(ANode->right()));
+
+    FResult = a.isEmpty() || b.isEmpty() ? TInterval<T>::empty()
+        : truth(a.isPoint() && b.isPoint() && a.lower() == b.lower(),
+                a.upper() < b.lower() || b.upper() < a.lower());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TUnEquNode<T> *ANode) {
+    const TInterval<T> a(calculate(ANode->left())), b(calculate(ANode->right()));
+
+    FResult = a.isEmpty() || b.isEmpty() ? TInterval<T>::empty()
+        : truth(a.upper() < b.lower() || b.upper() < a.lower(),
+                a.isPoint() && b.isPoint() && a.lower() == b.lower());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TGreaterNode<T> *ANode) {
+    const TInterval<T> a(calculate(ANode->left())), b(calculate(ANode->right()));
+
+    FResult = a.isEmpty() || b.isEmpty() ? TInterval<T>::empty()
+        : truth(a.lower() > b.upper(), a.upper() <= b.lower());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TLessNode<T> *ANode) {
+    const TInterval<T> a(calculate(ANode->left())), b(calculate(ANode->right()));
+
+    FResult = a.isEmpty() || b.isEmpty() ? TInterval<T>::empty()
+        : truth(a.upper() < b.lower(), a.lower() >= b.upper());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TGreaterEquNode<T> *ANode) {
+    const TInterval<T> a(calculate(ANode->left())), b(calculate(ANode->right()));
+
+    FResult = a.isEmpty() || b.isEmpty() ? TInterval<T>::empty()
+        : truth(a.lower() >= b.upper(), a.upper() < b.lower());
+}
+
+template<class T>
+void TIntervalCalculator<T>::visit(TLessEquNode<T> *ANode) {
+    const TInterval<T> a(calculate(ANode->left())), b(calculate(ANode->right()));
+
+    FResult = a.isEmpty() || b.isEmpty() ? TInterval<T>::empty()
+        : truth(a.upper() <= b.lower(), a.lower() > b.upper());
+}
+
+} // namespace math
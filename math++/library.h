@@ -24,37 +24,57 @@
 #define libmath_library_h
 
 #include <math++/error.h>
+#include <math++/thread.h>
 
 #include <list>
 #include <map>
+#include <set>
+#include <vector>
 #include <string>
 
 namespace math {
 
 template<class> class TNode;
 template<class> class TLibrary;
+template<class> class TSerializer;
+template<class> class TSnapshot;
+template<class> class TCodeGenerator;
 
 /**
   * TFunction<> is used for multiple function management as done by TLibrary<>.
+  * Its first parameter is always x, further ones may be named by a list
+  * such as "x, y, z" and get bound to the further arguments of a call.
   */
 template<typename T>
 class TFunction {
 private:
     std::string FName;
+    std::vector<std::string> FParams;   // the parameters following x
     TNode<T> *FExpression;
 
+    friend class TLibrary<T>;
+
 public:
     TFunction();
     TFunction(const TFunction<T>&);
     TFunction(const std::string& AName, const std::string& AExprStr = std::string());
     TFunction(const std::string& AName, const TNode<T> *AExprTree);
+    /// creates a function of the parameters AParams, e.g. "x, y"
+    TFunction(const std::string& AName, const std::string& AParams, const std::string& AExprStr);
     ~TFunction();
 
+    TFunction<T>& operator=(const TFunction<T>&);
+
     T call(const T& AParam, const TLibrary<T>& ALibrary, unsigned ALimit = 64) const;
 
     void name(const std::string&);
     std::string name() const;
 
+    /// sets the parameters following x, their names must not be built-ins
+    void params(const std::vector<std::string>&);
+    /// returns the parameters following x (empty for functions of x only)
+    const std::vector<std::string>& params() const;
+
     void expression(const TNode<T> *ACopyOf);
     void expression(const std::string& AExprStr);
     TNode<T> *expression() const;
@@ -81,6 +101,72 @@ public:
     T value() const;
 };
 
+/**
+  * ETableError is thrown by TTable<> if the tabulated data is unusable.
+  */
+class ETableError : public EMath {
+public:
+    ETableError(const std::string& AMsg) : EMath(AMsg) {}
+};
+
+/**
+  * TTable<> holds tabulated data (x[i], y[i]) for the TABLE(name, x) node, 
+  * interpolated piecewise linear or by a natural cubic spline. The x values 
+  * must be strictly increasing. A lookup takes O(log n), or O(1) if the x 
+  * values form a uniform grid (for float, double and long double).
+  * Outside the table the curve continues with the end values.
+  */
+template<typename T>
+class TTable {
+public:
+    enum TInterpolation { LINEAR, CUBIC };
+
+private:
+    std::string FName;
+    TInterpolation FInterpolation;
+    std::vector<T> FX;
+    std::vector<T> FY;
+    std::vector<T> FSecond;     // the spline's second derivatives at FX (CUBIC only)
+    T FStep;                    // the grid width, or 0 if the grid isn't uniform
+
+    /// checks the data and computes the spline
+    void setup();
+    /// returns the i with x[i] <= AX < x[i + 1] for AX inside the table
+    unsigned segment(const T& AX) const;
+    /// returns the AOrder-th derivative of the segment AIndex at AX
+    T piece(unsigned AIndex, const T& AX, unsigned AOrder) const;
+    /// updates AMin and AMax by the segment AIndex's extrema within [ALower, AUpper]
+    void extrema(unsigned AIndex, const T& ALower, const T& AUpper, unsigned AOrder,
+        T& AMin, T& AMax) const;
+
+    /// sets AIndex to floor(AOffset) if T allows to, returns false otherwise
+    static bool grid(const T& AOffset, unsigned& AIndex);
+    /// widens [AMin, AMax] to contain AValue
+    static void include(const T& AValue, T& AMin, T& AMax);
+
+public:
+    /// creates the table y[i] = f(x[i])
+    TTable(const std::string& AName, const std::vector<T>& AX, const std::vector<T>& AY,
+        TInterpolation AInterpolation = LINEAR);
+    /// creates the table y[i] = f(AFirst + i AStep)
+    TTable(const std::string& AName, const T& AFirst, const T& AStep, const std::vector<T>& AY,
+        TInterpolation AInterpolation = LINEAR);
+
+    void name(const std::string&);
+    std::string name() const;
+
+    TInterpolation interpolation() const;
+    const std::vector<T>& x() const;
+    const std::vector<T>& y() const;
+
+    /// returns the interpolated value (AOrder = 0) or its AOrder-th derivative at AX
+    T value(const T& AX, unsigned AOrder = 0) const;
+    /// computes value(x, AOrder) for each x in [ABegin, AEnd)
+    void calculate(const T *ABegin, const T *AEnd, T *AResult, unsigned AOrder = 0) const;
+    /// sets [AMin, AMax] to the range of value(x, AOrder) over x in [ALower, AUpper]
+    void range(const T& ALower, const T& AUpper, unsigned AOrder, T& AMin, T& AMax) const;
+};
+
 /**
   * ELibraryLookup is thrown by the TLibrary<> class when ever any lookup fails
   * or any elements in a library are found multiple.
@@ -93,53 +179,123 @@ public:
 
 /**
   * TLibrary<> is used to manage multiple functions and constants
-  * to be shared and to be called each other.
+  * to be shared and to be called each other, and the tables they look up.
   * Note, that you can't have a function called f and a constant called f.
+  * Tables have names of their own, so a table may be called f as well.
   */
 template<typename T>
 class TLibrary {
 private:
     typedef std::list<TFunction<T> > TFunctionList;
     typedef std::list<TConstant<T> > TConstantList;
+    typedef std::list<TTable<T> > TTableList;
+    typedef std::map<std::string, typename TFunctionList::iterator> TFunctionIndex;
+    typedef std::map<std::string, typename TConstantList::iterator> TConstantIndex;
+    typedef std::map<std::string, typename TTableList::iterator> TTableIndex;
     
     TFunctionList FFunctions;
     TConstantList FConstants;
+    TTableList FTables;
+    TFunctionIndex FFunctionIndex;  // the functions by name
+    TConstantIndex FConstantIndex;  // the constants by name
+    TTableIndex FTableIndex;        // the tables by name
+
+    /// TDerivatives holds the already computed derivatives of one function
+    struct TDerivatives {
+        std::vector<TNode<T> *> orders;     // the expression and its derivatives
+        std::set<std::string> depends;      // functions it (indirectly) calls
+    };
+    typedef std::map<std::string, TDerivatives> TDerivativeCache;
+
+    mutable TDerivativeCache FDerivatives;
+    mutable TMutex FMutex;      // guards FDerivatives
+
+    friend class TSerializer<T>;
+    friend class TSnapshot<T>;
+    friend class TCodeGenerator<T>;
 
     void removeIf(const std::string& AName, bool AReplaceIfExists);
+    /// rebuilds the name indices
+    void reindex();
+
+    /// drops all cached derivatives depending on the element AName
+    void invalidate(const std::string& AName);
+    /// drops all cached derivatives
+    void invalidate();
+    /// collects the functions called by the expression (and their callees)
+    void dependencies(const TNode<T> *AExpression, std::set<std::string>& AResult) const;
 
 public:
     TLibrary();
     TLibrary(const TLibrary<T>&);
+    ~TLibrary();
+
+    TLibrary<T>& operator=(const TLibrary<T>&);
 
     /// inserts given function into library, it throws if it's duplicated
     void insert(const TFunction<T>&, bool AReplaceIfExists = false);
     /// inserts given constant into library, it throws if it's duplicated
     void insert(const TConstant<T>&, bool AReplaceIfExists = false);
+    /// inserts given table into library, it throws if it's duplicated
+    void insert(const TTable<T>&, bool AReplaceIfExists = false);
+
+    /**
+      * inserts a function called AName, taking over the ownership of the 
+      * expression AExpression (instead of copying it). It throws if it's 
+      * duplicated, in which case AExpression is left to the caller.
+      */
+    void insert(const std::string& AName, TNode<T> *AExpression, bool AReplaceIfExists = false);
+    /// inserts a function of x and the parameters AParams just as above
+    void insert(const std::string& AName, const std::vector<std::string>& AParams,
+        TNode<T> *AExpression, bool AReplaceIfExists = false);
 
     /// removes function or constant called AName
     void remove(const std::string& AName);
+    /// removes the table called AName
+    void removeTable(const std::string& AName);
 
     /// returns reference to requested function, throws if not found
     TFunction<T> function(const std::string& AName) const;
+    /// returns the function AName (without copying it) or 0 if there's none
+    const TFunction<T> *find(const std::string& AName) const;
 
     /// returns reference to requested constant, throws if not fuond
     TConstant<T> constant(const std::string& AName) const;
 
+    /// returns the table AName (without copying it) or 0 if there's none
+    const TTable<T> *findTable(const std::string& AName) const;
+    /// returns the table AName (without copying it), throws if not found
+    const TTable<T>& table(const std::string& AName) const;
+
     /// returns true, if function (AName) exists
     bool hasFunction(const std::string& AName) const;
 
     /// returns true, if constant (AName) exists
     bool hasConstant(const std::string& AName) const;
 
+    /// returns true, if table (AName) exists
+    bool hasTable(const std::string& AName) const;
+
     /// call() looks for a function AName calls it using AParam and returns its result. It throws on lookup error.
     T call(const std::string& AName, const T& AParam) const;
     /// value() look for a constant AName and returns its value. It throws on lookup error.
     T value(const std::string& AName) const;
 
+    /**
+      * returns the simplified ACount-th derivative of the function AName.
+      * Derivatives are computed once on demand and then shared, also among
+      * threads. The result stays valid until the function itself, or any 
+      * function it calls, gets replaced or removed, so don't do that while
+      * the result is still in use, by this thread or any other one.
+      */
+    const TNode<T> *derivative(const std::string& AName, unsigned ACount = 1) const;
+
     /// returns the number of functions stored in this library.
     unsigned functions() const;
     /// returns the number of constants stored in this library.
     unsigned constants() const;
+    /// returns the number of tables stored in this library.
+    unsigned tables() const;
 };
 
 } // namespace math
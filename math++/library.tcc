@@ -24,8 +24,12 @@
 #include <math++/reader.h>
 #include <math++/printer.h>
 #include <math++/calculator.h>
+#include <math++/derive.h>
+#include <math++/simplifier.h>
 
+#include <algorithm>
 #include <iostream>
+#include <cmath>
 
 namespace math {
 
@@ -40,7 +44,8 @@ TFunction<T>::TFunction() :
 
 template<typename T>
 TFunction<T>::TFunction(const TFunction& ACopy) : 
-    FName(ACopy.FName), FExpression(ACopy.FExpression->clone()) {
+    FName(ACopy.FName), FParams(ACopy.FParams),
+    FExpression(ACopy.FExpression ? ACopy.FExpression->clone() : 0) {
 }
 
 template<typename T>
@@ -55,6 +60,15 @@ TFunction<T>::TFunction(const std::string& AName, const TNode<T> *ACopyOf) :
     FName(AName), FExpression(ACopyOf->clone()) {
 }
 
+template<typename T>
+TFunction<T>::TFunction(const std::string& AName, const std::string& AParams,
+    const std::string& AExprStr) :
+    FName(AName), FExpression(0) {
+
+    TReader<T>::parseParams(AParams.data(), AParams.data() + AParams.size(), FParams);
+    expression(AExprStr);
+}
+
 template<typename T>
 TFunction<T>::~TFunction() {
     // FExpression is either 0 or contains valid allocated data
@@ -62,6 +76,19 @@ TFunction<T>::~TFunction() {
     delete FExpression;
 }
 
+template<typename T>
+TFunction<T>& TFunction<T>::operator=(const TFunction<T>& ACopy) {
+    if (this != &ACopy) {
+        TNode<T> *expr = ACopy.FExpression ? ACopy.FExpression->clone() : 0;
+
+        delete FExpression;
+        FExpression = expr;
+        FName = ACopy.FName;
+        FParams = ACopy.FParams;
+    }
+    return *this;
+}
+
 template<typename T>
 T TFunction<T>::call(const T& AParam, const TLibrary<T>& ALibrary, 
     unsigned ALimit) const {
@@ -79,6 +106,24 @@ std::string TFunction<T>::name() const {
     return FName;
 }
 
+template<typename T>
+void TFunction<T>::params(const std::vector<std::string>& AParams) {
+    std::vector<std::string> params;
+
+    // checked just as if read from a list, e.g. "x, y"
+    std::string list("x");
+    for (unsigned i = 0; i < AParams.size(); ++i)
+        list += ", " + AParams[i];
+
+    TReader<T>::parseParams(list.data(), list.data() + list.size(), params);
+    FParams.swap(params);
+}
+
+template<typename T>
+const std::vector<std::string>& TFunction<T>::params() const {
+    return FParams;
+}
+
 template<typename T>
 void TFunction<T>::expression(const TNode<T> *ACopyOf) {
     delete FExpression;
@@ -90,7 +135,7 @@ void TFunction<T>::expression(const std::string& AExprStr) {
     delete FExpression;
 
     try {
-        FExpression = math::TReader<double>::parse(AExprStr);
+        FExpression = math::TReader<T>::parse(AExprStr);
     } catch (...) {
         // set FExpression to zero if parser has thrown...
         FExpression = 0;
@@ -141,6 +186,311 @@ T TConstant<T>::value() const {
     return FValue;
 }
 
+///////////////////////////////////////////////////////////////////////
+// TTable<>                                                          //
+///////////////////////////////////////////////////////////////////////
+
+template<typename T>
+TTable<T>::TTable(const std::string& AName, const std::vector<T>& AX, const std::vector<T>& AY,
+    TInterpolation AInterpolation) :
+    FName(AName), FInterpolation(AInterpolation), FX(AX), FY(AY), FStep(0) {
+
+    setup();
+}
+
+template<typename T>
+TTable<T>::TTable(const std::string& AName, const T& AFirst, const T& AStep,
+    const std::vector<T>& AY, TInterpolation AInterpolation) :
+    FName(AName), FInterpolation(AInterpolation), FY(AY), FStep(0) {
+
+    FX.reserve(AY.size());
+    for (unsigned i = 0; i < AY.size(); ++i)
+        FX.push_back(AFirst + T(i) * AStep);
+
+    setup();
+}
+
+template<typename T>
+void TTable<T>::setup() {
+    if (FX.size() != FY.size())
+        throw ETableError("Table " + FName + " has not as many x values as y values.");
+
+    if (FX.size() < 2)
+        throw ETableError("Table " + FName + " needs at least two points.");
+
+    for (unsigned i = 0; i + 1 < FX.size(); ++i)
+        if (!(FX[i] < FX[i + 1]))
+            throw ETableError("Table " + FName + " has x values not strictly increasing.");
+
+    // a grid counts as uniform if the guessed segment is off by one at most
+    const unsigned n = FX.size();
+    const T step = (FX[n - 1] - FX[0]) / T(n - 1);
+    bool uniform = true;
+
+    for (unsigned i = 1; i + 1 < n && uniform; ++i) {
+        const T d = FX[i] - (FX[0] + T(i) * step);
+        uniform = d < step / T(1000) && -d < step / T(1000);
+    }
+    FStep = uniform ? step : T(0);
+
+    FSecond.clear();
+    if (FInterpolation != CUBIC)
+        return;
+
+    // the natural spline: tridiagonal system, second derivatives 0 at both ends
+    std::vector<T> u(n, T(0));
+    FSecond.assign(n, T(0));
+
+    for (unsigned i = 1; i + 1 < n; ++i) {
+        const T sig = (FX[i] - FX[i - 1]) / (FX[i + 1] - FX[i - 1]);
+        const T p = sig * FSecond[i - 1] + T(2);
+
+        FSecond[i] = (sig - T(1)) / p;
+        u[i] = (FY[i + 1] - FY[i]) / (FX[i + 1] - FX[i]) - (FY[i] - FY[i - 1]) / (FX[i] - FX[i - 1]);
+        u[i] = (T(6) * u[i] / (FX[i + 1] - FX[i - 1]) - sig * u[i - 1]) / p;
+    }
+
+    for (unsigned i = n - 2; i > 0; --i)
+        FSecond[i] = FSecond[i] * FSecond[i + 1] + u[i];
+}
+
+template<typename T>
+bool TTable<T>::grid(const T&, unsigned&) {
+    return false;
+}
+
+template<>
+inline bool TTable<float>::grid(const float& AOffset, unsigned& AIndex) {
+    AIndex = AOffset > 0 ? unsigned(AOffset) : 0;
+    return true;
+}
+
+template<>
+inline bool TTable<double>::grid(const double& AOffset, unsigned& AIndex) {
+    AIndex = AOffset > 0 ? unsigned(AOffset) : 0;
+    return true;
+}
+
+template<>
+inline bool TTable<long double>::grid(const long double& AOffset, unsigned& AIndex) {
+    AIndex = AOffset > 0 ? unsigned(AOffset) : 0;
+    return true;
+}
+
+template<typename T>
+unsigned TTable<T>::segment(const T& AX) const {
+    const unsigned last = FX.size() - 2;
+    unsigned i;
+
+    if (FStep != T(0) && grid((AX - FX[0]) / FStep, i)) {
+        if (i > last)
+            i = last;
+
+        // the guess may be off by one due to rounding
+        while (i > 0 && AX < FX[i])
+            --i;
+        while (i < last && !(AX < FX[i + 1]))
+            ++i;
+
+        return i;
+    }
+
+    return std::upper_bound(FX.begin() + 1, FX.end() - 1, AX) - FX.begin() - 1;
+}
+
+template<typename T>
+T TTable<T>::piece(unsigned AIndex, const T& AX, unsigned AOrder) const {
+    const T h = FX[AIndex + 1] - FX[AIndex];
+    const T b = (AX - FX[AIndex]) / h;
+    const T a = T(1) - b;
+    const T& y0 = FY[AIndex];
+    const T& y1 = FY[AIndex + 1];
+
+    if (FInterpolation == LINEAR) {
+        switch (AOrder) {
+            case 0: return a * y0 + b * y1;
+            case 1: return (y1 - y0) / h;
+            default: return T(0);
+        }
+    }
+
+    const T& m0 = FSecond[AIndex];
+    const T& m1 = FSecond[AIndex + 1];
+
+    switch (AOrder) {
+        case 0:
+            return a * y0 + b * y1 + ((a * a * a - a) * m0 + (b * b * b - b) * m1) * h * h / T(6);
+        case 1:
+            return (y1 - y0) / h - (T(3) * a * a - T(1)) / T(6) * h * m0
+                                 + (T(3) * b * b - T(1)) / T(6) * h * m1;
+        case 2:
+            return a * m0 + b * m1;
+        case 3:
+            return (m1 - m0) / h;
+        default:
+            return T(0);
+    }
+}
+
+template<typename T>
+void TTable<T>::include(const T& AValue, T& AMin, T& AMax) {
+    if (AValue < AMin)
+        AMin = AValue;
+    if (AMax < AValue)
+        AMax = AValue;
+}
+
+template<typename T>
+void TTable<T>::extrema(unsigned AIndex, const T& ALower, const T& AUpper, unsigned AOrder,
+    T& AMin, T& AMax) const {
+
+    include(piece(AIndex, ALower, AOrder), AMin, AMax);
+    include(piece(AIndex, AUpper, AOrder), AMin, AMax);
+
+    // linear pieces and the higher spline derivatives are monotonic
+    if (FInterpolation != CUBIC || AOrder > 1)
+        return;
+
+    const T h = FX[AIndex + 1] - FX[AIndex];
+    const T& m0 = FSecond[AIndex];
+    const T& m1 = FSecond[AIndex + 1];
+
+    // the zeros of the next derivative, as b = (x - x[i]) / h
+    T roots[2];
+    unsigned count = 0;
+
+    if (AOrder == 1) {
+        if (m0 != m1)
+            roots[count++] = m0 / (m0 - m1);
+    } else {
+        // y'(b) = A b^2 + B b + C
+        const T A = h / T(2) * (m1 - m0);
+        const T B = h * m0;
+        const T C = (FY[AIndex + 1] - FY[AIndex]) / h - h * m0 / T(3) - h * m1 / T(6);
+
+        if (A == T(0)) {
+            if (B != T(0))
+                roots[count++] = -C / B;
+        } else {
+            const T d = B * B - T(4) * A * C;
+
+            if (!(d < T(0))) {
+                using std::sqrt;
+                const T q = B < T(0) ? (sqrt(d) - B) / T(2) : -(B + sqrt(d)) / T(2);
+
+                roots[count++] = q / A;
+                if (q != T(0))
+                    roots[count++] = C / q;
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        const T x = FX[AIndex] + roots[i] * h;
+
+        if (ALower < x && x < AUpper)
+            include(piece(AIndex, x, AOrder), AMin, AMax);
+    }
+}
+
+template<typename T>
+void TTable<T>::name(const std::string& AName) {
+    FName = AName;
+}
+
+template<typename T>
+std::string TTable<T>::name() const {
+    return FName;
+}
+
+template<typename T>
+typename TTable<T>::TInterpolation TTable<T>::interpolation() const {
+    return FInterpolation;
+}
+
+template<typename T>
+const std::vector<T>& TTable<T>::x() const {
+    return FX;
+}
+
+template<typename T>
+const std::vector<T>& TTable<T>::y() const {
+    return FY;
+}
+
+template<typename T>
+T TTable<T>::value(const T& AX, unsigned AOrder) const {
+    if (AX != AX)
+        return AX;
+
+    if (AX < FX.front())
+        return AOrder ? T(0) : FY.front();
+
+    if (FX.back() < AX)
+        return AOrder ? T(0) : FY.back();
+
+    return piece(segment(AX), AX, AOrder);
+}
+
+template<typename T>
+void TTable<T>::calculate(const T *ABegin, const T *AEnd, T *AResult, unsigned AOrder) const {
+    const unsigned last = FX.size() - 2;
+    unsigned i = 0;
+
+    for (; ABegin != AEnd; ++ABegin, ++AResult) {
+        const T& x = *ABegin;
+
+        if (x != x || x < FX.front() || FX.back() < x) {
+            *AResult = value(x, AOrder);
+            continue;
+        }
+
+        // sorted parameters mostly stay in the segment or move on to the next
+        if (x < FX[i] || (i < last && !(x < FX[i + 1]))) {
+            if (i < last && FX[i + 1] <= x && (i + 1 == last || x < FX[i + 2]))
+                ++i;
+            else
+                i = segment(x);
+        }
+
+        *AResult = piece(i, x, AOrder);
+    }
+}
+
+template<typename T>
+void TTable<T>::range(const T& ALower, const T& AUpper, unsigned AOrder, T& AMin, T& AMax) const {
+    const T lower = FX.front() < ALower ? ALower : FX.front();
+    const T upper = AUpper < FX.back() ? AUpper : FX.back();
+    bool found = false;
+
+    // the curve is constant outside the table
+    if (ALower < FX.front()) {
+        AMin = AMax = AOrder ? T(0) : FY.front();
+        found = true;
+    }
+    if (FX.back() < AUpper) {
+        const T v = AOrder ? T(0) : FY.back();
+
+        if (found)
+            include(v, AMin, AMax);
+        else
+            AMin = AMax = v;
+        found = true;
+    }
+
+    if (upper < lower)
+        return;
+
+    const unsigned first = segment(lower);
+    const unsigned last = segment(upper);
+
+    if (!found)
+        AMin = AMax = piece(first, lower, AOrder);
+
+    for (unsigned i = first; i <= last; ++i)
+        extrema(i, i == first ? lower : FX[i], i == last ? upper : FX[i + 1], AOrder, AMin, AMax);
+}
+
 ///////////////////////////////////////////////////////////////////////
 // TLibrary<>                                                        //
 ///////////////////////////////////////////////////////////////////////
@@ -152,37 +502,144 @@ TLibrary<T>::TLibrary() {
 template<typename T>
 TLibrary<T>::TLibrary(const TLibrary<T>& ACopyOf) :
     FFunctions(ACopyOf.FFunctions),
-    FConstants(ACopyOf.FConstants) {
+    FConstants(ACopyOf.FConstants),
+    FTables(ACopyOf.FTables) {
+    // the derivative cache isn't copied, it gets rebuilt on demand
+    reindex();
 }
 
 template<typename T>
-void TLibrary<T>::removeIf(const std::string& AName, bool AReplaceIfExists) {
-    for (typename TFunctionList::iterator i = FFunctions.begin(); i != FFunctions.end(); ++i) {
-        if (i->name() == AName) {
-            if (AReplaceIfExists) {
-                FFunctions.erase(i);
-                break;
-            } else
-                throw ELibraryLookup("Can't insert multiple elements with same name: " + AName + ".");
-        }
+TLibrary<T>::~TLibrary() {
+    invalidate();
+}
+
+template<typename T>
+TLibrary<T>& TLibrary<T>::operator=(const TLibrary<T>& ACopyOf) {
+    if (this != &ACopyOf) {
+        invalidate();
+
+        FFunctions = ACopyOf.FFunctions;
+        FConstants = ACopyOf.FConstants;
+        FTables = ACopyOf.FTables;
+        reindex();
+    }
+    return *this;
+}
+
+template<typename T>
+void TLibrary<T>::reindex() {
+    FFunctionIndex.clear();
+    for (typename TFunctionList::iterator i = FFunctions.begin(); i != FFunctions.end(); ++i)
+        FFunctionIndex[i->name()] = i;
+
+    FConstantIndex.clear();
+    for (typename TConstantList::iterator i = FConstants.begin(); i != FConstants.end(); ++i)
+        FConstantIndex[i->name()] = i;
+
+    FTableIndex.clear();
+    for (typename TTableList::iterator i = FTables.begin(); i != FTables.end(); ++i)
+        FTableIndex[i->name()] = i;
+}
+
+template<typename T>
+const TFunction<T> *TLibrary<T>::find(const std::string& AName) const {
+    typename TFunctionIndex::const_iterator i = FFunctionIndex.find(AName);
+
+    return i != FFunctionIndex.end() ? &*i->second : 0;
+}
+
+template<typename T>
+void TLibrary<T>::invalidate(const std::string& AName) {
+    TMutexLocker lock(FMutex);
+
+    typename TDerivativeCache::iterator i = FDerivatives.begin();
+    while (i != FDerivatives.end()) {
+        if (i->first == AName || i->second.depends.count(AName)) {
+            for (unsigned k = 1; k < i->second.orders.size(); ++k)
+                delete i->second.orders[k];
+
+            FDerivatives.erase(i++);
+        } else
+            ++i;
     }
+}
 
-    for (typename TConstantList::iterator i = FConstants.begin(); i != FConstants.end(); ++i) {
-        if (i->name() == AName) {
-            if (AReplaceIfExists) {
-                FConstants.erase(i);
-                break;
-            } else
-                throw ELibraryLookup("Can't insert multiple elements with same name: " + AName + ".");
+template<typename T>
+void TLibrary<T>::invalidate() {
+    TMutexLocker lock(FMutex);
+
+    for (typename TDerivativeCache::iterator i = FDerivatives.begin(); i != FDerivatives.end(); ++i)
+        for (unsigned k = 1; k < i->second.orders.size(); ++k)
+            delete i->second.orders[k];
+
+    FDerivatives.clear();
+}
+
+template<typename T>
+void TLibrary<T>::dependencies(const TNode<T> *AExpression, std::set<std::string>& AResult) const {
+    if (!AExpression)
+        return;
+
+    switch (AExpression->nodeType()) {
+        case TNode<T>::FUNC_NODE: {
+            const TFuncNode<T> *call = static_cast<const TFuncNode<T> *>(AExpression);
+            std::string name(call->name());
+
+            // also walk the callee, unless already done (recursive functions)
+            if (AResult.insert(name).second)
+                if (const TFunction<T> *f = find(name))
+                    dependencies(f->expression(), AResult);
+
+            for (unsigned i = 1; i < call->params(); ++i)
+                dependencies(call->param(i), AResult);
+            break;
         }
+        case TNode<T>::IF_NODE:
+            dependencies(static_cast<const TIfNode<T> *>(AExpression)->condition(), AResult);
+            break;
+        case TNode<T>::SUM_NODE:
+        case TNode<T>::PROD_NODE:
+            dependencies(static_cast<const TSeriesNode<T> *>(AExpression)->body(), AResult);
+            break;
+        default:
+            break;
+    }
+
+    dependencies(AExpression->left(), AResult);
+    dependencies(AExpression->right(), AResult);
+}
+
+template<typename T>
+void TLibrary<T>::removeIf(const std::string& AName, bool AReplaceIfExists) {
+    typename TFunctionIndex::iterator f = FFunctionIndex.find(AName);
+    if (f != FFunctionIndex.end()) {
+        if (!AReplaceIfExists)
+            throw ELibraryLookup("Can't insert multiple elements with same name: " + AName + ".");
+
+        // the cached derivatives refer to the expression
+        invalidate(AName);
+
+        FFunctions.erase(f->second);
+        FFunctionIndex.erase(f);
+    }
+
+    typename TConstantIndex::iterator c = FConstantIndex.find(AName);
+    if (c != FConstantIndex.end()) {
+        if (!AReplaceIfExists)
+            throw ELibraryLookup("Can't insert multiple elements with same name: " + AName + ".");
+
+        FConstants.erase(c->second);
+        FConstantIndex.erase(c);
     }
 }
 
 template<typename T>
 void TLibrary<T>::insert(const TFunction<T>& AFunc, bool AReplaceIfExists) {
     removeIf(AFunc.name(), AReplaceIfExists);
+    invalidate(AFunc.name());
 
     FFunctions.push_back(AFunc);
+    FFunctionIndex[AFunc.name()] = --FFunctions.end();
 }
 
 template<typename T>
@@ -190,79 +647,169 @@ void TLibrary<T>::insert(const TConstant<T>& AConst, bool AReplaceIfExists) {
     removeIf(AConst.name(), AReplaceIfExists);
 
     FConstants.push_back(AConst);
+    FConstantIndex[AConst.name()] = --FConstants.end();
+}
+
+template<typename T>
+void TLibrary<T>::insert(const TTable<T>& ATable, bool AReplaceIfExists) {
+    typename TTableIndex::iterator t = FTableIndex.find(ATable.name());
+    if (t != FTableIndex.end()) {
+        if (!AReplaceIfExists)
+            throw ELibraryLookup("Can't insert multiple tables with same name: " + ATable.name() + ".");
+
+        FTables.erase(t->second);
+        FTableIndex.erase(t);
+    }
+
+    FTables.push_back(ATable);
+    FTableIndex[ATable.name()] = --FTables.end();
+}
+
+template<typename T>
+void TLibrary<T>::insert(const std::string& AName, TNode<T> *AExpression, bool AReplaceIfExists) {
+    insert(AName, std::vector<std::string>(), AExpression, AReplaceIfExists);
+}
+
+template<typename T>
+void TLibrary<T>::insert(const std::string& AName, const std::vector<std::string>& AParams,
+    TNode<T> *AExpression, bool AReplaceIfExists) {
+
+    removeIf(AName, AReplaceIfExists);
+    invalidate(AName);
+
+    FFunctions.push_back(TFunction<T>());
+
+    TFunction<T>& f = FFunctions.back();
+    f.FName = AName;
+    f.FParams = AParams;
+    f.FExpression = AExpression;
+
+    FFunctionIndex[AName] = --FFunctions.end();
 }
 
 template<typename T>
 void TLibrary<T>::remove(const std::string& AName) {
-    for (typename TFunctionList::iterator i = FFunctions.begin(); i != FFunctions.end(); ++i)
-        if (i->name() == AName) {
-            FFunctions.erase(i);
-            return;
-        }
+    invalidate(AName);
 
-    for (typename TConstantList::iterator i = FConstants.begin(); i != FConstants.end(); ++i)
-        if (i->name() == AName) {
-            FConstants.erase(i);
-            return;
-        }
+    typename TFunctionIndex::iterator f = FFunctionIndex.find(AName);
+    if (f != FFunctionIndex.end()) {
+        FFunctions.erase(f->second);
+        FFunctionIndex.erase(f);
+        return;
+    }
+
+    typename TConstantIndex::iterator c = FConstantIndex.find(AName);
+    if (c != FConstantIndex.end()) {
+        FConstants.erase(c->second);
+        FConstantIndex.erase(c);
+        return;
+    }
 
     throw ELibraryLookup("No element found in library called: " + AName + ".");
 }
 
+template<typename T>
+void TLibrary<T>::removeTable(const std::string& AName) {
+    typename TTableIndex::iterator t = FTableIndex.find(AName);
+    if (t == FTableIndex.end())
+        throw ELibraryLookup("No table found in library called: " + AName + ".");
+
+    FTables.erase(t->second);
+    FTableIndex.erase(t);
+}
+
 template<typename T>
 TFunction<T> TLibrary<T>::function(const std::string& AName) const {
-    for (typename TFunctionList::const_iterator i = FFunctions.begin(); i != FFunctions.end(); ++i)
-        if (i->name() == AName)
-            return *i;
+    if (const TFunction<T> *f = find(AName))
+        return *f;
 
     throw ELibraryLookup("No function found in library called: " + AName + ".");
 }
 
 template<typename T>
 TConstant<T> TLibrary<T>::constant(const std::string& AName) const {
-    for (typename TConstantList::const_iterator i = FConstants.begin(); i != FConstants.end(); ++i)
-        if (i->name() == AName)
-            return *i;
+    typename TConstantIndex::const_iterator i = FConstantIndex.find(AName);
+    if (i != FConstantIndex.end())
+        return *i->second;
 
     throw ELibraryLookup("No constant found in library called: " + AName + ".");
 }
 
 template<typename T>
-bool TLibrary<T>::hasFunction(const std::string& AName) const {
-    for (typename TFunctionList::const_iterator i = FFunctions.begin(); i != FFunctions.end(); ++i)
-        if (i->name() == AName)
-            return true;
+const TTable<T> *TLibrary<T>::findTable(const std::string& AName) const {
+    typename TTableIndex::const_iterator i = FTableIndex.find(AName);
 
-    return false;
+    return i != FTableIndex.end() ? &*i->second : 0;
+}
+
+template<typename T>
+const TTable<T>& TLibrary<T>::table(const std::string& AName) const {
+    if (const TTable<T> *t = findTable(AName))
+        return *t;
+
+    throw ELibraryLookup("No table found in library called: " + AName + ".");
+}
+
+template<typename T>
+bool TLibrary<T>::hasFunction(const std::string& AName) const {
+    return FFunctionIndex.find(AName) != FFunctionIndex.end();
 }
 
 template<typename T>
 bool TLibrary<T>::hasConstant(const std::string& AName) const {
-    for (typename TConstantList::const_iterator i = FConstants.begin(); i != FConstants.end(); ++i)
-        if (i->name() == AName)
-            return true;
+    return FConstantIndex.find(AName) != FConstantIndex.end();
+}
 
-    return false;
+template<typename T>
+bool TLibrary<T>::hasTable(const std::string& AName) const {
+    return FTableIndex.find(AName) != FTableIndex.end();
 }
 
 template<typename T>
 T TLibrary<T>::call(const std::string& AName, const T& AParam) const {
-    for (typename TFunctionList::const_iterator i = FFunctions.begin(); i != FFunctions.end(); ++i)
-        if (i->name() == AName)
-            return i->call(AParam, *this);
+    if (const TFunction<T> *f = find(AName))
+        return f->call(AParam, *this);
 
     throw ELibraryLookup("No function found in library called: " + AName + ".");
 }
 
 template<typename T>
 T TLibrary<T>::value(const std::string& AName) const {
-    for (typename TConstantList::const_iterator i = FConstants.begin(); i != FConstants.end(); ++i)
-        if (i->name() == AName)
-            return i->value();
+    typename TConstantIndex::const_iterator i = FConstantIndex.find(AName);
+    if (i != FConstantIndex.end())
+        return i->second->value();
 
     throw ELibraryLookup("No constant found in library called: " + AName + ".");
 }
 
+template<typename T>
+const TNode<T> *TLibrary<T>::derivative(const std::string& AName, unsigned ACount) const {
+    TMutexLocker lock(FMutex);
+
+    typename TDerivativeCache::iterator i = FDerivatives.find(AName);
+    if (i == FDerivatives.end()) {
+        const TFunction<T> *f = find(AName);
+        if (!f)
+            throw ELibraryLookup("No function found in library called: " + AName + ".");
+
+        TDerivatives d;
+        dependencies(f->expression(), d.depends);
+        d.orders.push_back(f->expression());
+
+        i = FDerivatives.insert(std::make_pair(AName, d)).first;
+    }
+
+    // orders[0] refers to the function's own expression, which isn't ours.
+    std::vector<TNode<T> *>& orders = i->second.orders;
+    while (orders.size() <= ACount) {
+        std::auto_ptr<TNode<T> > d(TDeriver<T>::derive(orders.back()));
+
+        orders.push_back(TSimplifier<T>::simplify(d.get()));
+    }
+
+    return orders[ACount];
+}
+
 template<typename T>
 unsigned TLibrary<T>::functions() const {
     return FFunctions.size();
@@ -273,13 +820,22 @@ unsigned TLibrary<T>::constants() const {
     return FConstants.size();
 }
 
+template<typename T>
+unsigned TLibrary<T>::tables() const {
+    return FTables.size();
+}
+
 } // namespace math
 
 template<typename T> 
 std::ostream& operator<<(std::ostream& AOut, const math::TFunction<T>& AFunc) {
-    AOut << AFunc.name()
-         << "(x)=" 
-         << math::TPrinter<double>::print(AFunc.expression());
+    AOut << AFunc.name() << "(x";
+
+    for (unsigned i = 0; i < AFunc.params().size(); ++i)
+        AOut << ", " << AFunc.params()[i];
+
+    AOut << ")=" 
+         << math::TPrinter<T>::print(AFunc.expression());
 
     return AOut;
 }
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the bulk function loader interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_loader_h
+#define libmath_loader_h
+
+#include <math++/error.h>
+
+#include <string>
+#include <vector>
+
+namespace math {
+
+template<class> class TNode;
+template<class> class TLibrary;
+
+/**
+  * TLoadError describes a single line TLoader<> couldn't load.
+  */
+struct TLoadError {
+    unsigned line;          // line number, starting at 1
+    std::string reason;     // what's wrong with it
+
+    TLoadError(unsigned ALine, const std::string& AReason) : line(ALine), reason(AReason) {}
+};
+
+/**
+  * TLoader<> loads function definitions in bulk, one per line, such as:
+  *
+  *   # comment lines and empty lines are skipped
+  *   f(x) = x^2 + 1
+  *   g(x) = f(x) / 2
+  *   h(x, y) = let r = f(x) + f(y) in r / (1 + r)
+  *
+  * The input is parsed in place (files are memory mapped) by multiple 
+  * threads at once, each working on its own range of lines. The parsed 
+  * functions are then inserted into the library in file order.
+  *
+  * Erroneous lines (syntax errors, duplicates) don't abort loading, they 
+  * are reported one by one instead.
+  */
+template<class T>
+class TLoader {
+public:
+    typedef std::vector<TLoadError> TErrors;
+
+    /**
+      * loads all definitions of the file AFileName into ALibrary using 
+      * AThreads threads (0 means one per processor). The failed lines are 
+      * appended to AErrors. Returns the number of loaded functions.
+      */
+    static unsigned load(const std::string& AFileName, TLibrary<T>& ALibrary, 
+        TErrors& AErrors, unsigned AThreads = 0);
+
+    /// loads all definitions of the text [ABegin, AEnd), like above
+    static unsigned load(const char *ABegin, const char *AEnd, TLibrary<T>& ALibrary,
+        TErrors& AErrors, unsigned AThreads = 0);
+
+private:
+    /// TDefinition holds one parsed, not yet inserted function
+    struct TDefinition {
+        unsigned line;          // line number within the chunk
+        const char *name;       // points into the input
+        unsigned nameLength;
+        std::vector<std::string> params;    // the parameters following x
+        TNode<T> *expression;
+    };
+
+    /// TJob parses all lines of one chunk of the input
+    struct TJob {
+        const char *begin;
+        const char *end;
+        unsigned lines;                     // number of lines in this chunk
+        std::vector<TDefinition> definitions;
+        TErrors errors;                     // line numbers within the chunk
+
+        void run();
+    };
+
+    /// parses the line [ABegin, AEnd), returns false if it's no definition
+    static bool parse(const char *ABegin, const char *AEnd, TDefinition& AResult);
+
+    /// orders load errors by line
+    static bool before(const TLoadError& a, const TLoadError& b);
+};
+
+} // namespace math
+
+#include <math++/loader.tcc>
+
+#endif
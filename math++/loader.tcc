@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the bulk function loader template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_loader_h
+#error You may not include math++/loader.tcc directly; include math++/loader.h instead.
+#endif
+
+#include <math++/nodes.h>
+#include <math++/reader.h>
+#include <math++/library.h>
+#include <math++/mapped.h>
+#include <math++/thread.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+
+namespace math {
+
+template<class T>
+unsigned TLoader<T>::load(const std::string& AFileName, TLibrary<T>& ALibrary,
+    TErrors& AErrors, unsigned AThreads) {
+
+    TMappedFile file(AFileName);
+
+    return load(file.begin(), file.end(), ALibrary, AErrors, AThreads);
+}
+
+template<class T>
+unsigned TLoader<T>::load(const char *ABegin, const char *AEnd, TLibrary<T>& ALibrary,
+    TErrors& AErrors, unsigned AThreads) {
+
+    // small inputs aren't worth to be split
+    const unsigned minChunk = 65536;
+    unsigned threads = AThreads ? AThreads : processors();
+
+    const std::size_t size = AEnd - ABegin;
+    if (size / minChunk < threads)
+        threads = size / minChunk + 1;
+
+    // split the input into chunks of whole lines
+    std::vector<TJob> jobs(threads);
+    const char *p = ABegin;
+    for (unsigned i = 0; i < threads; ++i) {
+        jobs[i].begin = p;
+
+        p = i + 1 < threads ? ABegin + size / threads * (i + 1) : AEnd;
+        if (p < jobs[i].begin)
+            p = jobs[i].begin;
+
+        while (p != AEnd && p != ABegin && p[-1] != '\n')
+            ++p;
+
+        jobs[i].end = p;
+    }
+
+    parallel(jobs);
+
+    // insert the functions in file order
+    unsigned result = 0;
+    unsigned line = 0;  // lines of the chunks before
+    TErrors errors;
+
+    for (unsigned i = 0; i < jobs.size(); ++i) {
+        std::vector<TDefinition>& definitions = jobs[i].definitions;
+
+        for (unsigned k = 0; k < definitions.size(); ++k) {
+            TDefinition& d = definitions[k];
+
+            try {
+                ALibrary.insert(std::string(d.name, d.nameLength), d.params, d.expression);
+                ++result;
+            } catch (const EMath& e) {
+                delete d.expression;
+                errors.push_back(TLoadError(line + d.line, e.reason()));
+            }
+        }
+
+        for (unsigned k = 0; k < jobs[i].errors.size(); ++k) {
+            errors.push_back(jobs[i].errors[k]);
+            errors.back().line += line;
+        }
+
+        line += jobs[i].lines;
+    }
+
+    std::stable_sort(errors.begin(), errors.end(), before);
+    AErrors.insert(AErrors.end(), errors.begin(), errors.end());
+
+    return result;
+}
+
+template<class T>
+void TLoader<T>::TJob::run() {
+    lines = 0;
+
+    for (const char *p = begin; p != end; ) {
+        const char *eol = p;
+        while (eol != end && *eol != '\n')
+            ++eol;
+
+        ++lines;
+
+        try {
+            TDefinition d;
+
+            if (parse(p, eol, d)) {
+                d.line = lines;
+                definitions.push_back(d);
+            }
+        } catch (const EMath& e) {
+            errors.push_back(TLoadError(lines, e.reason()));
+        } catch (...) {
+            // anything else must not leave the thread
+            errors.push_back(TLoadError(lines, "Unexpected error."));
+        }
+
+        p = eol != end ? eol + 1 : eol;
+    }
+}
+
+template<class T>
+bool TLoader<T>::parse(const char *ABegin, const char *AEnd, TDefinition& AResult) {
+    const char *p = ABegin;
+
+    // skip spaces (and the carriage return of DOS line ends)
+    while (p != AEnd && std::isspace(static_cast<unsigned char>(*p)))
+        ++p;
+
+    if (p == AEnd || *p == '#')
+        return false;
+
+    // name(x) = or name(x, y, ...) = 
+    AResult.name = p;
+    while (p != AEnd && std::isalpha(static_cast<unsigned char>(*p)))
+        ++p;
+    AResult.nameLength = p - AResult.name;
+
+    while (p != AEnd && std::isspace(static_cast<unsigned char>(*p)))
+        ++p;
+
+    const char *close = p != AEnd && *p == '(' ? std::find(p, AEnd, ')') : AEnd;
+    if (!AResult.nameLength || close == AEnd)
+        throw EReadError("Function definition expected, like f(x)=expr.");
+
+    TReader<T>::parseParams(p + 1, close, AResult.params);
+
+    p = close + 1;
+    while (p != AEnd && std::isspace(static_cast<unsigned char>(*p)))
+        ++p;
+
+    if (p == AEnd || *p != '=')
+        throw EReadError("Function definition expected, like f(x)=expr.");
+    ++p;
+
+    AResult.expression = TReader<T>::parse(p, AEnd);
+    return true;
+}
+
+template<class T>
+bool TLoader<T>::before(const TLoadError& a, const TLoadError& b) {
+    return a.line < b.line;
+}
+
+} // namespace math
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the memory mapped file implementation)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#include <math++/mapped.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace math {
+
+TMappedFile::TMappedFile(const std::string& AFileName, TAccess AAccess) : FData(0), FSize(0) {
+    int fd = open(AFileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw EFileError("Can't open " + AFileName + ": " + std::strerror(errno) + ".");
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int error = errno;
+        close(fd);
+        throw EFileError("Can't stat " + AFileName + ": " + std::strerror(error) + ".");
+    }
+
+    FSize = st.st_size;
+
+    // empty files can't be mapped, but there's nothing to read either
+    if (FSize) {
+        void *data = mmap(0, FSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            throw EFileError("Can't map " + AFileName + ": " + std::strerror(error) + ".");
+        }
+
+        FData = static_cast<const char *>(data);
+
+        madvise(data, FSize, AAccess == acRandom ? MADV_RANDOM : MADV_SEQUENTIAL);
+    }
+
+    // the mapping stays valid without the descriptor
+    close(fd);
+}
+
+TMappedFile::~TMappedFile() {
+    if (FData)
+        munmap(const_cast<char *>(FData), FSize);
+}
+
+} // namespace math
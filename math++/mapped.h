@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the memory mapped file interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_mapped_h
+#define libmath_mapped_h
+
+#include <math++/error.h>
+
+#include <string>
+#include <cstddef>
+
+namespace math {
+
+/**
+  * EFileError is thrown whenever a file can't be opened or read.
+  */
+class EFileError : public EMath {
+public:
+    EFileError(const std::string& AReason) : EMath(AReason) {}
+};
+
+/**
+  * TMappedFile maps a whole file read-only into memory, so it may be
+  * parsed in place without reading (and copying) it first.
+  */
+class TMappedFile {
+private:
+    const char *FData;
+    std::size_t FSize;
+
+    // mappings are not copyable
+    TMappedFile(const TMappedFile&);
+    TMappedFile& operator=(const TMappedFile&);
+
+public:
+    /// tells the system how the mapped file is going to be read
+    enum TAccess { acSequential, acRandom };
+
+    /// maps the file AFileName, throws EFileError on failure
+    explicit TMappedFile(const std::string& AFileName, TAccess AAccess = acSequential);
+    ~TMappedFile();
+
+    /// returns the first byte of the file
+    const char *begin() const { return FData; }
+    /// returns the end of the file (not part of it)
+    const char *end() const { return FData + FSize; }
+    /// returns the size of the file in bytes
+    std::size_t size() const { return FSize; }
+};
+
+} // namespace math
+
+#endif
@@ -225,6 +225,10 @@ private:
 
     virtual void visit(TFuncNode<T> *);
     virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
 
     virtual void visit(TEquNode<T> *);
     virtual void visit(TUnEquNode<T> *);
@@ -299,6 +299,22 @@ template<class T>
 void TMatcher<T>::visit(TIfNode<T> *ANode) {
 }
 
+template<class T>
+void TMatcher<T>::visit(TTableNode<T> *ANode) {
+}
+
+template<class T>
+void TMatcher<T>::visit(TSumNode<T> *ANode) {
+}
+
+template<class T>
+void TMatcher<T>::visit(TProdNode<T> *ANode) {
+}
+
+template<class T>
+void TMatcher<T>::visit(TLetNode<T> *ANode) {
+}
+
 template<class T>
 void TMatcher<T>::visit(TEquNode<T> *ANode) {
 }
@@ -24,6 +24,7 @@
 #define libmath_nodes_h
 
 #include <deque>
+#include <vector>
 #include <string>
 #include <memory>
 
@@ -268,7 +269,14 @@ public:
         TAN_NODE,       // tan(x)                   (prio: -1)
         LN_NODE,        // logn(x)                  (prio: -1)
 
-        IF_NODE         // IF(cond, then, else)     (prio: -1)
+        IF_NODE,        // IF(cond, then, else)     (prio: -1)
+
+        TABLE_NODE,     // TABLE(name, x)           (prio: -1)
+
+        SUM_NODE,       // sum(k, a, b, expr)       (prio: -1)
+        PROD_NODE,      // prod(k, a, b, expr)      (prio: -1)
+
+        LET_NODE        // let v = expr in body     (prio: -15)
     };
 
 private:
@@ -276,6 +284,8 @@ private:
     TNodeType FNodeType;
     /// 0 is highes node priority (the higher the lower)
     short FPriority;
+    /// height of this node's subtree (saturated), tells how to delete it
+    unsigned short FDepth;
     /// contains a pointer to the parent node if any exists, otherwise 0
     TNode<T> *FParent;
 
@@ -287,6 +297,25 @@ protected:
     /// initializes the parent node with the given one
     void parent(TNode<T> *AParent);
 
+    /// updates this node's subtree height to cover the new child AChild
+    void adopt(const TNode<T> *AChild);
+
+    /// returns true if the subtree is too high to be deleted recursively
+    bool deep() const;
+
+    /**
+      * moves the child nodes (at most three) into AChildren and returns their
+      * number. The caller takes over their ownership.
+      */
+    virtual unsigned release(TNode<T> **AChildren);
+
+    /**
+      * deletes given nodes including their children. High subtrees are taken
+      * apart without recursion, so even degenerated trees of millions of 
+      * levels can be deleted.
+      */
+    static void destroy(TNode<T> **ANodes, unsigned ACount);
+
     friend class TUnaryNodeOp<T>;
     friend class TBinaryNodeOp<T>;
 
@@ -328,6 +357,9 @@ public:
 template<typename T> bool operator==(const TNode<T>&, const TNode<T>&);
 template<typename T> bool operator!=(const TNode<T>&, const TNode<T>&);
 
+/// returns true if the symbol ASymbol occurs within AExpression, bound there (by let, sum() or prod()) or not
+template<typename T> bool mentions(const TNode<T> *AExpression, const std::string& ASymbol);
+
 /**
   * TNumberNode<T> represents the node holding a constant value of type T.
   */
@@ -393,7 +425,11 @@ protected:
     /// creates an unary operator node of type AType.
     TUnaryNodeOp(typename TUnaryNodeOp<T>::TNodeType AType, short APriority, TNode<T> *ANode);
 
+    virtual unsigned release(TNode<T> **AChildren);
+
 public:
+    virtual ~TUnaryNodeOp();
+
     /// returns the child node for that unary operator node.
     TNode<T> *node() const;
 
@@ -417,7 +453,11 @@ protected:
     /// creates an binary operator node of type AType
     TBinaryNodeOp(typename TBinaryNodeOp<T>::TNodeType AType, short APrio, TNode<T> *ALeft, TNode<T> *ARight);
 
+    virtual unsigned release(TNode<T> **AChildren);
+
 public:
+    virtual ~TBinaryNodeOp();
+
     /// returns the right child node of the expression tree
     virtual TNode<T> *left() const;
 
@@ -557,23 +597,34 @@ public:
 };
 
 /**
-  * Any user defined function defined in a given library.
-  * If this user defined function can't be displayed
-  * in a graph if it has multiple parameters.
-  * MULTIPLE PARAMETER ARE TO BE DONE!
+  * Any user defined function defined in a given library, called with one
+  * or more arguments. The first one is the child node and gets passed as
+  * the parameter x, the further ones are bound to the function's further
+  * parameters (see TFunction<>::params()).
+  * example: dist(x, y) = sqrt(x^2 + y^2), called as dist(3, 4)
   */
 template<typename T>
 class TFuncNode : public TUnaryNodeOp<T> {
 private:
     std::string FName;
+    std::vector<TNode<T> *> FParams;    // the further arguments (owned)
 
 public:
     TFuncNode(const std::string& AName, TNode<T> *AParam);
+    virtual ~TFuncNode();
 
     std::string name() const;
 
+    /// appends a further argument, taking over its ownership
+    void addParam(TNode<T> *AParam);
+    /// returns the number of arguments, at least one
+    unsigned params() const;
+    /// returns the argument AIndex, param(0) is node()
+    TNode<T> *param(unsigned AIndex) const;
+
     virtual void accept(TNodeVisitor<T>&);
     virtual TFuncNode<T> *clone() const;
+    virtual bool equals(const TNode<T> *ANode) const;
 };
 
 /**
@@ -587,8 +638,12 @@ class TIfNode : public TBinaryNodeOp<T> {
 private:
     std::auto_ptr<TNode<T> > FCondition;
 
+protected:
+    virtual unsigned release(TNode<T> **AChildren);
+
 public:
     TIfNode(TNode<T> *ACondNode, TNode<T> *AThenNode, TNode<T> *AElseNode);
+    virtual ~TIfNode();
 
     TNode<T> *condition() const;
     TNode<T> *trueExpr() const;
@@ -596,6 +651,112 @@ public:
 
     virtual void accept(TNodeVisitor<T>&);
     virtual TIfNode *clone() const;
+    virtual bool equals(const TNode<T> *ANode) const;
+};
+
+/**
+  * TTableNode<> looks its argument up in the table of the given name
+  * found in the library (see TTable<>). A non-zero order gives the
+  * derivative of that order of the interpolated curve instead.
+  * example: rho(x) = TABLE(density, x)
+  */
+template<typename T>
+class TTableNode : public TUnaryNodeOp<T> {
+private:
+    std::string FName;
+    unsigned FOrder;
+
+public:
+    TTableNode(const std::string& AName, TNode<T> *AParam, unsigned AOrder = 0);
+
+    std::string name() const;
+    unsigned order() const;
+
+    virtual void accept(TNodeVisitor<T>&);
+    virtual TTableNode<T> *clone() const;
+    virtual bool equals(const TNode<T> *ANode) const;
+};
+
+/**
+  * TSeriesNode<> is the base of the finite sums and products. The body
+  * gets calculated for the index k = lower, lower + 1, ... as long as
+  * k <= upper, where the index is a symbol bound within the body only.
+  * The bounds are the left and right child, the body is the third one.
+  */
+template<typename T>
+class TSeriesNode : public TBinaryNodeOp<T> {
+private:
+    std::string FIndex;
+    std::auto_ptr<TNode<T> > FBody;
+
+protected:
+    TSeriesNode(typename TSeriesNode<T>::TNodeType AType, const std::string& AIndex,
+        TNode<T> *ALower, TNode<T> *AUpper, TNode<T> *ABody);
+
+    virtual unsigned release(TNode<T> **AChildren);
+
+public:
+    virtual ~TSeriesNode();
+
+    /// returns the name of the index symbol
+    std::string index() const;
+
+    TNode<T> *lower() const;
+    TNode<T> *upper() const;
+    TNode<T> *body() const;
+
+    virtual bool equals(const TNode<T> *ANode) const;
+};
+
+/**
+  * TSumNode<> adds up the body for each index value (an empty sum is 0).
+  * example: zeta2(x) = sum(k, 1, x, 1/k^2)
+  */
+template<typename T>
+class TSumNode : public TSeriesNode<T> {
+public:
+    TSumNode(const std::string& AIndex, TNode<T> *ALower, TNode<T> *AUpper, TNode<T> *ABody);
+
+    virtual void accept(TNodeVisitor<T>&);
+    virtual TSumNode<T> *clone() const;
+};
+
+/**
+  * TProdNode<> multiplies the body for each index value (an empty product is 1).
+  * example: fac(x) = prod(k, 1, x, k)
+  */
+template<typename T>
+class TProdNode : public TSeriesNode<T> {
+public:
+    TProdNode(const std::string& AIndex, TNode<T> *ALower, TNode<T> *AUpper, TNode<T> *ABody);
+
+    virtual void accept(TNodeVisitor<T>&);
+    virtual TProdNode<T> *clone() const;
+};
+
+/**
+  * TLetNode<> binds the value (left child) to a symbol within the body
+  * (right child), so the value gets calculated once, however often the 
+  * body refers to it.
+  * example: f(x) = let u = x^2 + 1 in sin(u) * cos(u)
+  */
+template<typename T>
+class TLetNode : public TBinaryNodeOp<T> {
+private:
+    std::string FName;
+
+public:
+    TLetNode(const std::string& AName, TNode<T> *AValue, TNode<T> *ABody);
+
+    /// returns the name of the bound symbol
+    std::string name() const;
+
+    TNode<T> *value() const;
+    TNode<T> *body() const;
+
+    virtual void accept(TNodeVisitor<T>&);
+    virtual TLetNode<T> *clone() const;
+    virtual bool equals(const TNode<T> *ANode) const;
 };
 
 /**
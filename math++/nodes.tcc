@@ -35,13 +35,14 @@ namespace math {
 // TNode
 template<typename T>
 TNode<T>::TNode(TNodeType ANodeType, short APriority, TNode<T> *AParent) :
-    FNodeType(ANodeType), FPriority(APriority), FParent(AParent) {
+    FNodeType(ANodeType), FPriority(APriority), FDepth(0), FParent(AParent) {
 }
 
 template<typename T>
 TNode<T>::TNode(const TNode<T>& ANode) :
     FNodeType(ANode.FNodeType),
     FPriority(ANode.FPriority),
+    FDepth(ANode.FDepth),
     FParent(ANode.FParent) {
 }
 
@@ -54,6 +55,47 @@ template<typename T>
 TNode<T>::~TNode() {
 }
 
+template<typename T>
+void TNode<T>::adopt(const TNode<T> *AChild) {
+    if (AChild->FDepth >= FDepth && AChild->FDepth != 0xFFFF)
+        FDepth = AChild->FDepth + 1;
+}
+
+template<typename T>
+bool TNode<T>::deep() const {
+    // trees up to this height are just deleted recursively
+    return FDepth >= 256;
+}
+
+template<typename T>
+unsigned TNode<T>::release(TNode<T> **) {
+    // the node doesn't support children by default
+    return 0;
+}
+
+template<typename T>
+void TNode<T>::destroy(TNode<T> **ANodes, unsigned ACount) {
+    // Each node gets deleted after its children have been moved out of it,
+    // so the destructors don't descend. Only the high subtrees are queued.
+    std::vector<TNode<T> *> pending(ANodes, ANodes + ACount);
+
+    while (!pending.empty()) {
+        TNode<T> *node = pending.back();
+        pending.pop_back();
+
+        if (!node->deep()) {
+            delete node;
+            continue;
+        }
+
+        TNode<T> *children[3];
+        unsigned count = node->release(children);
+        delete node;
+
+        pending.insert(pending.end(), children, children + count);
+    }
+}
+
 template<typename T>
 typename TNode<T>::TNodeType TNode<T>::nodeType() const {
     return FNodeType;
@@ -89,6 +131,44 @@ template<typename T> bool operator!=(const TNode<T>& a, const TNode<T>& b) {
     return !(a == b);
 }
 
+template<typename T> bool mentions(const TNode<T> *AExpression, const std::string& ASymbol) {
+    if (!AExpression)
+        return false;
+
+    switch (AExpression->nodeType()) {
+        case TNode<T>::SYMBOL_NODE:
+            return static_cast<const TSymbolNode<T> *>(AExpression)->symbol() == ASymbol;
+        case TNode<T>::FUNC_NODE: {
+            const TFuncNode<T> *call = static_cast<const TFuncNode<T> *>(AExpression);
+
+            for (unsigned i = 1; i < call->params(); ++i)
+                if (mentions(call->param(i), ASymbol))
+                    return true;
+            break;
+        }
+        case TNode<T>::IF_NODE:
+            if (mentions(static_cast<const TIfNode<T> *>(AExpression)->condition(), ASymbol))
+                return true;
+            break;
+        case TNode<T>::SUM_NODE:
+        case TNode<T>::PROD_NODE: {
+            const TSeriesNode<T> *series = static_cast<const TSeriesNode<T> *>(AExpression);
+
+            if (series->index() == ASymbol || mentions(series->body(), ASymbol))
+                return true;
+            break;
+        }
+        case TNode<T>::LET_NODE:
+            if (static_cast<const TLetNode<T> *>(AExpression)->name() == ASymbol)
+                return true;
+            break;
+        default:
+            break;
+    }
+
+    return mentions(AExpression->left(), ASymbol) || mentions(AExpression->right(), ASymbol);
+}
+
 // TNumberNode
 template<typename T>
 TNumberNode<T>::TNumberNode(const T& ANumber) :
@@ -170,6 +250,25 @@ TUnaryNodeOp<T>::TUnaryNodeOp(typename TUnaryNodeOp<T>::TNodeType AType, short A
     TNode<T>(AType, APrio), FNode(ANode) {
     
     FNode->parent(this);
+    this->adopt(ANode);
+}
+
+template<typename T>
+TUnaryNodeOp<T>::~TUnaryNodeOp() {
+    // the children of low trees are deleted by the auto_ptr<>s
+    if (this->deep()) {
+        TNode<T> *children[3];
+        TNode<T>::destroy(children, TUnaryNodeOp<T>::release(children));
+    }
+}
+
+template<typename T>
+unsigned TUnaryNodeOp<T>::release(TNode<T> **AChildren) {
+    if (!FNode.get())
+        return 0;
+
+    AChildren[0] = FNode.release();
+    return 1;
 }
 
 template<typename T>
@@ -198,6 +297,31 @@ TBinaryNodeOp<T>::TBinaryNodeOp(typename TBinaryNodeOp<T>::TNodeType AType, shor
 
     FLeft->parent(this);
     FRight->parent(this);
+
+    this->adopt(ALeft);
+    this->adopt(ARight);
+}
+
+template<typename T>
+TBinaryNodeOp<T>::~TBinaryNodeOp() {
+    // the children of low trees are deleted by the auto_ptr<>s
+    if (this->deep()) {
+        TNode<T> *children[3];
+        TNode<T>::destroy(children, TBinaryNodeOp<T>::release(children));
+    }
+}
+
+template<typename T>
+unsigned TBinaryNodeOp<T>::release(TNode<T> **AChildren) {
+    unsigned count = 0;
+
+    if (FLeft.get())
+        AChildren[count++] = FLeft.release();
+
+    if (FRight.get())
+        AChildren[count++] = FRight.release();
+
+    return count;
 }
 
 template<typename T>
@@ -392,11 +516,33 @@ TFuncNode<T>::TFuncNode(const std::string& AName, TNode<T> *AParam) :
     TUnaryNodeOp<T>(TNode<T>::FUNC_NODE, -1, AParam), FName(AName) {
 }
 
+template<typename T>
+TFuncNode<T>::~TFuncNode() {
+    if (!FParams.empty())
+        TNode<T>::destroy(&FParams[0], FParams.size());
+}
+
 template<typename T>
 std::string TFuncNode<T>::name() const {
     return FName;
 }
 
+template<typename T>
+void TFuncNode<T>::addParam(TNode<T> *AParam) {
+    FParams.push_back(AParam);
+    this->adopt(AParam);
+}
+
+template<typename T>
+unsigned TFuncNode<T>::params() const {
+    return FParams.size() + 1;
+}
+
+template<typename T>
+TNode<T> *TFuncNode<T>::param(unsigned AIndex) const {
+    return AIndex ? FParams[AIndex - 1] : this->node();
+}
+
 template<typename T>
 void TFuncNode<T>::accept(TNodeVisitor<T>& v) {
     v.visit(this);
@@ -404,7 +550,28 @@ void TFuncNode<T>::accept(TNodeVisitor<T>& v) {
 
 template<typename T>
 TFuncNode<T> *TFuncNode<T>::clone() const {
-    return new TFuncNode(FName, this->node()->clone());
+    std::auto_ptr<TFuncNode<T> > result(new TFuncNode(FName, this->node()->clone()));
+
+    for (unsigned i = 0; i < FParams.size(); ++i)
+        result->addParam(FParams[i]->clone());
+
+    return result.release();
+}
+
+template<typename T>
+bool TFuncNode<T>::equals(const TNode<T> *ANode) const {
+    if (!TUnaryNodeOp<T>::equals(ANode))
+        return false;
+
+    const TFuncNode<T> *f = static_cast<const TFuncNode<T> *>(ANode);
+    if (FName != f->FName || FParams.size() != f->FParams.size())
+        return false;
+
+    for (unsigned i = 0; i < FParams.size(); ++i)
+        if (!FParams[i]->equals(f->FParams[i]))
+            return false;
+
+    return true;
 }
 
 // TIfNode
@@ -412,6 +579,26 @@ template<typename T>
 TIfNode<T>::TIfNode(TNode<T> *ACondNode, TNode<T> *AThenNode, TNode<T> *AElseNode) :
     TBinaryNodeOp<T>(TNode<T>::IF_NODE, -1, AThenNode, AElseNode),
     FCondition(ACondNode) {
+
+    this->adopt(ACondNode);
+}
+
+template<typename T>
+TIfNode<T>::~TIfNode() {
+    if (this->deep()) {
+        TNode<T> *children[3];
+        TNode<T>::destroy(children, release(children));
+    }
+}
+
+template<typename T>
+unsigned TIfNode<T>::release(TNode<T> **AChildren) {
+    unsigned count = TBinaryNodeOp<T>::release(AChildren);
+
+    if (FCondition.get())
+        AChildren[count++] = FCondition.release();
+
+    return count;
 }
 
 template<typename T>
@@ -439,6 +626,170 @@ TIfNode<T> *TIfNode<T>::clone() const {
     return new TIfNode(this->FCondition->clone(), this->left()->clone(), this->right()->clone());
 }
 
+template<typename T>
+bool TIfNode<T>::equals(const TNode<T> *ANode) const {
+    return TBinaryNodeOp<T>::equals(ANode) &&
+        FCondition->equals(static_cast<const TIfNode<T> *>(ANode)->FCondition.get());
+}
+
+// TTableNode
+template<typename T>
+TTableNode<T>::TTableNode(const std::string& AName, TNode<T> *AParam, unsigned AOrder) :
+    TUnaryNodeOp<T>(TNode<T>::TABLE_NODE, -1, AParam), FName(AName), FOrder(AOrder) {
+}
+
+template<typename T>
+std::string TTableNode<T>::name() const {
+    return FName;
+}
+
+template<typename T>
+unsigned TTableNode<T>::order() const {
+    return FOrder;
+}
+
+template<typename T>
+void TTableNode<T>::accept(TNodeVisitor<T>& v) {
+    v.visit(this);
+}
+
+template<typename T>
+TTableNode<T> *TTableNode<T>::clone() const {
+    return new TTableNode(FName, this->node()->clone(), FOrder);
+}
+
+template<typename T>
+bool TTableNode<T>::equals(const TNode<T> *ANode) const {
+    return TUnaryNodeOp<T>::equals(ANode) &&
+        FName == static_cast<const TTableNode<T> *>(ANode)->FName &&
+        FOrder == static_cast<const TTableNode<T> *>(ANode)->FOrder;
+}
+
+// TSeriesNode
+template<typename T>
+TSeriesNode<T>::TSeriesNode(typename TSeriesNode<T>::TNodeType AType, const std::string& AIndex,
+    TNode<T> *ALower, TNode<T> *AUpper, TNode<T> *ABody) :
+    TBinaryNodeOp<T>(AType, -1, ALower, AUpper), FIndex(AIndex), FBody(ABody) {
+
+    this->adopt(ABody);
+}
+
+template<typename T>
+TSeriesNode<T>::~TSeriesNode() {
+    if (this->deep()) {
+        TNode<T> *children[3];
+        TNode<T>::destroy(children, release(children));
+    }
+}
+
+template<typename T>
+unsigned TSeriesNode<T>::release(TNode<T> **AChildren) {
+    unsigned count = TBinaryNodeOp<T>::release(AChildren);
+
+    if (FBody.get())
+        AChildren[count++] = FBody.release();
+
+    return count;
+}
+
+template<typename T>
+std::string TSeriesNode<T>::index() const {
+    return FIndex;
+}
+
+template<typename T>
+TNode<T> *TSeriesNode<T>::lower() const {
+    return this->left();
+}
+
+template<typename T>
+TNode<T> *TSeriesNode<T>::upper() const {
+    return this->right();
+}
+
+template<typename T>
+TNode<T> *TSeriesNode<T>::body() const {
+    return FBody.get();
+}
+
+template<typename T>
+bool TSeriesNode<T>::equals(const TNode<T> *ANode) const {
+    return TBinaryNodeOp<T>::equals(ANode) &&
+        FIndex == static_cast<const TSeriesNode<T> *>(ANode)->FIndex &&
+        FBody->equals(static_cast<const TSeriesNode<T> *>(ANode)->FBody.get());
+}
+
+// TSumNode
+template<typename T>
+TSumNode<T>::TSumNode(const std::string& AIndex, TNode<T> *ALower, TNode<T> *AUpper, TNode<T> *ABody) :
+    TSeriesNode<T>(TNode<T>::SUM_NODE, AIndex, ALower, AUpper, ABody) {
+}
+
+template<typename T>
+void TSumNode<T>::accept(TNodeVisitor<T>& v) {
+    v.visit(this);
+}
+
+template<typename T>
+TSumNode<T> *TSumNode<T>::clone() const {
+    return new TSumNode(this->index(), this->lower()->clone(), this->upper()->clone(),
+        this->body()->clone());
+}
+
+// TProdNode
+template<typename T>
+TProdNode<T>::TProdNode(const std::string& AIndex, TNode<T> *ALower, TNode<T> *AUpper, TNode<T> *ABody) :
+    TSeriesNode<T>(TNode<T>::PROD_NODE, AIndex, ALower, AUpper, ABody) {
+}
+
+template<typename T>
+void TProdNode<T>::accept(TNodeVisitor<T>& v) {
+    v.visit(this);
+}
+
+template<typename T>
+TProdNode<T> *TProdNode<T>::clone() const {
+    return new TProdNode(this->index(), this->lower()->clone(), this->upper()->clone(),
+        this->body()->clone());
+}
+
+// TLetNode
+template<typename T>
+TLetNode<T>::TLetNode(const std::string& AName, TNode<T> *AValue, TNode<T> *ABody) :
+    TBinaryNodeOp<T>(TNode<T>::LET_NODE, -15, AValue, ABody), FName(AName) {
+}
+
+template<typename T>
+std::string TLetNode<T>::name() const {
+    return FName;
+}
+
+template<typename T>
+TNode<T> *TLetNode<T>::value() const {
+    return this->left();
+}
+
+template<typename T>
+TNode<T> *TLetNode<T>::body() const {
+    return this->right();
+}
+
+template<typename T>
+void TLetNode<T>::accept(TNodeVisitor<T>& v) {
+    v.visit(this);
+}
+
+template<typename T>
+TLetNode<T> *TLetNode<T>::clone() const {
+    return new TLetNode(FName, this->value()->clone(), this->body()->clone());
+}
+
+template<typename T>
+bool TLetNode<T>::equals(const TNode<T> *ANode) const {
+    return TBinaryNodeOp<T>::equals(ANode) &&
+        FName == static_cast<const TLetNode<T> *>(ANode)->FName;
+}
+
 // TEquNode
 template<typename T>
 TEquNode<T>::TEquNode(TNode<T> *ALeft, TNode<T> *ARight) :
@@ -0,0 +1,186 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the polynomial and its root finder)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_polynomial_h
+#define libmath_polynomial_h
+
+#include <math++/visitor.h>
+#include <math++/nodes.h>
+#include <math++/library.h>
+
+#include <complex>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace math {
+
+/**
+  * TPolynomial<> is a polynomial in x with coefficients of type T, stored
+  * densely, the constant one first.
+  *
+  * detect() tells whether an expression tree is a polynomial in x and 
+  * computes its coefficients. Symbols and subexpressions not depending 
+  * on x are calculated, and calls of library functions being polynomials 
+  * themselves are substituted.
+  *
+  * roots() finds all complex roots at once using the Aberth-Ehrlich 
+  * iteration. Each step calculates p/p' at all roots in a single Horner 
+  * pass, which loops over the roots innermost, so it may be vectorized.
+  * Roots are evaluated on the reversed polynomial where |z| > 1, so large 
+  * degrees don't overflow.
+  *
+  * roots() requires T to be float, double or long double.
+  */
+template<class T>
+class TPolynomial {
+public:
+    typedef std::complex<T> TComplex;
+
+    struct TRoots {
+        std::vector<TComplex> roots;
+        unsigned iterations;
+        bool converged;
+    };
+
+    /// creates the zero polynomial
+    TPolynomial();
+    /// creates the polynomial of given coefficients, the constant one first
+    explicit TPolynomial(const std::vector<T>& ACoefficients);
+
+    /**
+      * returns true, if AExpression is a polynomial in x, whose 
+      * coefficients are stored into AResult then.
+      */
+    static bool detect(const TNode<T> *AExpression, const TLibrary<T>& ALibrary,
+        TPolynomial<T>& AResult);
+
+    /// returns the degree, 0 for the zero polynomial
+    unsigned degree() const;
+    /// returns the coefficients, the constant one first
+    const std::vector<T>& coefficients() const;
+
+    /// returns p(x)
+    T operator()(const T& x) const;
+    /// calculates p(x) for each x of [ABegin, AEnd) into AResult
+    void calculate(const T *ABegin, const T *AEnd, T *AResult) const;
+
+    /// returns the derivative p'
+    TPolynomial<T> derivative() const;
+
+    /// finds all roots of the polynomial (returns no roots for constants)
+    TRoots roots(unsigned AMaxIterations = 500) const;
+
+    /// finds the roots of each polynomial in [ABegin, AEnd) into AResult, by AThreads threads
+    static void roots(const TPolynomial<T> *ABegin, const TPolynomial<T> *AEnd,
+        TRoots *AResult, unsigned AThreads = 1, unsigned AMaxIterations = 500);
+
+private:
+    std::vector<T> FCoefficients;   // without leading zeros
+
+    /// removes leading zero coefficients
+    void trim();
+
+    static void add(const std::vector<T>& a, const std::vector<T>& b, std::vector<T>& AResult);
+    static void multiply(const std::vector<T>& a, const std::vector<T>& b, std::vector<T>& AResult);
+
+    /**
+      * calculates p(z)/p'(z) and the bound of p(z)'s rounding error at each 
+      * of the ACount roots AReal + i*AImag, into ARatio and AConverged.
+      * ACoefficients are those of p, or of the reversed p if AReversed.
+      */
+    static void ratios(const std::vector<T>& ACoefficients, bool AReversed, unsigned ACount,
+        const T *AReal, const T *AImag, TComplex *ARatio, char *AConverged);
+
+    /// TDetector calculates the coefficients of an expression
+    class TDetector : protected TNodeVisitor<T> {
+    public:
+        TDetector(const TLibrary<T>& ALibrary);
+
+        /// calculates the coefficients of AExpression, returns false if it's no polynomial
+        bool calculate(const TNode<T> *AExpression, std::vector<T>& AResult);
+
+    private:
+        /// a symbol bound by let (or a parameter) with its coefficients
+        typedef std::pair<std::string, std::vector<T> > TBinding;
+
+        const TLibrary<T>& FLibrary;
+        std::map<std::string, unsigned> FRecursions;
+        std::vector<TBinding> FBindings; // innermost last
+        bool FFailed;
+        std::vector<T> FResult;
+
+        /// returns true, if AExpression doesn't depend on x
+        static bool isConstant(const TNode<T> *AExpression);
+        /// calculates the constant ANode, returns false if it isn't (or uses bound symbols)
+        bool constant(const TNode<T> *ANode);
+
+        virtual void visit(TNumberNode<T> *);
+        virtual void visit(TSymbolNode<T> *);
+        virtual void visit(TParamNode<T> *);
+
+        virtual void visit(TPlusNode<T> *);
+        virtual void visit(TNegNode<T> *);
+
+        virtual void visit(TMulNode<T> *);
+        virtual void visit(TDivNode<T> *);
+
+        virtual void visit(TPowNode<T> *);
+        virtual void visit(TSqrtNode<T> *);
+
+        virtual void visit(TSinNode<T> *);
+        virtual void visit(TCosNode<T> *);
+        virtual void visit(TTanNode<T> *);
+        virtual void visit(TLnNode<T> *);
+
+        virtual void visit(TFuncNode<T> *);
+        virtual void visit(TIfNode<T> *);
+        virtual void visit(TTableNode<T> *);
+        virtual void visit(TSumNode<T> *);
+        virtual void visit(TProdNode<T> *);
+        virtual void visit(TLetNode<T> *);
+
+        virtual void visit(TEquNode<T> *);
+        virtual void visit(TUnEquNode<T> *);
+        virtual void visit(TGreaterNode<T> *);
+        virtual void visit(TLessNode<T> *);
+        virtual void visit(TGreaterEquNode<T> *);
+        virtual void visit(TLessEquNode<T> *);
+    };
+
+    friend class TDetector;
+
+    struct TJob {
+        const TPolynomial<T> *begin;
+        const TPolynomial<T> *end;
+        TRoots *result;
+        unsigned maxIterations;
+
+        void run();
+    };
+};
+
+} // namespace math
+
+#include <math++/polynomial.tcc>
+
+#endif
@@ -0,0 +1,695 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the polynomial template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_polynomial_h
+#error You may not include math++/polynomial.tcc directly; include math++/polynomial.h instead.
+#endif
+
+#include <math++/calculator.h>
+#include <math++/thread.h>
+#include <math++/error.h>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace math {
+
+template<class T>
+TPolynomial<T>::TPolynomial() {
+}
+
+template<class T>
+TPolynomial<T>::TPolynomial(const std::vector<T>& ACoefficients) :
+    FCoefficients(ACoefficients) {
+
+    trim();
+}
+
+template<class T>
+bool TPolynomial<T>::detect(const TNode<T> *AExpression, const TLibrary<T>& ALibrary,
+    TPolynomial<T>& AResult) {
+
+    TDetector detector(ALibrary);
+    std::vector<T> coefficients;
+
+    if (!detector.calculate(AExpression, coefficients))
+        return false;
+
+    AResult.FCoefficients.swap(coefficients);
+    AResult.trim();
+    return true;
+}
+
+template<class T>
+unsigned TPolynomial<T>::degree() const {
+    return FCoefficients.empty() ? 0 : FCoefficients.size() - 1;
+}
+
+template<class T>
+const std::vector<T>& TPolynomial<T>::coefficients() const {
+    return FCoefficients;
+}
+
+template<class T>
+T TPolynomial<T>::operator()(const T& x) const {
+    T result = T(0);
+
+    for (unsigned k = FCoefficients.size(); k-- > 0; )
+        result = result * x + FCoefficients[k];
+
+    return result;
+}
+
+template<class T>
+void TPolynomial<T>::calculate(const T *ABegin, const T *AEnd, T *AResult) const {
+    // blocks of points staying in the cache, the points innermost, so the 
+    // loop may be vectorized
+    const unsigned block = 256, size = AEnd - ABegin;
+
+    for (unsigned first = 0; first < size; first += block) {
+        const T *x = ABegin + first;
+        T *y = AResult + first;
+        const unsigned count = std::min(block, size - first);
+
+        std::fill(y, y + count, T(0));
+
+        for (unsigned k = FCoefficients.size(); k-- > 0; ) {
+            const T c = FCoefficients[k];
+
+            for (unsigned i = 0; i < count; ++i)
+                y[i] = y[i] * x[i] + c;
+        }
+    }
+}
+
+template<class T>
+TPolynomial<T> TPolynomial<T>::derivative() const {
+    std::vector<T> result;
+
+    for (unsigned k = 1; k < FCoefficients.size(); ++k)
+        result.push_back(T(k) * FCoefficients[k]);
+
+    return TPolynomial<T>(result);
+}
+
+template<class T>
+void TPolynomial<T>::trim() {
+    while (!FCoefficients.empty() && FCoefficients.back() == T(0))
+        FCoefficients.pop_back();
+}
+
+template<class T>
+void TPolynomial<T>::add(const std::vector<T>& a, const std::vector<T>& b, std::vector<T>& AResult) {
+    std::vector<T> result(std::max(a.size(), b.size()), T(0));
+
+    for (unsigned k = 0; k < a.size(); ++k)
+        result[k] += a[k];
+
+    for (unsigned k = 0; k < b.size(); ++k)
+        result[k] += b[k];
+
+    AResult.swap(result);
+}
+
+template<class T>
+void TPolynomial<T>::multiply(const std::vector<T>& a, const std::vector<T>& b, std::vector<T>& AResult) {
+    std::vector<T> result;
+
+    if (!a.empty() && !b.empty()) {
+        result.assign(a.size() + b.size() - 1, T(0));
+
+        for (unsigned i = 0; i < a.size(); ++i)
+            for (unsigned j = 0; j < b.size(); ++j)
+                result[i + j] += a[i] * b[j];
+    }
+
+    AResult.swap(result);
+}
+
+template<class T>
+void TPolynomial<T>::ratios(const std::vector<T>& ACoefficients, bool AReversed, unsigned ACount,
+    const T *AReal, const T *AImag, TComplex *ARatio, char *AConverged) {
+
+    const unsigned n = ACoefficients.size() - 1;
+
+    std::vector<T> pr(ACount, T(0)), pi(ACount, T(0));     // p(z)
+    std::vector<T> dr(ACount, T(0)), di(ACount, T(0));     // p'(z)
+    std::vector<T> bound(ACount, T(0)), modulus(ACount);
+
+    for (unsigned i = 0; i < ACount; ++i)
+        modulus[i] = std::sqrt(AReal[i] * AReal[i] + AImag[i] * AImag[i]);
+
+    // Horner's scheme, the roots innermost
+    for (unsigned k = n + 1; k-- > 0; ) {
+        const T c = ACoefficients[AReversed ? n - k : k];
+        const T a = std::fabs(c);
+
+        for (unsigned i = 0; i < ACount; ++i) {
+            const T zr = AReal[i], zi = AImag[i];
+            const T qr = pr[i], qi = pi[i];
+
+            const T sr = dr[i] * zr - di[i] * zi + qr;
+            di[i] = dr[i] * zi + di[i] * zr + qi;
+            dr[i] = sr;
+
+            pr[i] = qr * zr - qi * zi + c;
+            pi[i] = qr * zi + qi * zr;
+
+            bound[i] = bound[i] * modulus[i] + a;
+        }
+    }
+
+    const T epsilon = std::numeric_limits<T>::epsilon();
+
+    for (unsigned i = 0; i < ACount; ++i) {
+        const TComplex p(pr[i], pi[i]), d(dr[i], di[i]), z(AReal[i], AImag[i]);
+
+        AConverged[i] = std::abs(p) <= T(2 * n) * epsilon * bound[i];
+
+        if (p == TComplex(0))
+            ARatio[i] = TComplex(0);
+        else if (!AReversed)
+            ARatio[i] = d == TComplex(0) ? p : p / d;
+        else {
+            // z = 1/y: p(z)/p'(z) = 1 / (n y - y^2 q'(y)/q(y)), q being the reversed p
+            const TComplex s = T(n) * z - z * z * (d / p);
+            ARatio[i] = s == TComplex(0) ? p : TComplex(1) / s;
+        }
+    }
+}
+
+template<class T>
+typename TPolynomial<T>::TRoots TPolynomial<T>::roots(unsigned AMaxIterations) const {
+    TRoots result;
+    result.iterations = 0;
+    result.converged = true;
+
+    if (FCoefficients.size() < 2)
+        return result;
+
+    // zero roots first
+    unsigned zeros = 0;
+    while (FCoefficients[zeros] == T(0))
+        ++zeros;
+
+    result.roots.assign(zeros, TComplex(0));
+
+    std::vector<T> c(FCoefficients.begin() + zeros, FCoefficients.end());
+    const unsigned n = c.size() - 1;
+
+    if (!n)
+        return result;
+
+    // start on a circle of the roots' mean modulus, not symmetric to the real axis
+    const T radius = std::pow(std::fabs(c[0] / c[n]), T(1) / T(n));
+    const T pi = std::acos(T(-1));
+
+    std::vector<TComplex> z(n);
+    for (unsigned k = 0; k < n; ++k)
+        z[k] = std::polar(radius, T(2) * pi * k / n + T(0.4));
+
+    const T epsilon = std::numeric_limits<T>::epsilon();
+    std::vector<bool> done(n, false);
+    unsigned left = n;
+
+    std::vector<unsigned> index[2];
+    std::vector<T> real[2], imag[2];
+    std::vector<TComplex> ratio(n);
+    std::vector<char> converged(n);
+
+    while (left && result.iterations < AMaxIterations) {
+        ++result.iterations;
+
+        // roots outside the unit circle use the reversed polynomial at 1/z
+        for (unsigned r = 0; r < 2; ++r) {
+            index[r].clear();
+            real[r].clear();
+            imag[r].clear();
+        }
+
+        for (unsigned i = 0; i < n; ++i) {
+            if (done[i])
+                continue;
+
+            const unsigned r = std::abs(z[i]) > T(1) ? 1 : 0;
+            const TComplex y = r ? TComplex(1) / z[i] : z[i];
+
+            index[r].push_back(i);
+            real[r].push_back(y.real());
+            imag[r].push_back(y.imag());
+        }
+
+        for (unsigned r = 0; r < 2; ++r) {
+            const unsigned count = index[r].size();
+
+            if (!count)
+                continue;
+
+            std::vector<TComplex> q(count);
+            std::vector<char> flags(count);
+
+            ratios(c, r == 1, count, &real[r][0], &imag[r][0], &q[0], &flags[0]);
+
+            for (unsigned j = 0; j < count; ++j) {
+                ratio[index[r][j]] = q[j];
+                converged[index[r][j]] = flags[j];
+            }
+        }
+
+        // Aberth's correction, using the roots updated so far
+        for (unsigned i = 0; i < n; ++i) {
+            if (done[i])
+                continue;
+
+            TComplex sum(0);
+            for (unsigned j = 0; j < n; ++j)
+                if (j != i)
+                    sum += TComplex(1) / (z[i] - z[j]);
+
+            TComplex w = ratio[i] / (TComplex(1) - ratio[i] * sum);
+
+            if (!(std::abs(w) - std::abs(w) == T(0)))
+                w = ratio[i];
+
+            z[i] -= w;
+
+            // one more step after p(z) got as small as its rounding error
+            if (converged[i] || std::abs(w) <= epsilon * std::abs(z[i])) {
+                done[i] = true;
+                --left;
+            }
+        }
+    }
+
+    result.converged = !left;
+    result.roots.insert(result.roots.end(), z.begin(), z.end());
+
+    return result;
+}
+
+template<class T>
+void TPolynomial<T>::TJob::run() {
+    for (const TPolynomial<T> *p = begin; p != end; ++p, ++result)
+        *result = p->roots(maxIterations);
+}
+
+template<class T>
+void TPolynomial<T>::roots(const TPolynomial<T> *ABegin, const TPolynomial<T> *AEnd,
+    TRoots *AResult, unsigned AThreads, unsigned AMaxIterations) {
+
+    const unsigned count = AEnd - ABegin;
+    const unsigned threads = AThreads < 1 ? 1 : AThreads > count ? count : AThreads;
+
+    std::vector<TJob> jobs(threads);
+
+    for (unsigned i = 0; i < threads; ++i) {
+        const unsigned first = count * i / threads, last = count * (i + 1) / threads;
+
+        jobs[i].begin = ABegin + first;
+        jobs[i].end = ABegin + last;
+        jobs[i].result = AResult + first;
+        jobs[i].maxIterations = AMaxIterations;
+    }
+
+    parallel(jobs);
+}
+
+// TDetector
+template<class T>
+TPolynomial<T>::TDetector::TDetector(const TLibrary<T>& ALibrary) :
+    FLibrary(ALibrary), FFailed(false) {
+}
+
+template<class T>
+bool TPolynomial<T>::TDetector::calculate(const TNode<T> *AExpression, std::vector<T>& AResult) {
+    const_cast<TNode<T> *>(AExpression)->accept(*this);
+
+    AResult.swap(FResult);
+    return !FFailed;
+}
+
+template<class T>
+bool TPolynomial<T>::TDetector::isConstant(const TNode<T> *AExpression) {
+    std::vector<const TNode<T> *> pending(1, AExpression);
+
+    while (!pending.empty()) {
+        const TNode<T> *n = pending.back();
+        pending.pop_back();
+
+        if (!n)
+            continue;
+
+        if (n->nodeType() == TNode<T>::PARAM_NODE)
+            return false;
+
+        pending.push_back(n->left());
+        pending.push_back(n->right());
+
+        if (n->nodeType() == TNode<T>::IF_NODE)
+            pending.push_back(static_cast<const TIfNode<T> *>(n)->condition());
+        else if (n->nodeType() == TNode<T>::SUM_NODE || n->nodeType() == TNode<T>::PROD_NODE)
+            pending.push_back(static_cast<const TSeriesNode<T> *>(n)->body());
+        else if (n->nodeType() == TNode<T>::FUNC_NODE) {
+            const TFuncNode<T> *call = static_cast<const TFuncNode<T> *>(n);
+
+            for (unsigned i = 1; i < call->params(); ++i)
+                pending.push_back(call->param(i));
+        }
+    }
+    return true;
+}
+
+template<class T>
+bool TPolynomial<T>::TDetector::constant(const TNode<T> *ANode) {
+    if (!isConstant(ANode))
+        return false;
+
+    // the calculator wouldn't know the symbols bound here
+    for (unsigned i = 0; i < FBindings.size(); ++i)
+        if (mentions(ANode, FBindings[i].first))
+            return false;
+
+    try {
+        FResult.assign(1, TCalculator<T>::calculate(ANode, T(0), FLibrary));
+    } catch (const EMath&) {
+        return false;
+    }
+    return true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TNumberNode<T> *ANode) {
+    FResult.assign(1, ANode->number());
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TSymbolNode<T> *ANode) {
+    const std::string symbol(ANode->symbol());
+
+    for (unsigned i = FBindings.size(); i-- > 0; )
+        if (FBindings[i].first == symbol) {
+            FResult = FBindings[i].second;
+            return;
+        }
+
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TParamNode<T> *ANode) {
+    FResult.assign(2, T(0));
+    FResult[1] = T(1);
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TPlusNode<T> *ANode) {
+    std::vector<T> left, right;
+
+    if (calculate(ANode->left(), left) && calculate(ANode->right(), right))
+        add(left, right, FResult);
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TNegNode<T> *ANode) {
+    if (calculate(ANode->node(), FResult))
+        for (unsigned k = 0; k < FResult.size(); ++k)
+            FResult[k] = -FResult[k];
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TMulNode<T> *ANode) {
+    std::vector<T> left, right;
+
+    if (calculate(ANode->left(), left) && calculate(ANode->right(), right))
+        multiply(left, right, FResult);
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TDivNode<T> *ANode) {
+    std::vector<T> left, right;
+
+    if (!calculate(ANode->left(), left) || !calculate(ANode->right(), right))
+        return;
+
+    // only division by constants keeps it a polynomial
+    while (!right.empty() && right.back() == T(0))
+        right.pop_back();
+
+    if (right.size() != 1) {
+        FFailed = true;
+        return;
+    }
+
+    for (unsigned k = 0; k < left.size(); ++k)
+        left[k] /= right[0];
+
+    FResult.swap(left);
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TPowNode<T> *ANode) {
+    if (constant(ANode))
+        return;
+
+    std::vector<T> base;
+
+    if (!isConstant(ANode->right()) || !calculate(ANode->left(), base)) {
+        FFailed = true;
+        return;
+    }
+
+    T exponent;
+    try {
+        exponent = TCalculator<T>::calculate(ANode->right(), T(0), FLibrary);
+    } catch (const EMath&) {
+        FFailed = true;
+        return;
+    }
+
+    // natural numbers only (found without converting T into an integer)
+    const unsigned limit = 1 << 16;
+
+    if (!(T(0) <= exponent && exponent <= T(limit))) {
+        FFailed = true;
+        return;
+    }
+
+    unsigned lower = 0, upper = limit;
+    while (lower < upper) {
+        const unsigned middle = lower + (upper - lower) / 2;
+
+        if (T(middle) < exponent)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+
+    if (T(lower) != exponent) {
+        FFailed = true;
+        return;
+    }
+
+    // square and multiply
+    std::vector<T> result(1, T(1));
+
+    for (unsigned n = lower; n; n >>= 1) {
+        if (n & 1)
+            multiply(result, base, result);
+
+        if (n > 1)
+            multiply(base, base, base);
+    }
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TSqrtNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TSinNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TCosNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TTanNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TLnNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TFuncNode<T> *ANode) {
+    if (constant(ANode))
+        return;
+
+    const std::string name(ANode->name());
+    const TFunction<T> *f = FLibrary.find(name);
+    unsigned& depth = FRecursions[name];
+
+    std::vector<T> param, body;
+
+    if (!f || ++depth > 64 || ANode->params() != f->params().size() + 1
+            || !calculate(ANode->node(), param)) {
+        FFailed = true;
+        return;
+    }
+
+    // the further arguments must be constant, as the callee's polynomial is
+    // one of its own x, not of ours
+    std::vector<TBinding> bindings(f->params().size());
+
+    for (unsigned i = 0; i < bindings.size(); ++i) {
+        bindings[i].first = f->params()[i];
+
+        if (!calculate(ANode->param(i + 1), bindings[i].second))
+            return;
+
+        for (unsigned k = 1; k < bindings[i].second.size(); ++k)
+            if (bindings[i].second[k] != T(0)) {
+                FFailed = true;
+                return;
+            }
+    }
+
+    FBindings.swap(bindings);
+    const bool failed = !calculate(f->expression(), body);
+    FBindings.swap(bindings);
+
+    if (failed)
+        return;
+
+    --depth;
+
+    // substitute the parameter into the function's polynomial
+    std::vector<T> result;
+
+    for (unsigned k = body.size(); k-- > 0; ) {
+        multiply(result, param, result);
+        add(result, std::vector<T>(1, body[k]), result);
+    }
+
+    FResult.swap(result);
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TIfNode<T> *ANode) {
+    if (constant(ANode))
+        return;
+
+    // a constant condition picks the branch
+    if (!constant(ANode->condition())) {
+        FFailed = true;
+        return;
+    }
+
+    calculate(FResult[0] != T(0) ? ANode->trueExpr() : ANode->falseExpr(), FResult);
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TTableNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TSumNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TProdNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TLetNode<T> *ANode) {
+    if (constant(ANode))
+        return;
+
+    std::vector<T> value;
+    if (!calculate(ANode->value(), value))
+        return;
+
+    FBindings.push_back(TBinding(ANode->name(), std::vector<T>()));
+    FBindings.back().second.swap(value);
+
+    calculate(ANode->body(), FResult);
+    FBindings.pop_back();
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TEquNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TUnEquNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TGreaterNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TLessNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TGreaterEquNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+template<class T>
+void TPolynomial<T>::TDetector::visit(TLessEquNode<T> *ANode) {
+    if (!constant(ANode))
+        FFailed = true;
+}
+
+} // namespace math
@@ -26,18 +26,24 @@
 #include <math++/visitor.h>
 
 #include <iosfwd>
+#include <string>
 
 namespace math {
 
+template<class> class TNode;
+
 /**
-  * The TPrinter<> visitor class implements stream printing for
-  * for the expression tree. Use the static printOn method to print.
+  * The TPrinter<> visitor class implements printing for the expression 
+  * tree. It appends to a string buffer, use the static print methods.
+  *
+  * Numbers are printed in plain decimal notation with the fewest digits 
+  * needed to read back the very same number.
   */
 template<class T>
 class TPrinter : public TNodeVisitor<T> {
 private:
-    std::ostream& FStream;
-    TPrinter(std::ostream& AOutput);
+    std::string& FOutput;
+    TPrinter(std::string& AOutput);
 
     /// save print takes additionally care about brackets to be printed
     void savePrint(const TNode<T> *ANode, const TNode<T> *AParent);
@@ -62,6 +68,10 @@ private:
 
     virtual void visit(TFuncNode<T> *);
     virtual void visit(TIfNode<T> *);
+    virtual void visit(TTableNode<T> *);
+    virtual void visit(TSumNode<T> *);
+    virtual void visit(TProdNode<T> *);
+    virtual void visit(TLetNode<T> *);
 
     virtual void visit(TEquNode<T> *);
     virtual void visit(TUnEquNode<T> *);
@@ -79,10 +89,48 @@ public:
     /**
       * print prints given expression, AExpr, into a std::string and returns 
       * its value. <br>
-      * This is just a wrapper method to printon with std::ostringstream, 
-      * but often used.
+      * This is just a wrapper method to the appending print, but often used.
       */
     static std::string print(const TNode<T> *AExpr);
+
+    /**
+      * appends given expression, AExpr, to AOutput. Reuse the buffer to 
+      * print many expressions without allocating memory each time.
+      */
+    static void print(const TNode<T> *AExpr, std::string& AOutput);
+
+    /// appends the number ANumber to AOutput, just as it's printed in expressions
+    static void print(const T& ANumber, std::string& AOutput);
+};
+
+/**
+  * TPrintStream<> prints large batches of expressions into an output 
+  * stream. The text gets collected in a buffer, which is written as a 
+  * whole whenever it's full.
+  */
+template<class T>
+class TPrintStream {
+private:
+    std::ostream& FStream;
+    std::string FBuffer;
+    std::string::size_type FLimit;
+
+    TPrintStream(const TPrintStream<T>&);
+    TPrintStream<T>& operator=(const TPrintStream<T>&);
+
+public:
+    /// creates a print stream writing to AOutput in blocks of about ABufferSize bytes
+    explicit TPrintStream(std::ostream& AOutput, unsigned ABufferSize = 65536);
+    /// flushes the buffer
+    ~TPrintStream();
+
+    TPrintStream<T>& operator<<(const TNode<T> *AExpr);
+    TPrintStream<T>& operator<<(const std::string& AText);
+    TPrintStream<T>& operator<<(const char *AText);
+    TPrintStream<T>& operator<<(char AChar);
+
+    /// writes the buffered text to the output stream
+    void flush();
 };
 
 } // namespace math
@@ -24,29 +24,139 @@
 #error You may not include math++/printer.tcc directly; include math++/printer.h instead.
 #endif
 
+#include <ostream>
 #include <sstream>
+#include <limits>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
 
 namespace math {
 
 template<class T>
-TPrinter<T>::TPrinter(std::ostream& AOutput) :
-    FStream(AOutput) {
+TPrinter<T>::TPrinter(std::string& AOutput) :
+    FOutput(AOutput) {
 }
 
 template<class T>
 void TPrinter<T>::printOn(std::ostream& AOutput, const TNode<T> *ANode) {
-    TPrinter<T> printer(AOutput);
-    const_cast<TNode<T> *>(ANode)->accept(printer);
+    std::string buffer;
+    print(ANode, buffer);
+
+    AOutput.write(buffer.data(), buffer.size());
 }
 
 template<class T>
 std::string TPrinter<T>::print(const TNode<T> *ANode) {
-    std::stringstream sstr;
-    TPrinter<T> printer(sstr);
+    std::string result;
+    print(ANode, result);
+
+    return result;
+}
+
+template<class T>
+void TPrinter<T>::print(const TNode<T> *ANode, std::string& AOutput) {
+    TPrinter<T> printer(AOutput);
     const_cast<TNode<T> *>(ANode)->accept(printer);
-    sstr << std::ends;
+}
+
+template<class T>
+void TPrinter<T>::print(const T& ANumber, std::string& AOutput) {
+    std::ostringstream sstr;
+
+    // max_digits10 (C++11) is at most digits10 + 3, enough to read the same number back
+    if (std::numeric_limits<T>::is_specialized)
+        sstr.precision(std::numeric_limits<T>::digits10 + 3);
 
-    return sstr.str();
+    sstr << ANumber;
+    AOutput += sstr.str();
+}
+
+template<>
+inline void TPrinter<double>::print(const double& ANumber, std::string& AOutput) {
+    double a = ANumber < 0 ? -ANumber : ANumber;
+
+    if (ANumber < 0)
+        AOutput += '-';
+
+    // integers are the most common numbers, print them directly
+    if (a < 9007199254740992.0 && a == std::floor(a)) {
+        char digits[20];
+        char *p = digits + sizeof(digits);
+        unsigned long long n = static_cast<unsigned long long>(a);
+
+        do *--p = char('0' + n % 10);
+        while (n /= 10);
+
+        AOutput.append(p, digits + sizeof(digits) - p);
+        return;
+    }
+
+    if (a != a || a > std::numeric_limits<double>::max()) {
+        AOutput += a != a ? "nan" : "inf";
+        return;
+    }
+
+    // numbers with few decimals are common too: if a * 10^k is an integer
+    // and gets back a when divided, its digits read back the same number
+    static const double powers[] = { 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8 };
+
+    for (unsigned k = 0; k < sizeof(powers) / sizeof(*powers); ++k) {
+        const double m = a * powers[k];
+
+        if (m < 9007199254740992.0 && m == std::floor(m) && m / powers[k] == a) {
+            char digits[32];
+            char *p = digits + sizeof(digits);
+            unsigned long long n = static_cast<unsigned long long>(m);
+
+            for (unsigned i = 0; i <= k; ++i, n /= 10)
+                *--p = char('0' + n % 10);
+            *--p = '.';
+
+            do *--p = char('0' + n % 10);
+            while (n /= 10);
+
+            AOutput.append(p, digits + sizeof(digits) - p);
+            return;
+        }
+    }
+
+    // find the fewest significant digits reading back the same number
+    char buf[32];
+    for (int precision = 15; precision <= 17; ++precision) {
+        std::sprintf(buf, "%.*e", precision - 1, a);
+
+        if (std::strtod(buf, 0) == a)
+            break;
+    }
+
+    // buf is d.ddde[+-]xx now, get the digits without trailing zeros
+    char digits[20];
+    int count = 0;
+    const char *p = buf;
+
+    for (; *p != 'e'; ++p)
+        if (*p != '.')
+            digits[count++] = *p;
+
+    while (count > 1 && digits[count - 1] == '0')
+        --count;
+
+    const int exponent = std::atoi(p + 1);
+
+    // and print them without exponent, the reader doesn't know about them
+    if (exponent < 0) {
+        AOutput += "0.";
+        AOutput.append(-exponent - 1, '0');
+        AOutput.append(digits, count);
+    } else if (exponent + 1 >= count) {
+        AOutput.append(digits, count);
+        AOutput.append(exponent + 1 - count, '0');
+    } else {
+        AOutput.append(digits, exponent + 1);
+        AOutput += '.';
+        AOutput.append(digits + exponent + 1, count - exponent - 1);
+    }
 }
 
 template<class T>
@@ -56,32 +166,36 @@ void TPrinter<T>::savePrint(const TNode<T> *ANode, const TNode<T> *AParent) {
     bool less = ANode->priority() < AParent->priority() ||
                (AParent->nodeType() == TNode<T>::NEG_NODE &&
                  (ANode->nodeType() == TNode<T>::PLUS_NODE ||
-                  ANode->nodeType() == TNode<T>::NEG_NODE));
+                  ANode->nodeType() == TNode<T>::NEG_NODE)) ||
+               // a/(b*c) and (a^b)^c, as / binds to the left and ^ to the right
+               (ANode->priority() == AParent->priority() &&
+                ((AParent->nodeType() == TNode<T>::DIV_NODE && ANode == AParent->right()) ||
+                 (AParent->nodeType() == TNode<T>::POW_NODE && ANode == AParent->left())));
 #else
     bool less = true;//ANode->priority() < AParent->priority();
 #endif
     if (less)
-        FStream << "(";
+        FOutput += '(';
 
     const_cast<TNode<T> *>(ANode)->accept(*this);
 
     if (less)
-        FStream << ")";
+        FOutput += ')';
 }
 
 template<class T>
 void TPrinter<T>::visit(TNumberNode<T> *ANode) {
-    FStream << ANode->number();
+    print(ANode->number(), FOutput);
 }
 
 template<class T>
 void TPrinter<T>::visit(TSymbolNode<T> *ANode) {
-    FStream << ANode->symbol();
+    FOutput += ANode->symbol();
 }
 
 template<class T>
 void TPrinter<T>::visit(TParamNode<T> *ANode) {
-    FStream << "x"; // the parameter is usually x,
+    FOutput += 'x'; // the parameter is usually x,
                     // so keep this symbol reserved, or override me;)
 }
 
@@ -89,13 +203,13 @@ template<class T>
 void TPrinter<T>::visit(TPlusNode<T> *ANode) {
     savePrint(ANode->left(), ANode);
     if (ANode->right()->nodeType() != TNode<T>::NEG_NODE)
-        FStream << "+";
+        FOutput += '+';
     savePrint(ANode->right(), ANode);
 }
 
 template<class T>
 void TPrinter<T>::visit(TNegNode<T> *ANode) {
-    FStream << "-";
+    FOutput += '-';
     savePrint(ANode->node(), ANode);
 }
 
@@ -109,7 +223,7 @@ void TPrinter<T>::visit(TMulNode<T> *ANode) {
     //if (!(ANode->left()->nodeType() == TNode<T>::NUMBER_NODE &&
     //      (ANode->right()->nodeType() == TNode<T>::SYMBOL_NODE ||
     //       ANode->right()->nodeType() == TNode<T>::PARAM_NODE)))
-        FStream << "*";
+        FOutput += '*';
 
     savePrint(ANode->right(), ANode);
 }
@@ -117,112 +231,228 @@ void TPrinter<T>::visit(TMulNode<T> *ANode) {
 template<class T>
 void TPrinter<T>::visit(TDivNode<T> *ANode) {
     savePrint(ANode->left(), ANode);
-    FStream << "/";
+    FOutput += '/';
     savePrint(ANode->right(), ANode);
 }
 
 template<class T>
 void TPrinter<T>::visit(TPowNode<T> *ANode) {
     savePrint(ANode->left(), ANode);
-    FStream << "^";
+    FOutput += '^';
     savePrint(ANode->right(), ANode);
 }
 
 template<class T>
 void TPrinter<T>::visit(TSqrtNode<T> *ANode) {
-    FStream << "sqrt(";
+    FOutput += "sqrt(";
     ANode->node()->accept(*this);
-    FStream << ")";
+    FOutput += ')';
 }
 
 template<class T>
 void TPrinter<T>::visit(TSinNode<T> *ANode) {
-    FStream << "sin(";
+    FOutput += "sin(";
     ANode->node()->accept(*this);
-    FStream << ")";
+    FOutput += ')';
 }
 
 template<class T>
 void TPrinter<T>::visit(TCosNode<T> *ANode) {
-    FStream << "cos(";
+    FOutput += "cos(";
     ANode->node()->accept(*this);
-    FStream << ")";
+    FOutput += ')';
 }
 
 template<class T>
 void TPrinter<T>::visit(TTanNode<T> *ANode) {
-    FStream << "tan(";
+    FOutput += "tan(";
     ANode->node()->accept(*this);
-    FStream << ")";
+    FOutput += ')';
 }
 
 template<class T>
 void TPrinter<T>::visit(TLnNode<T> *ANode) {
-    FStream << "ln(";
+    FOutput += "ln(";
     ANode->node()->accept(*this);
-    FStream << ")";
+    FOutput += ')';
 }
 
 template<class T>
 void TPrinter<T>::visit(TFuncNode<T> *ANode) {
-    FStream << ANode->name() << "(";
+    FOutput += ANode->name();
+    FOutput += '(';
     ANode->node()->accept(*this);
-    FStream << ")";
+
+    for (unsigned i = 1; i < ANode->params(); ++i) {
+        FOutput += ", ";
+        ANode->param(i)->accept(*this);
+    }
+    FOutput += ')';
 }
 
 template<class T>
 void TPrinter<T>::visit(TIfNode<T> *ANode) {
-    FStream << "IF(";
+    FOutput += "IF(";
     ANode->condition()->accept(*this);
-    FStream << ", ";
+    FOutput += ", ";
     ANode->trueExpr()->accept(*this);
-    FStream << ", ";
+    FOutput += ", ";
     ANode->falseExpr()->accept(*this);
-    FStream << ")";
+    FOutput += ')';
+}
+
+template<class T>
+void TPrinter<T>::visit(TTableNode<T> *ANode) {
+    FOutput += "TABLE(";
+    FOutput += ANode->name();
+    FOutput += ", ";
+    ANode->node()->accept(*this);
+
+    if (ANode->order()) {
+        FOutput += ", ";
+        print(T(ANode->order()), FOutput);
+    }
+    FOutput += ')';
+}
+
+template<class T>
+void TPrinter<T>::visit(TSumNode<T> *ANode) {
+    FOutput += "sum(";
+    FOutput += ANode->index();
+    FOutput += ", ";
+    ANode->lower()->accept(*this);
+    FOutput += ", ";
+    ANode->upper()->accept(*this);
+    FOutput += ", ";
+    ANode->body()->accept(*this);
+    FOutput += ')';
+}
+
+template<class T>
+void TPrinter<T>::visit(TProdNode<T> *ANode) {
+    FOutput += "prod(";
+    FOutput += ANode->index();
+    FOutput += ", ";
+    ANode->lower()->accept(*this);
+    FOutput += ", ";
+    ANode->upper()->accept(*this);
+    FOutput += ", ";
+    ANode->body()->accept(*this);
+    FOutput += ')';
+}
+
+template<class T>
+void TPrinter<T>::visit(TLetNode<T> *ANode) {
+    // the body extends as far as possible, so it needs no brackets
+    FOutput += "let ";
+    FOutput += ANode->name();
+    FOutput += " = ";
+    ANode->value()->accept(*this);
+    FOutput += " in ";
+    ANode->body()->accept(*this);
 }
 
 template<class T>
 void TPrinter<T>::visit(TEquNode<T> *ANode) {
     ANode->left()->accept(*this);
-    FStream << "=";
+    FOutput += '=';
     ANode->right()->accept(*this);
 }
 
 template<class T>
 void TPrinter<T>::visit(TUnEquNode<T> *ANode) {
     ANode->left()->accept(*this);
-    FStream << "<>";
+    FOutput += "<>";
     ANode->right()->accept(*this);
 }
 
 template<class T>
 void TPrinter<T>::visit(TGreaterNode<T> *ANode) {
     ANode->left()->accept(*this);
-    FStream << ">";
+    FOutput += '>';
     ANode->right()->accept(*this);
 }
 
 template<class T>
 void TPrinter<T>::visit(TLessNode<T> *ANode) {
     ANode->left()->accept(*this);
-    FStream << "<";
+    FOutput += '<';
     ANode->right()->accept(*this);
 }
 
 template<class T>
 void TPrinter<T>::visit(TGreaterEquNode<T> *ANode) {
     ANode->left()->accept(*this);
-    FStream << ">=";
+    FOutput += ">=";
     ANode->right()->accept(*this);
 }
 
 template<class T>
 void TPrinter<T>::visit(TLessEquNode<T> *ANode) {
     ANode->left()->accept(*this);
-    FStream << "<=";
+    FOutput += "<=";
     ANode->right()->accept(*this);
 }
 
+// TPrintStream
+template<class T>
+TPrintStream<T>::TPrintStream(std::ostream& AOutput, unsigned ABufferSize) :
+    FStream(AOutput), FLimit(ABufferSize) {
+
+    FBuffer.reserve(ABufferSize + ABufferSize / 4);
+}
+
+template<class T>
+TPrintStream<T>::~TPrintStream() {
+    flush();
+}
+
+template<class T>
+TPrintStream<T>& TPrintStream<T>::operator<<(const TNode<T> *AExpr) {
+    TPrinter<T>::print(AExpr, FBuffer);
+
+    if (FBuffer.size() >= FLimit)
+        flush();
+
+    return *this;
+}
+
+template<class T>
+TPrintStream<T>& TPrintStream<T>::operator<<(const std::string& AText) {
+    FBuffer += AText;
+
+    if (FBuffer.size() >= FLimit)
+        flush();
+
+    return *this;
+}
+
+template<class T>
+TPrintStream<T>& TPrintStream<T>::operator<<(const char *AText) {
+    FBuffer += AText;
+
+    if (FBuffer.size() >= FLimit)
+        flush();
+
+    return *this;
+}
+
+template<class T>
+TPrintStream<T>& TPrintStream<T>::operator<<(char AChar) {
+    FBuffer += AChar;
+
+    if (FBuffer.size() >= FLimit)
+        flush();
+
+    return *this;
+}
+
+template<class T>
+void TPrintStream<T>::flush() {
+    FStream.write(FBuffer.data(), FBuffer.size());
+    FBuffer.clear();
+}
+
 /*template<class T>
 std::ostream& operator<< <T>(std::ostream& os, const TNode<T>& ANode) {
     TPrinter<T>::print(os, &ANode);
@@ -0,0 +1,644 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the exact rational number implementation)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+// 
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#include <math++/rational.h>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+namespace math {
+
+typedef unsigned long long TMagnitude;
+
+// the machine integers used, -MAX_SMALL is kept out for symmetry
+static const long long MAX_SMALL = 0x7FFFFFFFFFFFFFFFLL;
+
+static inline TMagnitude magnitude(long long a) {
+    return a < 0 ? 0ULL - TMagnitude(a) : TMagnitude(a);
+}
+
+static inline long long gcd(long long a, long long b) {
+    TMagnitude x = magnitude(a), y = magnitude(b);
+
+    while (y) {
+        TMagnitude t = x % y;
+        x = y;
+        y = t;
+    }
+    return (long long)x;
+}
+
+// r = a * b, returns false if that doesn't fit
+static inline bool multiply(long long a, long long b, long long& r) {
+    const TMagnitude ma = magnitude(a), mb = magnitude(b);
+
+    if (mb && ma > TMagnitude(MAX_SMALL) / mb)
+        return false;
+
+    r = a * b;
+    return true;
+}
+
+// r = a + b, returns false if that doesn't fit
+static inline bool add(long long a, long long b, long long& r) {
+    if (b > 0 ? a > MAX_SMALL - b : a < -MAX_SMALL - b)
+        return false;
+
+    r = a + b;
+    return true;
+}
+
+static inline bool fitsSmall(const TBigInteger& a) {
+    return a.fitsUnsigned() && a.toUnsigned() <= TMagnitude(MAX_SMALL);
+}
+
+static inline long long toSmall(const TBigInteger& a) {
+    long long result = (long long)a.toUnsigned();
+    return a.sign() < 0 ? -result : result;
+}
+
+// construction
+
+TRational::TRational() :
+    FNumerator(0), FDenominator(1), FBig(0) {
+}
+
+TRational::TRational(int ANumber) :
+    FNumerator(ANumber), FDenominator(1), FBig(0) {
+}
+
+TRational::TRational(unsigned ANumber) :
+    FNumerator(ANumber), FDenominator(1), FBig(0) {
+}
+
+TRational::TRational(long ANumber) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+    assign((long long)ANumber, 1LL);
+}
+
+TRational::TRational(unsigned long ANumber) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+    if (TMagnitude(ANumber) <= TMagnitude(MAX_SMALL))
+        FNumerator = (long long)ANumber;
+    else
+        assign(TBigInteger(ANumber), TBigInteger(1));
+}
+
+TRational::TRational(long long ANumber) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+    assign(ANumber, 1LL);
+}
+
+TRational::TRational(unsigned long long ANumber) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+    if (ANumber <= TMagnitude(MAX_SMALL))
+        FNumerator = (long long)ANumber;
+    else
+        assign(TBigInteger(ANumber), TBigInteger(1));
+}
+
+TRational::TRational(long long ANumerator, long long ADenominator) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+    assign(ANumerator, ADenominator);
+}
+
+TRational::TRational(const TBigInteger& ANumber) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+    assign(ANumber, TBigInteger(1));
+}
+
+TRational::TRational(const TBigInteger& ANumerator, const TBigInteger& ADenominator) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+    assign(ANumerator, ADenominator);
+}
+
+TRational::TRational(double ANumber) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+
+    if (ANumber != ANumber || ANumber - ANumber != 0)
+        throw ERational("Can't convert a number which isn't finite.");
+
+    if (ANumber == std::floor(ANumber) && std::fabs(ANumber) < 9007199254740992.0) {
+        FNumerator = (long long)ANumber;
+        return;
+    }
+
+    // the shortest decimal which reads back the same double
+    char buf[32];
+    for (int precision = 1; precision <= 17; ++precision) {
+        std::sprintf(buf, "%.*e", precision - 1, ANumber);
+
+        if (std::strtod(buf, 0) == ANumber)
+            break;
+    }
+    assign(buf, buf + std::strlen(buf));
+}
+
+TRational::TRational(const std::string& ANumber) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+    assign(ANumber.data(), ANumber.data() + ANumber.size());
+}
+
+TRational::TRational(const char *ANumber) :
+    FNumerator(0), FDenominator(1), FBig(0) {
+    assign(ANumber, ANumber + std::strlen(ANumber));
+}
+
+TRational::TRational(const TRational& AOther) :
+    FNumerator(AOther.FNumerator), FDenominator(AOther.FDenominator),
+    FBig(AOther.FBig ? new TBig(*AOther.FBig) : 0) {
+}
+
+TRational::~TRational() {
+    delete FBig;
+}
+
+TRational& TRational::operator=(const TRational& AOther) {
+    if (this != &AOther) {
+        TRational copy(AOther);
+        swap(copy);
+    }
+    return *this;
+}
+
+void TRational::swap(TRational& AOther) {
+    std::swap(FNumerator, AOther.FNumerator);
+    std::swap(FDenominator, AOther.FDenominator);
+    std::swap(FBig, AOther.FBig);
+}
+
+void TRational::assign(long long ANumerator, long long ADenominator) {
+    if (!ADenominator)
+        throw ERational("Division by zero.");
+
+    if (ANumerator < -MAX_SMALL || ADenominator < -MAX_SMALL) {
+        assign(TBigInteger(ANumerator), TBigInteger(ADenominator));
+        return;
+    }
+
+    if (ADenominator < 0) {
+        ANumerator = -ANumerator;
+        ADenominator = -ADenominator;
+    }
+
+    const long long g = gcd(ANumerator, ADenominator);
+
+    delete FBig;
+    FBig = 0;
+    FNumerator = ANumerator / g;
+    FDenominator = ADenominator / g;
+}
+
+void TRational::assign(const TBigInteger& ANumerator, const TBigInteger& ADenominator) {
+    if (ADenominator.isZero())
+        throw ERational("Division by zero.");
+
+    TBigInteger g(gcd(ANumerator, ADenominator));
+    if (ADenominator.sign() < 0)
+        g = -g;
+
+    TBigInteger n(ANumerator / g), d(ADenominator / g);
+
+    if (fitsSmall(n) && fitsSmall(d)) {
+        delete FBig;
+        FBig = 0;
+        FNumerator = toSmall(n);
+        FDenominator = toSmall(d);
+    } else {
+        if (!FBig)
+            FBig = new TBig;
+
+        FBig->numerator.swap(n);
+        FBig->denominator.swap(d);
+    }
+}
+
+void TRational::assign(const char *ABegin, const char *AEnd) {
+    while (ABegin != AEnd && std::isspace(static_cast<unsigned char>(*ABegin)))
+        ++ABegin;
+
+    bool negative = false;
+    if (ABegin != AEnd && (*ABegin == '-' || *ABegin == '+'))
+        negative = *ABegin++ == '-';
+
+    // the digits without the decimal point, and the decimal exponent
+    std::string digits;
+    long exponent = 0;
+
+    for (; ABegin != AEnd && std::isdigit(static_cast<unsigned char>(*ABegin)); ++ABegin)
+        digits += *ABegin;
+
+    if (ABegin != AEnd && *ABegin == '.')
+        for (++ABegin; ABegin != AEnd && std::isdigit(static_cast<unsigned char>(*ABegin)); ++ABegin) {
+            digits += *ABegin;
+            --exponent;
+        }
+
+    if (ABegin != AEnd && (*ABegin == 'e' || *ABegin == 'E'))
+        exponent += std::strtol(std::string(ABegin + 1, AEnd).c_str(), 0, 10);
+
+    if (digits.size() <= 18 && exponent > -19 && exponent < 19 - long(digits.size())) {
+        // fits into a long long
+        long long n = 0, d = 1;
+
+        for (std::string::size_type i = 0; i < digits.size(); ++i)
+            n = n * 10 + (digits[i] - '0');
+
+        for (; exponent > 0; --exponent)
+            n *= 10;
+        for (; exponent < 0; ++exponent)
+            d *= 10;
+
+        assign(negative ? -n : n, d);
+    } else {
+        TBigInteger n(digits), d(1);
+        TBigInteger scale(pow(TBigInteger(10), TBigInteger(exponent < 0 ? -exponent : exponent)));
+
+        if (exponent < 0)
+            d = scale;
+        else
+            n *= scale;
+
+        assign(negative ? -n : n, d);
+    }
+
+    // a denominator may follow
+    const char *slash = std::find(ABegin, AEnd, '/');
+    if (slash != AEnd)
+        *this /= TRational(std::string(slash + 1, AEnd));
+}
+
+// arithmetic
+
+TRational& TRational::operator+=(const TRational& AOther) {
+    if (!FBig && !AOther.FBig) {
+        // a/b + c/d = (a d' + c b') / (b d') with b' = b/g, d' = d/g
+        const long long g = gcd(FDenominator, AOther.FDenominator);
+        const long long b = FDenominator / g, d = AOther.FDenominator / g;
+        long long x, y, n, m;
+
+        if (multiply(FNumerator, d, x) && multiply(AOther.FNumerator, b, y)
+                && add(x, y, n) && multiply(FDenominator, d, m)) {
+            assign(n, m);
+            return *this;
+        }
+    }
+
+    assign(numerator() * AOther.denominator() + AOther.numerator() * denominator(),
+        denominator() * AOther.denominator());
+
+    return *this;
+}
+
+TRational& TRational::operator-=(const TRational& AOther) {
+    return *this += -AOther;
+}
+
+TRational& TRational::operator*=(const TRational& AOther) {
+    if (!FBig && !AOther.FBig) {
+        if (!FNumerator || !AOther.FNumerator) {
+            assign(0LL, 1LL);
+            return *this;
+        }
+
+        // cancelling crosswise first keeps the result in lowest terms
+        const long long g = gcd(FNumerator, AOther.FDenominator);
+        const long long h = gcd(AOther.FNumerator, FDenominator);
+        long long n, d;
+
+        if (multiply(FNumerator / g, AOther.FNumerator / h, n)
+                && multiply(FDenominator / h, AOther.FDenominator / g, d)) {
+            FNumerator = n;
+            FDenominator = d;
+            return *this;
+        }
+    }
+
+    assign(numerator() * AOther.numerator(), denominator() * AOther.denominator());
+    return *this;
+}
+
+TRational& TRational::operator/=(const TRational& AOther) {
+    if (AOther.isZero())
+        throw ERational("Division by zero.");
+
+    if (!FBig && !AOther.FBig) {
+        const long long c = AOther.FNumerator, d = AOther.FDenominator;
+        const long long g = gcd(FNumerator, c), h = gcd(FDenominator, d);
+        long long n, m;
+
+        if (multiply(FNumerator / g, d / h, n) && multiply(FDenominator / h, c / g, m)) {
+            assign(n, m);
+            return *this;
+        }
+    }
+
+    assign(numerator() * AOther.denominator(), denominator() * AOther.numerator());
+    return *this;
+}
+
+TRational TRational::operator-() const {
+    TRational result(*this);
+
+    if (result.FBig)
+        result.FBig->numerator = -result.FBig->numerator;
+    else
+        result.FNumerator = -result.FNumerator;
+
+    return result;
+}
+
+int TRational::sign() const {
+    if (FBig)
+        return FBig->numerator.sign();
+
+    return FNumerator < 0 ? -1 : FNumerator > 0;
+}
+
+bool TRational::equals(const TRational& a, const TRational& b) {
+    // both are in lowest terms, and big only where they have to be
+    if (!a.FBig && !b.FBig)
+        return a.FNumerator == b.FNumerator && a.FDenominator == b.FDenominator;
+
+    return a.FBig && b.FBig
+        && a.FBig->numerator == b.FBig->numerator
+        && a.FBig->denominator == b.FBig->denominator;
+}
+
+int TRational::compare(const TRational& a, const TRational& b) {
+    if (!a.FBig && !b.FBig) {
+        long long x, y;
+
+        if (a.FDenominator == b.FDenominator)
+            x = a.FNumerator, y = b.FNumerator;
+        else if (!multiply(a.FNumerator, b.FDenominator, x)
+                || !multiply(b.FNumerator, a.FDenominator, y))
+            return TBigInteger::compare(a.numerator() * b.denominator(),
+                b.numerator() * a.denominator());
+
+        return x < y ? -1 : x > y;
+    }
+
+    return TBigInteger::compare(a.numerator() * b.denominator(),
+        b.numerator() * a.denominator());
+}
+
+TBigInteger TRational::numerator() const {
+    return FBig ? FBig->numerator : TBigInteger(FNumerator);
+}
+
+TBigInteger TRational::denominator() const {
+    return FBig ? FBig->denominator : TBigInteger(FDenominator);
+}
+
+double TRational::toDouble() const {
+    if (!FBig)
+        return double(FNumerator) / double(FDenominator);
+
+    // about 20 significant digits of the quotient are enough
+    const TBigInteger& n = FBig->numerator;
+    const TBigInteger& d = FBig->denominator;
+    const long shift = 20 - (long(n.digits()) - long(d.digits()));
+
+    TBigInteger scale(pow(TBigInteger(10), TBigInteger(shift < 0 ? -shift : shift)));
+    TBigInteger q(shift < 0 ? n / (d * scale) : n * scale / d);
+
+    return q.toDouble() * std::pow(10.0, -double(shift));
+}
+
+void TRational::print(std::string& AOutput) const {
+    if (FBig) {
+        FBig->numerator.print(AOutput);
+        if (!isInteger()) {
+            AOutput += '/';
+            FBig->denominator.print(AOutput);
+        }
+        return;
+    }
+
+    char buf[48];
+    if (FDenominator == 1)
+        std::sprintf(buf, "%lld", FNumerator);
+    else
+        std::sprintf(buf, "%lld/%lld", FNumerator, FDenominator);
+
+    AOutput += buf;
+}
+
+std::string TRational::toString() const {
+    std::string result;
+    print(result);
+
+    return result;
+}
+
+// functions
+
+TRational TRational::power(const TRational& a, const TRational& b) {
+    if (b.isZero())
+        return TRational(1);
+
+    if (b.isInteger())
+        return power(a, b.numerator());
+
+    // (n/d)^(p/q) is exact if n/d has a rational q-th root
+    const TBigInteger q(b.denominator());
+
+    if (a.sign() >= 0 && q.fitsUnsigned() && q.toUnsigned() <= 64) {
+        TRational r(root(a, unsigned(q.toUnsigned())));
+
+        if (r.sign() >= 0 && equals(power(r, q), a))
+            return power(r, b.numerator());
+    }
+
+    return TRational(std::pow(a.toDouble(), b.toDouble()));
+}
+
+TRational TRational::power(const TRational& a, const TBigInteger& AExponent) {
+    if (AExponent.isZero())
+        return TRational(1);
+
+    // 0, 1 and -1 take any exponent
+    if (a.isZero() || equals(abs(a), TRational(1))) {
+        if (a.isZero() && AExponent.sign() < 0)
+            throw ERational("Division by zero.");
+
+        return a.sign() < 0 && AExponent.mod(2) == 0 ? TRational(1) : a;
+    }
+
+    const TBigInteger e(abs(AExponent));
+    if (!e.fitsUnsigned() || e.toUnsigned() > 0xFFFFFFFFULL)
+        throw ERational("Exponent too large.");
+
+    TRational result(1), square(a);
+    for (unsigned long long n = e.toUnsigned(); n; n >>= 1) {
+        if (n & 1)
+            result *= square;
+        if (n > 1)
+            square *= square;
+    }
+
+    return AExponent.sign() < 0 ? TRational(1) / result : result;
+}
+
+// returns the ADegree-th root of a, if it's an integer, or -1
+static TBigInteger integerRoot(const TBigInteger& a, unsigned ADegree) {
+    TBigInteger r;
+
+    if (ADegree == 2)
+        r = sqrt(a);
+    else {
+        double estimate = std::floor(std::pow(a.toDouble(), 1.0 / ADegree) + 0.5);
+
+        // beyond 2^53 the estimate doesn't get the exact root anyway
+        if (estimate > 9007199254740992.0)
+            return TBigInteger(-1);
+
+        r = TBigInteger(estimate);
+    }
+
+    return pow(r, TBigInteger(ADegree)) == a ? r : TBigInteger(-1);
+}
+
+TRational TRational::root(const TRational& a, unsigned ADegree) {
+    if (a.sign() < 0) {
+        if (ADegree == 2)
+            throw ERational("Square root of a negative number.");
+
+        return TRational(std::pow(a.toDouble(), 1.0 / ADegree));
+    }
+
+    TBigInteger n(integerRoot(a.numerator(), ADegree));
+    if (n.sign() >= 0) {
+        TBigInteger d(integerRoot(a.denominator(), ADegree));
+
+        if (d.sign() > 0)
+            return TRational(n, d);
+    }
+
+    return TRational(std::pow(a.toDouble(), 1.0 / ADegree));
+}
+
+TRational TRational::logarithm(const TRational& a) {
+    if (a.sign() <= 0)
+        throw ERational("Logarithm of a number not greater than zero.");
+
+    if (equals(a, TRational(1)))
+        return TRational();
+
+    // huge terms get scaled by 10^k towards 1 first, as they may be beyond double
+    if (a.FBig) {
+        const long k = long(a.FBig->numerator.digits()) - long(a.FBig->denominator.digits());
+        const TRational scaled(a * power(TRational(10), TBigInteger(-k)));
+
+        return TRational(std::log(scaled.toDouble()) + k * std::log(10.0));
+    }
+
+    return TRational(std::log(a.toDouble()));
+}
+
+TRational operator+(const TRational& a, const TRational& b) {
+    TRational result(a);
+    return result += b;
+}
+
+TRational operator-(const TRational& a, const TRational& b) {
+    TRational result(a);
+    return result -= b;
+}
+
+TRational operator*(const TRational& a, const TRational& b) {
+    TRational result(a);
+    return result *= b;
+}
+
+TRational operator/(const TRational& a, const TRational& b) {
+    TRational result(a);
+    return result /= b;
+}
+
+bool operator==(const TRational& a, const TRational& b) {
+    return TRational::equals(a, b);
+}
+
+bool operator!=(const TRational& a, const TRational& b) {
+    return !TRational::equals(a, b);
+}
+
+bool operator<(const TRational& a, const TRational& b) {
+    return TRational::compare(a, b) < 0;
+}
+
+bool operator>(const TRational& a, const TRational& b) {
+    return TRational::compare(a, b) > 0;
+}
+
+bool operator<=(const TRational& a, const TRational& b) {
+    return TRational::compare(a, b) <= 0;
+}
+
+bool operator>=(const TRational& a, const TRational& b) {
+    return TRational::compare(a, b) >= 0;
+}
+
+std::ostream& operator<<(std::ostream& AOutput, const TRational& ANumber) {
+    return AOutput << ANumber.toString();
+}
+
+std::istream& operator>>(std::istream& AInput, TRational& ANumber) {
+    // sign, digits, point, exponent and a denominator
+    std::string text;
+    char c;
+
+    AInput >> std::ws;
+    while (AInput.get(c)) {
+        const bool sign = (c == '-' || c == '+')
+            && (text.empty() || text[text.size() - 1] == 'e' || text[text.size() - 1] == 'E'
+                || text[text.size() - 1] == '/');
+
+        if (!sign && !std::isdigit(static_cast<unsigned char>(c))
+                && c != '.' && c != 'e' && c != 'E' && c != '/') {
+            AInput.putback(c);
+            break;
+        }
+        text += c;
+    }
+
+    if (text.empty()) {
+        AInput.setstate(std::ios::failbit);
+        return AInput;
+    }
+
+    if (AInput.eof())
+        AInput.clear(std::ios::eofbit);
+
+    ANumber = TRational(text);
+    return AInput;
+}
+
+} // namespace math
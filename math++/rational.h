@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the exact rational number type)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_rational_h
+#define libmath_rational_h
+
+#include <math++/biginteger.h>
+#include <math++/printer.h>
+
+#include <iosfwd>
+#include <cmath>
+#include <string>
+
+namespace math {
+
+/**
+  * ERational is thrown on invalid TRational operations, such as divisions 
+  * by zero or square roots of negative numbers.
+  */
+class ERational : public EMath {
+public:
+    ERational(const std::string& AReason) : EMath(AReason) {}
+};
+
+/**
+  * TRational is an exact fraction, always kept in lowest terms with a 
+  * positive denominator. Used as T, the simplifier folds constants 
+  * without rounding, so its comparisons against 0 and 1 are reliable.
+  *
+  * Numerator and denominator are machine integers as long as they fit, 
+  * and switch to TBigInteger where they would overflow.
+  *
+  * Integral powers and roots of perfect powers are exact. Everything 
+  * else goes through double and takes the shortest decimal that reads 
+  * back the same double, thus 0.1 becomes 1/10.
+  */
+class TRational {
+public:
+    TRational();
+    TRational(int);
+    TRational(unsigned);
+    TRational(long);
+    TRational(unsigned long);
+    TRational(long long);
+    TRational(unsigned long long);
+    /// ANumerator / ADenominator, throws ERational if ADenominator is zero
+    TRational(long long ANumerator, long long ADenominator);
+    explicit TRational(const TBigInteger& ANumber);
+    TRational(const TBigInteger& ANumerator, const TBigInteger& ADenominator);
+    /// the shortest decimal of ANumber, throws ERational if it's not finite
+    explicit TRational(double ANumber);
+    /// reads "3", "-0.25", "1.5e-3" or "2/3"
+    explicit TRational(const std::string& ANumber);
+    explicit TRational(const char *ANumber);
+    TRational(const TRational&);
+    ~TRational();
+
+    TRational& operator=(const TRational&);
+    void swap(TRational&);
+
+    TRational& operator+=(const TRational&);
+    TRational& operator-=(const TRational&);
+    TRational& operator*=(const TRational&);
+    /// throws ERational on division by zero
+    TRational& operator/=(const TRational&);
+    TRational operator-() const;
+
+    /// returns -1, 0 or 1 as a is less than, equal to or greater than b
+    static int compare(const TRational& a, const TRational& b);
+    /// returns true if a and b are the same number (cheaper than compare())
+    static bool equals(const TRational& a, const TRational& b);
+
+    int sign() const;
+    bool isZero() const { return !FBig && !FNumerator; }
+    bool isInteger() const { return FBig ? FBig->denominator == TBigInteger(1) : FDenominator == 1; }
+
+    TBigInteger numerator() const;
+    TBigInteger denominator() const;
+
+    /// returns the nearest double
+    double toDouble() const;
+
+    /// appends the fraction to AOutput, e.g. "-2/3" or "5"
+    void print(std::string& AOutput) const;
+    std::string toString() const;
+
+    // the functions of the calculator, found by argument dependent lookup only
+    friend TRational pow(const TRational& a, const TRational& b) { return power(a, b); }
+    friend TRational sqrt(const TRational& a) { return root(a, 2); }
+    friend TRational sin(const TRational& a) { return a.isZero() ? a : TRational(std::sin(a.toDouble())); }
+    friend TRational cos(const TRational& a) { return a.isZero() ? TRational(1) : TRational(std::cos(a.toDouble())); }
+    friend TRational tan(const TRational& a) { return a.isZero() ? a : TRational(std::tan(a.toDouble())); }
+    friend TRational log(const TRational& a) { return logarithm(a); }
+    friend TRational abs(const TRational& a) { return a.sign() < 0 ? -a : a; }
+
+private:
+    // the value, if numerator and denominator don't fit into a long long
+    struct TBig {
+        TBigInteger numerator;
+        TBigInteger denominator;
+    };
+
+    long long FNumerator;
+    long long FDenominator;
+    TBig *FBig;
+
+    void assign(long long ANumerator, long long ADenominator);
+    void assign(const TBigInteger& ANumerator, const TBigInteger& ADenominator);
+    void assign(const char *ABegin, const char *AEnd);
+
+    static TRational power(const TRational& a, const TRational& b);
+    /// a^AExponent, exactly
+    static TRational power(const TRational& a, const TBigInteger& AExponent);
+    static TRational root(const TRational& a, unsigned ADegree);
+    static TRational logarithm(const TRational& a);
+};
+
+TRational operator+(const TRational& a, const TRational& b);
+TRational operator-(const TRational& a, const TRational& b);
+TRational operator*(const TRational& a, const TRational& b);
+TRational operator/(const TRational& a, const TRational& b);
+
+bool operator==(const TRational& a, const TRational& b);
+bool operator!=(const TRational& a, const TRational& b);
+bool operator<(const TRational& a, const TRational& b);
+bool operator>(const TRational& a, const TRational& b);
+bool operator<=(const TRational& a, const TRational& b);
+bool operator>=(const TRational& a, const TRational& b);
+
+std::ostream& operator<<(std::ostream& AOutput, const TRational& ANumber);
+std::istream& operator>>(std::istream& AInput, TRational& ANumber);
+
+// fractions are bracketed within expressions, as 2^1/3 would read back 
+// as (2^1)/3
+template<>
+inline void TPrinter<TRational>::print(const TRational& ANumber, std::string& AOutput) {
+    if (ANumber.isInteger())
+        ANumber.print(AOutput);
+    else {
+        AOutput += '(';
+        ANumber.print(AOutput);
+        AOutput += ')';
+    }
+}
+
+} // namespace math
+
+#endif
@@ -26,6 +26,7 @@
 #include <math++/error.h>
 
 #include <string>
+#include <vector>
 
 namespace math {
 
@@ -44,6 +45,10 @@ public:
   * TReader<> represents the expression reader (aka. parser) wich generates
   * on given input (usually of type std::string) the equivalent output
   * of type TNode<>.
+  *
+  * It's an operator precedence parser keeping its state on explicit stacks
+  * instead of recursing, so neither long operator chains nor deeply nested
+  * brackets are limited by the size of the call stack.
   */
 template<class T>
 class TReader {
@@ -61,33 +66,79 @@ private:
         tkAngOpen = '<', tkAngClose = '>', tkSetOpen = '{', tkSetClose = '}'
     };
 
-    std::string FExprStr;       // holds the current parsed expression
-    std::string::size_type FPos;// holds the current read index
+    /// TKeyword represents the built-in symbols known by the reader
+    enum TKeyword {
+        kwNone, kwParam, kwSqrt, kwSin, kwCos, kwTan, kwLn, kwIf, kwTable, kwSum, kwProd,
+        kwLet, kwIn
+    };
+
+    /// TOperator represents an operator pending on the operator stack
+    enum TOperator {
+        opNeg, opPlus, opMinus, opMul, opDiv, opPow,
+        opEqu, opUnEqu, opLess, opGreater, opLessEqu, opGreaterEqu
+    };
+
+    /// TGroupKind tells what has opened a group
+    enum TGroupKind {
+        gkRound, gkSquare, gkSqrt, gkSin, gkCos, gkTan, gkLn, gkIf, gkTable, gkSum, gkProd,
+        gkFunc,
+        gkLet       // let name = value in body, the body ends where the enclosing group does
+    };
+
+    /// TGroup represents an opened bracket (or function parameter list)
+    struct TGroup {
+        TGroupKind kind;
+        unsigned base;          // operator stack size when it got opened
+        unsigned args;          // number of arguments read so far (1 for let within the body)
+        const char *name;       // name of the user function, table, index or let (points into the input)
+        unsigned nameLength;
+    };
+
+    const char *FPos;           // holds the current read position
+    const char *FEnd;           // holds the end of the input (not part of it)
 
     TToken FToken;              // holds current parsed token id
     T FNumber;                  // holds last read number
-    std::string FSymbol;        // holds last read symbol
+    const char *FSymbol;        // holds last read symbol (points into the input)
+    unsigned FSymbolLength;     // holds the length of the last read symbol
+
+    std::vector<TNode<T> *> FOperands;  // already parsed (sub) expressions
+    std::vector<TOperator> FOperators;  // operators waiting for their operands
+    std::vector<TGroup> FGroups;        // currently opened brackets
+    bool FEquation;             // true, if an equation is expected
+    unsigned FRelations;        // number of relations read outside of brackets
 
 private:
-    TReader(const std::string& AInput);
-
-    /// parses an expression on equation level (=,<>, <=, >=, <, >, <<, >>)
-    TNode<T> *equation(bool get);
-    // parses an expression (really any expression, even sub equations)
-    TNode<T> *expr(bool get);
-    /// parses whole expressions (+,-)...
-    TNode<T> *simpleExpr(bool get);
-    /// parses terms (*,/)...
-    TNode<T> *term(bool get);
-    /// parses facotrs (^)...
-    TNode<T> *factor(bool get);
-    /// parses that thing with the highest priority (e.g. numbers, idents, ...)
-    TNode<T> *prim(bool get);
-
-    /// creates a symbol node according to the current parsed symbol name
-    TNode<T> *createSymbol();
-    /// parses the parameter of a function (including the brackets)
-    TNode<T> *param();
+    TReader(const char *ABegin, const char *AEnd, bool AEquation);
+    ~TReader();
+
+    /// parses the whole input and returns its expression tree
+    TNode<T> *parse();
+
+    /// reads an operand (or a prefix of it) and returns true if still expecting one
+    bool operand();
+    /// reads what follows an operand and returns true if an operand is expected next
+    bool operation();
+    /// opens a new group of given kind (the current token is its opening bracket, or = for let)
+    void open(TGroupKind AKind, const char *AName = 0, unsigned ANameLength = 0);
+    /// closes the current group (or an argument of it) and returns true if another one follows
+    bool close();
+    /// closes the value or the body of the let being read, as close() does
+    bool closeLet();
+    /// throws because the current token is not allowed after an operand
+    void unexpected() const;
+
+    /// pushes given binary operator after reducing the ones binding tighter
+    void push(TOperator AOperator);
+    /// applies all pending operators down to the operator stack size ABase
+    void reduce(unsigned ABase);
+    /// applies the top most operator onto its operands
+    void apply();
+    /// returns the binding priority of given operator (higher binds tighter)
+    static int priority(TOperator AOperator);
+
+    /// returns the built-in the current symbol names (kwNone if none)
+    TKeyword keyword() const;
 
     /// returns true if parser reached end of input
     bool eof() const;
@@ -101,6 +152,9 @@ private:
     /// reads a symbol and returns true on success, result is stored in FSymbol
     bool readSymbol();
 
+    /// converts the number string [ABegin, AEnd) into AResult
+    static void convert(const char *ABegin, const char *AEnd, T& AResult);
+
     /// returns the string according to the given token.
     static std::string tok2str(TToken AToken);
     /// expects current token as given and throws on fail, otherwise reads next token.
@@ -112,6 +166,20 @@ public:
       * Equation parsing is enabled if AEquation is !false.
       */
     static TNode<T> *parse(const std::string& AInput, bool AEquation = false);
+
+    /**
+      * Parses the expression string [ABegin, AEnd) in place, it doesn't need 
+      * to be zero terminated. This avoids copying, e.g. when parsing many 
+      * formulas out of one large buffer.
+      */
+    static TNode<T> *parse(const char *ABegin, const char *AEnd, bool AEquation = false);
+
+    /**
+      * Parses the parameter list [ABegin, AEnd) of a function, e.g. "x, y, z",
+      * and stores the parameters following x into AResult. The first one has
+      * to be x, the further ones must be distinct and no built-ins.
+      */
+    static void parseParams(const char *ABegin, const char *AEnd, std::vector<std::string>& AResult);
 };
 
 } // namespace math
@@ -25,268 +25,586 @@
 #endif
 
 #include <memory>
+#include <algorithm>
 #include <sstream>
 #include <iostream> // just for debuggin
 
 #include <cstring>
+#include <cstdlib>
 #include <cctype>
 
 namespace math {
 
 // TReader<>
 template<class T>
-TReader<T>::TReader(const std::string& AInput) :
-    FExprStr(AInput), FPos(0), FToken(tkInvalid) {
+TReader<T>::TReader(const char *ABegin, const char *AEnd, bool AEquation) :
+    FPos(ABegin), FEnd(AEnd), FToken(tkInvalid), FSymbol(0), FSymbolLength(0),
+    FEquation(AEquation), FRelations(0) {
+
+    // enough for usual formulas, so the stacks don't need to grow
+    FOperands.reserve(16);
+    FOperators.reserve(16);
+    FGroups.reserve(8);
+}
+
+template<class T>
+TReader<T>::~TReader() {
+    // only non-empty if parsing has been aborted by an exception
+    for (unsigned i = 0; i < FOperands.size(); ++i)
+        delete FOperands[i];
 }
 
 template<class T>
 TNode<T> *TReader<T>::parse(const std::string& AInput, bool AEquation) {
-    TReader<T> reader(AInput);
-    TNode<T> *e = AEquation ? reader.equation(true) : reader.expr(true);
+    return parse(AInput.data(), AInput.data() + AInput.size(), AEquation);
+}
 
-    if (reader.FToken != tkEnd) {
-        throw EReadError("Unexpected characters left on input (" 
-            + tok2str(reader.FToken) + ").");
+template<class T>
+TNode<T> *TReader<T>::parse(const char *ABegin, const char *AEnd, bool AEquation) {
+    TReader<T> reader(ABegin, AEnd, AEquation);
+
+    return reader.parse();
+}
+
+template<class T>
+void TReader<T>::parseParams(const char *ABegin, const char *AEnd, std::vector<std::string>& AResult) {
+    TReader<T> reader(ABegin, AEnd, false);
+    std::vector<std::string> result;
+
+    if (reader.nextToken() != tkSymbol || reader.keyword() != kwParam)
+        throw EReadError("The first parameter must be x.");
+
+    while (reader.nextToken() == tkComma) {
+        if (reader.nextToken() != tkSymbol)
+            throw EReadError("Expected a parameter but got " + tok2str(reader.FToken) + " instead.");
+
+        const std::string name(reader.FSymbol, reader.FSymbolLength);
+
+        if (reader.keyword() != kwNone)
+            throw EReadError("A parameter must not be a built-in: " + name + ".");
+
+        if (std::find(result.begin(), result.end(), name) != result.end())
+            throw EReadError("Duplicated parameter: " + name + ".");
+
+        result.push_back(name);
     }
 
-    return e;
+    if (reader.FToken != tkEnd)
+        throw EReadError("Unexpected characters left on input ("
+            + tok2str(reader.FToken) + ").");
+
+    AResult.swap(result);
 }
 
 template<class T>
-TNode<T> *TReader<T>::equation(bool get) {
-    TNode<T> *left = simpleExpr(get);
+TNode<T> *TReader<T>::parse() {
+    bool expectOperand = true;
+
+    nextToken();
+    while (expectOperand || FToken != tkEnd || !FGroups.empty())
+        expectOperand = expectOperand ? operand() : operation();
 
+    reduce(0);
+
+    // Enforce a syntax error. Because the input is no equation as requested.
+    if (FEquation && !FRelations)
+        consume(tkEqu);
+
+    TNode<T> *result = FOperands.back();
+    FOperands.pop_back();
+
+    return result;
+}
+
+template<class T>
+bool TReader<T>::operand() {
     switch (FToken) {
-        case tkEqu:
-            left = new TEquNode<T>(left, simpleExpr(true));
-            break;
-        case tkUnEqu:
-            left = new TUnEquNode<T>(left, simpleExpr(true));
-            break;
-        case tkGreater:
-            left = new TGreaterNode<T>(left, simpleExpr(true));
-            break;
-        case tkLess:
-            left = new TLessNode<T>(left, simpleExpr(true));
-            break;
-        case tkGreaterEqu:
-            left = new TGreaterEquNode<T>(left, simpleExpr(true));
-            break;
-        case tkLessEqu:
-            left = new TLessEquNode<T>(left, simpleExpr(true));
+        case tkPlus:
+            nextToken();
+            return true;
+        case tkMinus:
+            FOperators.push_back(opNeg);
+            nextToken();
+            return true;
+        case tkRndOpen:
+            open(gkRound);
+            return true;
+        case tkBrOpen:
+            open(gkSquare);
+            return true;
+        case tkNumber:
+            FOperands.push_back(new TNumberNode<T>(FNumber));
+            nextToken();
+            return false;
+        case tkSymbol:
             break;
+        case tkEnd:
+            throw EReadError("Incomplete expression.");
         default:
-            // Enforce a syntax error. Because the input is no 
-            // equation as requested.
-            consume(tkEqu);
+            throw EReadError("Unexpected token " + tok2str(FToken) + ".");
     }
-    return left;
-}
 
-template<class T>
-TNode<T> *TReader<T>::expr(bool get) {
-    TNode<T> *left = simpleExpr(get);
-    
-    while (true) {
-        switch (FToken) {
-            case tkEqu:
-                left = new TEquNode<T>(left, simpleExpr(true));
-                break;
-            case tkUnEqu:
-                left = new TUnEquNode<T>(left, simpleExpr(true));
-                break;
-            case tkGreater:
-                left = new TGreaterNode<T>(left, simpleExpr(true));
-                break;
-            case tkLess:
-                left = new TLessNode<T>(left, simpleExpr(true));
-                break;
-            case tkGreaterEqu:
-                left = new TGreaterEquNode<T>(left, simpleExpr(true));
-                break;
-            case tkLessEqu:
-                left = new TLessEquNode<T>(left, simpleExpr(true));
-                break;
-            default:
-                return left;
+    switch (keyword()) {
+        case kwParam:
+            FOperands.push_back(new TParamNode<T>());
+            nextToken();
+            return false;
+        case kwSqrt:
+            nextToken();
+            open(gkSqrt);
+            return true;
+        case kwSin:
+            nextToken();
+            open(gkSin);
+            return true;
+        case kwCos:
+            nextToken();
+            open(gkCos);
+            return true;
+        case kwTan:
+            nextToken();
+            open(gkTan);
+            return true;
+        case kwLn:
+            nextToken();
+            open(gkLn);
+            return true;
+        case kwIf:
+            nextToken();
+            open(gkIf);
+            return true;
+        case kwTable:
+            // TABLE(name, x) or TABLE(name, x, order)
+            nextToken();
+            open(gkTable);
+
+            if (FToken != tkSymbol)
+                throw EReadError("Expected a table name but got " + tok2str(FToken) + " instead.");
+
+            FGroups.back().name = FSymbol;
+            FGroups.back().nameLength = FSymbolLength;
+
+            nextToken();
+            consume(tkComma);
+            return true;
+        case kwSum:
+        case kwProd: {
+            // sum(k, lower, upper, expr) or prod(k, lower, upper, expr)
+            const TGroupKind kind = keyword() == kwSum ? gkSum : gkProd;
+
+            nextToken();
+            open(kind);
+
+            if (FToken != tkSymbol)
+                throw EReadError("Expected an index symbol but got " + tok2str(FToken) + " instead.");
+
+            if (keyword() != kwNone)
+                throw EReadError("The index of sum() or prod() must not be a built-in: "
+                    + std::string(FSymbol, FSymbolLength) + ".");
+
+            FGroups.back().name = FSymbol;
+            FGroups.back().nameLength = FSymbolLength;
+
+            nextToken();
+            consume(tkComma);
+            return true;
         }
-    }
-}
+        case kwLet: {
+            // let name = value in body
+            if (nextToken() != tkSymbol)
+                throw EReadError("Expected a symbol to bind but got " + tok2str(FToken) + " instead.");
 
-template<class T>
-TNode<T> *TReader<T>::simpleExpr(bool get) {
-    TNode<T> *left = term(get);
-
-    while (true) {
-        switch (FToken) {
-            case tkPlus:
-                left = new TPlusNode<T>(left, term(true));
-                break;
-            case tkMinus:
-                left = new TPlusNode<T>(left, new TNegNode<T>(term(true)));
-                break;
-            default:
-                return left;
+            if (keyword() != kwNone)
+                throw EReadError("The symbol bound by let must not be a built-in: "
+                    + std::string(FSymbol, FSymbolLength) + ".");
+
+            const char *name = FSymbol;
+            unsigned length = FSymbolLength;
+
+            nextToken();
+            open(gkLet, name, length);
+            return true;
         }
+        case kwIn:
+            throw EReadError("Unexpected in, the value bound by let is missing.");
+        default:
+            break;
+    }
+
+    // okay, it's a user defined function to be called, or any constant 
+    // defined in a library
+    const char *name = FSymbol;
+    unsigned length = FSymbolLength;
+
+    if (nextToken() == tkRndOpen) {
+        open(gkFunc, name, length);
+        return true;
     }
+
+    // a constant
+    FOperands.push_back(new TSymbolNode<T>(std::string(name, length)));
+    return false;
 }
 
 template<class T>
-TNode<T> *TReader<T>::term(bool get) {
-    TNode<T> *left = factor(get);
-
-    while (true) {
-        switch (FToken) {
-            case tkMul:
-                left = new TMulNode<T>(left, factor(true));
-                break;
-            case tkDiv:
-                left = new TDivNode<T>(left, factor(true));
-                break;
-            case tkSymbol:
-            case tkRndOpen:
-            case tkBrOpen:
-                // "algebraische schreibweise, z.B.: 2x+3, anstatt 2*x+3"
-                left = new TMulNode<T>(left, factor(false));
-            default:
-                return left;
-        }
+bool TReader<T>::operation() {
+    switch (FToken) {
+        case tkPlus:        push(opPlus); break;
+        case tkMinus:       push(opMinus); break;
+        case tkMul:         push(opMul); break;
+        case tkDiv:         push(opDiv); break;
+        case tkPow:         push(opPow); break;
+        case tkEqu:         push(opEqu); break;
+        case tkUnEqu:       push(opUnEqu); break;
+        case tkLess:        push(opLess); break;
+        case tkGreater:     push(opGreater); break;
+        case tkLessEqu:     push(opLessEqu); break;
+        case tkGreaterEqu:  push(opGreaterEqu); break;
+        case tkSymbol:
+            // the in of let ends its value (and any let body nested within it)
+            if (keyword() == kwIn) {
+                if (FGroups.empty() || FGroups.back().kind != gkLet)
+                    throw EReadError("Unexpected in without let.");
+
+                return close();
+            }
+            // fall through
+        case tkRndOpen:
+        case tkBrOpen:
+            // "algebraische schreibweise, z.B.: 2x+3, anstatt 2*x+3"
+            push(opMul);
+            return true; // the current token already starts the operand
+        default:
+            if (FGroups.empty())
+                unexpected();
+
+            return close();
     }
+
+    nextToken();
+    return true;
 }
 
 template<class T>
-TNode<T> *TReader<T>::factor(bool get) {
-    TNode<T> *left = prim(get);
-
-    while (true) {
-        switch (FToken) {
-            case tkPow:
-                left = new TPowNode<T>(left, factor(true));
-            default:
-                return left;
-        }
-    }
+void TReader<T>::open(TGroupKind AKind, const char *AName, unsigned ANameLength) {
+    TGroup group;
+    group.kind = AKind;
+    group.base = FOperators.size();
+    group.args = 0;
+    group.name = AName;
+    group.nameLength = ANameLength;
+
+    consume(AKind == gkSquare ? tkBrOpen : AKind == gkLet ? tkEqu : tkRndOpen);
+
+    FGroups.push_back(group);
 }
 
 template<class T>
-TNode<T> *TReader<T>::prim(bool get) {
-    TNode<T> *n = 0;
+bool TReader<T>::close() {
+    const TGroup group = FGroups.back();
 
-    if (get)
-        nextToken();
+    if (group.kind == gkLet)
+        return closeLet();
 
-    switch (FToken) {
-        case tkPlus:
-            n = prim(true);
+    // TABLE()'s derivative order is optional, functions take any number of arguments
+    const bool more = (group.kind == gkIf && group.args < 2)
+        || (group.kind == gkTable && group.args == 0 && FToken == tkComma)
+        || ((group.kind == gkSum || group.kind == gkProd) && group.args < 2)
+        || (group.kind == gkFunc && FToken == tkComma);
+
+    if (group.kind == gkSquare)
+        consume(tkBrClose);
+    else if (more)
+        consume(tkComma);
+    else
+        consume(tkRndClose);
+
+    reduce(group.base);
+
+    switch (group.kind) {
+        case gkSin:
+            FOperands.back() = new TSinNode<T>(FOperands.back());
             break;
-        case tkMinus:
-            n = new TNegNode<T>(prim(true));
+        case gkCos:
+            FOperands.back() = new TCosNode<T>(FOperands.back());
             break;
-        case tkRndOpen:
-            n = expr(true);
-            consume(tkRndClose);
+        case gkTan:
+            FOperands.back() = new TTanNode<T>(FOperands.back());
             break;
-        case tkBrOpen:
-            n = expr(true);
-            consume(tkBrClose);
+        case gkSqrt:
+            FOperands.back() = new TSqrtNode<T>(FOperands.back());
             break;
-        case tkNumber:
-            n = new TNumberNode<T>(FNumber);
-            nextToken();
+        case gkLn:
+            FOperands.back() = new TLnNode<T>(FOperands.back());
             break;
-        case tkSymbol:
-            n = createSymbol();
+        case gkFunc: {
+            if (more) {
+                ++FGroups.back().args;
+                return true;
+            }
+
+            const unsigned first = FOperands.size() - 1 - group.args;
+            TFuncNode<T> *call = new TFuncNode<T>(
+                std::string(group.name, group.nameLength), FOperands[first]);
+
+            FOperands[first] = call;
+            for (unsigned i = first + 1; i < FOperands.size(); ++i)
+                call->addParam(FOperands[i]);
+
+            FOperands.resize(first + 1);
             break;
-        case tkEnd:
-            throw EReadError("Incomplete expression.");
+        }
+        case gkIf: {
+            if (group.args < 2) {
+                // the next argument follows
+                ++FGroups.back().args;
+                return true;
+            }
+
+            TNode<T> *elseExpr = FOperands.back();
+            FOperands.pop_back();
+            TNode<T> *thenExpr = FOperands.back();
+            FOperands.pop_back();
+
+            FOperands.back() = new TIfNode<T>(FOperands.back(), thenExpr, elseExpr);
+            break;
+        }
+        case gkTable: {
+            if (more) {
+                ++FGroups.back().args;
+                return true;
+            }
+
+            unsigned order = 0;
+            if (group.args) {
+                std::auto_ptr<TNode<T> > node(FOperands.back());
+                FOperands.pop_back();
+
+                if (node->nodeType() != TNode<T>::NUMBER_NODE)
+                    throw EReadError("The order of TABLE() must be a natural number.");
+
+                const T number(static_cast<TNumberNode<T> *>(node.get())->number());
+                while (order < 256 && T(order) != number)
+                    ++order;
+
+                if (order == 256)
+                    throw EReadError("The order of TABLE() must be a natural number.");
+            }
+
+            FOperands.back() = new TTableNode<T>(
+                std::string(group.name, group.nameLength), FOperands.back(), order);
+            break;
+        }
+        case gkSum:
+        case gkProd: {
+            if (more) {
+                ++FGroups.back().args;
+                return true;
+            }
+
+            TNode<T> *body = FOperands.back();
+            FOperands.pop_back();
+            TNode<T> *upper = FOperands.back();
+            FOperands.pop_back();
+
+            const std::string index(group.name, group.nameLength);
+
+            if (group.kind == gkSum)
+                FOperands.back() = new TSumNode<T>(index, FOperands.back(), upper, body);
+            else
+                FOperands.back() = new TProdNode<T>(index, FOperands.back(), upper, body);
+            break;
+        }
         default:
-            throw EReadError("Unexpected token " + tok2str(FToken) + ".");
-            ;// unknown or misplaced token? (returns automatically 0)
+            // just brackets
+            break;
     }
 
-    return n;
+    FGroups.pop_back();
+    return false;
 }
 
 template<class T>
-TNode<T> *TReader<T>::createSymbol() {
-    if (FSymbol == "x") {
-        nextToken();
-        return new TParamNode<T>();
-    } else if (FSymbol == "sin")
-        return new TSinNode<T>(param());
-    else if (FSymbol == "cos")
-        return new TCosNode<T>(param());
-    else if (FSymbol == "tan")
-        return new TTanNode<T>(param());
-    else if (FSymbol == "ln")
-        return new TLnNode<T>(param());
-    else if (FSymbol == "IF") { // example
+bool TReader<T>::closeLet() {
+    const TGroup group = FGroups.back();
+
+    reduce(group.base);
+
+    if (!group.args) {
+        // the value is complete, the body follows
+        if (FToken != tkSymbol || keyword() != kwIn)
+            throw EReadError("Expected in but got " + tok2str(FToken) + " instead.");
+
         nextToken();
+        ++FGroups.back().args;
+        return true;
+    }
 
-        consume(tkRndOpen);
-        TNode<T> *ifExpr = expr(false);
-        consume(tkComma);
-        TNode<T> *thenExpr = expr(false);
-        consume(tkComma);
-        TNode<T> *elseExpr = expr(false);
-        consume(tkRndClose);
+    // the token ending the body is left to the enclosing group
+    TNode<T> *body = FOperands.back();
+    FOperands.pop_back();
 
-        return new TIfNode<T>(ifExpr, thenExpr, elseExpr);
-    } else {
-        // okay, it's a user defined function to be called, or any constant 
-        // defined in a library
-        std::string name(FSymbol);
+    FOperands.back() = new TLetNode<T>(std::string(group.name, group.nameLength),
+        FOperands.back(), body);
+
+    FGroups.pop_back();
+    return false;
+}
+
+template<class T>
+void TReader<T>::unexpected() const {
+    if (FEquation && !FRelations)
+        throw EReadError("Expected token was " + tok2str(tkEqu) 
+            + " but got " + tok2str(FToken) + " instead.");
 
-        if (nextToken() == tkRndOpen) {
-#if 0 // TO BE IMPLEMENTED / DONE
-            // a function
-            TFuncNode *node = new TFuncNode<T>(name);
+    throw EReadError("Unexpected characters left on input (" 
+        + tok2str(FToken) + ").");
+}
 
-            node->addParam(expr(true));
+template<class T>
+void TReader<T>::push(TOperator AOperator) {
+    const int prio = priority(AOperator);
 
-            while (FToken == tkComma)
-                node->addParam(expr(true));
+    if (prio == priority(opEqu) && FGroups.empty()) {
+        // equations are made of exactly one relation
+        if (FEquation && FRelations)
+            unexpected();
 
-            consume(tkRndClose);
+        ++FRelations;
+    }
 
-            return node;
-#else
-            TNode<T> *param = expr(true);
-            consume(tkRndClose);
-            return new TFuncNode<T>(name, param);
-#endif
-        } else
-            // a constant
-            return new TSymbolNode<T>(name);
+    // everything is left associative, except the power operator
+    const unsigned base = FGroups.empty() ? 0 : FGroups.back().base;
+    while (FOperators.size() > base && (priority(FOperators.back()) > prio 
+            || (priority(FOperators.back()) == prio && AOperator != opPow)))
+        apply();
+
+    FOperators.push_back(AOperator);
+}
+
+template<class T>
+void TReader<T>::reduce(unsigned ABase) {
+    while (FOperators.size() > ABase)
+        apply();
+}
+
+template<class T>
+void TReader<T>::apply() {
+    const TOperator op = FOperators.back();
+    FOperators.pop_back();
+
+    TNode<T> *right = FOperands.back();
+
+    if (op == opNeg) {
+        FOperands.back() = new TNegNode<T>(right);
+        return;
+    }
+
+    FOperands.pop_back();
+    TNode<T> *left = FOperands.back();
+
+    switch (op) {
+        case opPlus:
+            FOperands.back() = new TPlusNode<T>(left, right);
+            break;
+        case opMinus:
+            FOperands.back() = new TPlusNode<T>(left, new TNegNode<T>(right));
+            break;
+        case opMul:
+            FOperands.back() = new TMulNode<T>(left, right);
+            break;
+        case opDiv:
+            FOperands.back() = new TDivNode<T>(left, right);
+            break;
+        case opPow:
+            FOperands.back() = new TPowNode<T>(left, right);
+            break;
+        case opEqu:
+            FOperands.back() = new TEquNode<T>(left, right);
+            break;
+        case opUnEqu:
+            FOperands.back() = new TUnEquNode<T>(left, right);
+            break;
+        case opLess:
+            FOperands.back() = new TLessNode<T>(left, right);
+            break;
+        case opGreater:
+            FOperands.back() = new TGreaterNode<T>(left, right);
+            break;
+        case opLessEqu:
+            FOperands.back() = new TLessEquNode<T>(left, right);
+            break;
+        case opGreaterEqu:
+            FOperands.back() = new TGreaterEquNode<T>(left, right);
+            break;
+        default:
+            break;
     }
 }
 
 template<class T>
-TNode<T> *TReader<T>::param() {
-    consume(tkSymbol);
-    consume(tkRndOpen);
-    TNode<T> *param = expr(false);
-    consume(tkRndClose);
+int TReader<T>::priority(TOperator AOperator) {
+    switch (AOperator) {
+        case opNeg:
+            return 5;
+        case opPow:
+            return 4;
+        case opMul:
+        case opDiv:
+            return 3;
+        case opPlus:
+        case opMinus:
+            return 2;
+        default:
+            // relations
+            return 1;
+    }
+}
 
-    return param;
+template<class T>
+typename TReader<T>::TKeyword TReader<T>::keyword() const {
+    // A perfect hash over the built-ins: (2 * first char + last char) mod 25
+    // maps each of them onto a distinct slot, so one compare is sufficient.
+    static const struct {
+        const char *name;
+        unsigned length;
+        TKeyword keyword;
+    } keywords[25] = {
+        { "", 0, kwNone }, { "ln", 2, kwLn }, { "", 0, kwNone }, { "", 0, kwNone },
+        { "", 0, kwNone }, { "", 0, kwNone }, { "", 0, kwNone }, { "let", 3, kwLet },
+        { "", 0, kwNone }, { "", 0, kwNone }, { "x", 1, kwParam }, { "", 0, kwNone },
+        { "TABLE", 5, kwTable }, { "cos", 3, kwCos }, { "sum", 3, kwSum }, { "sin", 3, kwSin },
+        { "IF", 2, kwIf }, { "tan", 3, kwTan }, { "", 0, kwNone }, { "", 0, kwNone },
+        { "in", 2, kwIn }, { "sqrt", 4, kwSqrt }, { "", 0, kwNone }, { "", 0, kwNone },
+        { "prod", 4, kwProd }
+    };
+
+    unsigned i = (2 * static_cast<unsigned char>(FSymbol[0]) 
+                + static_cast<unsigned char>(FSymbol[FSymbolLength - 1])) % 25;
+
+    if (keywords[i].length == FSymbolLength 
+            && std::memcmp(keywords[i].name, FSymbol, FSymbolLength) == 0)
+        return keywords[i].keyword;
+
+    return kwNone;
 }
 
 template<class T>
 bool TReader<T>::eof() const {
-    return FPos >= FExprStr.size();
+    return FPos >= FEnd;
 }
 
 template<class T>
 typename TReader<T>::TToken TReader<T>::nextToken() {
     // reset data
     FToken = tkInvalid;
-    FSymbol.erase();
+    FSymbolLength = 0;
 
     // skip spaces
 #if defined(__GNUC__) && (__GNUC__ < 3)
-    while (FPos < FExprStr.size() && isspace(FExprStr[FPos]))
+    while (FPos < FEnd && isspace(static_cast<unsigned char>(*FPos)))
 #else
-    while (FPos < FExprStr.size() && std::isspace(FExprStr[FPos]))
+    while (FPos < FEnd && std::isspace(static_cast<unsigned char>(*FPos)))
 #endif
         ++FPos;
 
@@ -307,29 +625,34 @@ typename TReader<T>::TToken TReader<T>::nextToken() {
 
 template<class T>
 bool TReader<T>::readOperator() {
-    if (std::strchr("+-*/^(,)[]=", FExprStr[FPos])) {
-        FToken = TToken(FExprStr[FPos++]);
-        return true;
-    }
-
-    switch (FExprStr[FPos]) {
+    switch (*FPos) {
+        case '+': case '-': case '*': case '/': case '^':
+        case '(': case ',': case ')': case '[': case ']': case '=':
+            FToken = TToken(*FPos++);
+            return true;
         case '<':
-            switch (FExprStr[++FPos]) {
-                case '=':
-                    ++FPos;
-                    return FToken = tkLessEqu;
-                case '>':
-                    ++FPos;
-                    return FToken = tkUnEqu;
-                default:
-                    return FToken = tkLess;
+            if (++FPos < FEnd) {
+                switch (*FPos) {
+                    case '=':
+                        ++FPos;
+                        FToken = tkLessEqu;
+                        return true;
+                    case '>':
+                        ++FPos;
+                        FToken = tkUnEqu;
+                        return true;
+                }
             }
+            FToken = tkLess;
+            return true;
         case '>':
-            if (FExprStr[++FPos] == tkEqu) {
+            if (++FPos < FEnd && *FPos == tkEqu) {
                 ++FPos;
-                return FToken = tkGreaterEqu;
+                FToken = tkGreaterEqu;
+                return true;
             }
-            return FToken = tkGreater;
+            FToken = tkGreater;
+            return true;
         default:
             return false;
     }
@@ -337,16 +660,17 @@ bool TReader<T>::readOperator() {
 
 template<class T>
 bool TReader<T>::readNumber() {
+    const char *start = FPos;
+
 #if defined(__GNUC__) && (__GNUC__ < 3)
-    while (isdigit(FExprStr[FPos]) || FExprStr[FPos] == '.')
+    while (FPos < FEnd && (isdigit(static_cast<unsigned char>(*FPos)) || *FPos == '.'))
 #else
-    while (std::isdigit(FExprStr[FPos]) || FExprStr[FPos] == '.')
+    while (FPos < FEnd && (std::isdigit(static_cast<unsigned char>(*FPos)) || *FPos == '.'))
 #endif
-        FSymbol += FExprStr[FPos++];
+        ++FPos;
 
-    if (FSymbol.size()) {
-        std::stringstream sstr(FSymbol);
-        sstr >> FNumber;
+    if (FPos != start) {
+        convert(start, FPos, FNumber);
 
         return true;
     }
@@ -355,14 +679,41 @@ bool TReader<T>::readNumber() {
 
 template<class T>
 bool TReader<T>::readSymbol() {
+    FSymbol = FPos;
+
 #if defined(__GNUC__) && (__GNUC__ < 3)
-    while (FPos < FExprStr.size() && isalpha(FExprStr[FPos]))
+    while (FPos < FEnd && isalpha(static_cast<unsigned char>(*FPos)))
 #else
-    while (FPos < FExprStr.size() && std::isalpha(FExprStr[FPos]))
+    while (FPos < FEnd && std::isalpha(static_cast<unsigned char>(*FPos)))
 #endif
-        FSymbol += FExprStr[FPos++];
+        ++FPos;
+
+    FSymbolLength = FPos - FSymbol;
+
+    return FSymbolLength;
+}
+
+template<class T>
+void TReader<T>::convert(const char *ABegin, const char *AEnd, T& AResult) {
+    std::stringstream sstr(std::string(ABegin, AEnd - ABegin));
+    sstr >> AResult;
+}
+
+// doubles are converted by strtod() from a stack copy, as the input
+// doesn't need to be zero terminated.
+template<>
+inline void TReader<double>::convert(const char *ABegin, const char *AEnd, double& AResult) {
+    char buf[64];
 
-    return FSymbol.size();
+    if (AEnd - ABegin < static_cast<long>(sizeof(buf))) {
+        std::memcpy(buf, ABegin, AEnd - ABegin);
+        buf[AEnd - ABegin] = '\0';
+
+        AResult = std::strtod(buf, 0);
+    } else {
+        std::stringstream sstr(std::string(ABegin, AEnd - ABegin));
+        sstr >> AResult;
+    }
 }
 
 template<class T>
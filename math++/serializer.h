@@ -0,0 +1,147 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the binary expression format interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_serializer_h
+#define libmath_serializer_h
+
+#include <math++/error.h>
+
+#include <string>
+#include <vector>
+
+namespace math {
+
+template<class> class TNode;
+template<class> class TLibrary;
+
+/**
+  * EFormatError is thrown whenever binary data can't be read back, 
+  * e.g. because it's truncated, corrupted or of an unknown version.
+  */
+class EFormatError : public EMath {
+public:
+    EFormatError(const std::string& AReason) : EMath(AReason) {}
+};
+
+/**
+  * TSerializer<> writes expression trees and whole libraries in a compact
+  * binary format and reads them back, without any loss of precision.
+  *
+  * The format is the same on every platform (little endian):
+  *
+  *   header:   "LMBF", version, content (1 = tree, 2 = library),
+  *             number encoding (0 = text, 1 = IEEE 754 double), 0
+  *   tree:     node count, then the nodes in postfix order, each an 
+  *             opcode byte followed by its number or name, if any
+  *             (small natural numbers are stored as counts)
+  *   library:  constant count, each name and value,
+  *             function count, each name, parameter count and 
+  *             names (those following x) and tree,
+  *             table count, each name, interpolation (0 = linear, 
+  *             1 = cubic), point count, the x values and the y values
+  *   trailer:  CRC-32 of all the bytes before
+  *
+  * Version 1 data (without tables) and version 2 data (without let and
+  * multi-argument functions) is still read.
+  *
+  * Counts and string lengths are stored as LEB128 variable length integers.
+  * Trees are written and read without recursion, so they may be of any height.
+  */
+template<class T>
+class TSerializer {
+public:
+    /// appends the binary form of the expression tree AExpression to AOutput
+    static void write(const TNode<T> *AExpression, std::string& AOutput);
+    /// appends the binary form of all elements of ALibrary to AOutput
+    static void write(const TLibrary<T>& ALibrary, std::string& AOutput);
+
+    /// reads an expression tree from [ABegin, AEnd), the caller owns it
+    static TNode<T> *read(const char *ABegin, const char *AEnd);
+    /// reads an expression tree from AInput, the caller owns it
+    static TNode<T> *read(const std::string& AInput);
+
+    /// reads all elements from [ABegin, AEnd) into ALibrary, which is left unchanged on errors
+    static void read(const char *ABegin, const char *AEnd, TLibrary<T>& ALibrary);
+    /// reads all elements from AInput into ALibrary
+    static void read(const std::string& AInput, TLibrary<T>& ALibrary);
+
+private:
+    enum TContent { ctTree = 1, ctLibrary = 2 };
+    enum TEncoding { enText = 0, enDouble = 1 };
+
+    /// the opcodes as stored, never reorder them
+    enum TOpcode {
+        ocNumber = 1, ocSymbol, ocParam, 
+        ocPlus, ocNeg, ocMul, ocDiv, ocPow, ocSqrt,
+        ocSin, ocCos, ocTan, ocLn, ocFunc, ocIf,
+        ocEqu, ocUnEqu, ocLess, ocGreater, ocLessEqu, ocGreaterEqu,
+        ocInteger,              // a number stored as count
+        ocTable,                // since version 2, name and order follow
+        ocSum, ocProd,          // since version 2, the index name follows
+        ocLet,                  // since version 3, the bound name follows
+        ocCall                  // since version 3, argument count and name follow
+    };
+
+    enum { formatVersion = 3 };
+
+    /// TInput walks through the bytes to be read
+    struct TInput {
+        const char *pos;
+        const char *end;
+        unsigned version;
+
+        TInput(const char *ABegin, const char *AEnd, unsigned AVersion) :
+            pos(ABegin), end(AEnd), version(AVersion) {}
+
+        unsigned char byte();
+        unsigned long count();
+        std::string name();
+        void skip(unsigned long ACount);
+    };
+
+    /// returns the number encoding used for T
+    static unsigned char encoding();
+    /// returns true if ANumber is a small natural number and can be stored as count
+    static bool integral(const T& ANumber, unsigned long& AResult);
+
+    /// returns the format version AOpcode got introduced with
+    static unsigned since(unsigned char AOpcode);
+
+    static void writeHeader(TContent AContent, std::string& AOutput);
+    /// appends the checksum of everything from AStart on
+    static void writeTrailer(std::string::size_type AStart, std::string& AOutput);
+    static void writeTree(const TNode<T> *AExpression, std::string& AOutput);
+    static void writeCount(unsigned long ACount, std::string& AOutput);
+    static void writeName(const std::string& AName, std::string& AOutput);
+    static void writeNumber(const T& ANumber, std::string& AOutput);
+
+    /// checks header and trailer of [ABegin, AEnd), returns the payload
+    static TInput open(const char *ABegin, const char *AEnd, TContent AContent);
+    static TNode<T> *readTree(TInput& AInput);
+    static T readNumber(TInput& AInput);
+};
+
+} // namespace math
+
+#include <math++/serializer.tcc>
+
+#endif
@@ -0,0 +1,582 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the binary expression format template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_serializer_h
+#error You may not include math++/serializer.tcc directly; include math++/serializer.h instead.
+#endif
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/reader.h>
+#include <math++/utils.h>
+
+#include <sstream>
+#include <limits>
+#include <cstring>
+#include <cmath>
+#include <utility>
+#include <set>
+
+namespace math {
+
+template<class T>
+void TSerializer<T>::write(const TNode<T> *AExpression, std::string& AOutput) {
+    std::string::size_type start = AOutput.size();
+
+    writeHeader(ctTree, AOutput);
+    writeTree(AExpression, AOutput);
+    writeTrailer(start, AOutput);
+}
+
+template<class T>
+void TSerializer<T>::write(const TLibrary<T>& ALibrary, std::string& AOutput) {
+    std::string::size_type start = AOutput.size();
+
+    writeHeader(ctLibrary, AOutput);
+
+    writeCount(ALibrary.FConstants.size(), AOutput);
+    for (typename TLibrary<T>::TConstantList::const_iterator i = ALibrary.FConstants.begin();
+        i != ALibrary.FConstants.end(); ++i) {
+        writeName(i->name(), AOutput);
+        writeNumber(i->value(), AOutput);
+    }
+
+    writeCount(ALibrary.FFunctions.size(), AOutput);
+    for (typename TLibrary<T>::TFunctionList::const_iterator i = ALibrary.FFunctions.begin();
+        i != ALibrary.FFunctions.end(); ++i) {
+        writeName(i->name(), AOutput);
+
+        writeCount(i->params().size(), AOutput);
+        for (unsigned k = 0; k < i->params().size(); ++k)
+            writeName(i->params()[k], AOutput);
+
+        writeTree(i->expression(), AOutput);
+    }
+
+    writeCount(ALibrary.FTables.size(), AOutput);
+    for (typename TLibrary<T>::TTableList::const_iterator i = ALibrary.FTables.begin();
+        i != ALibrary.FTables.end(); ++i) {
+        writeName(i->name(), AOutput);
+        AOutput += char(i->interpolation() == TTable<T>::CUBIC ? 1 : 0);
+
+        writeCount(i->x().size(), AOutput);
+        for (unsigned k = 0; k < i->x().size(); ++k)
+            writeNumber(i->x()[k], AOutput);
+        for (unsigned k = 0; k < i->y().size(); ++k)
+            writeNumber(i->y()[k], AOutput);
+    }
+
+    writeTrailer(start, AOutput);
+}
+
+template<class T>
+TNode<T> *TSerializer<T>::read(const char *ABegin, const char *AEnd) {
+    TInput input(open(ABegin, AEnd, ctTree));
+    TNode<T> *result = readTree(input);
+
+    if (input.pos != input.end) {
+        delete result;
+        throw EFormatError("Unexpected data after the expression tree.");
+    }
+    return result;
+}
+
+template<class T>
+TNode<T> *TSerializer<T>::read(const std::string& AInput) {
+    return read(AInput.data(), AInput.data() + AInput.size());
+}
+
+template<class T>
+void TSerializer<T>::read(const char *ABegin, const char *AEnd, TLibrary<T>& ALibrary) {
+    TInput input(open(ABegin, AEnd, ctLibrary));
+
+    // everything is decoded and checked first, so ALibrary stays as it is 
+    // on any error
+    std::vector<TConstant<T> > constants;
+    for (unsigned long n = input.count(); n; --n) {
+        std::string name(input.name());
+        constants.push_back(TConstant<T>(name, readNumber(input)));
+    }
+
+    // the functions are decoded as a whole, the library's index stays denser that way
+    std::vector<std::pair<std::string, TNode<T> *> > functions;
+    std::vector<std::vector<std::string> > params;
+    unsigned i = 0;
+
+    try {
+        for (unsigned long n = input.count(); n; --n) {
+            functions.push_back(std::make_pair(input.name(), static_cast<TNode<T> *>(0)));
+            params.push_back(std::vector<std::string>());
+
+            for (unsigned long k = input.version < 3 ? 0 : input.count(); k; --k)
+                params.back().push_back(input.name());
+
+            try {
+                // checked the way the library checks them
+                TFunction<T>().params(params.back());
+            } catch (const EReadError&) {
+                throw EFormatError("Malformed function parameters in binary data.");
+            }
+
+            functions.back().second = readTree(input);
+        }
+
+        std::vector<TTable<T> > tables;
+        for (unsigned long n = input.version < 2 ? 0 : input.count(); n; --n) {
+            std::string name(input.name());
+            unsigned char interpolation = input.byte();
+
+            if (interpolation > 1)
+                throw EFormatError("Unknown table interpolation in binary data.");
+
+            std::vector<T> x, y;
+            unsigned long points = input.count();
+
+            for (unsigned long k = 0; k < points; ++k)
+                x.push_back(readNumber(input));
+            for (unsigned long k = 0; k < points; ++k)
+                y.push_back(readNumber(input));
+
+            try {
+                tables.push_back(TTable<T>(name, x, y, interpolation
+                    ? TTable<T>::CUBIC : TTable<T>::LINEAR));
+            } catch (const ETableError&) {
+                throw EFormatError("Malformed table in binary data.");
+            }
+        }
+
+        if (input.pos != input.end)
+            throw EFormatError("Unexpected data after the library.");
+
+        // the names must not clash, neither among themselves nor with ALibrary
+        std::set<std::string> names, tableNames;
+
+        for (unsigned k = 0; k < constants.size() + functions.size(); ++k) {
+            const std::string& name = k < constants.size()
+                ? constants[k].name() : functions[k - constants.size()].first;
+
+            if (!names.insert(name).second || ALibrary.hasFunction(name) || ALibrary.hasConstant(name))
+                throw ELibraryLookup("Can't insert multiple elements with same name: " + name + ".");
+        }
+
+        for (unsigned k = 0; k < tables.size(); ++k)
+            if (!tableNames.insert(tables[k].name()).second || ALibrary.hasTable(tables[k].name()))
+                throw ELibraryLookup("Can't insert multiple tables with same name: "
+                    + tables[k].name() + ".");
+
+        for (unsigned k = 0; k < constants.size(); ++k)
+            ALibrary.insert(constants[k]);
+
+        for (; i < functions.size(); ++i)
+            ALibrary.insert(functions[i].first, params[i], functions[i].second);
+
+        for (unsigned k = 0; k < tables.size(); ++k)
+            ALibrary.insert(tables[k]);
+    } catch (...) {
+        for (; i < functions.size(); ++i)
+            delete functions[i].second;
+        throw;
+    }
+}
+
+template<class T>
+void TSerializer<T>::read(const std::string& AInput, TLibrary<T>& ALibrary) {
+    read(AInput.data(), AInput.data() + AInput.size(), ALibrary);
+}
+
+template<class T>
+unsigned char TSerializer<T>::encoding() {
+    return enText;
+}
+
+template<>
+inline unsigned char TSerializer<double>::encoding() {
+    return enDouble;
+}
+
+template<class T>
+bool TSerializer<T>::integral(const T&, unsigned long&) {
+    return false;
+}
+
+template<>
+inline bool TSerializer<double>::integral(const double& ANumber, unsigned long& AResult) {
+    if (ANumber == 0) {
+        AResult = 0;
+        return 1 / ANumber > 0;     // -0 must stay a double
+    }
+
+    if (!(ANumber >= 1 && ANumber <= 4294967295.0) || ANumber != std::floor(ANumber))
+        return false;
+
+    AResult = static_cast<unsigned long>(ANumber);
+    return true;
+}
+
+template<class T>
+void TSerializer<T>::writeHeader(TContent AContent, std::string& AOutput) {
+    const char header[] = { 'L', 'M', 'B', 'F', formatVersion, AContent, char(encoding()), 0 };
+
+    AOutput.append(header, sizeof(header));
+}
+
+template<class T>
+void TSerializer<T>::writeTrailer(std::string::size_type AStart, std::string& AOutput) {
+    unsigned crc = crc32(AOutput.data() + AStart, AOutput.data() + AOutput.size());
+
+    for (unsigned i = 0; i < 4; ++i, crc >>= 8)
+        AOutput += char(crc & 0xFF);
+}
+
+template<class T>
+void TSerializer<T>::writeTree(const TNode<T> *AExpression, std::string& AOutput) {
+    // the reversed pre-order walk (taking the right most child first) is 
+    // the post-order, so collect the nodes that way
+    std::vector<const TNode<T> *> nodes;
+    std::vector<const TNode<T> *> pending(1, AExpression);
+
+    while (!pending.empty()) {
+        const TNode<T> *n = pending.back();
+        pending.pop_back();
+        nodes.push_back(n);
+
+        if (n->nodeType() == TNode<T>::IF_NODE)
+            pending.push_back(static_cast<const TIfNode<T> *>(n)->condition());
+        if (n->left())
+            pending.push_back(n->left());
+        if (n->right())
+            pending.push_back(n->right());
+        if (n->nodeType() == TNode<T>::SUM_NODE || n->nodeType() == TNode<T>::PROD_NODE)
+            pending.push_back(static_cast<const TSeriesNode<T> *>(n)->body());
+        if (n->nodeType() == TNode<T>::FUNC_NODE) {
+            const TFuncNode<T> *f = static_cast<const TFuncNode<T> *>(n);
+
+            for (unsigned k = 1; k < f->params(); ++k)
+                pending.push_back(f->param(k));
+        }
+    }
+
+    writeCount(nodes.size(), AOutput);
+
+    for (typename std::vector<const TNode<T> *>::reverse_iterator i = nodes.rbegin();
+        i != nodes.rend(); ++i) {
+        const TNode<T> *n = *i;
+
+        switch (n->nodeType()) {
+            case TNode<T>::NUMBER_NODE: {
+                const T number(static_cast<const TNumberNode<T> *>(n)->number());
+                unsigned long value;
+
+                if (integral(number, value)) {
+                    AOutput += char(ocInteger);
+                    writeCount(value, AOutput);
+                } else {
+                    AOutput += char(ocNumber);
+                    writeNumber(number, AOutput);
+                }
+                break;
+            }
+            case TNode<T>::SYMBOL_NODE:
+                AOutput += char(ocSymbol);
+                writeName(static_cast<const TSymbolNode<T> *>(n)->symbol(), AOutput);
+                break;
+            case TNode<T>::FUNC_NODE: {
+                const TFuncNode<T> *f = static_cast<const TFuncNode<T> *>(n);
+
+                if (f->params() == 1)
+                    AOutput += char(ocFunc);
+                else {
+                    AOutput += char(ocCall);
+                    writeCount(f->params(), AOutput);
+                }
+                writeName(f->name(), AOutput);
+                break;
+            }
+            case TNode<T>::LET_NODE:
+                AOutput += char(ocLet);
+                writeName(static_cast<const TLetNode<T> *>(n)->name(), AOutput);
+                break;
+            case TNode<T>::TABLE_NODE:
+                AOutput += char(ocTable);
+                writeName(static_cast<const TTableNode<T> *>(n)->name(), AOutput);
+                writeCount(static_cast<const TTableNode<T> *>(n)->order(), AOutput);
+                break;
+            case TNode<T>::SUM_NODE:
+            case TNode<T>::PROD_NODE:
+                AOutput += char(n->nodeType() == TNode<T>::SUM_NODE ? ocSum : ocProd);
+                writeName(static_cast<const TSeriesNode<T> *>(n)->index(), AOutput);
+                break;
+            case TNode<T>::PARAM_NODE: AOutput += char(ocParam); break;
+            case TNode<T>::PLUS_NODE: AOutput += char(ocPlus); break;
+            case TNode<T>::NEG_NODE: AOutput += char(ocNeg); break;
+            case TNode<T>::MUL_NODE: AOutput += char(ocMul); break;
+            case TNode<T>::DIV_NODE: AOutput += char(ocDiv); break;
+            case TNode<T>::POW_NODE: AOutput += char(ocPow); break;
+            case TNode<T>::SQRT_NODE: AOutput += char(ocSqrt); break;
+            case TNode<T>::SIN_NODE: AOutput += char(ocSin); break;
+            case TNode<T>::COS_NODE: AOutput += char(ocCos); break;
+            case TNode<T>::TAN_NODE: AOutput += char(ocTan); break;
+            case TNode<T>::LN_NODE: AOutput += char(ocLn); break;
+            case TNode<T>::IF_NODE: AOutput += char(ocIf); break;
+            case TNode<T>::EQU_NODE: AOutput += char(ocEqu); break;
+            case TNode<T>::UNEQU_NODE: AOutput += char(ocUnEqu); break;
+            case TNode<T>::LESS_NODE: AOutput += char(ocLess); break;
+            case TNode<T>::GREATER_NODE: AOutput += char(ocGreater); break;
+            case TNode<T>::LESS_EQU_NODE: AOutput += char(ocLessEqu); break;
+            case TNode<T>::GREATER_EQU_NODE: AOutput += char(ocGreaterEqu); break;
+            default:
+                throw EFormatError("Unsupported node type for the binary format.");
+        }
+    }
+}
+
+template<class T>
+void TSerializer<T>::writeCount(unsigned long ACount, std::string& AOutput) {
+    while (ACount >= 0x80) {
+        AOutput += char((ACount & 0x7F) | 0x80);
+        ACount >>= 7;
+    }
+    AOutput += char(ACount);
+}
+
+template<class T>
+void TSerializer<T>::writeName(const std::string& AName, std::string& AOutput) {
+    writeCount(AName.size(), AOutput);
+    AOutput += AName;
+}
+
+template<class T>
+void TSerializer<T>::writeNumber(const T& ANumber, std::string& AOutput) {
+    std::ostringstream sstr;
+
+    if (std::numeric_limits<T>::is_specialized)
+        sstr.precision(std::numeric_limits<T>::digits10 + 3);
+
+    sstr << ANumber;
+    writeName(sstr.str(), AOutput);
+}
+
+template<>
+inline void TSerializer<double>::writeNumber(const double& ANumber, std::string& AOutput) {
+    unsigned long long bits;
+    std::memcpy(&bits, &ANumber, sizeof(bits));
+
+    char bytes[8];
+    for (unsigned i = 0; i < 8; ++i, bits >>= 8)
+        bytes[i] = char(bits & 0xFF);
+
+    AOutput.append(bytes, 8);
+}
+
+template<class T>
+typename TSerializer<T>::TInput TSerializer<T>::open(const char *ABegin, const char *AEnd,
+    TContent AContent) {
+
+    if (AEnd - ABegin < 12 || std::memcmp(ABegin, "LMBF", 4) != 0)
+        throw EFormatError("Not in binary expression format.");
+
+    if (ABegin[4] < 1 || ABegin[4] > formatVersion)
+        throw EFormatError("Unsupported binary expression format version.");
+
+    if (ABegin[5] != AContent)
+        throw EFormatError(AContent == ctTree ? "Binary data contains no expression tree."
+                                              : "Binary data contains no library.");
+
+    if (ABegin[6] != encoding())
+        throw EFormatError("Binary data was written for another number type.");
+
+    unsigned crc = 0;
+    for (unsigned i = 0; i < 4; ++i)
+        crc |= static_cast<unsigned>(static_cast<unsigned char>(AEnd[int(i) - 4])) << 8 * i;
+
+    if (crc != crc32(ABegin, AEnd - 4))
+        throw EFormatError("Checksum mismatch in binary data.");
+
+    return TInput(ABegin + 8, AEnd - 4, ABegin[4]);
+}
+
+template<class T>
+unsigned TSerializer<T>::since(unsigned char AOpcode) {
+    switch (AOpcode) {
+        case ocTable: case ocSum: case ocProd: return 2;
+        case ocLet: case ocCall: return 3;
+        default: return 1;
+    }
+}
+
+template<class T>
+TNode<T> *TSerializer<T>::readTree(TInput& AInput) {
+    unsigned long count = AInput.count();
+    std::vector<TNode<T> *> stack;
+
+    try {
+        for (; count; --count) {
+            unsigned char opcode = AInput.byte();
+            unsigned long arity;
+
+            if (since(opcode) > AInput.version)
+                throw EFormatError("Opcode unknown to the binary format version.");
+
+            switch (opcode) {
+                case ocCall: arity = AInput.count(); break;
+                case ocNumber: case ocInteger: case ocSymbol: case ocParam: arity = 0; break;
+                case ocIf: case ocSum: case ocProd: arity = 3; break;
+                case ocNeg: case ocSqrt: case ocSin: case ocCos: case ocTan: case ocLn: 
+                case ocFunc: case ocTable: arity = 1; break;
+                default: arity = 2; break;
+            }
+
+            if (stack.size() < arity || (opcode == ocCall && arity < 2))
+                throw EFormatError("Malformed expression tree in binary data.");
+
+            TNode<T> **args = arity ? &stack[stack.size() - arity] : 0;
+            TNode<T> *node;
+
+            switch (opcode) {
+                case ocNumber: node = new TNumberNode<T>(readNumber(AInput)); break;
+                case ocInteger: node = new TNumberNode<T>(T(AInput.count())); break;
+                case ocSymbol: node = new TSymbolNode<T>(AInput.name()); break;
+                case ocParam: node = new TParamNode<T>(); break;
+                case ocFunc: node = new TFuncNode<T>(AInput.name(), args[0]); break;
+                case ocCall: {
+                    TFuncNode<T> *call = new TFuncNode<T>(AInput.name(), args[0]);
+
+                    for (unsigned long k = 1; k < arity; ++k)
+                        call->addParam(args[k]);
+                    node = call;
+                    break;
+                }
+                case ocLet: node = new TLetNode<T>(AInput.name(), args[0], args[1]); break;
+                case ocTable: {
+                    std::string name(AInput.name());
+                    unsigned long order = AInput.count();
+
+                    if (order > 255)
+                        throw EFormatError("Malformed expression tree in binary data.");
+
+                    node = new TTableNode<T>(name, args[0], order);
+                    break;
+                }
+                case ocPlus: node = new TPlusNode<T>(args[0], args[1]); break;
+                case ocNeg: node = new TNegNode<T>(args[0]); break;
+                case ocMul: node = new TMulNode<T>(args[0], args[1]); break;
+                case ocDiv: node = new TDivNode<T>(args[0], args[1]); break;
+                case ocPow: node = new TPowNode<T>(args[0], args[1]); break;
+                case ocSqrt: node = new TSqrtNode<T>(args[0]); break;
+                case ocSin: node = new TSinNode<T>(args[0]); break;
+                case ocCos: node = new TCosNode<T>(args[0]); break;
+                case ocTan: node = new TTanNode<T>(args[0]); break;
+                case ocLn: node = new TLnNode<T>(args[0]); break;
+                case ocIf: node = new TIfNode<T>(args[0], args[1], args[2]); break;
+                case ocSum: node = new TSumNode<T>(AInput.name(), args[0], args[1], args[2]); break;
+                case ocProd: node = new TProdNode<T>(AInput.name(), args[0], args[1], args[2]); break;
+                case ocEqu: node = new TEquNode<T>(args[0], args[1]); break;
+                case ocUnEqu: node = new TUnEquNode<T>(args[0], args[1]); break;
+                case ocLess: node = new TLessNode<T>(args[0], args[1]); break;
+                case ocGreater: node = new TGreaterNode<T>(args[0], args[1]); break;
+                case ocLessEqu: node = new TLessEquNode<T>(args[0], args[1]); break;
+                case ocGreaterEqu: node = new TGreaterEquNode<T>(args[0], args[1]); break;
+                default:
+                    throw EFormatError("Unknown opcode in binary data.");
+            }
+
+            stack.resize(stack.size() - arity);
+            stack.push_back(node);
+        }
+
+        if (stack.size() != 1)
+            throw EFormatError("Malformed expression tree in binary data.");
+    } catch (...) {
+        for (unsigned i = 0; i < stack.size(); ++i)
+            delete stack[i];
+        throw;
+    }
+
+    return stack.back();
+}
+
+template<class T>
+T TSerializer<T>::readNumber(TInput& AInput) {
+    std::istringstream sstr(AInput.name());
+    T result;
+
+    if (!(sstr >> result))
+        throw EFormatError("Malformed number in binary data.");
+
+    return result;
+}
+
+template<>
+inline double TSerializer<double>::readNumber(TInput& AInput) {
+    AInput.skip(8);
+
+    unsigned long long bits = 0;
+    for (unsigned i = 8; i; --i)
+        bits = bits << 8 | static_cast<unsigned char>(AInput.pos[int(i) - 9]);
+
+    double result;
+    std::memcpy(&result, &bits, sizeof(result));
+
+    return result;
+}
+
+template<class T>
+unsigned char TSerializer<T>::TInput::byte() {
+    if (pos == end)
+        throw EFormatError("Unexpected end of binary data.");
+
+    return *pos++;
+}
+
+template<class T>
+unsigned long TSerializer<T>::TInput::count() {
+    unsigned long result = 0;
+
+    for (unsigned shift = 0; ; shift += 7) {
+        unsigned long b = byte();
+
+        if (shift >= 8 * sizeof(result) || ((b & 0x7F) << shift) >> shift != (b & 0x7F))
+            throw EFormatError("Malformed count in binary data.");
+
+        result |= (b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return result;
+    }
+}
+
+template<class T>
+std::string TSerializer<T>::TInput::name() {
+    unsigned long length = count();
+    skip(length);
+
+    return std::string(pos - length, length);
+}
+
+template<class T>
+void TSerializer<T>::TInput::skip(unsigned long ACount) {
+    if (static_cast<unsigned long>(end - pos) < ACount)
+        throw EFormatError("Unexpected end of binary data.");
+
+    pos += ACount;
+}
+
+} // namespace math
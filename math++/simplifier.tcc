@@ -71,8 +71,8 @@ T TSimplifier<T>::calculate(const TNode<T> *AExpr) const {
     static TLibrary<T> library;
 
     if (!library.constants()) {
-        library.insert(TConstant<T>("pi", 3.1415));// M_PI)); // just in case they're used. :)
-        library.insert(TConstant<T>("e", 2.1718));// M_E));
+        library.insert(TConstant<T>("pi", T(3.1415)));// M_PI)); // just in case they're used. :)
+        library.insert(TConstant<T>("e", T(2.1718)));// M_E));
     }
 
     return TCalculator<T>::calculate(TFunction<T>("tmp", AExpr), T(), library);
@@ -606,7 +606,12 @@ void TSimplifier<T>::visit(TLnNode<T> *ANode) {
 
 template<class T>
 void TSimplifier<T>::visit(TFuncNode<T> *ANode) {
-    FResult = new TFuncNode<T>(ANode->name(), simplify(ANode->node()));
+    std::auto_ptr<TFuncNode<T> > result(new TFuncNode<T>(ANode->name(), simplify(ANode->node())));
+
+    for (unsigned i = 1; i < ANode->params(); ++i)
+        result->addParam(simplify(ANode->param(i)));
+
+    FResult = result.release();
 }
 
 template<class T>
@@ -615,6 +620,64 @@ void TSimplifier<T>::visit(TIfNode<T> *ANode) {
         simplify(ANode->trueExpr()), simplify(ANode->falseExpr()));
 }
 
+template<class T>
+void TSimplifier<T>::visit(TTableNode<T> *ANode) {
+    // the table's data isn't known here, so only the argument gets simplified
+    FResult = new TTableNode<T>(ANode->name(), simplify(ANode->node()), ANode->order());
+}
+
+template<class T>
+void TSimplifier<T>::visit(TSumNode<T> *ANode) {
+    std::auto_ptr<TNode<T> > lower(simplify(ANode->lower()));
+    std::auto_ptr<TNode<T> > upper(simplify(ANode->upper()));
+
+    // the empty sum is 0
+    if (isConst(lower.get()) && isConst(upper.get()) 
+            && calculate(lower.get()) > calculate(upper.get())) {
+        FResult = new TNumberNode<T>(T(0));
+        return;
+    }
+
+    FResult = new TSumNode<T>(ANode->index(), lower.release(), upper.release(),
+        simplify(ANode->body()));
+}
+
+template<class T>
+void TSimplifier<T>::visit(TProdNode<T> *ANode) {
+    std::auto_ptr<TNode<T> > lower(simplify(ANode->lower()));
+    std::auto_ptr<TNode<T> > upper(simplify(ANode->upper()));
+
+    // the empty product is 1
+    if (isConst(lower.get()) && isConst(upper.get()) 
+            && calculate(lower.get()) > calculate(upper.get())) {
+        FResult = new TNumberNode<T>(T(1));
+        return;
+    }
+
+    FResult = new TProdNode<T>(ANode->index(), lower.release(), upper.release(),
+        simplify(ANode->body()));
+}
+
+template<class T>
+void TSimplifier<T>::visit(TLetNode<T> *ANode) {
+    std::auto_ptr<TNode<T> > value(simplify(ANode->value()));
+    std::auto_ptr<TNode<T> > body(simplify(ANode->body()));
+
+    // let v = f in g = g, if g doesn't use v
+    if (!mentions(body.get(), ANode->name())) {
+        FResult = body.release();
+        return;
+    }
+
+    // let v = f in v = f
+    if (body->nodeType() == TNode<T>::SYMBOL_NODE) {
+        FResult = value.release();
+        return;
+    }
+
+    FResult = new TLetNode<T>(ANode->name(), value.release(), body.release());
+}
+
 template<class T>
 void TSimplifier<T>::visit(TEquNode<T> *ANode) {
     FResult = new TEquNode<T>(simplify(ANode->left()), 
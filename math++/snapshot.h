@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the memory mapped library snapshot interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_snapshot_h
+#define libmath_snapshot_h
+
+#include <math++/error.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace math {
+
+template<class> class TNode;
+template<class> class TLibrary;
+class TMappedFile;
+
+/**
+  * TSnapshot<> is a read-only, fully linked image of a TLibrary<>, made to 
+  * be memory mapped and used in place: there is no parsing nor any other 
+  * loading pass, so processes start at once and share the image's pages.
+  *
+  * The image holds a name index (sorted by name), the functions compiled 
+  * into programs for a small stack machine, the numbers and the names.
+  * Calls of library functions and uses of library constants are resolved 
+  * when the image is written. Tables aren't part of images, so writing a 
+  * library whose functions look up tables throws EFormatError.
+  *
+  * Numbers are stored as they are in memory, so T must be a plain number 
+  * type such as double, and images only work on the same kind of machine 
+  * (use TSerializer<> to exchange libraries).
+  */
+template<class T>
+class TSnapshot {
+public:
+    /// appends the image of ALibrary to AOutput
+    static void write(const TLibrary<T>& ALibrary, std::string& AOutput);
+    /// writes the image of ALibrary into the file AFileName
+    static void write(const TLibrary<T>& ALibrary, const std::string& AFileName);
+
+    /// maps the image file AFileName, throws EFileError or EFormatError
+    explicit TSnapshot(const std::string& AFileName);
+    /// uses the image [ABegin, AEnd), which must stay valid and be aligned like malloc()'s results
+    TSnapshot(const char *ABegin, const char *AEnd);
+    ~TSnapshot();
+
+    /// returns the number of functions in the image
+    unsigned functions() const;
+    /// returns the number of constants in the image
+    unsigned constants() const;
+
+    /// returns true, if function (AName) exists
+    bool hasFunction(const std::string& AName) const;
+    /// returns true, if constant (AName) exists
+    bool hasConstant(const std::string& AName) const;
+
+    /// calls the function AName for AParam, just as TLibrary<>::call() does
+    T call(const std::string& AName, const T& AParam, unsigned ARecursionLimit = 64) const;
+    /// returns the value of the constant AName
+    T value(const std::string& AName) const;
+
+private:
+    enum TKind { kdFunction, kdConstant };
+
+    enum TOpcode {
+        opNumber, opParam, opSymbol,
+        opNeg, opPlus, opMul, opDiv, opPow,
+        opSqrt, opSin, opCos, opTan, opLn,
+        opEqu, opUnEqu, opLess, opGreater, opLessEqu, opGreaterEqu,
+        opCall,                 // calls the function of entry operand
+        opCallName,             // calls the unknown function named at operand
+        opJumpIfZero, opJump, opReturn
+    };
+
+    enum { formatVersion = 1, byteOrder = 0x01020304 };
+
+    /// THeader starts the image, all offsets are relative to it
+    struct THeader {
+        char magic[4];
+        unsigned version;
+        unsigned byteOrder;
+        unsigned numberSize;
+        unsigned size;              // of the whole image
+        unsigned functions;
+        unsigned entries, entryOffset;
+        unsigned code, codeOffset;
+        unsigned numbers, numberOffset;
+        unsigned names, nameOffset;
+    };
+
+    /// TEntry is an element of the name index
+    struct TEntry {
+        unsigned name;              // offset in the names
+        unsigned nameLength;
+        unsigned kind;
+        unsigned index;             // program start or number index
+    };
+
+    struct TInstruction {
+        unsigned opcode;
+        unsigned operand;
+    };
+
+    /// TFrame is a pending function call of the stack machine
+    struct TFrame {
+        unsigned pc;
+        T param;
+
+        TFrame(unsigned APc, const T& AParam) : pc(APc), param(AParam) {}
+    };
+
+    TMappedFile *FFile;
+    const THeader *FHeader;
+    const TEntry *FEntries;
+    const TInstruction *FCode;
+    const T *FNumbers;
+    const char *FNames;
+
+    /// checks the image [ABegin, AEnd) and sets up the pointers into it
+    void open(const char *ABegin, const char *AEnd);
+    /// returns the entry named AName or 0 if there's none
+    const TEntry *find(const std::string& AName) const;
+    /// returns the (zero terminated) name at AOffset
+    std::string name(unsigned AOffset) const;
+    /// runs the program starting at APc
+    T run(unsigned APc, const T& AParam, unsigned ALimit) const;
+
+    /// TImage collects the parts of an image while it's written
+    struct TImage {
+        std::vector<TEntry> entries;
+        std::vector<TInstruction> code;
+        std::vector<T> numbers;
+        std::string names;
+        std::map<std::string, unsigned> index;  // entry by name
+    };
+
+    /// TPending is a node being compiled, state tells how far
+    struct TPending {
+        const TNode<T> *node;
+        unsigned state;
+        unsigned jump;              // instruction to be patched
+    };
+
+    /// appends the program of AExpression to AImage
+    static void compile(const TNode<T> *AExpression, TImage& AImage);
+    /// appends AName (zero terminated) to the names and returns its offset
+    static unsigned addName(const std::string& AName, TImage& AImage);
+
+    TSnapshot(const TSnapshot<T>&);
+    TSnapshot<T>& operator=(const TSnapshot<T>&);
+};
+
+} // namespace math
+
+#include <math++/snapshot.tcc>
+
+#endif
@@ -0,0 +1,519 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the memory mapped library snapshot template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_snapshot_h
+#error You may not include math++/snapshot.tcc directly; include math++/snapshot.h instead.
+#endif
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+#include <math++/calculator.h>
+#include <math++/serializer.h>
+#include <math++/mapped.h>
+
+#include <fstream>
+#include <cstring>
+#include <cmath>
+
+namespace math {
+
+template<class T>
+void TSnapshot<T>::write(const TLibrary<T>& ALibrary, std::string& AOutput) {
+    TImage image;
+
+    // the name index, sorted by name
+    std::map<std::string, const TNode<T> *> functions;
+    std::map<std::string, T> constants;
+
+    for (typename TLibrary<T>::TFunctionList::const_iterator i = ALibrary.FFunctions.begin();
+        i != ALibrary.FFunctions.end(); ++i) {
+        // the image calls with a single argument only
+        if (!i->params().empty())
+            throw EFormatError("Multi-argument functions are unsupported in library snapshots: "
+                + i->name() + ".");
+        functions[i->name()] = i->expression();
+    }
+
+    for (typename TLibrary<T>::TConstantList::const_iterator i = ALibrary.FConstants.begin();
+        i != ALibrary.FConstants.end(); ++i)
+        constants[i->name()] = i->value();
+
+    typename std::map<std::string, const TNode<T> *>::const_iterator f = functions.begin();
+    typename std::map<std::string, T>::const_iterator c = constants.begin();
+
+    while (f != functions.end() || c != constants.end()) {
+        TEntry entry;
+
+        if (c == constants.end() || (f != functions.end() && f->first < c->first)) {
+            entry.name = addName(f->first, image);
+            entry.nameLength = f->first.size();
+            entry.kind = kdFunction;
+            entry.index = 0;    // set below, once all names are known
+            image.index[f->first] = image.entries.size();
+            ++f;
+        } else {
+            entry.name = addName(c->first, image);
+            entry.nameLength = c->first.size();
+            entry.kind = kdConstant;
+            entry.index = image.numbers.size();
+            image.numbers.push_back(c->second);
+            image.index[c->first] = image.entries.size();
+            ++c;
+        }
+        image.entries.push_back(entry);
+    }
+
+    // the programs
+    for (f = functions.begin(); f != functions.end(); ++f) {
+        image.entries[image.index[f->first]].index = image.code.size();
+        compile(f->second, image);
+    }
+
+    // the layout, each part aligned to 16 bytes
+    THeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "LMSS", 4);
+    header.version = formatVersion;
+    header.byteOrder = byteOrder;
+    header.numberSize = sizeof(T);
+    header.functions = functions.size();
+
+    unsigned offset = (sizeof(THeader) + 15) & ~15U;
+
+    header.entries = image.entries.size();
+    header.entryOffset = offset;
+    offset = (offset + header.entries * sizeof(TEntry) + 15) & ~15U;
+
+    header.code = image.code.size();
+    header.codeOffset = offset;
+    offset = (offset + header.code * sizeof(TInstruction) + 15) & ~15U;
+
+    header.numbers = image.numbers.size();
+    header.numberOffset = offset;
+    offset = (offset + header.numbers * sizeof(T) + 15) & ~15U;
+
+    header.names = image.names.size();
+    header.nameOffset = offset;
+    header.size = offset + header.names;
+
+    std::string::size_type start = AOutput.size();
+    AOutput.resize(start + header.size, '\0');
+    char *out = &AOutput[start];
+
+    std::memcpy(out, &header, sizeof(header));
+    if (header.entries)
+        std::memcpy(out + header.entryOffset, &image.entries[0], header.entries * sizeof(TEntry));
+    if (header.code)
+        std::memcpy(out + header.codeOffset, &image.code[0], header.code * sizeof(TInstruction));
+    if (header.numbers)
+        std::memcpy(out + header.numberOffset, &image.numbers[0], header.numbers * sizeof(T));
+    std::memcpy(out + header.nameOffset, image.names.data(), header.names);
+}
+
+template<class T>
+void TSnapshot<T>::write(const TLibrary<T>& ALibrary, const std::string& AFileName) {
+    std::string image;
+    write(ALibrary, image);
+
+    std::ofstream out(AFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(image.data(), image.size());
+    out.close();
+
+    if (!out)
+        throw EFileError("Can't write " + AFileName + ".");
+}
+
+template<class T>
+TSnapshot<T>::TSnapshot(const std::string& AFileName) :
+    FFile(new TMappedFile(AFileName, TMappedFile::acRandom)) {
+
+    try {
+        open(FFile->begin(), FFile->end());
+    } catch (...) {
+        delete FFile;
+        throw;
+    }
+}
+
+template<class T>
+TSnapshot<T>::TSnapshot(const char *ABegin, const char *AEnd) : FFile(0) {
+    open(ABegin, AEnd);
+}
+
+template<class T>
+TSnapshot<T>::~TSnapshot() {
+    delete FFile;
+}
+
+template<class T>
+unsigned TSnapshot<T>::functions() const {
+    return FHeader->functions;
+}
+
+template<class T>
+unsigned TSnapshot<T>::constants() const {
+    return FHeader->entries - FHeader->functions;
+}
+
+template<class T>
+bool TSnapshot<T>::hasFunction(const std::string& AName) const {
+    const TEntry *e = find(AName);
+    return e && e->kind == kdFunction;
+}
+
+template<class T>
+bool TSnapshot<T>::hasConstant(const std::string& AName) const {
+    const TEntry *e = find(AName);
+    return e && e->kind == kdConstant;
+}
+
+template<class T>
+T TSnapshot<T>::call(const std::string& AName, const T& AParam, unsigned ALimit) const {
+    const TEntry *e = find(AName);
+    if (!e || e->kind != kdFunction)
+        throw ELibraryLookup("No function found in library called: " + AName + ".");
+
+    return run(e->index, AParam, ALimit);
+}
+
+template<class T>
+T TSnapshot<T>::value(const std::string& AName) const {
+    const TEntry *e = find(AName);
+    if (!e || e->kind != kdConstant)
+        throw ELibraryLookup("No constant found in library called: " + AName + ".");
+
+    if (e->index >= FHeader->numbers)
+        throw EFormatError("Corrupted library snapshot.");
+
+    return FNumbers[e->index];
+}
+
+template<class T>
+void TSnapshot<T>::compile(const TNode<T> *AExpression, TImage& AImage) {
+    TPending root = { AExpression, 0, 0 };
+    std::vector<TPending> pending(1, root);
+
+    while (!pending.empty()) {
+        const TNode<T> *n = pending.back().node;
+        unsigned state = pending.back().state++;
+        TInstruction i = { opReturn, 0 };
+
+        switch (n->nodeType()) {
+            case TNode<T>::NUMBER_NODE:
+                i.opcode = opNumber;
+                i.operand = AImage.numbers.size();
+                AImage.numbers.push_back(static_cast<const TNumberNode<T> *>(n)->number());
+                break;
+            case TNode<T>::PARAM_NODE:
+                i.opcode = opParam;
+                break;
+            case TNode<T>::SYMBOL_NODE: {
+                const std::string symbol(static_cast<const TSymbolNode<T> *>(n)->symbol());
+                std::map<std::string, unsigned>::const_iterator e = AImage.index.find(symbol);
+
+                if (e != AImage.index.end() && AImage.entries[e->second].kind == kdConstant) {
+                    i.opcode = opNumber;
+                    i.operand = AImage.entries[e->second].index;
+                } else {
+                    i.opcode = opSymbol;
+                    i.operand = addName(symbol, AImage);
+                }
+                break;
+            }
+            case TNode<T>::IF_NODE: {
+                const TIfNode<T> *f = static_cast<const TIfNode<T> *>(n);
+                TPending next = { 0, 0, 0 };
+
+                switch (state) {
+                    case 0:
+                        next.node = f->condition();
+                        break;
+                    case 1:
+                        pending.back().jump = AImage.code.size();
+                        i.opcode = opJumpIfZero;
+                        AImage.code.push_back(i);
+                        next.node = f->trueExpr();
+                        break;
+                    case 2:
+                        AImage.code[pending.back().jump].operand = AImage.code.size() + 1;
+                        pending.back().jump = AImage.code.size();
+                        i.opcode = opJump;
+                        AImage.code.push_back(i);
+                        next.node = f->falseExpr();
+                        break;
+                    default:
+                        AImage.code[pending.back().jump].operand = AImage.code.size();
+                        pending.pop_back();
+                        continue;
+                }
+                pending.push_back(next);
+                continue;
+            }
+            default: {
+                // operators, their operands come first
+                const TNode<T> *operand = state == 0 ? (n->left() ? n->left() : n->right())
+                                        : state == 1 && n->left() ? n->right() : 0;
+                if (operand) {
+                    TPending next = { operand, 0, 0 };
+                    pending.push_back(next);
+                    continue;
+                }
+
+                switch (n->nodeType()) {
+                    case TNode<T>::PLUS_NODE: i.opcode = opPlus; break;
+                    case TNode<T>::NEG_NODE: i.opcode = opNeg; break;
+                    case TNode<T>::MUL_NODE: i.opcode = opMul; break;
+                    case TNode<T>::DIV_NODE: i.opcode = opDiv; break;
+                    case TNode<T>::POW_NODE: i.opcode = opPow; break;
+                    case TNode<T>::SQRT_NODE: i.opcode = opSqrt; break;
+                    case TNode<T>::SIN_NODE: i.opcode = opSin; break;
+                    case TNode<T>::COS_NODE: i.opcode = opCos; break;
+                    case TNode<T>::TAN_NODE: i.opcode = opTan; break;
+                    case TNode<T>::LN_NODE: i.opcode = opLn; break;
+                    case TNode<T>::EQU_NODE: i.opcode = opEqu; break;
+                    case TNode<T>::UNEQU_NODE: i.opcode = opUnEqu; break;
+                    case TNode<T>::LESS_NODE: i.opcode = opLess; break;
+                    case TNode<T>::GREATER_NODE: i.opcode = opGreater; break;
+                    case TNode<T>::LESS_EQU_NODE: i.opcode = opLessEqu; break;
+                    case TNode<T>::GREATER_EQU_NODE: i.opcode = opGreaterEqu; break;
+                    case TNode<T>::FUNC_NODE: {
+                        if (static_cast<const TFuncNode<T> *>(n)->params() > 1)
+                            throw EFormatError("Unsupported node type for library snapshots.");
+
+                        const std::string name(static_cast<const TFuncNode<T> *>(n)->name());
+                        std::map<std::string, unsigned>::const_iterator e = AImage.index.find(name);
+
+                        if (e != AImage.index.end() && AImage.entries[e->second].kind == kdFunction) {
+                            i.opcode = opCall;
+                            i.operand = e->second;
+                        } else {
+                            i.opcode = opCallName;
+                            i.operand = addName(name, AImage);
+                        }
+                        break;
+                    }
+                    default:
+                        throw EFormatError("Unsupported node type for library snapshots.");
+                }
+            }
+        }
+
+        AImage.code.push_back(i);
+        pending.pop_back();
+    }
+
+    TInstruction ret = { opReturn, 0 };
+    AImage.code.push_back(ret);
+}
+
+template<class T>
+unsigned TSnapshot<T>::addName(const std::string& AName, TImage& AImage) {
+    unsigned result = AImage.names.size();
+
+    AImage.names += AName;
+    AImage.names += '\0';
+
+    return result;
+}
+
+template<class T>
+void TSnapshot<T>::open(const char *ABegin, const char *AEnd) {
+    const unsigned size = AEnd - ABegin;
+
+    if (size < sizeof(THeader) || std::memcmp(ABegin, "LMSS", 4) != 0)
+        throw EFormatError("Not a library snapshot.");
+
+    FHeader = reinterpret_cast<const THeader *>(ABegin);
+
+    if (FHeader->version != formatVersion)
+        throw EFormatError("Unsupported library snapshot version.");
+
+    if (FHeader->byteOrder != byteOrder || FHeader->numberSize != sizeof(T))
+        throw EFormatError("Library snapshot was written for another machine or number type.");
+
+    if (FHeader->size != size)
+        throw EFormatError("Library snapshot is truncated.");
+
+    // each part must be aligned and lie within the image
+    const unsigned parts[][3] = {
+        { FHeader->entryOffset, FHeader->entries, sizeof(TEntry) },
+        { FHeader->codeOffset, FHeader->code, sizeof(TInstruction) },
+        { FHeader->numberOffset, FHeader->numbers, sizeof(T) },
+        { FHeader->nameOffset, FHeader->names, 1 }
+    };
+
+    for (unsigned i = 0; i < sizeof(parts) / sizeof(*parts); ++i)
+        if (parts[i][0] % 16 || parts[i][0] > size || parts[i][1] > (size - parts[i][0]) / parts[i][2])
+            throw EFormatError("Corrupted library snapshot.");
+
+    if (FHeader->functions > FHeader->entries)
+        throw EFormatError("Corrupted library snapshot.");
+
+    FEntries = reinterpret_cast<const TEntry *>(ABegin + FHeader->entryOffset);
+    FCode = reinterpret_cast<const TInstruction *>(ABegin + FHeader->codeOffset);
+    FNumbers = reinterpret_cast<const T *>(ABegin + FHeader->numberOffset);
+    FNames = ABegin + FHeader->nameOffset;
+}
+
+template<class T>
+const typename TSnapshot<T>::TEntry *TSnapshot<T>::find(const std::string& AName) const {
+    unsigned lo = 0;
+    unsigned hi = FHeader->entries;
+
+    while (lo < hi) {
+        const unsigned mid = (lo + hi) / 2;
+        const TEntry& e = FEntries[mid];
+
+        if (e.name > FHeader->names || e.nameLength > FHeader->names - e.name)
+            throw EFormatError("Corrupted library snapshot.");
+
+        int c = AName.compare(0, AName.size(), FNames + e.name, e.nameLength);
+
+        if (c == 0)
+            return &e;
+
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return 0;
+}
+
+template<class T>
+std::string TSnapshot<T>::name(unsigned AOffset) const {
+    if (AOffset >= FHeader->names)
+        throw EFormatError("Corrupted library snapshot.");
+
+    const char *begin = FNames + AOffset;
+    const char *end = begin;
+
+    while (end != FNames + FHeader->names && *end)
+        ++end;
+
+    return std::string(begin, end - begin);
+}
+
+template<class T>
+T TSnapshot<T>::run(unsigned APc, const T& AParam, unsigned ALimit) const {
+    // the number of operands each instruction takes from the stack
+    static const unsigned char operands[] = {
+        0, 0, 0,
+        1, 2, 2, 2, 2,
+        1, 1, 1, 1, 1,
+        2, 2, 2, 2, 2, 2,
+        1, 1,
+        1, 0, 1
+    };
+
+    std::vector<T> stack;
+    std::vector<TFrame> frames;
+    T param(AParam);
+    unsigned pc = APc;
+
+    stack.reserve(16);
+
+    for (;;) {
+        if (pc >= FHeader->code)
+            throw EFormatError("Corrupted library snapshot.");
+
+        const TInstruction& i = FCode[pc++];
+
+        if (i.opcode > opReturn || stack.size() < operands[i.opcode])
+            throw EFormatError("Corrupted library snapshot.");
+
+        if (operands[i.opcode] == 2) {
+            T b(stack.back());
+            stack.pop_back();
+            T& a = stack.back();
+
+            switch (i.opcode) {
+                case opPlus: a = a + b; break;
+                case opMul: a = a * b; break;
+                case opDiv: a = a / b; break;
+                case opPow: a = pow(a, b); break;
+                case opEqu: a = a == b; break;
+                case opUnEqu: a = a != b; break;
+                case opLess: a = a < b; break;
+                case opGreater: a = a > b; break;
+                case opLessEqu: a = a <= b; break;
+                case opGreaterEqu: a = a >= b; break;
+            }
+            continue;
+        }
+
+        switch (i.opcode) {
+            case opNumber:
+                if (i.operand >= FHeader->numbers)
+                    throw EFormatError("Corrupted library snapshot.");
+                stack.push_back(FNumbers[i.operand]);
+                break;
+            case opParam:
+                stack.push_back(param);
+                break;
+            case opSymbol:
+                throw ELibraryLookup("No constant found in library called: " + name(i.operand) + ".");
+            case opNeg: stack.back() = - stack.back(); break;
+            case opSqrt: stack.back() = sqrt(stack.back()); break;
+            case opSin: stack.back() = sin(stack.back()); break;
+            case opCos: stack.back() = cos(stack.back()); break;
+            case opTan: stack.back() = tan(stack.back()); break;
+            case opLn: stack.back() = log(stack.back()); break;
+            case opCall:
+                if (i.operand >= FHeader->entries || FEntries[i.operand].kind != kdFunction)
+                    throw EFormatError("Corrupted library snapshot.");
+
+                if (frames.size() >= ALimit)
+                    throw ECalcError("Function exceeds recursion counter: " 
+                        + name(FEntries[i.operand].name) + ".");
+
+                frames.push_back(TFrame(pc, param));
+                param = stack.back();
+                stack.pop_back();
+                pc = FEntries[i.operand].index;
+                break;
+            case opCallName:
+                throw ELibraryLookup("No function found in library called: " + name(i.operand) + ".");
+            case opJumpIfZero: {
+                const bool condition = stack.back();
+                stack.pop_back();
+
+                if (!condition)
+                    pc = i.operand;
+                break;
+            }
+            case opJump:
+                pc = i.operand;
+                break;
+            case opReturn:
+                if (frames.empty())
+                    return stack.back();
+
+                pc = frames.back().pc;
+                param = frames.back().param;
+                frames.pop_back();
+                break;
+        }
+    }
+}
+
+} // namespace math
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the numeric equation solver interface)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_solver_h
+#define libmath_solver_h
+
+#include <math++/nodes.h>
+#include <math++/library.h>
+
+#include <memory>
+
+namespace math {
+
+/**
+  * TSolver<> numerically solves f(x) = y for x within a bracket 
+  * [lower, upper], for one y or whole arrays of them.
+  *
+  * It runs Brent's method, which always keeps the root bracketed, and 
+  * tries a Newton step first in each iteration. The derivative is built 
+  * once when the solver is created. Newton steps are only taken if they 
+  * stay inside the bracket and shrink it fast enough, otherwise Brent's 
+  * interpolation or bisection is used. Functions calling library 
+  * functions are solved without Newton steps, as their derivative isn't 
+  * known.
+  *
+  * The solver can be used by many threads at once.
+  */
+template<class T>
+class TSolver {
+public:
+    enum TStatus {
+        CONVERGED,      // x is within the tolerance of a solution
+        NO_BRACKET,     // f(lower) - y and f(upper) - y have the same sign
+        NO_CONVERGENCE, // the iteration limit was hit
+        FAILED          // f couldn't be calculated (e.g. too deep recursion)
+    };
+
+    struct TResult {
+        T x;
+        TStatus status;
+        unsigned iterations;    // function evaluations done
+    };
+
+    /**
+      * creates a solver for AFunction over [ALower, AUpper], which stops 
+      * when x is known up to ATolerance. ALibrary must live as long as the 
+      * solver does.
+      */
+    TSolver(const TFunction<T>& AFunction, const TLibrary<T>& ALibrary,
+        const T& ALower, const T& AUpper, const T& ATolerance, unsigned AMaxIterations = 100);
+
+    /// solves f(x) = AY
+    TResult solve(const T& AY) const;
+
+    /**
+      * solves f(x) = y for each y in [ABegin, AEnd) into AResult, split up 
+      * on AThreads threads. Each solution is the first guess for the next 
+      * target, so sorted targets converge faster.
+      */
+    void solve(const T *ABegin, const T *AEnd, TResult *AResult, unsigned AThreads = 1) const;
+
+private:
+    struct TJob {
+        const TSolver<T> *solver;
+        const T *begin;
+        const T *end;
+        TResult *result;
+
+        void run();
+    };
+
+    std::auto_ptr<TNode<T> > FExpression;
+    std::auto_ptr<TNode<T> > FDerivative;   // 0 if not known
+    const TLibrary<T>& FLibrary;
+    T FLower, FUpper;
+    T FLowerValue, FUpperValue;             // f(FLower), f(FUpper)
+    bool FBoundsFailed;
+    T FTolerance;
+    unsigned FMaxIterations;
+
+    TSolver(const TSolver<T>&);
+    TSolver<T>& operator=(const TSolver<T>&);
+
+    /// solves f(x) = AY, starting at AGuess if given
+    TResult solve(const T& AY, const T *AGuess) const;
+
+    T calculate(const TNode<T> *AExpression, const T& x) const;
+
+    static T absolute(const T& x) { return x < T(0) ? -x : x; }
+    /// returns true if AExpression calls any library function
+    static bool callsFunctions(const TNode<T> *AExpression);
+};
+
+} // namespace math
+
+#include <math++/solver.tcc>
+
+#endif
@@ -0,0 +1,259 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the numeric equation solver template members)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_solver_h
+#error You may not include math++/solver.tcc directly; include math++/solver.h instead.
+#endif
+
+#include <math++/calculator.h>
+#include <math++/utils.h>
+#include <math++/thread.h>
+#include <math++/error.h>
+
+#include <limits>
+#include <vector>
+
+namespace math {
+
+template<class T>
+TSolver<T>::TSolver(const TFunction<T>& AFunction, const TLibrary<T>& ALibrary,
+    const T& ALower, const T& AUpper, const T& ATolerance, unsigned AMaxIterations) :
+    FExpression(AFunction.expression()->clone()), FLibrary(ALibrary),
+    FLower(ALower), FUpper(AUpper), FLowerValue(), FUpperValue(), FBoundsFailed(false),
+    FTolerance(ATolerance), FMaxIterations(AMaxIterations) {
+
+    if (!callsFunctions(FExpression.get()))
+        FDerivative.reset(derive(FExpression.get()));
+
+    // both bounds are the same for all targets
+    try {
+        FLowerValue = calculate(FExpression.get(), FLower);
+        FUpperValue = calculate(FExpression.get(), FUpper);
+    } catch (const EMath&) {
+        FBoundsFailed = true;
+    }
+}
+
+template<class T>
+bool TSolver<T>::callsFunctions(const TNode<T> *AExpression) {
+    std::vector<const TNode<T> *> pending(1, AExpression);
+
+    while (!pending.empty()) {
+        const TNode<T> *n = pending.back();
+        pending.pop_back();
+
+        if (!n)
+            continue;
+
+        if (n->nodeType() == TNode<T>::FUNC_NODE)
+            return true;
+
+        pending.push_back(n->left());
+        pending.push_back(n->right());
+
+        if (n->nodeType() == TNode<T>::IF_NODE)
+            pending.push_back(static_cast<const TIfNode<T> *>(n)->condition());
+        else if (n->nodeType() == TNode<T>::SUM_NODE || n->nodeType() == TNode<T>::PROD_NODE)
+            pending.push_back(static_cast<const TSeriesNode<T> *>(n)->body());
+    }
+    return false;
+}
+
+template<class T>
+T TSolver<T>::calculate(const TNode<T> *AExpression, const T& x) const {
+    return TCalculator<T>::calculate(AExpression, x, FLibrary);
+}
+
+template<class T>
+typename TSolver<T>::TResult TSolver<T>::solve(const T& AY) const {
+    return solve(AY, 0);
+}
+
+template<class T>
+typename TSolver<T>::TResult TSolver<T>::solve(const T& AY, const T *AGuess) const {
+    TResult result;
+    result.x = FLower;
+    result.status = FAILED;
+    result.iterations = 0;
+
+    if (FBoundsFailed)
+        return result;
+
+    try {
+        // the bracket is [a, b], c is on the other side of the root than b
+        T a = FLower, b = FUpper, c;
+        T fa = FLowerValue - AY, fb = FUpperValue - AY, fc;
+
+        if ((fa > T(0) && fb > T(0)) || (fa < T(0) && fb < T(0))) {
+            result.x = absolute(fa) < absolute(fb) ? a : b;
+            result.status = NO_BRACKET;
+            return result;
+        }
+
+        // the guess replaces the bound of the same sign
+        if (AGuess && FLower < *AGuess && *AGuess < FUpper) {
+            const T g = *AGuess, fg = calculate(FExpression.get(), g) - AY;
+            ++result.iterations;
+
+            if ((fg > T(0)) == (fa > T(0))) {
+                a = g;
+                fa = fg;
+            } else {
+                b = g;
+                fb = fg;
+            }
+        }
+
+        // Brent's method as in "Numerical Recipes", with Newton steps
+        c = b;
+        fc = fb;
+        T d = b - a, e = d;
+        const T epsilon = std::numeric_limits<T>::epsilon();
+
+        while (result.iterations < FMaxIterations) {
+            if ((fb > T(0) && fc > T(0)) || (fb < T(0) && fc < T(0))) {
+                c = a;
+                fc = fa;
+                d = e = b - a;
+            }
+
+            // b is the best guess so far
+            if (absolute(fc) < absolute(fb)) {
+                a = b; b = c; c = a;
+                fa = fb; fb = fc; fc = fa;
+            }
+
+            const T tolerance = T(2) * epsilon * absolute(b) + FTolerance / T(2);
+            const T middle = (c - b) / T(2);
+
+            if (absolute(middle) <= tolerance || fb == T(0)) {
+                result.x = b;
+                result.status = CONVERGED;
+                return result;
+            }
+
+            bool newton = false;
+            if (FDerivative.get()) {
+                const T derivative = calculate(FDerivative.get(), b);
+                ++result.iterations;
+
+                // inside the bracket, and at least twice as fast as bisecting
+                if (derivative != T(0) && derivative == derivative) {
+                    const T step = -fb / derivative;
+
+                    if ((middle > T(0) ? step > T(0) && step < middle + middle
+                                       : step < T(0) && step > middle + middle)
+                            && absolute(step) < absolute(e) / T(2)) {
+                        e = d;
+                        d = step;
+                        newton = true;
+                    }
+                }
+            }
+
+            if (newton)
+                ;
+            else if (absolute(e) >= tolerance && absolute(fa) > absolute(fb)) {
+                // inverse quadratic interpolation, or secant if a == c
+                const T s = fb / fa;
+                T p, q;
+
+                if (a == c) {
+                    p = T(2) * middle * s;
+                    q = T(1) - s;
+                } else {
+                    const T r = fb / fc;
+                    q = fa / fc;
+                    p = s * (T(2) * middle * q * (q - r) - (b - a) * (r - T(1)));
+                    q = (q - T(1)) * (r - T(1)) * (s - T(1));
+                }
+
+                if (p > T(0))
+                    q = -q;
+                p = absolute(p);
+
+                const T min1 = T(3) * middle * q - absolute(tolerance * q);
+                const T min2 = absolute(e * q);
+
+                if (T(2) * p < (min1 < min2 ? min1 : min2)) {
+                    e = d;
+                    d = p / q;
+                } else {
+                    d = middle;
+                    e = d;
+                }
+            } else {
+                d = middle;
+                e = d;
+            }
+
+            a = b;
+            fa = fb;
+
+            if (absolute(d) > tolerance)
+                b += d;
+            else
+                b += middle > T(0) ? tolerance : -tolerance;
+
+            fb = calculate(FExpression.get(), b) - AY;
+            ++result.iterations;
+        }
+
+        result.x = b;
+        result.status = NO_CONVERGENCE;
+    } catch (const EMath&) {
+        result.status = FAILED;
+    }
+
+    return result;
+}
+
+template<class T>
+void TSolver<T>::TJob::run() {
+    const T *guess = 0;
+
+    for (const T *y = begin; y != end; ++y, ++result) {
+        *result = solver->solve(*y, guess);
+        guess = result->status == CONVERGED ? &result->x : 0;
+    }
+}
+
+template<class T>
+void TSolver<T>::solve(const T *ABegin, const T *AEnd, TResult *AResult, unsigned AThreads) const {
+    const unsigned count = AEnd - ABegin;
+    const unsigned threads = AThreads < 1 ? 1 : AThreads > count ? count : AThreads;
+
+    std::vector<TJob> jobs(threads);
+
+    for (unsigned i = 0; i < threads; ++i) {
+        const unsigned first = count * i / threads, last = count * (i + 1) / threads;
+
+        jobs[i].solver = this;
+        jobs[i].begin = ABegin + first;
+        jobs[i].end = ABegin + last;
+        jobs[i].result = AResult + first;
+    }
+
+    parallel(jobs);
+}
+
+} // namespace math
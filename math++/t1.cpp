@@ -7,7 +7,7 @@
 #include <math++/library.h>
 #include <math++/utils.h>
 #include <math++/matcher.h>
-//#include <math++/biginteger.h>
+#include <math++/biginteger.h>
 
 #include <cmath>
 
@@ -16,8 +16,6 @@
 
 int main(int argc, char *argv[]) {
     try {
-#if 0
-#if 0
         math::TBigInteger a(1);
         math::TBigInteger b(2);
         math::TBigInteger c("3");
@@ -31,7 +29,7 @@ int main(int argc, char *argv[]) {
                   << r << std::endl
                   << "--------------------" << std::endl
                   << std::endl;
-#endif
+#if 0
         math::TLibrary<double> library;
         library.insert(math::TConstant<double>("e", 2.1718));//M_E));
         library.insert(math::TConstant<double>("pi", 3.1415));//M_PI));
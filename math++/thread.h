@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////
+//  Math Type Library
+//  $Id$
+//  (This file contains the thread synchronization helpers)
+//
+//  Copyright (c) 2002 by Christian Parpart <cparpart@surakware.net>
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Library General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Library General Public License for more details.
+//
+//  You should have received a copy of the GNU Library General Public License
+//  along with this library; see the file COPYING.LIB.  If not, write to
+//  the Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+//  Boston, MA 02111-1307, USA.
+///////////////////////////////////////////////////////////////////////
+#ifndef libmath_thread_h
+#define libmath_thread_h
+
+// Thread support gets enabled when compiling with POSIX threads
+// (e.g. g++ -pthread), otherwise the classes below do nothing.
+#if defined(_REENTRANT)
+#   include <pthread.h>
+#   include <unistd.h>
+#endif
+
+#include <vector>
+
+namespace math {
+
+/**
+  * TMutex is a simple (non recursive) mutual exclusion lock.
+  */
+class TMutex {
+private:
+#if defined(_REENTRANT)
+    pthread_mutex_t FMutex;
+#endif
+
+    // mutexes are not copyable
+    TMutex(const TMutex&);
+    TMutex& operator=(const TMutex&);
+
+public:
+#if defined(_REENTRANT)
+    TMutex() { pthread_mutex_init(&FMutex, 0); }
+    ~TMutex() { pthread_mutex_destroy(&FMutex); }
+
+    void lock() { pthread_mutex_lock(&FMutex); }
+    void unlock() { pthread_mutex_unlock(&FMutex); }
+#else
+    TMutex() {}
+
+    void lock() {}
+    void unlock() {}
+#endif
+};
+
+/**
+  * TMutexLocker locks the given mutex for the lifetime of itself.
+  */
+class TMutexLocker {
+private:
+    TMutex& FMutex;
+
+    TMutexLocker(const TMutexLocker&);
+    TMutexLocker& operator=(const TMutexLocker&);
+
+public:
+    TMutexLocker(TMutex& AMutex) : FMutex(AMutex) { FMutex.lock(); }
+    ~TMutexLocker() { FMutex.unlock(); }
+};
+
+/// returns the number of threads worth to be started for parallel work
+inline unsigned processors() {
+#if defined(_REENTRANT) && defined(_SC_NPROCESSORS_ONLN)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return count > 0 ? count : 1;
+#else
+    return 1;
+#endif
+}
+
+#if defined(_REENTRANT)
+template<class TJob>
+void *runJob(void *AJob) {
+    static_cast<TJob *>(AJob)->run();
+    return 0;
+}
+#endif
+
+/**
+  * runs the run() method of each job in AJobs in its own thread (the last 
+  * one in the calling thread) and returns when all of them are done.
+  * The jobs must not throw. Without thread support they just run in order.
+  */
+template<class TJob>
+void parallel(std::vector<TJob>& AJobs) {
+#if defined(_REENTRANT)
+    std::vector<pthread_t> threads;
+    threads.reserve(AJobs.size());
+
+    for (unsigned i = 0; i + 1 < AJobs.size(); ++i) {
+        pthread_t thread;
+
+        if (pthread_create(&thread, 0, &runJob<TJob>, &AJobs[i]) == 0)
+            threads.push_back(thread);
+        else
+            AJobs[i].run(); // out of threads, so do it ourself
+    }
+
+    if (!AJobs.empty())
+        AJobs.back().run();
+
+    for (unsigned i = 0; i < threads.size(); ++i)
+        pthread_join(threads[i], 0);
+#else
+    for (unsigned i = 0; i < AJobs.size(); ++i)
+        AJobs[i].run();
+#endif
+}
+
+} // namespace math
+
+#endif
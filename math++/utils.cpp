@@ -21,50 +21,619 @@
 //  Boston, MA 02111-1307, USA.
 ///////////////////////////////////////////////////////////////////////
 #include <math++/utils.h>
+#include <math++/thread.h>
 #include <sstream>
+#include <algorithm>
 
 #include <cmath>
 
 namespace math {
 
-inline unsigned long long pow(unsigned long long ABase, unsigned long long AExp) {
-    unsigned long long result = 1;
+// TPrimeTable holds the primes below 2^16, found by the sieve of Eratosthenes
+class TPrimeTable {
+public:
+    enum { LIMIT = 65536 };
+
+    std::vector<unsigned> primes;
+
+    // for each odd prime p its inverse modulo 2^64 and (2^64 - 1) / p: 
+    // p divides n exactly if n * inverse <= limit, then n / p = n * inverse
+    std::vector<unsigned long long> inverses;
+    std::vector<unsigned long long> limits;
+
+    TPrimeTable() : FComposite(LIMIT / 2) {
+        // FComposite[i] tells whether 2i+1 is composite
+        FComposite[0] = true;
+        for (unsigned i = 3; i * i < LIMIT; i += 2)
+            if (!FComposite[i / 2])
+                for (unsigned j = i * i; j < LIMIT; j += 2 * i)
+                    FComposite[j / 2] = true;
+
+        primes.push_back(2);
+        for (unsigned i = 3; i < LIMIT; i += 2)
+            if (!FComposite[i / 2])
+                primes.push_back(i);
+
+        inverses.resize(primes.size());
+        limits.resize(primes.size());
+        for (unsigned i = 1; i < primes.size(); ++i) {
+            unsigned long long p = primes[i], x = p;
+
+            for (unsigned k = 0; k < 5; ++k) // Newton's iteration, 3 bits to 96
+                x *= 2 - p * x;
 
-    while (AExp--)
-        result *= ABase; 
+            inverses[i] = x;
+            limits[i] = ~0ULL / p;
+        }
+    }
+
+    /// returns true if ANumber (below LIMIT) is a prime
+    bool contains(unsigned ANumber) const {
+        return ANumber & 1 ? !FComposite[ANumber / 2] : ANumber == 2;
+    }
+
+private:
+    std::vector<bool> FComposite;
+};
+
+// returns the prime table, it's built on first use
+static const TPrimeTable& primeTable() {
+    static const TPrimeTable table;
+    return table;
+}
 
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 TUInt128;
+#endif
+
+// returns a * b mod m
+static inline unsigned long long mulmod(unsigned long long a, unsigned long long b,
+    unsigned long long m) {
+
+    if (!(m >> 32))
+        return a * b % m; // both factors are below 2^32
+
+#if defined(__SIZEOF_INT128__)
+    return (unsigned long long)(TUInt128(a) * b % m);
+#else
+    // double and add, without ever overflowing
+    unsigned long long result = 0;
+    for (a %= m; b; b >>= 1) {
+        if (b & 1)
+            result = result >= m - a ? result - (m - a) : result + a;
+        a = a >= m - a ? a - (m - a) : a + a;
+    }
     return result;
+#endif
 }
 
-bool isPrime(unsigned long long ANumber) {
-    if (ANumber == 1)
-        return false;
+// returns a^e mod m
+static inline unsigned long long powmod(unsigned long long a, unsigned long long e,
+    unsigned long long m) {
 
-    if (!(ANumber & 1))
-        return ANumber == 2;
+    unsigned long long result = 1;
+    for (a %= m; e; e >>= 1) {
+        if (e & 1)
+            result = mulmod(result, a, m);
+        a = mulmod(a, a, m);
+    }
+    return result;
+}
 
-    if (ANumber == 3)
+// the strong probable prime test of the odd number n > 2 to base a
+static bool probablePrime(unsigned long long n, unsigned long long a) {
+    a %= n;
+    if (!a)
         return true;
 
-    unsigned long long n = 3;
-    while (ANumber % n) {
-        n += 2;
-        
-        if ((n * n) > ANumber)
-            return true;
+    unsigned long long d = n - 1;
+    unsigned s = 0;
+    while (!(d & 1)) {
+        d >>= 1;
+        ++s;
     }
 
+    unsigned long long x = powmod(a, d, n);
+    if (x == 1 || x == n - 1)
+        return true;
+
+    while (--s) {
+        x = mulmod(x, x, n);
+        if (x == n - 1)
+            return true;
+    }
     return false;
 }
 
+bool isPrime(unsigned long long ANumber) {
+    const TPrimeTable& table = primeTable();
+
+    if (ANumber < TPrimeTable::LIMIT)
+        return table.contains(unsigned(ANumber));
+
+    // trial division catches most composites cheaply
+    for (unsigned i = 0; i < 64; ++i)
+        if (ANumber % table.primes[i] == 0)
+            return false;
+
+    // Miller-Rabin with bases known to be deterministic for the range
+    if (!(ANumber >> 32))
+        return probablePrime(ANumber, 2)
+            && probablePrime(ANumber, 7)
+            && probablePrime(ANumber, 61);
+
+    static const unsigned long long bases[] = {
+        2, 325, 9375, 28178, 450775, 9780504, 1795265022
+    };
+
+    for (unsigned i = 0; i < sizeof(bases) / sizeof(*bases); ++i)
+        if (!probablePrime(ANumber, bases[i]))
+            return false;
+
+    return true;
+}
+
+void isPrime(const unsigned long long *ABegin, const unsigned long long *AEnd, bool *AResult) {
+    primeTable(); // build it just once, before the loop
+
+    for (const unsigned long long *i = ABegin; i != AEnd; ++i)
+        *AResult++ = isPrime(*i);
+}
+
+// the primes 3, 5, 7, 11 and 13 are sieved out once into a pattern, which 
+// gets copied into each segment (a wheel of 2*3*5*7*11*13 = 30030)
+class TSievePattern {
+public:
+    enum { WORDS = 15015 }; // the period in odd numbers, 64 times
+
+    unsigned long long words[WORDS];
+
+    TSievePattern() {
+        for (unsigned w = 0; w < WORDS; ++w) {
+            words[w] = 0;
+
+            for (unsigned b = 0; b < 64; ++b) {
+                unsigned long long n = 2 * (64ULL * w + b) + 1;
+
+                if (n % 3 && n % 5 && n % 7 && n % 11 && n % 13)
+                    words[w] |= 1ULL << b;
+            }
+        }
+    }
+};
+
+static const TSievePattern& sievePattern() {
+    static const TSievePattern pattern;
+    return pattern;
+}
+
+static inline unsigned popCount(unsigned long long AWord) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(AWord);
+#else
+    unsigned result = 0;
+    for (; AWord; AWord &= AWord - 1)
+        ++result;
+    return result;
+#endif
+}
+
+static inline unsigned lowestBit(unsigned long long AWord) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(AWord);
+#else
+    unsigned result = 0;
+    for (; !(AWord & 1); AWord >>= 1)
+        ++result;
+    return result;
+#endif
+}
+
+// returns floor(sqrt(ANumber))
+static unsigned long long squareRoot(unsigned long long ANumber) {
+    unsigned long long r = (unsigned long long)std::sqrt(double(ANumber));
+
+    while (r && r > ANumber / r)
+        --r;
+    while (r < 4294967295ULL && r + 1 <= ANumber / (r + 1))
+        ++r;
+
+    return r;
+}
+
+// a prime above the segment size, waiting for the segment of its next multiple
+struct TBucketEntry {
+    unsigned prime;
+    unsigned long long index;
+};
+
+/**
+  * sieves the range [AFrom, ATo] segment by segment, using the odd sieving 
+  * primes APrimes from 17 up to sqrt(ATo) (smaller ones are skipped).
+  * The primes found are appended to AOutput unless it's 0, the number 
+  * of them is returned.
+  *
+  * Only odd numbers are stored, bit i of the sieve stands for 2i+1. Each 
+  * segment fits into the level 2 cache; primes spanning more than a 
+  * segment are kept in buckets of the segment they hit next.
+  */
+static unsigned long long sieve(unsigned long long AFrom, unsigned long long ATo,
+    const std::vector<unsigned>& APrimes, std::vector<unsigned long long> *AOutput) {
+
+    enum { WORDS = 4096, BITS = WORDS * 64 };
+
+    unsigned long long count = 0;
+
+    if (AFrom > ATo || ATo < 2)
+        return 0;
+
+    if (AFrom <= 2) {
+        ++count;
+        if (AOutput)
+            AOutput->push_back(2);
+    }
+
+    if (ATo < 3)
+        return count;
+
+    const unsigned long long first = AFrom / 2;
+    const unsigned long long last = (ATo - 1) / 2;
+    const unsigned long long start = first & ~63ULL;
+
+    std::vector<unsigned> medium;
+    std::vector<unsigned long long> next;
+    std::vector<std::vector<TBucketEntry> > buckets;
+    std::vector<TBucketEntry> waiting; // the large primes, until they get in reach
+    unsigned long long reached = 0;
+
+    for (unsigned i = 0; i < APrimes.size(); ++i) {
+        const unsigned long long p = APrimes[i];
+
+        if (p < 17)
+            continue;
+
+        // the first odd multiple to cross out, not below p^2
+        unsigned long long j = std::max(first, p * p / 2);
+        j += ((p - 1) / 2 + p - j % p) % p;
+
+        if (j > last)
+            continue;
+
+        if (p < BITS) {
+            medium.push_back(p);
+            next.push_back(j);
+        } else {
+            TBucketEntry e = { unsigned(p), j };
+            waiting.push_back(e);
+        }
+    }
+
+    // the buckets reach as many segments ahead as the largest prime spans
+    if (!waiting.empty())
+        buckets.resize(waiting.back().prime / BITS + 2);
+
+    const TSievePattern& pattern = sievePattern();
+    std::vector<unsigned long long> bits(WORDS);
+    std::vector<TBucketEntry> current;
+
+    for (unsigned long long s = start, k = 0; s <= last; s += BITS, ++k) {
+        const unsigned words = unsigned(std::min<unsigned long long>(WORDS, (last - s) / 64 + 1));
+        const unsigned long long end = s + 64ULL * words;
+
+        for (unsigned w = 0, pw = unsigned(s / 64 % TSievePattern::WORDS); w < words; ++w) {
+            bits[w] = pattern.words[pw];
+
+            if (++pw == TSievePattern::WORDS)
+                pw = 0;
+        }
+
+        if (s == 0)
+            bits[0] = (bits[0] & ~1ULL) | 0x6EULL; // not 1, but 3, 5, 7, 11 and 13
+
+        for (unsigned m = 0; m < medium.size(); ++m) {
+            const unsigned p = medium[m];
+            unsigned long long j = next[m];
+
+            for (; j < end; j += p)
+                bits[(j - s) >> 6] &= ~(1ULL << ((j - s) & 63));
+
+            next[m] = j;
+        }
+
+        if (!buckets.empty()) {
+            // (their first multiples ascend with the primes)
+            for (; reached < waiting.size()
+                   && (waiting[reached].index - start) / BITS < k + buckets.size(); ++reached)
+                buckets[(waiting[reached].index - start) / BITS % buckets.size()].push_back(waiting[reached]);
+
+            current.swap(buckets[k % buckets.size()]);
+
+            for (unsigned i = 0; i < current.size(); ++i) {
+                TBucketEntry& e = current[i];
+                bits[(e.index - s) >> 6] &= ~(1ULL << ((e.index - s) & 63));
+
+                if ((e.index += e.prime) <= last)
+                    buckets[(e.index - start) / BITS % buckets.size()].push_back(e);
+            }
+            current.clear();
+        }
+
+        // cut off what's outside the range
+        if (s < first)
+            bits[0] &= ~0ULL << (first - s);
+        if (end - 1 > last)
+            bits[words - 1] &= ~(~0ULL << ((last - s) % 64 + 1));
+
+        for (unsigned w = 0; w < words; ++w) {
+            if (AOutput)
+                for (unsigned long long b = bits[w]; b; b &= b - 1)
+                    AOutput->push_back(2 * (s + 64ULL * w + lowestBit(b)) + 1);
+
+            count += popCount(bits[w]);
+        }
+    }
+
+    return count;
+}
+
+// returns the sieving primes needed for a range up to ATo
+static void sievingPrimes(unsigned long long ATo, std::vector<unsigned>& AResult) {
+    const TPrimeTable& table = primeTable();
+    const unsigned long long root = squareRoot(ATo);
+
+    AResult.erase(AResult.begin(), AResult.end());
+
+    if (root < TPrimeTable::LIMIT) {
+        for (unsigned i = 0; i < table.primes.size() && table.primes[i] <= root; ++i)
+            AResult.push_back(table.primes[i]);
+    } else {
+        std::vector<unsigned long long> found;
+        sieve(0, root, table.primes, &found);
+
+        AResult.assign(found.begin(), found.end());
+    }
+}
+
+// TSieveJob sieves a part of a range within its own thread
+struct TSieveJob {
+    unsigned long long from, to, count;
+    const std::vector<unsigned> *primes;
+    bool collect;
+    std::vector<unsigned long long> found;
+
+    void run() {
+        found.erase(found.begin(), found.end());
+        count = sieve(from, to, *primes, collect ? &found : 0);
+    }
+};
+
+void primes(unsigned long long AFrom, unsigned long long ATo,
+    TPrimeCallback ACallback, void *AContext, unsigned AThreads) {
+
+    if (AFrom > ATo)
+        return;
+
+    std::vector<unsigned> sieving;
+    sievingPrimes(ATo, sieving);
+
+    // each job sieves some segments ahead, but not too much for its buffer
+    const unsigned long long span = std::max(1ULL << 23,
+        std::min(squareRoot(ATo), 1ULL << 27));
+
+    std::vector<TSieveJob> jobs(AThreads ? AThreads : 1);
+    for (bool done = false; !done; ) {
+        unsigned n = 0;
+
+        for (; n < jobs.size() && !done; ++n) {
+            jobs[n].from = AFrom;
+            jobs[n].to = ATo - AFrom < span ? ATo : AFrom + span - 1;
+            jobs[n].primes = &sieving;
+            jobs[n].collect = true;
+
+            if (jobs[n].to == ATo)
+                done = true;
+            else
+                AFrom = jobs[n].to + 1;
+        }
+        jobs.resize(n);
+
+        parallel(jobs);
+
+        // the callback gets them all in order, from this thread
+        for (unsigned i = 0; i < jobs.size(); ++i)
+            if (!jobs[i].found.empty())
+                ACallback(&jobs[i].found[0], &jobs[i].found[0] + jobs[i].found.size(), AContext);
+    }
+}
+
+static void appendPrimes(const unsigned long long *ABegin, const unsigned long long *AEnd,
+    void *AResult) {
+
+    std::vector<unsigned long long>& result = *static_cast<std::vector<unsigned long long> *>(AResult);
+    result.insert(result.end(), ABegin, AEnd);
+}
+
+void primes(unsigned long long AFrom, unsigned long long ATo,
+    std::vector<unsigned long long>& AResult, unsigned AThreads) {
+
+    primes(AFrom, ATo, &appendPrimes, &AResult, AThreads);
+}
+
+unsigned long long countPrimes(unsigned long long AFrom, unsigned long long ATo,
+    unsigned AThreads) {
+
+    if (AFrom > ATo)
+        return 0;
+
+    std::vector<unsigned> sieving;
+    sievingPrimes(ATo, sieving);
+
+    // one part of the range per thread
+    const unsigned threads = AThreads ? AThreads : 1;
+    const unsigned long long part = (ATo - AFrom) / threads + 1;
+
+    // a small range leaves the last threads without a part
+    std::vector<TSieveJob> jobs;
+    for (unsigned i = 0; i < threads && i * part <= ATo - AFrom; ++i) {
+        TSieveJob job;
+        job.count = 0;
+        job.from = AFrom + i * part;
+        job.to = i + 1 == threads || ATo - job.from < part ? ATo : job.from + part - 1;
+        job.primes = &sieving;
+        job.collect = false;
+
+        jobs.push_back(job);
+    }
+
+    parallel(jobs);
+
+    unsigned long long result = 0;
+    for (unsigned i = 0; i < jobs.size(); ++i)
+        result += jobs[i].count;
+
+    return result;
+}
+
+unsigned long long primePi(unsigned long long ANumber, unsigned AThreads) {
+    return countPrimes(0, ANumber, AThreads);
+}
+
 unsigned primeCount(unsigned long long ANumber,
                               unsigned long long APrime) {
-    if ((!(ANumber & 1) && ANumber != 2) || !isPrime(ANumber))
+    if (!ANumber || !isPrime(APrime))
         return 0;
 
-    unsigned long long exp = 0;
-    while (!(ANumber % pow(APrime, exp++)));
-    return exp - 2;
+    unsigned result = 0;
+    while (ANumber % APrime == 0) {
+        ANumber /= APrime;
+        ++result;
+    }
+    return result;
+}
+
+static inline unsigned long long gcd(unsigned long long a, unsigned long long b) {
+    while (b) {
+        unsigned long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// returns a non trivial divisor of the odd composite ANumber (Pollard-Brent rho)
+static unsigned long long findDivisor(unsigned long long ANumber) {
+    const unsigned long long n = ANumber;
+    const unsigned batch = 128; // differences multiplied up per gcd
+
+    for (unsigned long long c = 1; ; ++c) {
+        unsigned long long x = 0, y = 2, ys = 2, q = 1, g = 1;
+
+        for (unsigned long long r = 1; g == 1; r *= 2) {
+            x = y;
+            for (unsigned long long i = 0; i < r; ++i) {
+                y = mulmod(y, y, n);
+                y = y >= n - c ? y - (n - c) : y + c;
+            }
+
+            for (unsigned long long k = 0; k < r && g == 1; k += batch) {
+                ys = y;
+                for (unsigned long long i = 0; i < batch && i < r - k; ++i) {
+                    y = mulmod(y, y, n);
+                    y = y >= n - c ? y - (n - c) : y + c;
+                    q = mulmod(q, x > y ? x - y : y - x, n);
+                }
+                g = gcd(q, n);
+            }
+        }
+
+        // the batch overshot, so step again one by one
+        if (g == n) {
+            do {
+                ys = mulmod(ys, ys, n);
+                ys = ys >= n - c ? ys - (n - c) : ys + c;
+                g = gcd(x > ys ? x - ys : ys - x, n);
+            } while (g == 1);
+        }
+
+        if (g != n)
+            return g;
+    }
+}
+
+// adds the prime factors of ANumber (without small ones) to AFactors, unordered
+static void split(unsigned long long ANumber, std::vector<unsigned long long>& AFactors) {
+    unsigned long long pending[64]; // there are less than 64 factors
+    unsigned count = 0;
+
+    pending[count++] = ANumber;
+
+    while (count) {
+        unsigned long long n = pending[--count];
+
+        if (isPrime(n))
+            AFactors.push_back(n);
+        else {
+            unsigned long long d = findDivisor(n);
+            pending[count++] = d;
+            pending[count++] = n / d;
+        }
+    }
+}
+
+/**
+  * appends the factors of ANumber (at least 2) to AResult, using AFactors 
+  * as scratch space.
+  */
+static void appendFactors(unsigned long long ANumber,
+    std::vector<std::pair<unsigned long long, unsigned long long> >& AResult,
+    std::vector<unsigned long long>& AFactors) {
+
+    const TPrimeTable& table = primeTable();
+    unsigned long long n = ANumber;
+
+    if (!(n & 1)) {
+        unsigned e = lowestBit(n);
+        n >>= e;
+
+        AResult.push_back(std::make_pair(2ULL, (unsigned long long)e));
+    }
+
+    // trial division by the sieve primes, without dividing
+    for (unsigned i = 1; i < table.primes.size(); ++i) {
+        const unsigned long long p = table.primes[i];
+
+        if (p * p > n)
+            break;
+
+        if (n * table.inverses[i] <= table.limits[i]) {
+            unsigned long long e = 0;
+            do {
+                n *= table.inverses[i];
+                ++e;
+            } while (n * table.inverses[i] <= table.limits[i]);
+
+            AResult.push_back(std::make_pair(p, e));
+        }
+    }
+
+    if (n > 1) {
+        // n has no factors below 2^16, so it's prime below 2^32
+        AFactors.erase(AFactors.begin(), AFactors.end());
+
+        if (n >> 32)
+            split(n, AFactors);
+        else
+            AFactors.push_back(n);
+
+        std::sort(AFactors.begin(), AFactors.end());
+
+        for (unsigned i = 0; i < AFactors.size(); ++i) {
+            if (i && AFactors[i] == AFactors[i - 1])
+                ++AResult.back().second;
+            else
+                AResult.push_back(std::make_pair(AFactors[i], 1ULL));
+        }
+    }
 }
 
 unsigned factorize(unsigned long long ANumber,
@@ -72,16 +641,78 @@ unsigned factorize(unsigned long long ANumber,
 
     AResult.erase(AResult.begin(), AResult.end());
 
-    for (unsigned long long b = 2; b < ANumber; ++b)
-        if (unsigned long long e = primeCount(ANumber, b))
-            AResult.push_back(std::make_pair(b, e));
-
-    if (AResult.empty())
-        AResult.push_back(std::make_pair(ANumber, 1));
+    if (ANumber < 2)
+        AResult.push_back(std::make_pair(ANumber, 1ULL));
+    else {
+        std::vector<unsigned long long> factors;
+        appendFactors(ANumber, AResult, factors);
+    }
 
     return AResult.size();
 }
 
+// TFactorJob factorizes a part of a batch within its own thread
+struct TFactorJob {
+    const unsigned long long *numbers;
+    unsigned count;
+    std::vector<unsigned> offsets;
+    std::vector<std::pair<unsigned long long, unsigned long long> > factors;
+
+    void run() {
+        std::vector<unsigned long long> scratch;
+
+        offsets.resize(count);
+        factors.reserve(count * 3);
+
+        for (unsigned i = 0; i < count; ++i) {
+            offsets[i] = factors.size();
+
+            if (numbers[i] < 2)
+                factors.push_back(std::make_pair(numbers[i], 1ULL));
+            else
+                appendFactors(numbers[i], factors, scratch);
+        }
+    }
+};
+
+void factorize(const unsigned long long *ANumbers, unsigned ACount,
+    std::vector<unsigned>& AOffsets,
+    std::vector<std::pair<unsigned long long, unsigned long long> >& AFactors,
+    unsigned AThreads) {
+
+    primeTable(); // build it before the threads need it
+
+    const unsigned threads = std::max(1U, std::min(AThreads, ACount));
+    std::vector<TFactorJob> jobs(threads);
+
+    for (unsigned i = 0, first = 0; i < threads; ++i) {
+        jobs[i].numbers = ANumbers + first;
+        jobs[i].count = ACount / threads + (i < ACount % threads);
+        first += jobs[i].count;
+    }
+
+    parallel(jobs);
+
+    AOffsets.resize(ACount + 1);
+    AFactors.erase(AFactors.begin(), AFactors.end());
+
+    unsigned size = 0;
+    for (unsigned i = 0; i < threads; ++i)
+        size += jobs[i].factors.size();
+    AFactors.reserve(size);
+
+    unsigned k = 0;
+    for (unsigned i = 0; i < threads; ++i) {
+        const unsigned base = AFactors.size();
+
+        for (unsigned j = 0; j < jobs[i].count; ++j)
+            AOffsets[k++] = base + jobs[i].offsets[j];
+
+        AFactors.insert(AFactors.end(), jobs[i].factors.begin(), jobs[i].factors.end());
+    }
+    AOffsets[ACount] = AFactors.size();
+}
+
 // converts given number to string
 inline std::string strcnv(unsigned long long ANumber) {
     std::stringstream s;
@@ -90,24 +721,77 @@ inline std::string strcnv(unsigned long long ANumber) {
 }
 
 std::string factorize(unsigned long long ANumber) {
+    std::vector<std::pair<unsigned long long, unsigned long long> > factors;
+    factorize(ANumber, factors);
+
     std::string result;
 
-    for (unsigned long long b = 2; b < ANumber; ++b) {
-        if (unsigned long long e = primeCount(ANumber, b)) {
-            if (result.size())
-                result += "*";
+    for (unsigned i = 0; i < factors.size(); ++i) {
+        if (result.size())
+            result += "*";
 
-            result += std::string(strcnv(b))
-                    + std::string("^")
-                    + std::string(strcnv(e));
-        }
+        result += std::string(strcnv(factors[i].first))
+                + std::string("^")
+                + std::string(strcnv(factors[i].second));
     }
 
-    if (result.empty())
-        result = std::string(strcnv(ANumber))
-               + std::string("^1");
-
     return result;
 }
 
+// the CRC-32 of each byte value (polynomial 0xEDB88320), a constant, so
+// concurrent loaders and serializers never race on filling it in
+static const unsigned crcTable[256] = {
+    0x00000000U, 0x77073096U, 0xEE0E612CU, 0x990951BAU, 0x076DC419U, 0x706AF48FU,
+    0xE963A535U, 0x9E6495A3U, 0x0EDB8832U, 0x79DCB8A4U, 0xE0D5E91EU, 0x97D2D988U,
+    0x09B64C2BU, 0x7EB17CBDU, 0xE7B82D07U, 0x90BF1D91U, 0x1DB71064U, 0x6AB020F2U,
+    0xF3B97148U, 0x84BE41DEU, 0x1ADAD47DU, 0x6DDDE4EBU, 0xF4D4B551U, 0x83D385C7U,
+    0x136C9856U, 0x646BA8C0U, 0xFD62F97AU, 0x8A65C9ECU, 0x14015C4FU, 0x63066CD9U,
+    0xFA0F3D63U, 0x8D080DF5U, 0x3B6E20C8U, 0x4C69105EU, 0xD56041E4U, 0xA2677172U,
+    0x3C03E4D1U, 0x4B04D447U, 0xD20D85FDU, 0xA50AB56BU, 0x35B5A8FAU, 0x42B2986CU,
+    0xDBBBC9D6U, 0xACBCF940U, 0x32D86CE3U, 0x45DF5C75U, 0xDCD60DCFU, 0xABD13D59U,
+    0x26D930ACU, 0x51DE003AU, 0xC8D75180U, 0xBFD06116U, 0x21B4F4B5U, 0x56B3C423U,
+    0xCFBA9599U, 0xB8BDA50FU, 0x2802B89EU, 0x5F058808U, 0xC60CD9B2U, 0xB10BE924U,
+    0x2F6F7C87U, 0x58684C11U, 0xC1611DABU, 0xB6662D3DU, 0x76DC4190U, 0x01DB7106U,
+    0x98D220BCU, 0xEFD5102AU, 0x71B18589U, 0x06B6B51FU, 0x9FBFE4A5U, 0xE8B8D433U,
+    0x7807C9A2U, 0x0F00F934U, 0x9609A88EU, 0xE10E9818U, 0x7F6A0DBBU, 0x086D3D2DU,
+    0x91646C97U, 0xE6635C01U, 0x6B6B51F4U, 0x1C6C6162U, 0x856530D8U, 0xF262004EU,
+    0x6C0695EDU, 0x1B01A57BU, 0x8208F4C1U, 0xF50FC457U, 0x65B0D9C6U, 0x12B7E950U,
+    0x8BBEB8EAU, 0xFCB9887CU, 0x62DD1DDFU, 0x15DA2D49U, 0x8CD37CF3U, 0xFBD44C65U,
+    0x4DB26158U, 0x3AB551CEU, 0xA3BC0074U, 0xD4BB30E2U, 0x4ADFA541U, 0x3DD895D7U,
+    0xA4D1C46DU, 0xD3D6F4FBU, 0x4369E96AU, 0x346ED9FCU, 0xAD678846U, 0xDA60B8D0U,
+    0x44042D73U, 0x33031DE5U, 0xAA0A4C5FU, 0xDD0D7CC9U, 0x5005713CU, 0x270241AAU,
+    0xBE0B1010U, 0xC90C2086U, 0x5768B525U, 0x206F85B3U, 0xB966D409U, 0xCE61E49FU,
+    0x5EDEF90EU, 0x29D9C998U, 0xB0D09822U, 0xC7D7A8B4U, 0x59B33D17U, 0x2EB40D81U,
+    0xB7BD5C3BU, 0xC0BA6CADU, 0xEDB88320U, 0x9ABFB3B6U, 0x03B6E20CU, 0x74B1D29AU,
+    0xEAD54739U, 0x9DD277AFU, 0x04DB2615U, 0x73DC1683U, 0xE3630B12U, 0x94643B84U,
+    0x0D6D6A3EU, 0x7A6A5AA8U, 0xE40ECF0BU, 0x9309FF9DU, 0x0A00AE27U, 0x7D079EB1U,
+    0xF00F9344U, 0x8708A3D2U, 0x1E01F268U, 0x6906C2FEU, 0xF762575DU, 0x806567CBU,
+    0x196C3671U, 0x6E6B06E7U, 0xFED41B76U, 0x89D32BE0U, 0x10DA7A5AU, 0x67DD4ACCU,
+    0xF9B9DF6FU, 0x8EBEEFF9U, 0x17B7BE43U, 0x60B08ED5U, 0xD6D6A3E8U, 0xA1D1937EU,
+    0x38D8C2C4U, 0x4FDFF252U, 0xD1BB67F1U, 0xA6BC5767U, 0x3FB506DDU, 0x48B2364BU,
+    0xD80D2BDAU, 0xAF0A1B4CU, 0x36034AF6U, 0x41047A60U, 0xDF60EFC3U, 0xA867DF55U,
+    0x316E8EEFU, 0x4669BE79U, 0xCB61B38CU, 0xBC66831AU, 0x256FD2A0U, 0x5268E236U,
+    0xCC0C7795U, 0xBB0B4703U, 0x220216B9U, 0x5505262FU, 0xC5BA3BBEU, 0xB2BD0B28U,
+    0x2BB45A92U, 0x5CB36A04U, 0xC2D7FFA7U, 0xB5D0CF31U, 0x2CD99E8BU, 0x5BDEAE1DU,
+    0x9B64C2B0U, 0xEC63F226U, 0x756AA39CU, 0x026D930AU, 0x9C0906A9U, 0xEB0E363FU,
+    0x72076785U, 0x05005713U, 0x95BF4A82U, 0xE2B87A14U, 0x7BB12BAEU, 0x0CB61B38U,
+    0x92D28E9BU, 0xE5D5BE0DU, 0x7CDCEFB7U, 0x0BDBDF21U, 0x86D3D2D4U, 0xF1D4E242U,
+    0x68DDB3F8U, 0x1FDA836EU, 0x81BE16CDU, 0xF6B9265BU, 0x6FB077E1U, 0x18B74777U,
+    0x88085AE6U, 0xFF0F6A70U, 0x66063BCAU, 0x11010B5CU, 0x8F659EFFU, 0xF862AE69U,
+    0x616BFFD3U, 0x166CCF45U, 0xA00AE278U, 0xD70DD2EEU, 0x4E048354U, 0x3903B3C2U,
+    0xA7672661U, 0xD06016F7U, 0x4969474DU, 0x3E6E77DBU, 0xAED16A4AU, 0xD9D65ADCU,
+    0x40DF0B66U, 0x37D83BF0U, 0xA9BCAE53U, 0xDEBB9EC5U, 0x47B2CF7FU, 0x30B5FFE9U,
+    0xBDBDF21CU, 0xCABAC28AU, 0x53B39330U, 0x24B4A3A6U, 0xBAD03605U, 0xCDD70693U,
+    0x54DE5729U, 0x23D967BFU, 0xB3667A2EU, 0xC4614AB8U, 0x5D681B02U, 0x2A6F2B94U,
+    0xB40BBE37U, 0xC30C8EA1U, 0x5A05DF1BU, 0x2D02EF8DU
+};
+
+unsigned crc32(const char *ABegin, const char *AEnd, unsigned ACrc) {
+    unsigned crc = ~ACrc & 0xFFFFFFFFU;
+    for (const char *p = ABegin; p != AEnd; ++p)
+        crc = crcTable[(crc ^ static_cast<unsigned char>(*p)) & 0xFF] ^ (crc >> 8);
+
+    return ~crc & 0xFFFFFFFFU;
+}
+
 } // namespace math
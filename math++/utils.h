@@ -31,11 +31,54 @@ namespace math {
 
 template<class> class TNode;
 template<class> class TLibrary;
+template<class> class TExprCache;
 
 /**
-  * isPrime returns true if ANumber is a prime number, otherwise false
+  * isPrime returns true if ANumber is a prime number, otherwise false.
+  * Small numbers are looked up in a sieve, the others get trial divided 
+  * and then run through a Miller-Rabin test, which is deterministic 
+  * for all 64 bit numbers.
   */
-bool isPrime(unsigned ANumber);
+bool isPrime(unsigned long long ANumber);
+
+/**
+  * tests each number in [ABegin, AEnd) for being prime and stores the 
+  * results in order into AResult.
+  */
+void isPrime(const unsigned long long *ABegin, const unsigned long long *AEnd, bool *AResult);
+
+/**
+  * TPrimeCallback gets a block of consecutive primes [ABegin, AEnd) found 
+  * by primes(), along with the context passed to it.
+  */
+typedef void (*TPrimeCallback)(const unsigned long long *ABegin,
+    const unsigned long long *AEnd, void *AContext);
+
+/**
+  * passes all primes in [AFrom, ATo] to ACallback, in ascending order and 
+  * in blocks. The range is sieved segment by segment (each fitting into 
+  * the CPU cache) by AThreads threads, but the callback is always called 
+  * from the calling thread.
+  */
+void primes(unsigned long long AFrom, unsigned long long ATo,
+    TPrimeCallback ACallback, void *AContext = 0, unsigned AThreads = 1);
+
+/**
+  * appends all primes in [AFrom, ATo] to AResult, in ascending order.
+  */
+void primes(unsigned long long AFrom, unsigned long long ATo,
+    std::vector<unsigned long long>& AResult, unsigned AThreads = 1);
+
+/**
+  * returns the number of primes in [AFrom, ATo], sieved by AThreads threads.
+  */
+unsigned long long countPrimes(unsigned long long AFrom, unsigned long long ATo,
+    unsigned AThreads = 1);
+
+/**
+  * returns the number of primes up to ANumber, pi(ANumber).
+  */
+unsigned long long primePi(unsigned long long ANumber, unsigned AThreads = 1);
 
 /**
   * primeCount returns the number of primes (APrime) in ANumber.
@@ -52,16 +95,36 @@ unsigned primeCount(unsigned long long ANumber,
   * The result structure is designed as follows:
   *   first value of a pair is the prim factor.
   *   second value of a pair is the number of occurence.
+  *
+  * The factors are found by trial division by the primes below 2^16, 
+  * any larger ones by Pollard's rho method (in Brent's variant).
   */
 unsigned factorize(unsigned long long ANumber, 
     std::vector<std::pair<unsigned long long, unsigned long long> >& AResult);
 
+/**
+  * factorizes the ACount numbers at ANumbers at once, by AThreads threads.
+  * The factors of all numbers get stored one after another in AFactors, 
+  * the ones of ANumbers[i] (as described above) from AFactors[AOffsets[i]] 
+  * up to before AFactors[AOffsets[i + 1]]. AOffsets gets ACount + 1 entries.
+  */
+void factorize(const unsigned long long *ANumbers, unsigned ACount,
+    std::vector<unsigned>& AOffsets,
+    std::vector<std::pair<unsigned long long, unsigned long long> >& AFactors,
+    unsigned AThreads = 1);
+
 /**
   * Factorizes the given number (ANumber) and returns its result
   * as a well formatted string.
   */
 std::string factorize(unsigned long long ANumber);
 
+/**
+  * returns the CRC-32 (as used by zlib and PNG) of the bytes [ABegin, AEnd).
+  * Pass the previous result as ACrc to continue a checksum.
+  */
+unsigned crc32(const char *ABegin, const char *AEnd, unsigned ACrc = 0);
+
 /**
   * Simply returns calculates expression (AExpression) without usage of
   * any library.
@@ -75,6 +138,13 @@ T calculate(const std::string& AExpression);
 template<class T>
 T calculate(const std::string& AExpression, const TLibrary<T>&);
 
+/**
+  * Simply returns calculates expression (AExpression), parsing it only 
+  * if it's not in the given cache yet.
+  */
+template<class T>
+T calculate(const std::string& AExpression, const TLibrary<T>&, TExprCache<T>&);
+
 /**
   * This method derivates given expression, AExpression, ACount times.
   * and returns its result.
@@ -110,12 +180,16 @@ TNode<T> *createTree(const std::string& AExprStr);
 
 /**
   * Creates the "umkehrfunktion" of given input tree.
+  * Not done symbolically yet; see TSolver<> in math++/solver.h for 
+  * solving f(x) = y numerically.
   */
 template<class T>
 TNode<T> *umkehrfunktion(const TNode<T> *ATree);
 
 /**
   * Creates the integral of given input tree.
+  * Not done symbolically yet; see TIntegrator<> in math++/integrator.h 
+  * for definite integrals.
   */
 template<class T>
 TNode<T> *integral(const TNode<T> *ATree);
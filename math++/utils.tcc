@@ -27,9 +27,11 @@
 #include <math++/derive.h>
 #include <math++/printer.h>
 #include <math++/simplifier.h>
+#include <math++/expander.h>
 #include <math++/library.h>
 #include <math++/calculator.h>
 #include <math++/reader.h>
+#include <math++/exprcache.h>
 
 #include <memory>
 
@@ -37,7 +39,14 @@ namespace math {
 
 template<class T>
 T calculate(const std::string& AExprStr, const TLibrary<T>& ALib) {
-    return TCalculator<T>::calculate(TFunction<T>("f", AExprStr), T(), ALib);
+    std::auto_ptr<TNode<T> > expr(TReader<T>::parse(AExprStr));
+
+    return TCalculator<T>::calculate(expr.get(), T(), ALib);
+}
+
+template<class T>
+T calculate(const std::string& AExprStr, const TLibrary<T>& ALib, TExprCache<T>& ACache) {
+    return ACache.calculate(AExprStr, ALib);
 }
 
 template<class T>
@@ -63,6 +72,11 @@ TNode<T> *derive(const TNode<T> *AExpression, unsigned ACount) {
     return result;
 }
 
+template<class T>
+TNode<T> *expand(const TNode<T> *AExpression) {
+    return TExpander<T>::expand(AExpression);
+}
+
 template<class T>
 TNode<T> *createTree(const std::string& AExprStr) {
     return TReader<T>::parse(AExprStr);
@@ -47,6 +47,10 @@ template<class> class TLnNode;
 template<class> class TFuncNode;    // user defined functions
 
 template<class> class TIfNode;      // extended functions
+template<class> class TTableNode;
+template<class> class TSumNode;
+template<class> class TProdNode;
+template<class> class TLetNode;
 
 template<class> class TEquNode;     // equations
 template<class> class TUnEquNode;
@@ -85,6 +89,10 @@ public:
 
     virtual void visit(TFuncNode<T> *) = 0;
     virtual void visit(TIfNode<T> *) = 0;
+    virtual void visit(TTableNode<T> *) = 0;
+    virtual void visit(TSumNode<T> *) = 0;
+    virtual void visit(TProdNode<T> *) = 0;
+    virtual void visit(TLetNode<T> *) = 0;
 
     virtual void visit(TEquNode<T> *) = 0;
     virtual void visit(TUnEquNode<T> *) = 0;